@@ -884,6 +884,13 @@ TESTS=(
   "if_eqz 0"
   "if_eqz 1"
   "${TESTS_I32_STORE_LOAD[@]}"
+  "i32_store_load_alias 0 100"
+  "i32_store_load_alias 100 96"
+  "i32_store_load_alias 96 100"
+  "iv_index_store_load 0"
+  "iv_index_store_load 5"
+  "global_ptr_store_load 0"
+  "global_ptr_store_load 60"
   "${TESTS_I64_STORE_LOAD[@]}"
   "${TESTS_I64_EXTEND_I32_S[@]}"
   "${TESTS_I64_EXTEND_I32_U[@]}"
@@ -914,6 +921,88 @@ TESTS=(
   "call_simple 3"
   "call_simple 5"
   "call_simple 10"
+  "call_chain 0"
+  "call_chain 5"
+  "call_chain -7"
+  "call_in_loop 1"
+  "call_in_loop 4"
+  "call_in_loop 10"
+  "f64_param_return_call 0"
+  "f64_param_return_call 3"
+  "const_arg_call 0"
+  "const_arg_call 5"
+  "const_call_fold 0"
+  "const_call_fold 7"
+  "i64_const_call_fold 0"
+  "i64_const_call_fold 5"
+  "unroll_sum 0"
+  "unroll_sum 1"
+  "unroll_sum 7"
+  "unroll_sum 8"
+  "unroll_sum 37"
+  "do_while_loop 0"
+  "do_while_loop 5"
+  "do_while_loop 20"
+  "do_while_loop -1"
+  "loop_rotate 0"
+  "loop_rotate 1"
+  "loop_rotate 5"
+  "loop_rotate -3"
+  "v128_add_store_load 0"
+  "v128_add_store_load 7"
+  "f32_store_load 0"
+  "f32_store_load 3"
+  "f64_fast_math_store_load 0"
+  "f64_fast_math_store_load 3"
+  "f64_fma_store_load 0"
+  "f64_fma_store_load 5"
+  "scalar_repl_store_load 0"
+  "scalar_repl_store_load 9"
+  "select_min_max 3 5"
+  "select_min_max 9 2"
+  "select_min_max 4 4"
+  "i64_select_param 1 4294967296 1"
+  "i64_select_param 0 -5 8589934593"
+  "i64_select_param 7 -4294967297 3"
+  "loop_unswitch_store_load 0"
+  "loop_unswitch_store_load 3"
+  "loop_unswitch_store_load 4"
+  "loop_idiom_store_load 0"
+  "loop_idiom_store_load 3"
+  "loop_idiom_store_load 9"
+  "frame_select_store_load 0"
+  "frame_select_store_load 1"
+  "specialize_store_load 0"
+  "specialize_store_load 5"
+  "specialize_store_load 22"
+  "unroll_jam_store_load 0"
+  "unroll_jam_store_load 4"
+  "unroll_jam_store_load 6"
+  "unroll_jam_store_load 13"
+  "matmul_tile_store_load 0"
+  "matmul_tile_store_load 2"
+  "matmul_tile_store_load 7"
+  "distribute_store_load 0"
+  "distribute_store_load 9"
+  "distribute_store_load 40"
+  "parallel_store_load 0"
+  "parallel_store_load 77"
+  "parallel_store_load 1023"
+  "wavefront_store_load 0"
+  "wavefront_store_load 5"
+  "wavefront_store_load 47"
+  "temporal_block_store_load 0"
+  "temporal_block_store_load 9"
+  "temporal_block_store_load 63"
+  "fuse_store_load 0"
+  "fuse_store_load 9"
+  "fuse_store_load 200"
+  "vectorize_store_load 0"
+  "vectorize_store_load 9"
+  "vectorize_store_load 30"
+  "slp_store_load 0"
+  "slp_store_load 9"
+  "slp_store_load 30"
   "factorial_rec 1"
   "factorial_rec 2"
   "factorial_rec 3"
@@ -924,7 +1013,44 @@ TESTS=(
   "factorial_rec 8"
   "factorial_rec 9"
   "factorial_rec 10"
+  "gcd_rec 48 36"
+  "gcd_rec 7 0"
+  "gcd_rec 1071 462"
   "minidp"
+  "deps_dump"
+)
+
+# 各 pass 自己的測試在預設 -O0 下 pass 全關，等於沒測：這裡列的 flags
+# 接在 WASM2SEA_FLAGS 後面，整組用 -O1 / -O2 重跑時也一樣會打開
+declare -A TEST_FLAGS=(
+  [i32_store_load_alias]="--load-elim"
+  [iv_index_store_load]="--assume-inbounds-addressing"
+  [global_ptr_store_load]="--load-elim --promote-stack-slots"
+  [call_in_loop]="--inline"
+  [gcd_rec]="--tail-recursion"
+  [const_arg_call]="--ipcp"
+  [const_call_fold]="--partial-eval"
+  [i64_const_call_fold]="--partial-eval"
+  [unroll_sum]="--unroll"
+  [f64_fma_store_load]="--fp-contract=fast"
+  [f64_fast_math_store_load]="--fast-math --fp-contract=off"
+  [scalar_repl_store_load]="--scalar-repl --assume-noalias-params"
+  [select_min_max]="--if-convert"
+  [i64_select_param]="--if-convert"
+  [loop_rotate]="--rotate-loops"
+  [loop_unswitch_store_load]="--unswitch"
+  [loop_idiom_store_load]="--loop-idiom"
+  [frame_select_store_load]="--load-elim"
+  [specialize_store_load]="--specialize-calls"
+  [unroll_jam_store_load]="--unroll-and-jam --assume-noalias-params"
+  [matmul_tile_store_load]="--interchange --tile --tile-size=4 --assume-noalias-params"
+  [distribute_store_load]="--distribute --assume-noalias-params"
+  [parallel_store_load]="--threads=2 --assume-noalias-params"
+  [wavefront_store_load]="--threads=2 --tile-size=8 --assume-noalias-params"
+  [temporal_block_store_load]="--temporal-blocking --tile-size=16 --assume-noalias-params"
+  [fuse_store_load]="--fuse --assume-noalias-params"
+  [vectorize_store_load]="--vectorize"
+  [slp_store_load]="--slp-vectorize"
 )
 
 PASS=0
@@ -962,21 +1088,43 @@ for entry in "${TESTS[@]}"; do
     continue
   fi
 
+  # --print-after=deps 的 golden：value id 換成 v#，其他（位址多項式、距離、
+  # 方向向量）要一字不差
+  if [ "$TEST" = "deps_dump" ]; then
+    wat2wasm ~/wasm2sea/tests/deps_dump.wat -o ~/wasm2sea/tests/deps_dump.wasm 2>/dev/null
+    (cd /tmp && ~/wasm2sea/build/wasm2sea ~/wasm2sea/tests/deps_dump.wasm --print-after=deps \
+        --out-c /tmp/deps_dump.c 2>/dev/null) \
+      | sed -n '/IR Dump After DependenceAnalysis/,$p' \
+      | grep -E '^(// |v[0-9]+ = |flow |anti |output )' | sed 's/\bv[0-9]\+/v#/g' > /tmp/actual_out.txt
+
+    if diff -u ~/wasm2sea/tests/deps_dump.expected /tmp/actual_out.txt; then
+      echo "PASS: deps_dump"
+      PASS=$((PASS+1))
+    else
+      echo "FAIL: deps_dump"
+      FAIL=$((FAIL+1))
+    fi
+    continue
+  fi
+
+  FLAGS="$WASM2SEA_FLAGS ${TEST_FLAGS[$TEST]}"
+
   # wasmtime expected
   EXPECTED=$(wasmtime run --invoke test ~/wasm2sea/tests/${TEST}.wasm $ARGS 2>/dev/null)
 
   # your pipeline actual
-  bash ~/wasm2sea/tests/run_test.sh $TEST $ARGS > /tmp/actual_out.txt 2>&1
-  ACTUAL=$(bash ~/wasm2sea/tests/run_test.sh $TEST $ARGS 2>/dev/null | tail -1)
+  WASM2SEA_FLAGS="$FLAGS" bash ~/wasm2sea/tests/run_test.sh $TEST $ARGS > /tmp/actual_out.txt 2>&1
+  ACTUAL=$(WASM2SEA_FLAGS="$FLAGS" bash ~/wasm2sea/tests/run_test.sh $TEST $ARGS 2>/dev/null | tail -1)
 
   if [ "$EXPECTED" = "$ACTUAL" ]; then
     echo "PASS: $TEST ($ARGS) = $EXPECTED"
     PASS=$((PASS+1))
   else
-    echo "FAIL: $TEST ($ARGS) expected=$EXPECTED actual=$ACTUAL"
+    echo "FAIL: $TEST ($ARGS) [${FLAGS# }] expected=$EXPECTED actual=$ACTUAL"
     FAIL=$((FAIL+1))
   fi
 done
 
 echo ""
-echo "Results: $PASS passed, $FAIL failed"
\ No newline at end of file
+echo "Results: $PASS passed, $FAIL failed"
+[ "$FAIL" -eq 0 ]
@@ -0,0 +1,190 @@
+/*
+ * wasm2sea runtime：work-stealing thread pool（見 w2s_runtime.h）
+ *
+ * 一次只跑一個 w2s_parallel_for：
+ *
+ *   1. 呼叫端把 [lo, hi) 切成 threads × kChunksPerThread 個 chunk，輪流
+ *      放進每個 worker 的 deque，喚醒 worker
+ *   2. 每個 worker（呼叫端是 0 號）從自己 deque 的尾端拿，空了就從別人
+ *      deque 的頭偷；所有 deque 都空了就離開
+ *   3. 呼叫端等到所有 worker 都離開才回傳（ctx 在呼叫端的 stack 上）
+ *
+ * chunk 只在開始時放進去，之後只會變少，所以「偷不到」就表示沒有工作了。
+ * deque 很短（每個 worker 最多 kChunksPerThread 個），每個一把 mutex。
+ * worker thread 第一次用到時才建，之後一直留著。
+ */
+#include "w2s_runtime.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+enum { kChunksPerThread = 8 };
+
+typedef struct {
+    int32_t lo, hi;
+} Range;
+
+typedef struct {
+    pthread_mutex_t lock;
+    Range items[kChunksPerThread];
+    int head, tail;   /* [head, tail) */
+} Deque;
+
+static struct {
+    pthread_mutex_t job;          /* 一次一個 w2s_parallel_for */
+    pthread_mutex_t lock;         /* 下面的欄位 */
+    pthread_cond_t wake, done;
+    int started;                  /* 已經建好的 worker thread（1 ~ started 號） */
+    unsigned long generation;
+    unsigned long born[W2S_MAX_THREADS];  /* worker 建起來時的 generation */
+    int active;                   /* 這一輪參與的 worker 數（含 0 號） */
+    int running;                  /* 還沒離開這一輪的 worker thread */
+    w2s_task_fn fn;
+    void* ctx;
+    Deque deques[W2S_MAX_THREADS];
+} pool = {
+    .job = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+static _Thread_local int in_worker;
+
+static int pop_own(int id, Range* r) {
+    Deque* d = &pool.deques[id];
+    int ok = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->head < d->tail) {
+        *r = d->items[--d->tail];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+static int steal(int id, int n, Range* r) {
+    for (int k = 1; k < n; k++) {
+        Deque* d = &pool.deques[(id + k) % n];
+        int ok = 0;
+        pthread_mutex_lock(&d->lock);
+        if (d->head < d->tail) {
+            *r = d->items[d->head++];
+            ok = 1;
+        }
+        pthread_mutex_unlock(&d->lock);
+        if (ok) return 1;
+    }
+    return 0;
+}
+
+static void run_chunks(int id, int n, w2s_task_fn fn, void* ctx) {
+    Range r;
+    while (pop_own(id, &r) || steal(id, n, &r))
+        fn(ctx, r.lo, r.hi, id);
+}
+
+static void* worker_main(void* arg) {
+    const int id = (int)(intptr_t)arg;
+    in_worker = 1;
+    pthread_mutex_lock(&pool.lock);
+    unsigned long seen = pool.born[id];
+    pthread_mutex_unlock(&pool.lock);
+    for (;;) {
+        pthread_mutex_lock(&pool.lock);
+        while (pool.generation == seen) pthread_cond_wait(&pool.wake, &pool.lock);
+        seen = pool.generation;
+        const int n = pool.active;
+        w2s_task_fn fn = pool.fn;
+        void* ctx = pool.ctx;
+        pthread_mutex_unlock(&pool.lock);
+        if (id >= n) continue;
+
+        run_chunks(id, n, fn, ctx);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.running == 0) pthread_cond_signal(&pool.done);
+        pthread_mutex_unlock(&pool.lock);
+    }
+    return NULL;
+}
+
+int w2s_num_threads(int requested) {
+    int n = requested;
+    const char* env = getenv("W2S_NUM_THREADS");
+    if (env && atoi(env) > 0) n = atoi(env);
+    if (n <= 0) n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > W2S_MAX_THREADS) n = W2S_MAX_THREADS;
+    return n;
+}
+
+/* 1 ~ n-1 號 worker 還沒建的建起來；建不起來時回傳實際能用的數量 */
+static int ensure_workers(int n) {
+    while (pool.started < n - 1) {
+        pthread_t t;
+        const int id = pool.started + 1;
+        pool.born[id] = pool.generation;
+        if (pthread_create(&t, NULL, worker_main, (void*)(intptr_t)id) != 0) break;
+        pthread_detach(t);
+        pool.started = id;
+    }
+    return pool.started + 1 < n ? pool.started + 1 : n;
+}
+
+void w2s_parallel_for(w2s_task_fn fn, void* ctx, int32_t lo, int32_t hi,
+                      int threads, int64_t min_iters) {
+    if (lo >= hi) return;
+    const int64_t iters = (int64_t)hi - lo;
+    int n = w2s_num_threads(threads);
+    if (n > iters) n = (int)iters;
+    if (n <= 1 || iters < min_iters || in_worker || pthread_mutex_trylock(&pool.job) != 0) {
+        fn(ctx, lo, hi, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    n = ensure_workers(n);
+    pthread_mutex_unlock(&pool.lock);
+    if (n <= 1) {
+        pthread_mutex_unlock(&pool.job);
+        fn(ctx, lo, hi, 0);
+        return;
+    }
+
+    /* chunk 輪流分給每個 worker：一開始就大致平均，偷的次數少 */
+    int64_t chunks = (int64_t)n * kChunksPerThread;
+    if (chunks > iters) chunks = iters;
+    static int initialized;
+    if (!initialized) {
+        for (int w = 0; w < W2S_MAX_THREADS; w++) pthread_mutex_init(&pool.deques[w].lock, NULL);
+        initialized = 1;
+    }
+    for (int w = 0; w < n; w++) pool.deques[w].head = pool.deques[w].tail = 0;
+    for (int64_t c = 0; c < chunks; c++) {
+        Deque* d = &pool.deques[c % n];
+        Range r;
+        r.lo = (int32_t)(lo + iters * c / chunks);
+        r.hi = (int32_t)(lo + iters * (c + 1) / chunks);
+        d->items[d->tail++] = r;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.active = n;
+    pool.running = n - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    in_worker = 1;
+    run_chunks(0, n, fn, ctx);
+    in_worker = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.running > 0) pthread_cond_wait(&pool.done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+    pthread_mutex_unlock(&pool.job);
+}
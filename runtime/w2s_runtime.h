@@ -0,0 +1,41 @@
+/*
+ * wasm2sea runtime：--threads=N 產生的 out.c 要跟這個一起編
+ *
+ *     cc -O2 out.c runtime/w2s_runtime.c -Iruntime -lpthread
+ *
+ * value_ir_parallel 把 DOALL loop 拆成 task，out.c 裡每個 task 的 `_run`
+ * 呼叫 w2s_parallel_for 把迭代範圍切成 chunk 交給這裡的 thread pool。
+ */
+#ifndef W2S_RUNTIME_H
+#define W2S_RUNTIME_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* worker 編號的上限（含呼叫端自己的 0 號），reduction 的部分結果陣列用 */
+#define W2S_MAX_THREADS 64
+
+/* 跑 [lo, hi) 那一段迭代；worker 是 0 ~ threads-1，同一個 worker 不會同時跑兩段 */
+typedef void (*w2s_task_fn)(void* ctx, int32_t lo, int32_t hi, int worker);
+
+/*
+ * 把 [lo, hi) 切成 chunk，用 threads 個 thread（含呼叫端）跑完才回傳。
+ * 每個 worker 先做自己 deque 裡的 chunk，做完再從別人的 deque 另一端偷。
+ *
+ * 環境變數 W2S_NUM_THREADS 蓋過 threads。迭代數少於 min_iters、threads
+ * 是 1，或是在 worker 裡面又呼叫（巢狀的平行 loop）時直接在呼叫端跑完。
+ */
+void w2s_parallel_for(w2s_task_fn fn, void* ctx, int32_t lo, int32_t hi,
+                      int threads, int64_t min_iters);
+
+/* 實際會用的 thread 數（套用 W2S_NUM_THREADS 與上限之後） */
+int w2s_num_threads(int requested);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* W2S_RUNTIME_H */
@@ -23,6 +23,7 @@
  */
 #include "ir_bridge.hpp"
 #include "value_ir.hpp"
+#include "value_ir_util.hpp"
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -93,9 +94,12 @@
 #include "node/F64AbsNode.hpp"
 #include "node/F64MinNode.hpp"
 #include "node/F64MaxNode.hpp"
+#include "node/F64FmaNode.hpp"
 #include "node/F64ConvertINode.hpp"
 #include "node/I32TruncF64Node.hpp"
 #include "node/I64TruncF64Node.hpp"
+#include "node/F32DemoteF64Node.hpp"
+#include "node/F64PromoteF32Node.hpp"
 
 // ----- Constants -----
 #include "node/I32ConstNode.hpp"
@@ -196,6 +200,10 @@ const std::unordered_map<Op, ir_node::Node*> kDispatchTable = {
     { Op::F64Log,         new ir_node::F64LogNode() },
     { Op::F64Sin,         new ir_node::F64SinNode() },
     { Op::F64Cos,         new ir_node::F64CosNode() },
+    { Op::F64Abs,         new ir_node::F64AbsNode() },
+    { Op::F64Min,         new ir_node::F64MinNode() },
+    { Op::F64Max,         new ir_node::F64MaxNode() },
+    { Op::F64Fma,         new ir_node::F64FmaNode() },
     { Op::F64Eq,          new ir_node::F64EqNode() },
     { Op::F64Ne,          new ir_node::F64NeNode() },
     { Op::F64Lt,          new ir_node::F64LtNode() },
@@ -210,6 +218,8 @@ const std::unordered_map<Op, ir_node::Node*> kDispatchTable = {
     { Op::I32TruncF64U,   new ir_node::I32TruncF64Node() },
     { Op::I64TruncF64S,   new ir_node::I64TruncF64Node() },
     { Op::I64TruncF64U,   new ir_node::I64TruncF64Node() },
+    { Op::F32DemoteF64,   new ir_node::F32DemoteF64Node() },
+    { Op::F64PromoteF32,  new ir_node::F64PromoteF32Node() },
     { Op::I32Const,       new ir_node::I32ConstNode() },
     { Op::I64Const,       new ir_node::I64ConstNode() },
     { Op::F64Const,       new ir_node::F64ConstNode() },
@@ -269,6 +279,8 @@ static std::unordered_map<int, ir_type> buildLocalTypes(
     for (int idx : local_indices) {
         if (idx < (int)paramTypes.size() && paramTypes[idx] == ParamType::I64) {
             local_types[idx] = IR_I64;
+        } else if (idx < (int)paramTypes.size() && paramTypes[idx] == ParamType::F32) {
+            local_types[idx] = IR_FLOAT;
         } else if (idx < (int)paramTypes.size() && paramTypes[idx] == ParamType::F64) {
             local_types[idx] = IR_DOUBLE;
         } else {
@@ -278,6 +290,7 @@ static std::unordered_map<int, ir_type> buildLocalTypes(
             for (const auto& v : values) {
                 if ((v.op == Op::LocalSet || v.op == Op::LocalTee) &&
                     v.paramIndex == idx && v.lhs >= 0 && v.lhs < (int)values.size()) {
+                    if (values[v.lhs].type == ValueType::F32) { inferred = IR_FLOAT; break; }
                     if (values[v.lhs].type == ValueType::F64) { inferred = IR_DOUBLE; break; }
                     if (values[v.lhs].type == ValueType::I64) { inferred = IR_I64; break; }
                 }
@@ -313,29 +326,26 @@ static std::map<int, int> collectParamIndexToValueId(const ValueIR& values) {
 // }
 
 // 掃描整個 ValueIR，判斷這個函式裡有沒有任何記憶體讀寫指令
-// （Load/Store/F64Load/F64Store）。只有需要記憶體操作的函式才需要
-// 額外的 __mem 參數（見下方 mem_param 的建立）。
+// （Load/Store/F64Load/F64Store），或要把 __mem 傳給 callee 的 call。
+// 只有需要記憶體操作的函式才需要額外的 __mem 參數（見下方 mem_param
+// 的建立）。
 static bool detectMemoryOps(const ValueIR& values) {
-    for (const auto& v : values) {
-        if (v.op == Op::Load || v.op == Op::Store ||
-            v.op == Op::F64Load || v.op == Op::F64Store) {
-            return true;
-        }
-    }
-    return false;
+    return usesMemoryParam(values);
 }
 
 // ===== build() =====
 
 IRFunction* IRBridge::build(const ValueIR& values,
                              const std::vector<ParamType>& paramTypes,
-                             const std::unordered_map<int, int32_t>& globalInitValues) {
+                             const std::unordered_map<int, int32_t>& globalInitValues,
+                             const BridgeOptions& opts) {
     ir_ctx* ctx = ctx_;
 
     TRACE("--- paramTypes ---\n");
     for (size_t i = 0; i < paramTypes.size(); i++) {
         TRACE("  param[%zu] = %s\n", i,
             paramTypes[i] == ParamType::I64 ? "I64" :
+            paramTypes[i] == ParamType::F32 ? "F32" :
             paramTypes[i] == ParamType::F64 ? "F64" : "I32");
     }
     TRACE("=== Starting IR Bridge Construction ===\n");
@@ -360,21 +370,30 @@ IRFunction* IRBridge::build(const ValueIR& values,
     // 第一遍：收集 param
     param_index_to_value_id = collectParamIndexToValueId(values);
 
-    // 第二遍：建 ir_PARAM
+    // 第二遍：建 ir_PARAM。宣告的參數每個都建，不管 ValueIR 裡還有沒有
+    // 對應的 Param 節點（沒用到、或被 ipcp / specialization 換成常數），
+    // C 函式的簽章才會跟 caller 傳的引數對得上。
     TRACE("--- Phase 1: Creating Parameters ---\n");
-    for (auto& [param_idx, value_id] : param_index_to_value_id) {
+    std::set<int> param_indices;
+    for (int p = 0; p < (int)paramTypes.size(); p++) param_indices.insert(p);
+    for (auto& [param_idx, value_id] : param_index_to_value_id) param_indices.insert(param_idx);
+    std::map<int, ir_ref> param_refs;
+    for (int param_idx : param_indices) {
         char name[32];
         snprintf(name, sizeof(name), "p%d", param_idx);
         ir_type t = IR_I32;
         if (param_idx < (int)paramTypes.size()) {
             if (paramTypes[param_idx] == ParamType::I64) t = IR_I64;
+            else if (paramTypes[param_idx] == ParamType::F32) t = IR_FLOAT;
             else if (paramTypes[param_idx] == ParamType::F64) t = IR_DOUBLE;
         }
         int pos = has_memory_ops ? param_idx + 2 : param_idx + 1;
         ir_ref param_ref = ir_PARAM(t, name, pos);
-        value_map[value_id] = param_ref;
-        TRACE("v%d = Param(%d) -> ir_PARAM(\"%s\", %d) [node ref=%d]\n",
-            value_id, param_idx, name, param_idx + 1, param_ref);
+        param_refs[param_idx] = param_ref;
+        auto vit = param_index_to_value_id.find(param_idx);
+        if (vit != param_index_to_value_id.end()) value_map[vit->second] = param_ref;
+        TRACE("Param(%d) -> ir_PARAM(\"%s\", %d) [node ref=%d]\n",
+            param_idx, name, param_idx + 1, param_ref);
     }
 
     std::set<int> local_indices = collectLocalIndices(values);
@@ -414,11 +433,11 @@ IRFunction* IRBridge::build(const ValueIR& values,
         ir_type t = local_types.count(idx) ? local_types[idx] : IR_I32;
         ir_ref var = ir_VAR(t, name);
         local_vars[idx] = var;
-        auto it = param_index_to_value_id.find(idx);
-        if (it != param_index_to_value_id.end()) {
-            ir_VSTORE(var, value_map[it->second]);
+        auto it = param_refs.find(idx);
+        if (it != param_refs.end()) {
+            ir_VSTORE(var, it->second);
         } else {
-            ir_ref zero = ir_CONST_I32(0);
+            ir_ref zero = (t == IR_FLOAT) ? ir_CONST_FLOAT(0.0f) : ir_CONST_I32(0);
             ir_VSTORE(var, zero);
         }
     }
@@ -439,15 +458,17 @@ IRFunction* IRBridge::build(const ValueIR& values,
         }
     }
 
+    ir_node::AddrCache addr_cache;
+
     // 主迴圈
     for (size_t i = 0; i < values.size(); i++) {
         const Value& val = values[i];
         TRACE("--- Processing v%zu ---\n", i);
 
         if (val.op == Op::Param) {
-            auto it = param_index_to_value_id.find(val.paramIndex);
-            if (it != param_index_to_value_id.end())
-                value_map[i] = value_map[it->second];
+            auto it = param_refs.find(val.paramIndex);
+            if (it != param_refs.end())
+                value_map[i] = it->second;
             continue;
         }
 
@@ -455,7 +476,8 @@ IRFunction* IRBridge::build(const ValueIR& values,
             ctx_, values, paramTypes,
             value_map, local_vars, local_types,
             global_vars,
-            mem_param, has_memory_ops, i
+            mem_param, has_memory_ops, i,
+            opts.assumeInboundsAddressing, addr_cache
         };
 
         auto it = kDispatchTable.find(val.op);
@@ -13,6 +13,13 @@ struct IRFunction {
     ir_ref entry_ref;
 };
 
+struct BridgeOptions {
+    // 假設 wasm 的 32-bit 位址運算不會 wrap、指標都在 2 GiB 以下（C 的
+    // 陣列存取不越界即成立），讓 makeMemAddr 把位址拆成 64-bit 的
+    // base + index*scale + disp。-O2 / --assume-inbounds-addressing 打開。
+    bool assumeInboundsAddressing = false;
+};
+
 class IRBridge {
 public:
     IRBridge();
@@ -21,7 +28,8 @@ public:
     // 將 ValueIR 轉成 dstogov/ir 的 IRFunction
     IRFunction* build(const ValueIR& values,
                     const std::vector<ParamType>& paramTypes = {},
-                    const std::unordered_map<int, int32_t>& globalInitValues = {});
+                    const std::unordered_map<int, int32_t>& globalInitValues = {},
+                    const BridgeOptions& opts = {});
 
     // 印出 IR graph
     void dump(IRFunction* fn);
@@ -2,6 +2,10 @@
 #include "wasm_lower.hpp"
 #include "value_ir_dump.hpp"
 #include "value_ir_verify.hpp"
+#include "value_ir_passes.hpp"
+#include "value_ir_ipa.hpp"
+#include "value_ir_parallel.hpp"
+#include "value_ir_vectorize.hpp"
 #include "ir_bridge.hpp"
 #include "wasm_reader.hpp"
 #include "wasm_dump.hpp"
@@ -26,7 +30,63 @@ static void usage(const char* prog) {
         << "  --save-ir <out.ir>          Save dstogov/ir IR to file\n"
         << "  --out-c <out.c>             Path to write generated C code (default: ./out.c)\n"
         << "  --print-after-valueir       Print ValueIR after Stage 1 lowering\n"
-        << "  --print-after-seaofnodes    Print progress after Stage 2 (dstogov/ir bridge)\n";
+        << "  --print-after-seaofnodes    Print progress after Stage 2 (dstogov/ir bridge)\n"
+        << "  --print-after=<stages>      Comma-separated: valueir,seaofnodes,tailrec,partial-eval,\n"
+        << "                              specialize,inline,ipa,alias,deps,if-convert,temporal-blocking,\n"
+        << "                              distribute,interchange,fuse,tile,scalar-repl,vectorize,\n"
+        << "                              unroll,load-elim,slp,wavefront,parallelize,fp-contract,\n"
+        << "                              rotate,unswitch,loop-idiom\n"
+        << "\n"
+        << "Optimization:\n"
+        << "  -O0                         No ValueIR optimization (default)\n"
+        << "  -O1                         Enable the passes below\n"
+        << "  -O2                         -O1 + --assume-inbounds-addressing --specialize-calls\n"
+        << "                              --temporal-blocking --distribute --interchange --fuse\n"
+        << "                              --tile --scalar-repl --vectorize --unroll --unroll-and-jam\n"
+        << "                              --slp-vectorize --unswitch\n"
+        << "  --promote-stack-slots       Promote non-escaping shadow-stack slots to locals\n"
+        << "  --tail-recursion            Turn self tail recursion (with +,*,&,|,^ accumulator) into loops\n"
+        << "  --inline                    Inline small / single-call-site functions\n"
+        << "  --partial-eval              Evaluate pure calls with constant arguments at compile time\n"
+        << "  --ipcp                      Interprocedural constant args / constant returns\n"
+        << "  --load-elim                 Alias-based redundant load / store-to-load forwarding\n"
+        << "  --if-convert                Turn small value-only if/else diamonds into branchless selects\n"
+        << "  --loop-idiom                Turn fill / copy loops into memory.fill / memory.copy (memset /\n"
+        << "                              memmove; small constant sizes are inlined as stores)\n"
+        << "  --rotate-loops              Turn top-tested loops into guarded do-while loops (exit test\n"
+        << "                              at the latch)\n"
+        << "  --interchange               Reorder loop nests so the innermost loop has stride 1\n"
+        << "  --unswitch                  Hoist loop-invariant if conditions out of loops by duplicating\n"
+        << "                              the loop for each branch (code-size budget)\n"
+        << "  --temporal-blocking         Run several time steps of iterative stencils per cache tile\n"
+        << "  --distribute                Split recurrences out of innermost loops into their own loops\n"
+        << "  --fuse                      Fuse adjacent loops with the same bounds that reuse data\n"
+        << "  --tile                      Cache-block affine loop nests (dependence-checked)\n"
+        << "  --tile-size=<N>             Tile size (default: chosen from the cache sizes)\n"
+        << "  --l1-cache-size=<N>[K|M]    L1 data cache size for tiling (default: host)\n"
+        << "  --l2-cache-size=<N>[K|M]    L2 cache size for tiling (default: host)\n"
+        << "  --scalar-repl               Keep loop-invariant array elements updated in a loop in a\n"
+        << "                              register (one load before, one store after)\n"
+        << "  --vectorize                 Vectorize innermost f64 / i32 loops (C vector extensions,\n"
+        << "                              SSE2 + AVX2 versions picked at run time)\n"
+        << "  --slp-vectorize             Pack adjacent isomorphic stores / i32 reductions in a block\n"
+        << "                              into 128-bit vector kernels\n"
+        << "  --unroll                    Unroll innermost counted loops (remainder loop, cost model)\n"
+        << "  --unroll-and-jam            Unroll outer loops of rectangular nests and fuse the inner loops\n"
+        << "  --threads=<N>               Run DOALL loops (and wavefronts of 2-D stencil / DP nests)\n"
+        << "                              on N threads (work-stealing runtime;\n"
+        << "                              link out.c with runtime/w2s_runtime.c -lpthread)\n"
+        << "  --assume-noalias-params     Treat distinct pointer params as non-overlapping\n"
+        << "                              (restrict semantics; not implied by -O)\n"
+        << "  --fp-contract=fast|off      Fuse f64 / f32 a*b+c into fma (rounds once; not implied by -O);\n"
+        << "                              the later of --fp-contract / --fast-math wins\n"
+        << "  --fast-math                 --fp-contract=fast + reassociate f64 +,* reductions for\n"
+        << "                              --vectorize / --threads, min/max without NaN / -0 handling\n"
+        << "  --assume-inbounds-addressing  Address arithmetic never wraps; fold scaled\n"
+        << "                              indices into 64-bit base+index*scale+disp\n"
+        << "  --specialize-calls          Clone loop functions for constant call-site arguments\n"
+        << "  --specialize=<f>:<p>=<v>,...  Clone f with params fixed (name or index) and\n"
+        << "                              dispatch to it when they match (repeatable)\n";
 }
 
 static uint8_t wasm_memory[65536] = {0};
@@ -45,6 +105,7 @@ int main(int argc, char* argv[]) {
     std::string saveIrPath;
     std::string outCPath;
     std::set<std::string> printAfterStages;
+    PassOptions passOpts;
 
     // ---- argv parsing (minimal) ----
     // First non-flag arg is input.wasm
@@ -79,6 +140,8 @@ int main(int argc, char* argv[]) {
             std::stringstream ss(stages);
             std::string stage;
             while (std::getline(ss, stage, ',')) printAfterStages.insert(stage);
+        } else if (parsePassOption(a, passOpts)) {
+            // 優化選項，見 value_ir_passes.hpp
         } else if (!a.empty() && a[0] == '-') {
             std::cerr << "Unknown option: " << a << "\n";
             usage(argv[0]);
@@ -91,8 +154,8 @@ int main(int argc, char* argv[]) {
     // ✅ 读取所有函数
     std::vector<FunctionResult> functions;
 
-    if (argc > 1) {
-        functions = readWasmFile(argv[1]);
+    if (!wasmPath.empty()) {
+        functions = readWasmFile(wasmPath);
         if (functions.empty()) {
             std::cerr << "Failed to read WASM file or no functions found\n";
             return 1;
@@ -124,18 +187,22 @@ int main(int argc, char* argv[]) {
     // header will be written after processing all functions
     fclose(cFile);
 
-    // ✅ 处理所有函数
+    // 建函數名稱表：Call 指令的 callee_idx 是相對於 wasm 原生的
+    // 完整函式索引空間（import 在前，自己定義的函式在後）編碼的，
+    // 但 `functions`（readWasmFile 的回傳值）已經略過了 import
+    // 函式（沒有 body），索引跟原生 wasm 索引不同步。這裡改用
+    // g_all_function_names（在 readWasmFile 內部、略過 import 之前
+    // 建立的完整表），確保索引跟 Call 指令的 callee_idx 一致。
+    std::vector<std::string> funcNames = g_all_function_names;
+
+    // Step 1: Wasm → ValueIR (你的 SSA IR)
+    // 先把所有函式都 lower 完，inlining 這種跨函式的 pass 才看得到
+    // callee 的 ValueIR；之後再逐一跑單函式的 pass 與 bridge。
+    std::vector<ModuleFunction> module(functions.size());
     for (size_t i = 0; i < functions.size(); i++) {
         const auto& func = functions[i];
+        InstrSeq code = runInstrSeqPasses(func.instructions, passOpts);
 
-        std::cout << "\n" << std::string(70, '=') << "\n";
-        std::cout << "Processing function [" << i << "]: " << func.name << "\n";
-        std::cout << "Parameters: " << func.numParams << "\n";
-        std::cout << std::string(70, '=') << "\n\n";
-
-        InstrSeq code = func.instructions;
-
-        // Step 1: Wasm → ValueIR (你的 SSA IR)
         if (printAfterStages.count("valueir")) {
             std::cout << "\n// -----// IR Dump After ValueIRLowering ("
                     << func.name << ") //----- //\n";
@@ -146,16 +213,49 @@ int main(int argc, char* argv[]) {
         // 輸出。不需要再用 benchmark mode 手動註解/解除註解切換。
         dumpInstrSeq(code);
 
-        // 建函數名稱表：Call 指令的 callee_idx 是相對於 wasm 原生的
-        // 完整函式索引空間（import 在前，自己定義的函式在後）編碼的，
-        // 但 `functions`（readWasmFile 的回傳值）已經略過了 import
-        // 函式（沒有 body），索引跟原生 wasm 索引不同步。這裡改用
-        // g_all_function_names（在 readWasmFile 內部、略過 import 之前
-        // 建立的完整表），確保索引跟 Call 指令的 callee_idx 一致。
-        std::vector<std::string> funcNames = g_all_function_names;
+        module[i].name = func.name;
+        module[i].numParams = func.numParams;
+        module[i].exported = func.exported;
+        module[i].paramNames = func.paramNames;
+        for (ParamType t : func.paramTypes)
+            module[i].paramTypes.push_back(t == ParamType::I64 ? ValueType::I64
+                                         : t == ParamType::F32 ? ValueType::F32
+                                         : t == ParamType::F64 ? ValueType::F64 : ValueType::I32);
+        module[i].values = lowerWasmToSsa(code, funcNames);
+        if (printAfterStages.count("valueir")) dumpValueIR(module[i].values);
+    }
+
+    // 有 v128 的函式 bridge 寫不出來，先標成 kernel，caller 改叫 `_run`
+    routeSimdFunctions(module);
+    runModulePasses(module, passOpts, printAfterStages);
+
+    // ✅ 处理所有函数（含 specialization 產生的 clone，排在原本的函式後面；
+    // clone 的參數型別 / global 初值跟原函式一樣）。向量化拆出來的 kernel
+    // 也接在後面，但不經過 bridge：最後由 vectorGlueC 直接寫成 C
+    for (size_t i = 0; i < module.size(); i++) {
+        if (module[i].vector.isKernel) continue;
+        std::cout << "\n" << std::string(70, '=') << "\n";
+        std::cout << "Processing function [" << i << "]: " << module[i].name << "\n";
+        std::cout << "Parameters: " << module[i].numParams << "\n";
+        std::cout << std::string(70, '=') << "\n\n";
+
+        std::vector<ModuleFunction> kernels;
+        runValueIRPasses(module[i], passOpts, printAfterStages, kernels);
+        for (auto& k : kernels) {
+            if (k.origin < 0) k.origin = (int)i;
+            module.push_back(std::move(k));
+        }
+    }
 
-        ValueIR values = lowerWasmToSsa(code, funcNames);
-        if (printAfterStages.count("valueir")) dumpValueIR(values);
+    // callee 要不要 __mem 得等每個函式的 pass 都跑完才知道（load / store
+    // 可能被刪光），所以 bridge 另外一輪跑
+    annotateCallMemory(module);
+
+    for (size_t i = 0; i < module.size(); i++) {
+        if (module[i].vector.isKernel) continue;
+        const auto& func = functions[module[i].origin >= 0 ? module[i].origin : i];
+        const std::string funcName = module[i].name;
+        ValueIR& values = module[i].values;
 
         auto verifyResult = verifyValueIR(values);
         if (verifyResult.ok) {
@@ -167,11 +267,19 @@ int main(int argc, char* argv[]) {
         // Step 2: ValueIR → dstogov/ir
         if (printAfterStages.count("seaofnodes")) {
             std::cout << "\n// -----// IR Dump After SeaOfNodesBridge ("
-                    << func.name << ") //----- //\n";
+                    << funcName << ") //----- //\n";
         }
 
         IRBridge bridge;
-        IRFunction* fn = bridge.build(values, func.paramTypes, func.globalInitValues);
+        BridgeOptions bridgeOpts;
+        bridgeOpts.assumeInboundsAddressing = passOpts.inboundsAddressing;
+        // 參數型別用 module[i] 的：平行化拆出來的 task 參數跟原函式不一樣
+        std::vector<ParamType> paramTypes;
+        for (ValueType t : module[i].paramTypes)
+            paramTypes.push_back(t == ValueType::I64 ? ParamType::I64
+                               : t == ValueType::F32 ? ParamType::F32
+                               : t == ValueType::F64 ? ParamType::F64 : ParamType::I32);
+        IRFunction* fn = bridge.build(values, paramTypes, func.globalInitValues, bridgeOpts);
         
         // bridge.dump(fn);  // disabled for benchmark mode
 
@@ -201,7 +309,7 @@ int main(int argc, char* argv[]) {
             ir_compute_live_ranges(ctx);
             if (printAfterStages.count("seaofnodes")) { printf("  pass: coalesce\n"); fflush(stdout); }
             ir_coalesce(ctx);
-            std::string cname = sanitize_cname(func.name);
+            std::string cname = sanitize_cname(funcName);
             char tmpPath[256];
             snprintf(tmpPath, sizeof(tmpPath), "/tmp/wasm2sea_%zu.c", i);
 
@@ -235,12 +343,25 @@ int main(int argc, char* argv[]) {
         for (auto it = begin; it != end_it; ++it)
             used_locals.insert(std::stoi((*it)[1].str()));
 
-        std::string header = "#include <stdint.h>\n#include <stdbool.h>\n\n";
+        // 有平行化的 task 時 local_N / wasm_global_N 改成每個 thread 一份：
+        // bridge 在每個函式進入時都會重新初始化它們，不會跨 thread 共用值
+        const std::string glue = parallelGlueC(module);
+        const std::string vectorGlue = vectorGlueC(module);
+        const std::string storage = glue.empty() ? "static int32_t " : "static _Thread_local int32_t ";
+        std::string header = "#include <stdint.h>\n#include <stdbool.h>\n";
+        // vector glue 的 memcpy、bridge 把 memory.fill / memory.copy 寫成的 memset / memmove
+        bool usesString = !vectorGlue.empty();
+        for (const auto& f : module)
+            for (const auto& v : f.values)
+                if (v.op == Op::MemoryFill || v.op == Op::MemoryCopy) usesString = true;
+        if (usesString) header += "#include <string.h>\n";
+        if (!glue.empty()) header += "#include \"w2s_runtime.h\"\n";
+        header += "\n";
         for (int idx : used_locals)
-            header += "static int32_t local_" + std::to_string(idx) + ";\n";
+            header += storage + "local_" + std::to_string(idx) + ";\n";
         for (int _gi = 0; _gi < g_wasm_global_count; _gi++)
-            header += "static int32_t wasm_global_" + std::to_string(_gi) + ";\n";
-        header += "\n";
+            header += storage + "wasm_global_" + std::to_string(_gi) + ";\n";
+        header += "\n" + vectorGlue + glue;
 
         std::ofstream out_f(cPath);
         out_f << header << scan_content;
@@ -249,7 +370,7 @@ int main(int argc, char* argv[]) {
 
     std::cout << "\n" << std::string(70, '=') << "\n";
     std::cout << "=== Compilation Complete ===\n";
-    std::cout << "Successfully processed " << functions.size() << " function(s)\n";
+    std::cout << "Successfully processed " << module.size() << " function(s)\n";
     std::cout << std::string(70, '=') << "\n";
 
     return 0;
@@ -55,6 +55,7 @@ struct BrIfNode : Node {
                 }
             }
         }
+        closeWideIVs(ctx, loop_info);
         ir_IF_TRUE(if_node);
         ir_ref loop_end_ref = ir_LOOP_END();
         ir_MERGE_SET_OP(loop_info.loop_begin, 2, loop_end_ref);
@@ -38,6 +38,8 @@ struct BrNode : Node {
             }
         }
 
+        closeWideIVs(ctx, *target_loop);
+
         // 設 outer carry PHI 的 back-edge
         if (loop_stack.size() >= 2) {
             LoopInfo& outer_loop = loop_stack[loop_stack.size() - 2];
@@ -7,6 +7,13 @@
 
 namespace ir_node {
 
+// makeMemAddr 的 memo：整個函式共用一份（BuildContext 每個節點重建，
+// 這份由 IRBridge::build() 持有）。
+struct AddrCache {
+    std::unordered_map<ir_ref, ir_ref> base;   // i32 指標 ref -> __mem + zext(ptr)
+    std::unordered_map<int, ir_ref> index;     // ValueIR id -> 64-bit（ADDR）index
+};
+
 // Unchanged from the original file-scope BuildContext in ir_bridge.cpp --
 // just relocated so every node/*.hpp can see it.
 struct BuildContext {
@@ -20,6 +27,8 @@ struct BuildContext {
     ir_ref mem_param;
     bool has_memory_ops;
     size_t current_index;
+    bool inbounds_addressing;   // 假設 32-bit 位址運算不 wrap（見 MemAddr.hpp）
+    AddrCache& addr_cache;
 };
 
 }  // namespace ir_node
@@ -15,6 +15,7 @@ struct CallNode : Node {
         ir_ref name_ref = ir_str(ctx, cname.c_str());
         ir_ref func_ref = ir_const_func(ctx, name_ref, IR_UNUSED);
         std::vector<ir_ref> arg_refs;
+        if (val.pass_memory && bc.has_memory_ops) arg_refs.push_back(bc.mem_param);
         for (int arg_id : val.operands)
             if (arg_id >= 0 && arg_id < (int)bc.value_map.size())
                 arg_refs.push_back(bc.value_map[arg_id]);
@@ -27,13 +28,23 @@ struct CallNode : Node {
         // 函式呼叫需要非 I32 回傳型別，需要從 wasm 的函式簽章正確推導，
         // 而不是繼續擴充這個清單。
         static const std::unordered_set<std::string> kDoubleReturningFuncs = {
-            "exp", "expf", "pow", "powf", "log", "logf",
-            "sin", "sinf", "cos", "cosf", "sqrt", "sqrtf",
-            "tan", "tanf", "atan", "atanf", "atan2", "atan2f",
-            "exp2", "exp2f", "log2", "log2f", "log10", "log10f",
-            "fabs", "fabsf", "floor", "floorf", "ceil", "ceilf"
+            "exp", "pow", "log", "sin", "cos", "sqrt", "tan", "atan", "atan2",
+            "exp2", "log2", "log10", "fabs", "floor", "ceil"
         };
-        ir_type ret_type = kDoubleReturningFuncs.count(cname) ? IR_DOUBLE : IR_I32;
+        // f 結尾的單精度版本回傳 float，不能當成 double 讀（f32 的 kernel）
+        static const std::unordered_set<std::string> kFloatReturningFuncs = {
+            "expf", "powf", "logf", "sinf", "cosf", "sqrtf", "tanf", "atanf", "atan2f",
+            "exp2f", "log2f", "log10f", "fabsf", "floorf", "ceilf"
+        };
+        // module 裡的函式：回傳型別由 value_ir_ipa 的摘要標在 val.type 上
+        // （void 的 call 結果沒人用，也不能宣告成 int32_t 回傳）。
+        ir_type ret_type = IR_I32;
+        if (kDoubleReturningFuncs.count(cname)) ret_type = IR_DOUBLE;
+        else if (kFloatReturningFuncs.count(cname)) ret_type = IR_FLOAT;
+        else if (val.type == ValueType::Void) ret_type = IR_VOID;
+        else if (val.type == ValueType::I64) ret_type = IR_I64;
+        else if (val.type == ValueType::F32) ret_type = IR_FLOAT;
+        else if (val.type == ValueType::F64) ret_type = IR_DOUBLE;
         bc.value_map[i] = ir_CALL_N(ret_type, func_ref, (uint32_t)arg_refs.size(), arg_refs.data());
         TRACE("  v%zu = Call(%s, %zu args)\n", i, val.callee_name.c_str(), val.operands.size());
     }
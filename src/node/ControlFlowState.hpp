@@ -1,5 +1,6 @@
 #pragma once
 #include "ir_internal.hpp"
+#include <cstdint>
 #include <stack>
 #include <vector>
 #include <unordered_map>
@@ -24,6 +25,14 @@ struct IfInfo {
     bool true_branch_returns;
 };
 
+// makeMemAddr 幫 i32 induction variable 建的 64-bit 影子 phi：
+// phi64 = PHI(sext(entry), phi64 + step)
+struct WideIV {
+    int id;          // i32 IV 的 ValueIR id
+    ir_ref phi;
+    int64_t step;
+};
+
 struct LoopInfo {
     ir_ref loop_begin;
     ir_ref entry_point;
@@ -32,8 +41,20 @@ struct LoopInfo {
     ir_ref loop_exit = IR_UNUSED;
     std::vector<ir_ref> exits;
     std::unordered_map<int, ir_ref> outer_carry_phis;  // local_idx -> outer PHI ref
+    std::vector<WideIV> wide_ivs;     // 只在 loop 還開著（back-edge 之前）時有效
+    bool back_edge_done = false;
+    int back_edges = -1;              // 跳回來的 Br / Br_if 數，widenIndex 第一次用到時才數
 };
 
+// 在 back-edge（Br / Br_if loop_back）補上 64-bit IV phi 的第二個 operand。
+// 之後（latch Br_if 到 End 之間、loop 外）再用到 IV 就照一般值延伸
+inline void closeWideIVs(ir_ctx* ctx, LoopInfo& loop) {
+    for (const auto& w : loop.wide_ivs)
+        ir_PHI_SET_OP(w.phi, 2, ir_ADD_A(w.phi, ir_CONST_ADDR((uintptr_t)w.step)));
+    loop.wide_ivs.clear();
+    loop.back_edge_done = true;
+}
+
 // Defined once in ir_bridge.cpp.
 extern std::stack<IfInfo> if_stack;
 extern std::vector<LoopInfo> loop_stack;
@@ -3,6 +3,7 @@
 #include "Trace.hpp"
 #include "ControlFlowState.hpp"
 #include <cstdio>
+#include <vector>
 
 namespace ir_node {
 
@@ -11,7 +12,8 @@ struct EndNode : Node {
         ir_ctx* ctx = bc.ctx;
         size_t i = bc.current_index;
             // fprintf(stderr, "DEBUG: Op::End reached, if_stack.size()=%zu\n", if_stack.size());
-        if (!if_stack.empty()) {
+        // 只有 If 的 End(2) 收 if_stack：If 裡面的 loop / block 結尾不能把 If 關掉
+        if (val.constValue == 2 && !if_stack.empty()) {
             IfInfo info = if_stack.top();
             if_stack.pop();
 
@@ -36,8 +38,21 @@ struct EndNode : Node {
             return;
         }
 
-        // loop end：只有這裡才 pop loop_stack
+        // loop end：Br 的 back-edge 已經 pop 過了。End 前面是 back-edge 的
+        // Br_if（do-while、rotate 過的 loop）時 loop 還在 stack 上，它的
+        // IF_FALSE 就是出口，跟其他 Br_if 的出口合併
         if (val.constValue == 0) {
+            const Value* latch = i > 0 ? &bc.values[i - 1] : nullptr;
+            if (latch && latch->op == Op::Br_if && latch->constValue != 1 && !loop_stack.empty() &&
+                loop_stack.back().loop_value_id == latch->rhs) {
+                LoopInfo& loop = loop_stack.back();
+                if (!loop.exits.empty()) {
+                    std::vector<ir_ref> ends = loop.exits;
+                    ends.push_back(ir_END());
+                    ir_MERGE_N((ir_ref)ends.size(), ends.data());
+                }
+                loop_stack.pop_back();
+            }
             TRACE("  v%zu = End(loop)\n", i);
             return;
         }
@@ -0,0 +1,13 @@
+#pragma once
+#include "Node.hpp"
+
+namespace ir_node {
+
+struct F32DemoteF64Node : Node {
+    void lower(BuildContext& bc, const Value& val) const override {
+        ir_ctx* ctx = bc.ctx;
+        bc.value_map[bc.current_index] = ir_D2F(bc.value_map[val.lhs]);
+    }
+};
+
+}  // namespace ir_node
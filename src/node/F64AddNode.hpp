@@ -9,7 +9,7 @@ struct F64AddNode : Node {
         if (val.lhs < 0 || val.rhs < 0) return;
         ir_ref l = bc.value_map[val.lhs], r = bc.value_map[val.rhs];
         if (l == IR_UNUSED || r == IR_UNUSED) return;
-        bc.value_map[bc.current_index] = ir_ADD_D(l, r);
+        bc.value_map[bc.current_index] = (val.type == ValueType::F32) ? ir_ADD_F(l, r) : ir_ADD_D(l, r);
     }
 };
 
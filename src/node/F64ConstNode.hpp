@@ -6,7 +6,8 @@ namespace ir_node {
 struct F64ConstNode : Node {
     void lower(BuildContext& bc, const Value& val) const override {
         ir_ctx* ctx = bc.ctx;
-        bc.value_map[bc.current_index] = ir_CONST_DOUBLE(val.fconst);
+        bc.value_map[bc.current_index] = (val.type == ValueType::F32) ? ir_CONST_FLOAT((float)val.fconst)
+                                                                      : ir_CONST_DOUBLE(val.fconst);
     }
 };
 
@@ -6,7 +6,8 @@ namespace ir_node {
 struct F64ConvertINode : Node {
     void lower(BuildContext& bc, const Value& val) const override {
         ir_ctx* ctx = bc.ctx;
-        bc.value_map[bc.current_index] = ir_INT2D(bc.value_map[val.lhs]);
+        ir_ref x = bc.value_map[val.lhs];
+        bc.value_map[bc.current_index] = (val.type == ValueType::F32) ? ir_INT2F(x) : ir_INT2D(x);
     }
 };
 
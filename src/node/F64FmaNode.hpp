@@ -0,0 +1,20 @@
+#pragma once
+#include "Node.hpp"
+
+namespace ir_node {
+
+// dstogov/ir 沒有 fused multiply-add，跟 sqrt 一樣呼叫 libm：C compiler 認得
+// fma() 這個 builtin，target 有 FMA 時（-mfma / -march=native）直接是 vfmadd
+struct F64FmaNode : Node {
+    void lower(BuildContext& bc, const Value& val) const override {
+        ir_ctx* ctx = bc.ctx;
+        const bool f32 = val.type == ValueType::F32;
+        ir_ref name_ref = ir_str(ctx, f32 ? "fmaf" : "fma");
+        ir_ref func_ref = ir_const_func(ctx, name_ref, IR_UNUSED);
+        bc.value_map[bc.current_index] =
+            ir_CALL_3(f32 ? IR_FLOAT : IR_DOUBLE, func_ref, bc.value_map[val.operands[0]],
+                      bc.value_map[val.operands[1]], bc.value_map[val.operands[2]]);
+    }
+};
+
+}  // namespace ir_node
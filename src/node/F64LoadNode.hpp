@@ -11,8 +11,8 @@ struct F64LoadNode : Node {
         if (val.lhs < 0 || val.lhs >= (int)i) return;
         ir_ref ptr_ref = bc.value_map[val.lhs];
         if (ptr_ref == IR_UNUSED) return;
-        ir_ref real_ptr = makeMemAddr(bc, ptr_ref, val.mem_offset);
-        bc.value_map[i] = ir_LOAD_D(real_ptr);
+        ir_ref real_ptr = makeMemAddr(bc, val.lhs, val.mem_offset);
+        bc.value_map[i] = (val.type == ValueType::F32) ? ir_LOAD_F(real_ptr) : ir_LOAD_D(real_ptr);
     }
 };
 
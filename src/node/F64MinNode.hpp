@@ -6,7 +6,8 @@ namespace ir_node {
 struct F64MinNode : Node {
     void lower(BuildContext& bc, const Value& val) const override {
         ir_ctx* ctx = bc.ctx;
-        bc.value_map[bc.current_index] = ir_MIN_D(bc.value_map[val.lhs], bc.value_map[val.rhs]);
+        ir_ref l = bc.value_map[val.lhs], r = bc.value_map[val.rhs];
+        bc.value_map[bc.current_index] = (val.type == ValueType::F32) ? ir_MIN_F(l, r) : ir_MIN_D(l, r);
     }
 };
 
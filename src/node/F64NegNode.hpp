@@ -6,7 +6,8 @@ namespace ir_node {
 struct F64NegNode : Node {
     void lower(BuildContext& bc, const Value& val) const override {
         ir_ctx* ctx = bc.ctx;
-        bc.value_map[bc.current_index] = ir_NEG_D(bc.value_map[val.lhs]);
+        ir_ref x = bc.value_map[val.lhs];
+        bc.value_map[bc.current_index] = (val.type == ValueType::F32) ? ir_NEG_F(x) : ir_NEG_D(x);
     }
 };
 
@@ -11,7 +11,7 @@ struct I32ConstNode : Node {
         ir_ref c = ir_CONST_I32(val.constValue);
         ir_ref copy = ir_COPY_I32(c);
         bc.value_map[i] = copy;
-        TRACE(" v%zu = Const(%d) -> ir_CONST_I32 ref %d, ir_COPY ref %d\n\n", i, val.constValue, c, copy);
+        TRACE(" v%zu = Const(%d) -> ir_CONST_I32 ref %d, ir_COPY ref %d\n\n", i, (int)val.constValue, c, copy);
     }
 };
 
@@ -11,7 +11,7 @@ struct LoadNode : Node {
         if (val.lhs < 0 || val.lhs >= (int)i) return;
         ir_ref ptr_ref = bc.value_map[val.lhs];
         if (ptr_ref == IR_UNUSED) return;
-        ir_ref real_ptr = makeMemAddr(bc, ptr_ref, val.mem_offset);
+        ir_ref real_ptr = makeMemAddr(bc, val.lhs, val.mem_offset);
         bc.value_map[i] = (val.type == ValueType::I64) ? ir_LOAD_I64(real_ptr) : ir_LOAD_I32(real_ptr);
     }
 };
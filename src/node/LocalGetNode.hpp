@@ -16,6 +16,7 @@ struct LocalGetNode : Node {
         ir_type t = bc.local_types.count(var_idx) ? bc.local_types[var_idx] : IR_I32;
         ir_ref loaded = (t == IR_I64) ? ir_VLOAD_I64(var_ref)
                       : (t == IR_DOUBLE) ? ir_VLOAD_D(var_ref)
+                      : (t == IR_FLOAT) ? ir_VLOAD_F(var_ref)
                       : ir_VLOAD_I32(var_ref);
         bc.value_map[i] = loaded;
         TRACE("  v%zu = LocalGet(local_%d) -> ref %d\n\n", i, var_idx, loaded);
@@ -1,21 +1,205 @@
 #pragma once
 #include "ir_internal.hpp"
 #include "BuildContext.hpp"
+#include "ControlFlowState.hpp"
+#include <cstdint>
+#include <vector>
 
 namespace ir_node {
 
-// Shared by LoadNode/StoreNode/F64LoadNode/F64StoreNode. Unchanged from the
-// original file-scope `static ir_ref makeMemAddr(...)` in ir_bridge.cpp,
-// just made `inline` since it now lives in a header (harmless -- only
-// ir_bridge.cpp ever includes this transitively, but `inline` keeps it
-// correct even if that stops being true later).
-inline ir_ref makeMemAddr(BuildContext& bc, ir_ref ptr_ref, int mem_offset) {
+// Shared by LoadNode/StoreNode/F64LoadNode/F64StoreNode.
+//
+// wasm 的有效位址是 zext(ptr) + offset（33-bit，不 wrap），所以預設形狀是
+//
+//     ADD_A(ADD_A(__mem, ZEXT_A(ptr)), CONST_ADDR(offset))
+//
+// __mem + zext(ptr) 依 ptr memo 住，同一個指標不同 offset 的存取（frame
+// slot、展開後的 A[i], A[i+1]）共用一個 base，常數 offset 留在最外層，
+// 讓 backend 折進 [base + disp]。不再先做 ADD_I32(ptr, offset)：那會讓
+// offset 卡在 32-bit 加法裡，而且每個存取都要重新做一次 32→64 延伸。
+//
+// inbounds_addressing（-O2 / --assume-inbounds-addressing）另外假設 wasm
+// 這邊的 32-bit 位址運算不會 wrap（C 的陣列存取不越界就成立），於是可以把
+// ptr 拆開、改在 64-bit 上算：
+//
+//     ptr = p + (i << 3) + 16   →   (__mem + zext(p)) + sext(i) * 8 + 16
+//
+// 剛好對上 x86 的 base + index*scale + disp。i 若是目前 loop 的 i32 IV
+// （back-edge = i + c），另外建一個 64-bit 的影子 phi，整個 loop 只在
+// 進入時 sext 一次，不必每個 iteration 都延伸。
+
+// __mem + zext(ptr)，依 ptr memo
+inline ir_ref memBase(BuildContext& bc, ir_ref ptr_ref) {
     ir_ctx* ctx = bc.ctx;   // 關鍵：ir_builder macro 需要這個名字
-    ir_ref offset_ref = ptr_ref;
-    if (mem_offset != 0) {
-        offset_ref = ir_ADD_I32(ptr_ref, ir_CONST_I32(mem_offset));
+    auto it = bc.addr_cache.base.find(ptr_ref);
+    if (it != bc.addr_cache.base.end()) return it->second;
+    ir_ref base = ir_ADD_A(bc.mem_param, ir_ZEXT_A(ptr_ref));
+    bc.addr_cache.base[ptr_ref] = base;
+    return base;
+}
+
+// i32 IV 的步長：back-edge 是 Add(phi, Const) / Add(Const, phi) / Sub(phi, Const)
+inline bool inductionStep(const ValueIR& values, int phi_id, int64_t& step) {
+    const Value& phi = values[phi_id];
+    if (phi.operands.size() < 2) return false;
+    int back = phi.operands[1];
+    if (back < 0 || back >= (int)values.size()) return false;
+    const Value& b = values[back];
+    auto isConst = [&](int id) {
+        return id >= 0 && id < (int)values.size() && values[id].op == Op::I32Const;
+    };
+    if (b.op == Op::Add && b.lhs == phi_id && isConst(b.rhs)) { step = values[b.rhs].constValue; return true; }
+    if (b.op == Op::Add && b.rhs == phi_id && isConst(b.lhs)) { step = values[b.lhs].constValue; return true; }
+    if (b.op == Op::Sub && b.lhs == phi_id && isConst(b.rhs)) { step = -(int64_t)values[b.rhs].constValue; return true; }
+    return false;
+}
+
+// 跳回 loop 的 Br / Br_if 有幾個；影子 phi 只有一個 back-edge 的值
+inline int countBackEdges(const ValueIR& values, int loop_id) {
+    int n = 0;
+    for (const Value& v : values)
+        if ((v.op == Op::Br && v.lhs == loop_id) ||
+            (v.op == Op::Br_if && v.constValue != 1 && v.rhs == loop_id))
+            n++;
+    return n;
+}
+
+// 把 i32 index 延伸成 ADDR。IV 的影子 phi 記在它的 loop 上（back-edge 補完
+// 就作廢）；其他值依 ValueIR id memo
+inline ir_ref widenIndex(BuildContext& bc, int id) {
+    ir_ctx* ctx = bc.ctx;
+    const Value& v = bc.values[id];
+    int64_t step;
+    if (v.op == Op::Phi && v.local_index >= 0 && inductionStep(bc.values, id, step)) {
+        for (auto loop = loop_stack.rbegin(); loop != loop_stack.rend(); ++loop) {
+            bool owns = false;
+            for (int p : loop->phi_ids) owns |= (p == id);
+            if (!owns) continue;
+            if (loop->back_edges < 0) loop->back_edges = countBackEdges(bc.values, loop->loop_value_id);
+            if (loop->back_edge_done || loop->back_edges != 1) break;
+            for (const auto& w : loop->wide_ivs)
+                if (w.id == id) return w.phi;
+            ir_ref phi32 = bc.value_map[id];
+            ir_ref entry = ctx->ir_base[phi32].op2;   // op1=LOOP_BEGIN, op2=entry, op3=back-edge
+            ir_ref saved = ctx->control;
+            ctx->control = loop->loop_begin;
+            ir_ref wide = ir_PHI_2(IR_ADDR, ir_SEXT_A(entry), IR_UNUSED);
+            ctx->control = saved;
+            loop->wide_ivs.push_back({id, wide, step});
+            return wide;
+        }
     }
-    return ir_ADD_A(bc.mem_param, offset_ref);
+    auto it = bc.addr_cache.index.find(id);
+    if (it != bc.addr_cache.index.end()) return it->second;
+    ir_ref wide = ir_SEXT_A(bc.value_map[id]);
+    bc.addr_cache.index[id] = wide;
+    return wide;
+}
+
+struct AddrTerm {
+    int id;
+    int64_t scale;
+};
+
+// ptr 拆成 Σ term*scale + disp；scale 最多到 8（x86 addressing mode 的上限）
+inline void decomposeAddr(const ValueIR& values, int id, int64_t scale,
+                          std::vector<AddrTerm>& terms, int64_t& disp, int depth) {
+    const Value& v = values[id];
+    auto constOf = [&](int ref, int64_t& c) {
+        if (ref < 0 || ref >= id || values[ref].op != Op::I32Const) return false;
+        c = values[ref].constValue;
+        return true;
+    };
+    int64_t c;
+    if (depth < 6 && v.type == ValueType::I32) {
+        switch (v.op) {
+        case Op::I32Const:
+            disp += scale * v.constValue;
+            return;
+        case Op::Add:
+            if (v.lhs >= 0 && v.rhs >= 0 && v.lhs < id && v.rhs < id) {
+                decomposeAddr(values, v.lhs, scale, terms, disp, depth + 1);
+                decomposeAddr(values, v.rhs, scale, terms, disp, depth + 1);
+                return;
+            }
+            break;
+        case Op::Sub:
+            if (v.lhs >= 0 && v.lhs < id && constOf(v.rhs, c)) {
+                decomposeAddr(values, v.lhs, scale, terms, disp, depth + 1);
+                disp -= scale * c;
+                return;
+            }
+            break;
+        case Op::Shl:
+            if (v.lhs >= 0 && v.lhs < id && constOf(v.rhs, c) && c >= 0 && c <= 3 && (scale << c) <= 8) {
+                decomposeAddr(values, v.lhs, scale << c, terms, disp, depth + 1);
+                return;
+            }
+            break;
+        case Op::Mul: {
+            int x = -1;
+            if (constOf(v.rhs, c)) x = v.lhs;
+            else if (constOf(v.lhs, c)) x = v.rhs;
+            if (x >= 0 && x < id && (c == 1 || c == 2 || c == 4 || c == 8) && scale * c <= 8) {
+                decomposeAddr(values, x, scale * c, terms, disp, depth + 1);
+                return;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    for (auto& t : terms)
+        if (t.id == id) { t.scale += scale; return; }
+    terms.push_back({id, scale});
+}
+
+inline ir_ref makeMemAddr(BuildContext& bc, int ptr_id, int mem_offset) {
+    ir_ctx* ctx = bc.ctx;
+    ir_ref ptr_ref = bc.value_map[ptr_id];
+    uint64_t offset = (uint32_t)mem_offset;
+
+    if (bc.inbounds_addressing) {
+        std::vector<AddrTerm> terms;
+        int64_t disp = (int64_t)offset;
+        decomposeAddr(bc.values, ptr_id, 1, terms, disp, 0);
+
+        // 最多 base + index*scale 兩項。scale > 1 的那項是 index；兩項都是
+        // scale 1 時，loop phi（IV）當 index，另一項當 base。
+        bool ok = terms.size() <= 2;
+        int indexPos = -1;
+        for (size_t k = 0; ok && k < terms.size(); k++) {
+            const AddrTerm& t = terms[k];
+            if (bc.value_map[t.id] == IR_UNUSED || t.scale <= 0 || (t.scale & (t.scale - 1)) != 0) ok = false;
+            else if (t.scale > 1 && indexPos >= 0) ok = false;
+            else if (t.scale > 1) indexPos = (int)k;
+        }
+        if (ok && indexPos < 0) {
+            for (size_t k = 0; k < terms.size(); k++)
+                if (bc.values[terms[k].id].op == Op::Phi) { indexPos = (int)k; break; }
+            if (indexPos < 0 && terms.size() == 2) indexPos = 1;
+        }
+        const AddrTerm* index = indexPos >= 0 ? &terms[indexPos] : nullptr;
+        const AddrTerm* base = nullptr;
+        for (size_t k = 0; k < terms.size(); k++)
+            if ((int)k != indexPos) base = &terms[k];
+        if (base && base->scale != 1) ok = false;
+        if (ok) {
+            ir_ref addr = base ? memBase(bc, bc.value_map[base->id]) : bc.mem_param;
+            if (index) {
+                ir_ref idx = widenIndex(bc, index->id);
+                if (index->scale > 1) idx = ir_MUL_A(idx, ir_CONST_ADDR((uintptr_t)index->scale));
+                addr = ir_ADD_A(addr, idx);
+            }
+            if (disp != 0) addr = ir_ADD_A(addr, ir_CONST_ADDR((uintptr_t)disp));
+            return addr;
+        }
+    }
+
+    ir_ref addr = memBase(bc, ptr_ref);
+    if (offset != 0) addr = ir_ADD_A(addr, ir_CONST_ADDR((uintptr_t)offset));
+    return addr;
 }
 
 }  // namespace ir_node
@@ -1,14 +1,40 @@
 #pragma once
 #include "Node.hpp"
+#include "MemAddr.hpp"
+#include "MemoryFillNode.hpp"
+#include <vector>
 
 namespace ir_node {
 
+// memory.copy(dst, src, n) → memmove(__mem + dst, __mem + src, n)（wasm 的
+// memory.copy 允許重疊）。小的常數長度展開：先全部 load 再全部 store，
+// 重疊時也跟 memmove 一樣
 struct MemoryCopyNode : Node {
     void lower(BuildContext& bc, const Value& val) const override {
         ir_ctx* ctx = bc.ctx;
-        ir_ref name_ref = ir_str(ctx, "__wasm_memory_copy");
+        ir_ref dst = memBase(bc, bc.value_map[val.operands[0]]);
+        ir_ref src = memBase(bc, bc.value_map[val.operands[1]]);
+        int n;
+        if (inlineLength(bc, val, n)) {
+            auto at = [&](ir_ref base, int off) {
+                return off ? ir_ADD_A(base, ir_CONST_ADDR((uintptr_t)off)) : base;
+            };
+            const auto chunks = inlineChunks(n);
+            std::vector<ir_ref> loaded;
+            for (auto [off, w] : chunks) {
+                switch (w) {
+                case 8: loaded.push_back(ir_LOAD_I64(at(src, off))); break;
+                case 4: loaded.push_back(ir_LOAD_I32(at(src, off))); break;
+                case 2: loaded.push_back(ir_LOAD_I16(at(src, off))); break;
+                default: loaded.push_back(ir_LOAD_I8(at(src, off))); break;
+                }
+            }
+            for (size_t k = 0; k < chunks.size(); k++) ir_STORE(at(dst, chunks[k].first), loaded[k]);
+            return;
+        }
+        ir_ref name_ref = ir_str(ctx, "memmove");
         ir_ref func_ref = ir_const_func(ctx, name_ref, IR_UNUSED);
-        ir_CALL_3(IR_VOID, func_ref, bc.value_map[val.operands[0]], bc.value_map[val.operands[1]], bc.value_map[val.operands[2]]);
+        ir_CALL_3(IR_VOID, func_ref, dst, src, ir_ZEXT_A(bc.value_map[val.operands[2]]));
     }
 };
 
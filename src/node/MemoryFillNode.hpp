@@ -1,14 +1,59 @@
 #pragma once
 #include "Node.hpp"
+#include "MemAddr.hpp"
+#include <utility>
+#include <vector>
 
 namespace ir_node {
 
+// 這個大小以下的常數 memory.fill / memory.copy 直接展開成 store，不呼叫 libc
+constexpr int kInlineBytes = 64;
+
+// n 個 byte 切成 8-byte 的塊，尾巴用 4 / 2 / 1 byte 補：(offset, 寬度)
+inline std::vector<std::pair<int, int>> inlineChunks(int n) {
+    std::vector<std::pair<int, int>> chunks;
+    int off = 0;
+    for (int w : {8, 4, 2, 1})
+        for (; off + w <= n; off += w) chunks.push_back({off, w});
+    return chunks;
+}
+
+// memory.fill / memory.copy 的長度是不超過 kInlineBytes 的常數時回傳 true
+inline bool inlineLength(const BuildContext& bc, const Value& val, int& n) {
+    const Value& len = bc.values[val.operands[2]];
+    if (len.op != Op::I32Const || len.constValue < 0 || len.constValue > kInlineBytes) return false;
+    n = len.constValue;
+    return true;
+}
+
+// memory.fill(dst, val, n) → memset(__mem + dst, val, n)。小的常數長度展開成
+// val 最低 byte 複製 8 份的 64-bit store（尾巴截短）
 struct MemoryFillNode : Node {
     void lower(BuildContext& bc, const Value& val) const override {
         ir_ctx* ctx = bc.ctx;
-        ir_ref name_ref = ir_str(ctx, "__wasm_memory_fill");
+        ir_ref dst = memBase(bc, bc.value_map[val.operands[0]]);
+        ir_ref byte = bc.value_map[val.operands[1]];
+        int n;
+        if (inlineLength(bc, val, n)) {
+            const Value& b = bc.values[val.operands[1]];
+            const uint64_t splat = 0x0101010101010101ULL;
+            ir_ref pattern = b.op == Op::I32Const
+                ? ir_CONST_I64((int64_t)((uint64_t)(b.constValue & 0xff) * splat))
+                : ir_MUL_I64(ir_ZEXT_I64(ir_AND_I32(byte, ir_CONST_I32(0xff))), ir_CONST_I64((int64_t)splat));
+            for (auto [off, w] : inlineChunks(n)) {
+                ir_ref addr = off ? ir_ADD_A(dst, ir_CONST_ADDR((uintptr_t)off)) : dst;
+                switch (w) {
+                case 8: ir_STORE(addr, pattern); break;
+                case 4: ir_STORE(addr, ir_TRUNC_I32(pattern)); break;
+                case 2: ir_STORE(addr, ir_TRUNC_I16(pattern)); break;
+                default: ir_STORE(addr, ir_TRUNC_I8(pattern)); break;
+                }
+            }
+            return;
+        }
+        ir_ref name_ref = ir_str(ctx, "memset");
         ir_ref func_ref = ir_const_func(ctx, name_ref, IR_UNUSED);
-        ir_CALL_3(IR_VOID, func_ref, bc.value_map[val.operands[0]], bc.value_map[val.operands[1]], bc.value_map[val.operands[2]]);
+        ir_CALL_3(IR_VOID, func_ref, dst, byte, ir_ZEXT_A(bc.value_map[val.operands[2]]));
     }
 };
 
@@ -31,7 +31,10 @@ struct PhiNode : Node {
             }
 
             ir_ref inputs[2] = {entry_val, IR_UNUSED};
-            ir_ref phi = ir_emit_N(ctx, IR_OPT(IR_PHI, IR_I32), 3);
+            // 型別跟著入口值走（tail recursion 改出來的 i64 累加器等）；
+            // use_vload_entry 的 outer PHI 目前只有 i32。
+            ir_type phi_type = val.use_vload_entry ? IR_I32 : (ir_type)ctx->ir_base[entry_val].type;
+            ir_ref phi = ir_emit_N(ctx, IR_OPT(IR_PHI, phi_type), 3);
             //
             ir_set_op(ctx, phi, 1, ctx->control);
             ir_set_op(ctx, phi, 2, entry_val);
@@ -16,6 +16,9 @@ struct ReturnNode : Node {
         } else {
             ir_ref ret_val = bc.value_map[val.lhs];
             TRACE("  v%zu = Return(v%d) -> ir_RETURN(ref %d)\n\n", i, val.lhs, ret_val);
+            // 浮點結果（f32 / f64）的回傳型別跟著值走，其他維持 I32
+            ir_type t = (ir_type)ctx->ir_base[ret_val].type;
+            if (t == IR_FLOAT || t == IR_DOUBLE) ctx->ret_type = t;
             ir_RETURN(ret_val);
         }
         if (!if_stack.empty() && !if_stack.top().has_else)
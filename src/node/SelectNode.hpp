@@ -3,6 +3,8 @@
 
 namespace ir_node {
 
+// Select{cond, t, f} → ir_COND：不分支的 cond ? t : f（x86 上是 cmov / blend），
+// 型別跟著 operand 走，跟 If 的 merge phi 一樣
 struct SelectNode : Node {
     void lower(BuildContext& bc, const Value& val) const override {
         ir_ctx* ctx = bc.ctx;
@@ -13,13 +15,8 @@ struct SelectNode : Node {
         ir_ref cond_ref = bc.value_map[cond_idx];
         ir_ref true_ref = bc.value_map[true_idx];
         ir_ref false_ref = bc.value_map[false_idx];
-        ir_ref if_node = ir_IF(cond_ref);
-        ir_IF_TRUE(if_node);
-        ir_ref end_true = ir_END();
-        ir_IF_FALSE(if_node);
-        ir_ref end_false = ir_END();
-        ir_MERGE_2(end_true, end_false);
-        bc.value_map[i] = ir_PHI_2(IR_I32, true_ref, false_ref);
+        ir_type type = (ir_type)ctx->ir_base[true_ref].type;
+        bc.value_map[i] = ir_COND(type, cond_ref, true_ref, false_ref);
     }
 };
 
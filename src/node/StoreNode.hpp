@@ -11,7 +11,7 @@ struct StoreNode : Node {
         if (val.lhs < 0 || val.lhs >= (int)i || val.rhs < 0 || val.rhs >= (int)i) return;
         ir_ref ptr_ref = bc.value_map[val.lhs], val_ref = bc.value_map[val.rhs];
         if (ptr_ref == IR_UNUSED || val_ref == IR_UNUSED) return;
-        ir_ref real_ptr = makeMemAddr(bc, ptr_ref, val.mem_offset);
+        ir_ref real_ptr = makeMemAddr(bc, val.lhs, val.mem_offset);
         ir_STORE(real_ptr, val_ref);
     }
 };
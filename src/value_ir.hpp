@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -56,13 +57,15 @@ enum class Op {
     Br_if,     // 条件跳转
     Phi,      // 新增：Phi 节点，用于合并循环变量
 
-    // F64
+    // F64（type 是 F32 的就是單精度：跟整數 op 用 type 分 i32 / i64 一樣，
+    // f32 的 add / load / const ... 共用這些 op，不另外開一套）
     F64Const,
     F64Add, F64Sub, F64Mul, F64Div,
     F64Abs, F64Neg, F64Sqrt,
     F64Exp, F64Log, F64Sin, F64Cos,
     F64Min, F64Max,
     F64Pow,
+    F64Fma,    // operands = {a, b, c}：a * b + c 只捨入一次（value_ir_fastmath）
     F64Eq, F64Ne, F64Lt, F64Gt, F64Le, F64Ge,
     F64ConvertI32S, F64ConvertI32U,
     I32TruncF64S, I32TruncF64U,
@@ -72,6 +75,8 @@ enum class Op {
     // i64 ↔ f64
     F64ConvertI64S, F64ConvertI64U,
     I64TruncF64S, I64TruncF64U,
+    // f32 ↔ f64
+    F32DemoteF64, F64PromoteF32,
     // Memory
     Load, Store,
     F64Load, F64Store,
@@ -81,10 +86,32 @@ enum class Op {
     MemoryFill,    // 新增：memory.fill
     MemoryCopy,    // 新增：memory.copy
     Return,
+    // 向量（value_ir_vectorize 拆出來的 kernel 才有）
+    Splat,        // lhs 的純量放進每個 lane
+    ExtractLane,  // lhs 的第 constValue 個 lane
+    Pack,         // operands 依序放進每個 lane（value_ir_slp）
+    // wasm SIMD（v128）：i32x4 / i64x2 / f64x2 的向量節點
+    V128Const,    // v128 的 16 個 byte
+    Bitcast,      // lhs 的 128 bit 換一種 lane 的看法
+    ReplaceLane,  // lhs 的第 constValue 個 lane 換成純量 rhs
+    Shuffle,      // 每個 byte 從 lhs:rhs 的第 v128[k] 個 byte 來
+    AnyTrue,      // lhs 有任何一個 bit 是 1（i32）
+    AllTrue,      // lhs 每個 lane 都不是 0（i32）
     _Count   // ← 新增，必須放最後
 };
 
-enum class ValueType { I32, I64, F64, Void };
+enum class ValueType { I32, I64, F32, F64, Void };
+
+// Call 的副作用摘要（value_ir_ipa.cpp 依 call graph 算出來，標在 Call 節點
+// 的 call_effects 上）。import、還沒分析過的 call 一律是 CallEffectsUnknown。
+enum CallEffect : unsigned {
+    CallReadsMemory    = 1u << 0,
+    CallWritesMemory   = 1u << 1,   // store / memory.fill / memory.copy
+    CallReadsGlobals   = 1u << 2,
+    CallWritesGlobals  = 1u << 3,
+    CallMayTrap        = 1u << 4,   // 有 unreachable（除法 / load 的 trap 跟 DCE 一樣不算）
+    CallEffectsUnknown = 0x1f,
+};
 
 struct Value {
     int id = -1;         // SSA value id
@@ -92,13 +119,14 @@ struct Value {
     ValueType type = ValueType::I32;  // 新增：值的类型
 
     int paramIndex = -1;  // for Param
-    int constValue = 0;   // for I32Const
-    double fconst = 0.0;   // for F64Const
+    int64_t constValue = 0;   // for I32Const / I64Const（i32 存 sign-extend 後的值）
+    double fconst = 0.0;   // for F64Const（F32 的也存在這裡，值是 float 取得到的）
     int lhs = -1;         // 對 binary op / Return 使用
     int rhs = -1;         // for binary op
 
     int mem_offset = 0;
     int mem_align = 0;
+    int mem_bytes = 0;    // Load/Store 實際存取寬度（0 = 依 type 推定）
 
     // 為了向後兼容，可以加 operands 陣列
     std::vector<int> operands;
@@ -107,6 +135,13 @@ struct Value {
     int globalIndex = -1; // for GlobalGet/GlobalSet
     bool use_vload_entry = false;  // inner-only PHI 需要從 VAR VLOAD 初始值
     std::string callee_name;  // ← 加這行
+    unsigned call_effects = CallEffectsUnknown;  // for Call：CallEffect 的 bitmask
+    bool pass_memory = false;  // for Call：__mem 當第一個引數傳下去（value_ir_parallel 的 task）
+    bool doall = false;        // for Loop：已知迭代之間沒有相依（value_ir_wavefront 排出來的）
+    bool fast_math = false;    // 浮點運算可以重排 / 不照 wasm 的 NaN、±0 規則（--fast-math）
+    int lanes = 1;             // > 1：向量節點，type 是每個 lane 的型別（value_ir_vectorize）
+                               // lanes > 1 的 Select：operands[0] 是逐 bit 的 mask（v128.bitselect）
+    uint8_t v128[16] = {};     // for V128Const / Shuffle
 
     // 建構函式（可選）
     Value() = default;
@@ -114,6 +149,40 @@ struct Value {
 
 using ValueIR = std::vector<Value>;  // 改：Value → ValueDef
 
+// value_ir_parallel 拆出來的 loop：函式本身跑 [p0, p1) 那一段迭代、回傳
+// reduction 的部分結果；caller 呼叫的是 C glue 的 <name>_run。
+struct ParallelTask {
+    bool isTask = false;
+    Op reduceOp = Op::Add;                    // 部分結果的合併方式
+    ValueType resultType = ValueType::Void;   // 沒有 reduction 時是 Void
+    int threads = 0;                          // --threads=N
+    int64_t minIters = 2;                     // 迭代數比這少時 runtime 不開 thread
+};
+
+// value_ir_vectorize 拆出來的 loop：有向量節點，不經過 dstogov/ir，由
+// vectorGlueC 直接寫成 C 的 vector extension。caller 呼叫的是 <name>_run，
+// 執行時依 CPU 挑 128-bit 的 <name> 或 256-bit 的 <name>_avx2。
+struct VectorKernel {
+    bool isKernel = false;
+    int bits = 128;                           // 向量寬度
+    bool straightLine = false;                // value_ir_slp 的：沒有 loop，參數裡沒有 lo / hi
+    bool simd = false;                        // wasm 本身就有 v128 的函式，整個函式是 kernel
+};
+
+// 整個 module 一起處理的 pass（inlining 等）用：每個有 body 的函式
+// lower 完的 ValueIR。name 跟 Call.callee_name 是同一套名字。
+struct ModuleFunction {
+    std::string name;
+    size_t numParams = 0;
+    bool exported = false;    // 有 export：module 外面也會呼叫，參數不能假設
+    std::vector<ValueType> paramTypes;     // 空 = 全部 i32
+    std::vector<std::string> paramNames;   // name section 的參數名稱（沒有就是空字串）
+    int origin = -1;          // specialization 產生的 clone / 平行化的 task：原函式在 module 裡的位置
+    ParallelTask parallel;
+    VectorKernel vector;
+    ValueIR values;
+};
+
 inline const char* opToString(Op op) {
     static const char* const kOpNames[] = {
         "Param",           // Param
@@ -176,6 +245,7 @@ inline const char* opToString(Op op) {
         "F64Min",          // F64Min         ← 同上
         "F64Max",          // F64Max         ← 同上
         "F64Pow",          // F64Pow         ← 同上
+        "F64Fma",          // F64Fma
         "F64Eq",           // F64Eq          ← 同上
         "F64Ne",           // F64Ne          ← 同上
         "F64Lt",           // F64Lt          ← 同上
@@ -193,6 +263,8 @@ inline const char* opToString(Op op) {
         "F64ConvertI64U",  // F64ConvertI64U
         "I64TruncF64S",    // I64TruncF64S
         "I64TruncF64U",    // I64TruncF64U
+        "F32DemoteF64",    // F32DemoteF64
+        "F64PromoteF32",   // F64PromoteF32
         "Load",            // Load
         "Store",           // Store
         "F64Load",         // F64Load
@@ -203,6 +275,15 @@ inline const char* opToString(Op op) {
         "MemoryFill",      // MemoryFill
         "MemoryCopy",      // MemoryCopy
         "Return",          // Return
+        "Splat",           // Splat
+        "ExtractLane",     // ExtractLane
+        "Pack",            // Pack
+        "V128Const",       // V128Const
+        "Bitcast",         // Bitcast
+        "ReplaceLane",     // ReplaceLane
+        "Shuffle",         // Shuffle
+        "AnyTrue",         // AnyTrue
+        "AllTrue",         // AllTrue
     };
 
     static_assert(sizeof(kOpNames) / sizeof(kOpNames[0])
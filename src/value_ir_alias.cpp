@@ -0,0 +1,273 @@
+#include "value_ir_alias.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_instr.hpp"
+#include <iostream>
+
+// ============================================================
+// 位址分解
+// ============================================================
+//
+// 認得的形狀（-O0 與 -O1 的 clang 輸出都只會用到這幾種）：
+//
+//   I32Const c                 → Absolute + c
+//   Param p                    → Param(p)
+//   GlobalGet sp               → Frame（shadow stack pointer，wasm-ld 固定是
+//                                global 0），只有落在 SP 之下的存取才算
+//                                frame，其餘降為 Unknown；其他 global 當
+//                                指標用時是 Unknown
+//   Add(x, Const c) / Sub(x, Const c)
+//                              → dec(x) ± c
+//   Add(base, idx)             → base 的種類 + index = idx
+//   Load(frame slot K)         → Param(p)，若 slot K 整個函式只被寫入
+//                                過參數 p（-O0 把指標參數先存進 frame，
+//                                之後每次用都重新 load 的慣用法）
+//
+// 其他一律 Unknown，base 記成「根節點」的 SSA id，讓同一個未知指標
+// 加不同常數 offset 的兩個存取仍然可以判斷不重疊。
+
+namespace {
+
+// global.get __stack_pointer：frame 位址的來源
+bool isStackPointer(const Value& v) {
+    return v.op == Op::GlobalGet && v.globalIndex == kStackPointerGlobal;
+}
+
+} // namespace
+
+AliasAnalysis::AliasAnalysis(const ValueIR& values, AliasOptions opts)
+    : values_(values), opts_(opts) {
+    // ---- frame 逃逸分析 ----
+    std::vector<bool>& frameDerived = frameDerived_;
+    frameDerived.assign(values.size(), false);
+    for (size_t i = 0; i < values.size(); i++) {
+        const Value& v = values[i];
+        // 位址經過任何算術（對齊用的 And、Select、if-merge Phi……）都還是
+        // frame 位址；只有 load（讀出來的是內容）與比較結果不算。
+        bool derived = isStackPointer(v);
+        switch (v.op) {
+        case Op::Load: case Op::F64Load: case Op::Eqz:
+        case Op::Eq: case Op::Ne: case Op::Lt_S: case Op::Lt_U: case Op::Gt_S: case Op::Gt_U:
+        case Op::Le_S: case Op::Le_U: case Op::Ge_S: case Op::Ge_U:
+            break;
+        default:
+            if (hasSideEffects(v.op)) break;
+            forEachOperand(v, [&](int ref) {
+                if (ref < (int)i && frameDerived[ref]) derived = true;
+            });
+            break;
+        }
+        frameDerived[i] = derived;
+
+        auto escapesVia = [&](int ref) {
+            if (ref >= 0 && ref < (int)values.size() && frameDerived[ref]) frameEscapes_ = true;
+        };
+        switch (v.op) {
+        case Op::Store: case Op::F64Store:
+            escapesVia(v.rhs);
+            break;
+        case Op::Call: case Op::MemoryFill: case Op::MemoryCopy:
+            for (int op : v.operands) escapesVia(op);
+            break;
+        case Op::Return:
+            escapesVia(v.lhs);
+            break;
+        default:
+            break;
+        }
+    }
+    // loop phi 的 back-edge 可能是 forward ref，上面單趟掃描看不到；
+    // 保守處理：frame 值只要進了 loop phi 就當作逃逸。
+    for (const auto& v : values)
+        if (v.op == Op::Phi && v.local_index >= 0)
+            for (int op : v.operands)
+                if (op >= 0 && op < (int)values.size() && frameDerived[op]) frameEscapes_ = true;
+
+    // ---- 只存過單一參數的 frame slot ----
+    if (!frameEscapes_) {
+        std::unordered_map<int64_t, int> slot;   // offset -> param（-1 = 不是）
+        bool unknownFrameWrite = false;
+        for (size_t i = 0; i < values.size(); i++) {
+            const Value& v = values[i];
+            if (!isMemoryWrite(v.op)) continue;
+            if (v.op == Op::MemoryFill || v.op == Op::MemoryCopy) continue;  // frame 沒逃逸，碰不到
+            MemLocation loc = location((int)i);
+            if (loc.kind != MemLocation::Frame) continue;
+            if (loc.index >= 0 || (slotBase_ >= 0 && loc.base != slotBase_)) {
+                unknownFrameWrite = true;
+                break;
+            }
+            slotBase_ = loc.base;
+            int param = -1;
+            if (v.op == Op::Store && loc.size == 4 && v.rhs >= 0 && values[v.rhs].op == Op::Param)
+                param = values[v.rhs].paramIndex;
+            // 跟其他 slot 重疊的寫入：把被碰到的 slot 都作廢
+            for (auto& [off, p] : slot)
+                if (off != loc.offset && off < loc.offset + loc.size && loc.offset < off + 4) p = -1;
+            auto it = slot.find(loc.offset);
+            if (it == slot.end()) slot[loc.offset] = (loc.size == 4) ? param : -1;
+            else if (it->second != param) it->second = -1;
+        }
+        if (!unknownFrameWrite)
+            for (auto& [off, p] : slot)
+                if (p >= 0) slotParam_[off] = p;
+        if (slotParam_.empty()) slotBase_ = -1;
+    }
+    ptrCache_.clear();
+}
+
+MemLocation AliasAnalysis::decompose(int ptr) const {
+    auto cached = ptrCache_.find(ptr);
+    if (cached != ptrCache_.end()) return cached->second;
+
+    MemLocation r;
+    r.kind = MemLocation::Unknown;
+    r.base = ptr;
+
+    if (ptr >= 0 && ptr < (int)values_.size()) {
+        const Value& v = values_[ptr];
+        auto isConst = [](const MemLocation& m) {
+            return m.kind == MemLocation::Absolute && m.index < 0;
+        };
+        // 把「沒有已知 base 的那一側」當成 index
+        auto withIndex = [&](MemLocation base, const MemLocation& idx, int idxId) {
+            if (idx.kind == MemLocation::Unknown && idx.index < 0) {
+                base.index = idx.base;
+                base.offset += idx.offset;
+            } else {
+                base.index = idxId;
+            }
+            return base;
+        };
+
+        switch (v.op) {
+        case Op::I32Const:
+            r.kind = MemLocation::Absolute;
+            r.base = -1;
+            r.offset = v.constValue;
+            break;
+        case Op::Param:
+            if (v.type == ValueType::I32) {
+                r.kind = MemLocation::Param;
+                r.base = v.paramIndex;
+            }
+            break;
+        case Op::GlobalGet:
+            // 每個 GlobalGet 節點自成一個 base：中間若有 global.set sp，
+            // 前後兩次讀到的 SP 不同，不能當成同一個 frame 比 offset。
+            if (isStackPointer(v)) r.kind = MemLocation::Frame;
+            break;
+        case Op::Add: {
+            if (v.lhs < 0 || v.rhs < 0) break;
+            MemLocation a = decompose(v.lhs), b = decompose(v.rhs);
+            if (isConst(b)) {
+                r = a;
+                r.offset += b.offset;
+            } else if (isConst(a)) {
+                r = b;
+                r.offset += a.offset;
+            } else if (a.kind != MemLocation::Unknown && a.index < 0 && b.kind == MemLocation::Unknown) {
+                r = withIndex(a, b, v.rhs);
+            } else if (b.kind != MemLocation::Unknown && b.index < 0 && a.kind == MemLocation::Unknown) {
+                r = withIndex(b, a, v.lhs);
+            }
+            break;
+        }
+        case Op::Sub: {
+            if (v.lhs < 0 || v.rhs < 0) break;
+            MemLocation b = decompose(v.rhs);
+            if (isConst(b)) {
+                r = decompose(v.lhs);
+                r.offset -= b.offset;
+            }
+            break;
+        }
+        case Op::Load: {
+            if (v.type != ValueType::I32 || slotParam_.empty()) break;
+            MemLocation slot = location(ptr);
+            if (slot.kind != MemLocation::Frame || slot.index >= 0 || slot.base != slotBase_) break;
+            auto it = slotParam_.find(slot.offset);
+            if (it != slotParam_.end()) {
+                r = MemLocation{};
+                r.kind = MemLocation::Param;
+                r.base = it->second;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    r.size = 0;
+    ptrCache_[ptr] = r;
+    return r;
+}
+
+MemLocation AliasAnalysis::location(int id) const {
+    const Value& v = values_[id];
+    MemLocation loc = decompose(v.lhs);
+    loc.offset += v.mem_offset;
+    loc.size = memAccessBytes(v);
+    // frame 是「進入時的 SP 往下」那一段；沒有 index 卻碰到 SP 以上的
+    // 存取其實是 caller 的記憶體（或 global 根本不是 SP），不能當 frame。
+    if (loc.kind == MemLocation::Frame && loc.index < 0 && loc.offset + loc.size > 0)
+        loc.kind = MemLocation::Unknown;
+    return loc;
+}
+
+AliasResult AliasAnalysis::alias(int a, int b) const {
+    MemLocation A = location(a), B = location(b);
+
+    auto compareRanges = [&]() {
+        if (A.offset + A.size <= B.offset || B.offset + B.size <= A.offset)
+            return AliasResult::NoAlias;
+        if (A.offset == B.offset && A.size == B.size)
+            return AliasResult::MustAlias;
+        return AliasResult::MayAlias;
+    };
+
+    bool aFrame = A.kind == MemLocation::Frame, bFrame = B.kind == MemLocation::Frame;
+    if (aFrame != bFrame) {
+        // 目前函式的 frame 在進入時的 SP 之下；frame 位址沒逃逸時，caller
+        // 傳進來的指標、static data、從記憶體 load 出來的指標都不可能指到
+        // 這裡。逃逸之後（傳給 callee、存進記憶體）任何指標都可能繞回來；
+        // 帶 index 的 frame 存取不知道落在哪，也不保證在 frame 裡。
+        // 另一邊的位址若是從 SP 算出來、只是 decompose 認不出來（select 兩個
+        // slot、對齊用的 And），一樣可能是 frame。
+        const MemLocation& frame = aFrame ? A : B;
+        if (frame.index >= 0 || frameEscapes_) return AliasResult::MayAlias;
+        const int ptr = values_[aFrame ? b : a].lhs;
+        if (ptr < 0 || ptr >= (int)frameDerived_.size() || frameDerived_[ptr])
+            return AliasResult::MayAlias;
+        return AliasResult::NoAlias;
+    }
+
+    if (A.kind != B.kind) return AliasResult::MayAlias;
+
+    if (A.base != B.base) {
+        if (A.kind == MemLocation::Param && opts_.distinctParamsNoAlias)
+            return AliasResult::NoAlias;
+        return AliasResult::MayAlias;
+    }
+    if (A.index != B.index) return AliasResult::MayAlias;
+    return compareRanges();
+}
+
+// ============================================================
+// Dump
+// ============================================================
+
+void dumpAliasInfo(const ValueIR& values, const AliasAnalysis& aa) {
+    static const char* const kKindNames[] = { "unknown", "param", "frame", "abs" };
+    std::cout << "// frame escapes: " << (aa.frameEscapes() ? "yes" : "no") << "\n";
+    for (size_t i = 0; i < values.size(); i++) {
+        const Value& v = values[i];
+        if (!memAccessBytes(v)) continue;
+        MemLocation loc = aa.location((int)i);
+        std::cout << "v" << v.id << " = " << opToString(v.op) << "  ["
+                  << kKindNames[loc.kind];
+        if (loc.kind == MemLocation::Unknown) std::cout << "(v" << loc.base << ")";
+        else if (loc.base >= 0) std::cout << "(" << loc.base << ")";
+        if (loc.index >= 0) std::cout << " + v" << loc.index;
+        std::cout << " + " << loc.offset << ", " << loc.size << "B]\n";
+    }
+}
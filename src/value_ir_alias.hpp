@@ -0,0 +1,74 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================
+// Alias analysis：linear memory 上的指標到底指向哪裡
+// ============================================================
+//
+// wasm 只有一塊 linear memory，所有存取在 C 端都是 `__mem + addr`，
+// 所以 C compiler 完全看不出兩個 kernel 參數 A、B 指向不同陣列。
+// 這裡在 ValueIR 上把每個 load/store 的位址拆成
+//
+//     base（從哪個指標來的） + index（變動部分，SSA id） + offset（常數）
+//
+// 再依 base 的種類回答「兩個存取會不會碰到同一塊記憶體」。
+
+enum class AliasResult { NoAlias, MayAlias, MustAlias };
+
+struct MemLocation {
+    enum Kind {
+        Unknown,    // 追不到來源
+        Param,      // 從函式參數（指標）衍生
+        Frame,      // 從 shadow stack pointer（global.get sp）衍生
+        Absolute,   // 常數位址（static data）
+    } kind = Unknown;
+    int base = -1;         // Param: wasm 參數編號；Frame: GlobalGet 節點的 SSA id；
+                           // Unknown: 追到的根節點 SSA id
+    int index = -1;        // 變動部分的 SSA id，-1 表示沒有
+    int64_t offset = 0;    // 常數位移（已含 mem_offset）
+    int size = 0;          // 存取寬度（bytes）
+};
+
+struct AliasOptions {
+    // 假設不同的指標參數指向互不重疊的記憶體（C99 restrict 語意）。
+    // PolyBench 之類的 kernel 成立，但一般的 wasm 不保證，所以要明確打開
+    // （--assume-noalias-params）。
+    bool distinctParamsNoAlias = false;
+};
+
+class AliasAnalysis {
+public:
+    explicit AliasAnalysis(const ValueIR& values, AliasOptions opts = {});
+
+    // id 必須是 Load / Store / F64Load / F64Store。查詢是 lazy + memoized，
+    // 呼叫端在 pass 中途改寫「id 之前」的節點是安全的。
+    MemLocation location(int id) const;
+    AliasResult alias(int a, int b) const;
+    bool mayAlias(int a, int b) const { return alias(a, b) != AliasResult::NoAlias; }
+
+    // frame 位址有沒有流到 load/store 位址以外的地方（存進記憶體、傳給
+    // call、回傳……）。沒有逃逸時，frame 上不帶 index 的存取跟 frame 以外的
+    // 存取都不重疊。
+    bool frameEscapes() const { return frameEscapes_; }
+
+private:
+    MemLocation decompose(int ptr) const;
+
+    const ValueIR& values_;
+    AliasOptions opts_;
+    bool frameEscapes_ = false;
+    // 值是不是從 SP 算出來的（經過 Select / And / Phi 之後 decompose 認不出
+    // 是 Frame，但還是可能指到 frame）
+    std::vector<bool> frameDerived_;
+    // frame slot（相對 slotBase_ 的 offset）-> 唯一寫進去的參數編號
+    int slotBase_ = -1;
+    std::unordered_map<int64_t, int> slotParam_;
+    mutable std::unordered_map<int, MemLocation> ptrCache_;
+};
+
+// --print-after=alias：列出每個記憶體存取的 MemLocation
+void dumpAliasInfo(const ValueIR& values, const AliasAnalysis& aa);
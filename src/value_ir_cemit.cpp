@@ -0,0 +1,572 @@
+#include "value_ir_cemit.hpp"
+#include "value_ir_util.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+const char* kernelParamCType(ValueType t) {
+    switch (t) {
+    case ValueType::I64: return "int64_t";
+    case ValueType::F32: return "float";
+    case ValueType::F64: return "double";
+    case ValueType::Void: return "void";
+    default: return "int32_t";
+    }
+}
+
+std::string kernelPreludeC() {
+    std::ostringstream os;
+    os << "/* vector kernels (value_ir_vectorize) */\n";
+    for (int lanes : {2, 4, 8}) {
+        os << "typedef uint32_t w2s_u32x" << lanes << " __attribute__((vector_size(" << 4 * lanes << ")));\n";
+        os << "typedef int32_t w2s_i32x" << lanes << " __attribute__((vector_size(" << 4 * lanes << ")));\n";
+    }
+    for (int lanes : {2, 4}) {
+        os << "typedef uint64_t w2s_u64x" << lanes << " __attribute__((vector_size(" << 8 * lanes << ")));\n";
+        os << "typedef int64_t w2s_i64x" << lanes << " __attribute__((vector_size(" << 8 * lanes << ")));\n";
+        os << "typedef double w2s_f64x" << lanes << " __attribute__((vector_size(" << 8 * lanes << ")));\n";
+    }
+    // i8x16.shuffle：clang 跟 GCC 的 builtin 不一樣
+    os << "typedef uint8_t w2s_u8x16 __attribute__((vector_size(16)));\n";
+    os << "#if defined(__clang__)\n"
+          "#define W2S_SHUFFLE(a, b, ...) __builtin_shufflevector(a, b, __VA_ARGS__)\n"
+          "#else\n"
+          "#define W2S_SHUFFLE(a, b, ...) __builtin_shuffle(a, b, (w2s_u8x16){__VA_ARGS__})\n"
+          "#endif\n";
+    // f64 常數照 bit pattern 寫，NaN / -0.0 都不會變
+    os << "static inline double w2s_f64(uint64_t b) { double d; memcpy(&d, &b, 8); return d; }\n";
+    // wasm 的 f64.min / f64.max：有 NaN 就是 NaN，-0.0 < +0.0
+    os << "static inline double w2s_fmin(double a, double b) {\n"
+          "    if (a != a || b != b) return a + b;\n"
+          "    if (a == b) return __builtin_signbit(a) ? a : b;\n"
+          "    return a < b ? a : b;\n"
+          "}\n";
+    os << "static inline double w2s_fmax(double a, double b) {\n"
+          "    if (a != a || b != b) return a + b;\n"
+          "    if (a == b) return __builtin_signbit(a) ? b : a;\n"
+          "    return a > b ? a : b;\n"
+          "}\n\n";
+    return os.str();
+}
+
+namespace {
+
+class KernelEmitter {
+public:
+    explicit KernelEmitter(const ModuleFunction& f) : f_(f), v_(f.values) {}
+
+    bool emit(const std::string& cname, const std::string& attrs, std::string& out);
+
+private:
+    std::string type(int id) const;
+    std::string ref(int id) const;
+    std::string as(int dst, int src);
+    bool loopPhis(int loop, std::vector<int>& phis) const;
+    void backedge(int loop);
+    std::string addr(const Value& v) const;
+    bool statement(int i);
+    bool scalarOp(int i);
+    bool vectorOp(int i);
+    bool isSigned(int id) const {
+        const ValueType t = resultTypeOf(v_[id]);
+        return t != ValueType::F64 && t != ValueType::F32;
+    }
+    int bits(int id) const { return resultTypeOf(v_[id]) == ValueType::I64 ? 64 : 32; }
+
+    const ModuleFunction& f_;
+    const ValueIR& v_;
+    std::vector<int> match_;        // matchRegions
+    std::vector<int> open_;         // 目前在裡面的 Loop（C 的 for）
+    std::vector<bool> exitLabel_;   // Loop → End 後面要放 `e<loop>:;`
+    bool failed_ = false;
+    std::ostringstream body_;
+    int depth_ = 1;
+    std::string indent() const { return std::string(4 * depth_, ' '); }
+};
+
+// lanes > 1 是 vector typedef；i32 / i64 一律 unsigned
+std::string KernelEmitter::type(int id) const {
+    const Value& v = v_[id];
+    ValueType t = resultTypeOf(v);
+    if (v.op == Op::Param && v.paramIndex >= 0 && v.paramIndex < (int)f_.paramTypes.size())
+        t = f_.paramTypes[v.paramIndex];
+    if (v.lanes > 1) {
+        std::string lanes = std::to_string(v.lanes);
+        if (t == ValueType::F64) return "w2s_f64x" + lanes;
+        return (t == ValueType::I64 ? "w2s_u64x" : "w2s_u32x") + lanes;
+    }
+    switch (t) {
+    case ValueType::I64: return "uint64_t";
+    case ValueType::F32: return "float";
+    case ValueType::F64: return "double";
+    default: return "uint32_t";
+    }
+}
+
+// Param / 常數直接寫在用到的地方，其他節點是變數
+std::string KernelEmitter::ref(int id) const {
+    const Value& v = v_[id];
+    switch (v.op) {
+    case Op::Param:
+        return "((" + type(id) + ")p" + std::to_string(v.paramIndex) + ")";
+    case Op::I32Const:
+        return "((uint32_t)" + std::to_string((int64_t)v.constValue) + ")";
+    case Op::I64Const:
+        return "((uint64_t)(int64_t)" + std::to_string((int64_t)v.constValue) + ")";
+    case Op::F64Const: {
+        uint64_t bits;
+        std::memcpy(&bits, &v.fconst, sizeof bits);
+        std::ostringstream os;
+        os << "w2s_f64(0x" << std::hex << bits << "ull)";
+        // F32 的值本來就是 float 取得到的，轉回 float 不會變
+        return v.type == ValueType::F32 ? "((float)" + os.str() + ")" : os.str();
+    }
+    default:
+        return "v" + std::to_string(id);
+    }
+}
+
+// dst = src 的右邊：v128 的 phi 可能從另一種 lane 看法的值進來，
+// 同樣 16 byte 的向量直接轉型。純量跟向量混在一起寫不出來
+std::string KernelEmitter::as(int dst, int src) {
+    if (type(dst) == type(src)) return ref(src);
+    if (v_[dst].lanes > 1 && v_[src].lanes > 1) return "(" + type(dst) + ")" + ref(src);
+    failed_ = true;
+    return ref(src);
+}
+
+// loop 帶的 phi（local_index >= 0，在 Loop 跟下一個 Loop 之間）。只接
+// {入口值, back-edge} 兩個 operand 的：多個 back-edge 分不出哪個是哪個
+bool KernelEmitter::loopPhis(int loop, std::vector<int>& phis) const {
+    const int end = match_[loop] >= 0 ? match_[loop] : (int)v_.size();
+    for (int j = loop + 1; j < end && v_[j].op != Op::Loop; j++) {
+        if (v_[j].op != Op::Phi || v_[j].local_index < 0) continue;
+        if (v_[j].use_vload_entry || v_[j].operands.empty() || v_[j].operands.size() > 2) return false;
+        phis.push_back(j);
+    }
+    return true;
+}
+
+// 所有 phi 一起換成下一輪的值
+void KernelEmitter::backedge(int loop) {
+    std::vector<int> phis;
+    if (!loopPhis(loop, phis)) { failed_ = true; return; }
+    std::vector<int> next;
+    for (int p : phis)
+        if (v_[p].operands.size() == 2) next.push_back(p);
+    for (size_t k = 0; k < next.size(); k++)
+        body_ << indent() << type(next[k]) << " n" << k << " = " << as(next[k], v_[next[k]].operands[1]) << ";\n";
+    for (size_t k = 0; k < next.size(); k++) body_ << indent() << ref(next[k]) << " = n" << k << ";\n";
+}
+
+std::string KernelEmitter::addr(const Value& v) const {
+    return "(void*)(mem + (uintptr_t)" + ref(v.lhs) + " + " + std::to_string((uint32_t)v.mem_offset) + "u)";
+}
+
+bool KernelEmitter::scalarOp(int i) {
+    const Value& v = v_[i];
+    const std::string d = indent() + ref(i) + " = ";
+    const std::string a = v.lhs >= 0 ? ref(v.lhs) : "", b = v.rhs >= 0 ? ref(v.rhs) : "";
+    const bool wide = v.lhs >= 0 && bits(v.lhs) == 64;
+    const std::string st = wide ? "(int64_t)" : "(int32_t)";
+    const std::string mask = wide ? " & 63)" : " & 31)";
+    const std::string w = wide ? "64" : "32";
+    auto binary = [&](const char* o) { body_ << d << a << " " << o << " " << b << ";\n"; };
+    auto compare = [&](const char* o, bool sign) {
+        if (sign) body_ << d << "(uint32_t)(" << st << a << " " << o << " " << st << b << ");\n";
+        else body_ << d << "(uint32_t)(" << a << " " << o << " " << b << ");\n";
+    };
+    switch (v.op) {
+    case Op::Add: binary("+"); break;
+    case Op::Sub: binary("-"); break;
+    case Op::Mul: binary("*"); break;
+    case Op::And: binary("&"); break;
+    case Op::Or: binary("|"); break;
+    case Op::Xor: binary("^"); break;
+    case Op::Shl: body_ << d << a << " << (" << b << mask << ";\n"; break;
+    case Op::Shr_U: body_ << d << a << " >> (" << b << mask << ";\n"; break;
+    case Op::Shr_S:
+        body_ << d << "(" << type(i) << ")(" << st << a << " >> (" << b << mask << ");\n";
+        break;
+    case Op::Rotl: case Op::Rotr: {
+        const std::string n = "(" + b + mask, l = v.op == Op::Rotl ? "<<" : ">>", r = v.op == Op::Rotl ? ">>" : "<<";
+        body_ << d << "(" << a << " " << l << " " << n << ") | (" << a << " " << r << " ((" << w << " - " << n
+              << ")" << mask << ");\n";
+        break;
+    }
+    case Op::Clz:
+        body_ << d << "(" << type(i) << ")(" << a << " ? " << (wide ? "__builtin_clzll(" : "__builtin_clz(") << a
+              << ") : " << w << ");\n";
+        break;
+    case Op::Ctz:
+        body_ << d << "(" << type(i) << ")(" << a << " ? " << (wide ? "__builtin_ctzll(" : "__builtin_ctz(") << a
+              << ") : " << w << ");\n";
+        break;
+    case Op::Popcnt:
+        body_ << d << "(" << type(i) << ")" << (wide ? "__builtin_popcountll(" : "__builtin_popcount(") << a << ");\n";
+        break;
+    case Op::Eqz: body_ << d << "(uint32_t)(" << a << " == 0);\n"; break;
+    case Op::Eq: compare("==", false); break;
+    case Op::Ne: compare("!=", false); break;
+    case Op::Lt_S: compare("<", true); break;
+    case Op::Lt_U: compare("<", false); break;
+    case Op::Gt_S: compare(">", true); break;
+    case Op::Gt_U: compare(">", false); break;
+    case Op::Le_S: compare("<=", true); break;
+    case Op::Le_U: compare("<=", false); break;
+    case Op::Ge_S: compare(">=", true); break;
+    case Op::Ge_U: compare(">=", false); break;
+    case Op::F64Eq: compare("==", false); break;
+    case Op::F64Ne: compare("!=", false); break;
+    case Op::F64Lt: compare("<", false); break;
+    case Op::F64Gt: compare(">", false); break;
+    case Op::F64Le: compare("<=", false); break;
+    case Op::F64Ge: compare(">=", false); break;
+    case Op::F64Add: binary("+"); break;
+    case Op::F64Sub: binary("-"); break;
+    case Op::F64Mul: binary("*"); break;
+    case Op::F64Div: binary("/"); break;
+    // --fast-math：不管 NaN / ±0，compiler 直接變成 minsd / maxsd
+    case Op::F64Min:
+        if (v.fast_math) body_ << d << a << " < " << b << " ? " << a << " : " << b << ";\n";
+        else body_ << d << "w2s_fmin(" << a << ", " << b << ");\n";
+        break;
+    case Op::F64Max:
+        if (v.fast_math) body_ << d << a << " > " << b << " ? " << a << " : " << b << ";\n";
+        else body_ << d << "w2s_fmax(" << a << ", " << b << ");\n";
+        break;
+    case Op::F64Fma:
+        if (v.operands.size() != 3) return false;
+        body_ << d << (v.type == ValueType::F32 ? "__builtin_fmaf(" : "__builtin_fma(") << ref(v.operands[0])
+              << ", " << ref(v.operands[1]) << ", " << ref(v.operands[2]) << ");\n";
+        break;
+    case Op::F64Neg: body_ << d << "-" << a << ";\n"; break;
+    case Op::F64Abs:
+        body_ << d << (v.type == ValueType::F32 ? "__builtin_fabsf(" : "__builtin_fabs(") << a << ");\n";
+        break;
+    case Op::F64Sqrt:
+        body_ << d << (v.type == ValueType::F32 ? "__builtin_sqrtf(" : "__builtin_sqrt(") << a << ");\n";
+        break;
+    case Op::F64ConvertI32S: body_ << d << "(" << type(i) << ")(int32_t)" << a << ";\n"; break;
+    case Op::F64ConvertI32U: body_ << d << "(" << type(i) << ")(uint32_t)" << a << ";\n"; break;
+    case Op::F64ConvertI64S: body_ << d << "(" << type(i) << ")(int64_t)" << a << ";\n"; break;
+    case Op::F64ConvertI64U: body_ << d << "(" << type(i) << ")(uint64_t)" << a << ";\n"; break;
+    case Op::F32DemoteF64: body_ << d << "(float)" << a << ";\n"; break;
+    case Op::F64PromoteF32: body_ << d << "(double)" << a << ";\n"; break;
+    case Op::I32WrapI64: body_ << d << "(uint32_t)" << a << ";\n"; break;
+    case Op::I64ExtendI32S: body_ << d << "(uint64_t)(int64_t)(int32_t)" << a << ";\n"; break;
+    case Op::I64ExtendI32U: body_ << d << "(uint64_t)(uint32_t)" << a << ";\n"; break;
+    case Op::Select:
+        if (v.operands.size() != 3) return false;
+        body_ << d << ref(v.operands[0]) << " ? " << ref(v.operands[1]) << " : " << ref(v.operands[2]) << ";\n";
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+// lane-wise：vector extension 直接支援的用運算子，其他的逐 lane 做
+// （compiler 會變成 sqrtpd / andpd）。比較的結果是每個 lane 全 1 / 全 0
+bool KernelEmitter::vectorOp(int i) {
+    const Value& v = v_[i];
+    const std::string d = indent() + ref(i) + " = ";
+    const std::string a = v.lhs >= 0 ? ref(v.lhs) : "", b = v.rhs >= 0 ? ref(v.rhs) : "";
+    const std::string lanes = std::to_string(v.lanes);
+    const bool wide = v.lhs >= 0 && resultTypeOf(v_[v.lhs]) == ValueType::I64;
+    const std::string signedType = (wide ? "w2s_i64x" : "w2s_i32x") + lanes;
+    const std::string mask = wide ? " & 63" : " & 31";
+    auto binary = [&](const char* o) { body_ << d << a << " " << o << " " << b << ";\n"; };
+    auto perLane = [&](const char* fn) {
+        body_ << indent() << "for (int l = 0; l < " << lanes << "; l++) " << ref(i) << "[l] = " << fn << "("
+              << a << "[l]" << (v.rhs >= 0 ? ", " + b + "[l]" : "") << ");\n";
+    };
+    auto compare = [&](const char* o, bool sign) {
+        if (sign) body_ << d << "(" << type(i) << ")((" << signedType << ")" << a << " " << o << " (" << signedType
+                        << ")" << b << ");\n";
+        else body_ << d << "(" << type(i) << ")(" << a << " " << o << " " << b << ");\n";
+    };
+    switch (v.op) {
+    case Op::Add: case Op::F64Add: binary("+"); break;
+    case Op::Sub: case Op::F64Sub: binary("-"); break;
+    case Op::Mul: case Op::F64Mul: binary("*"); break;
+    case Op::F64Div: binary("/"); break;
+    case Op::And: binary("&"); break;
+    case Op::Or: binary("|"); break;
+    case Op::Xor: binary("^"); break;
+    case Op::Shl: body_ << d << a << " << (" << b << mask << ");\n"; break;
+    case Op::Shr_U: body_ << d << a << " >> (" << b << mask << ");\n"; break;
+    case Op::Shr_S:
+        body_ << d << "(" << type(i) << ")((" << signedType << ")" << a << " >> (" << signedType << ")(" << b
+              << mask << "));\n";
+        break;
+    case Op::Eq: case Op::F64Eq: compare("==", false); break;
+    case Op::Ne: case Op::F64Ne: compare("!=", false); break;
+    case Op::Lt_S: compare("<", true); break;
+    case Op::Lt_U: case Op::F64Lt: compare("<", false); break;
+    case Op::Gt_S: compare(">", true); break;
+    case Op::Gt_U: case Op::F64Gt: compare(">", false); break;
+    case Op::Le_S: compare("<=", true); break;
+    case Op::Le_U: case Op::F64Le: compare("<=", false); break;
+    case Op::Ge_S: compare(">=", true); break;
+    case Op::Ge_U: case Op::F64Ge: compare(">=", false); break;
+    case Op::F64Min: case Op::F64Max: {
+        if (!v.fast_math) {
+            perLane(v.op == Op::F64Min ? "w2s_fmin" : "w2s_fmax");
+            break;
+        }
+        // --fast-math：比較出來的 mask 挑 lane（cmppd + blend，跟 minpd 一樣不管 NaN / ±0）
+        const std::string u = "w2s_u64x" + lanes;
+        body_ << indent() << "{ " << u << " m = (" << u << ")(" << a << (v.op == Op::F64Min ? " < " : " > ") << b
+              << "); " << ref(i) << " = (" << type(i) << ")(((" << u << ")" << a << " & m) | ((" << u << ")" << b
+              << " & ~m)); }\n";
+        break;
+    }
+    // vector extension 沒有 fma：寫成一個運算式，target 有 FMA 時 compiler 會合併
+    // （GCC 預設 -ffp-contract=fast，clang 的 on 也合併同一個運算式）
+    case Op::F64Fma:
+        if (v.operands.size() != 3) return false;
+        body_ << d << ref(v.operands[0]) << " * " << ref(v.operands[1]) << " + " << ref(v.operands[2]) << ";\n";
+        break;
+    case Op::F64Neg: body_ << d << "-" << a << ";\n"; break;
+    case Op::F64Abs: perLane("__builtin_fabs"); break;
+    case Op::F64Sqrt: perLane("__builtin_sqrt"); break;
+    case Op::F64ConvertI32S:
+        body_ << d << "__builtin_convertvector((" << signedType << ")" << a << ", " << type(i) << ");\n";
+        break;
+    case Op::F64ConvertI32U:
+        body_ << d << "__builtin_convertvector(" << a << ", " << type(i) << ");\n";
+        break;
+    case Op::Select: {
+        // 純量條件挑整個向量；向量條件是逐 bit 的 mask（v128.bitselect）
+        if (v.operands.size() != 3) return false;
+        const std::string m = ref(v.operands[0]), t = as(i, v.operands[1]), f = as(i, v.operands[2]);
+        if (v_[v.operands[0]].lanes == 1) {
+            body_ << d << m << " ? " << t << " : " << f << ";\n";
+            break;
+        }
+        const std::string u = (v.type == ValueType::F64 ? "(w2s_u64x" : "(") +
+                              (v.type == ValueType::F64 ? lanes : type(i)) + ")";
+        body_ << d << "(" << type(i) << ")((" << u << t << " & " << u << m << ") | (" << u << f << " & ~" << u << m
+              << "));\n";
+        break;
+    }
+    default:
+        return false;
+    }
+    return true;
+}
+
+bool KernelEmitter::statement(int i) {
+    const Value& v = v_[i];
+    switch (v.op) {
+    case Op::Param: case Op::I32Const: case Op::I64Const: case Op::F64Const:
+    case Op::LocalSet:
+        return true;
+    case Op::Phi: {
+        // loop 的 phi 在進 loop 之前 / back-edge 給值；If 的 merge phi 看走了哪邊
+        if (v.local_index >= 0) return true;
+        int j = i - 1;
+        while (j >= 0 && v_[j].op == Op::Phi) j--;
+        if (j < 0 || v_[j].op != Op::End || v_[j].constValue != 2 || match_[j] < 0 || v.operands.size() != 2)
+            return false;
+        body_ << indent() << ref(i) << " = " << ref(v_[match_[j]].lhs) << " ? " << as(i, v.operands[0]) << " : "
+              << as(i, v.operands[1]) << ";\n";
+        return true;
+    }
+    case Op::Loop: {
+        std::vector<int> phis;
+        if (!loopPhis(i, phis)) return false;
+        for (int p : phis) body_ << indent() << ref(p) << " = " << as(p, v_[p].operands[0]) << ";\n";
+        body_ << indent() << "for (;;) {\n";
+        depth_++;
+        open_.push_back(i);
+        return true;
+    }
+    case Op::Br_if:
+        if (open_.empty()) return false;
+        if (v.constValue == 1) {
+            // cond 為 0 時離開 rhs 那個 loop
+            if (v.rhs == open_.back()) {
+                body_ << indent() << "if (!" << ref(v.lhs) << ") break;\n";
+            } else {
+                if (v.rhs < 0 || std::find(open_.begin(), open_.end(), v.rhs) == open_.end()) return false;
+                exitLabel_[v.rhs] = true;
+                body_ << indent() << "if (!" << ref(v.lhs) << ") goto e" << v.rhs << ";\n";
+            }
+            return true;
+        }
+        // cond 不為 0 時回到 loop 開頭
+        if (v.rhs != open_.back()) return false;
+        body_ << indent() << "if (" << ref(v.lhs) << ") {\n";
+        depth_++;
+        backedge(v.rhs);
+        body_ << indent() << "continue;\n";
+        depth_--;
+        body_ << indent() << "}\n";
+        return true;
+    case Op::Br: {
+        // 跳到 block 結尾的 Br 在 ValueIR 裡沒有作用（跟 bridge 一樣）
+        if (v.lhs < 0) return true;
+        if (open_.empty() || v.lhs != open_.back()) return false;
+        backedge(v.lhs);
+        const bool last = i + 1 < (int)v_.size() && v_[i + 1].op == Op::End && match_[i + 1] == v.lhs;
+        if (!last) body_ << indent() << "continue;\n";
+        return true;
+    }
+    case Op::If:
+        body_ << indent() << "if (" << ref(v.lhs) << ") {\n";
+        depth_++;
+        return true;
+    case Op::Else:
+        if (depth_ <= 1) return false;
+        body_ << std::string(4 * (depth_ - 1), ' ') << "} else {\n";
+        return true;
+    case Op::End:
+        if (v.constValue == 1) return true;
+        if ((v.constValue != 0 && v.constValue != 2) || depth_ <= 1) return false;
+        if (v.constValue == 0) {
+            if (open_.empty() || open_.back() != match_[i]) return false;
+            // 前面不是 back-edge 的 Br 時，走到 End 就是離開 loop
+            if (!(v_[i - 1].op == Op::Br && v_[i - 1].lhs == match_[i])) body_ << indent() << "break;\n";
+            open_.pop_back();
+        }
+        depth_--;
+        body_ << indent() << "}\n";
+        if (v.constValue == 0 && exitLabel_[match_[i]]) body_ << indent() << "e" << match_[i] << ":;\n";
+        return true;
+    case Op::Return:
+        if (v.lhs >= 0 && v_[v.lhs].lanes > 1) return false;
+        if (v.lhs < 0) body_ << indent() << "return;\n";
+        else body_ << indent() << "return (" << kernelParamCType(resultTypeOf(v_[v.lhs])) << ")" << ref(v.lhs) << ";\n";
+        return true;
+    case Op::Load: case Op::F64Load:
+        if (memAccessBytes(v) != typeBytes(memAccessType(v))) return false;
+        body_ << indent() << "memcpy(&" << ref(i) << ", " << addr(v) << ", sizeof " << ref(i) << ");\n";
+        return true;
+    case Op::Store: case Op::F64Store: {
+        if (memAccessBytes(v) != typeBytes(memAccessType(v)) || v_[v.rhs].lanes != v.lanes) return false;
+        body_ << indent() << "{ " << type(v.rhs) << " s = " << ref(v.rhs) << "; memcpy(" << addr(v)
+              << ", &s, sizeof s); }\n";
+        return true;
+    }
+    case Op::Splat: {
+        body_ << indent() << ref(i) << " = (" << type(i) << "){";
+        for (int l = 0; l < v.lanes; l++) body_ << (l ? ", " : "") << ref(v.lhs);
+        body_ << "};\n";
+        return true;
+    }
+    case Op::ExtractLane:
+        body_ << indent() << ref(i) << " = " << ref(v.lhs) << "[" << v.constValue << "];\n";
+        return true;
+    case Op::Pack: {
+        if ((int)v.operands.size() != v.lanes) return false;
+        body_ << indent() << ref(i) << " = (" << type(i) << "){";
+        for (int l = 0; l < v.lanes; l++) body_ << (l ? ", " : "") << ref(v.operands[l]);
+        body_ << "};\n";
+        return true;
+    }
+    case Op::V128Const:
+        body_ << indent() << "memcpy(&" << ref(i) << ", (const uint8_t[16]){";
+        for (int k = 0; k < 16; k++) body_ << (k ? ", " : "") << (int)v.v128[k];
+        body_ << "}, 16);\n";
+        return true;
+    case Op::Bitcast:
+        if (v_[v.lhs].lanes <= 1) return false;
+        body_ << indent() << ref(i) << " = (" << type(i) << ")" << ref(v.lhs) << ";\n";
+        return true;
+    case Op::ReplaceLane:
+        body_ << indent() << ref(i) << " = " << ref(v.lhs) << ";\n";
+        body_ << indent() << ref(i) << "[" << v.constValue << "] = " << ref(v.rhs) << ";\n";
+        return true;
+    case Op::Shuffle:
+        body_ << indent() << ref(i) << " = (" << type(i) << ")W2S_SHUFFLE((w2s_u8x16)" << ref(v.lhs)
+              << ", (w2s_u8x16)" << ref(v.rhs);
+        for (int k = 0; k < 16; k++) body_ << ", " << (int)v.v128[k];
+        body_ << ");\n";
+        return true;
+    case Op::AnyTrue: case Op::AllTrue: {
+        const int lanes = v_[v.lhs].lanes;
+        if (lanes <= 1) return false;
+        body_ << indent() << ref(i) << (v.op == Op::AnyTrue ? " = (uint32_t)((" : " = (uint32_t)(");
+        for (int l = 0; l < lanes; l++) {
+            if (l) body_ << (v.op == Op::AnyTrue ? " | " : " && ");
+            body_ << ref(v.lhs) << "[" << l << "]" << (v.op == Op::AllTrue ? " != 0" : "");
+        }
+        body_ << (v.op == Op::AnyTrue ? ") != 0);\n" : ");\n");
+        return true;
+    }
+    case Op::GlobalGet:
+        body_ << indent() << ref(i) << " = (uint32_t)wasm_global_" << v.globalIndex << ";\n";
+        return true;
+    case Op::GlobalSet:
+        body_ << indent() << "wasm_global_" << v.globalIndex << " = (int32_t)" << ref(v.lhs) << ";\n";
+        return true;
+    case Op::Unreachable:
+        body_ << indent() << "__builtin_trap();\n";
+        return true;
+    default:
+        return v.lanes > 1 ? vectorOp(i) : scalarOp(i);
+    }
+}
+
+bool KernelEmitter::emit(const std::string& cname, const std::string& attrs, std::string& out) {
+    ValueType ret = ValueType::Void;
+    for (const Value& v : v_)
+        if (v.op == Op::Return && v.lhs >= 0) ret = resultTypeOf(v_[v.lhs]);
+
+    std::ostringstream os;
+    if (!attrs.empty()) os << attrs << "\n";
+    os << "static " << kernelParamCType(ret) << " " << cname << "(";
+    std::string sep;
+    if (usesMemoryParam(v_)) {
+        os << "uintptr_t mem";
+        sep = ", ";
+    }
+    for (size_t k = 0; k < f_.paramTypes.size(); k++) {
+        os << sep << kernelParamCType(f_.paramTypes[k]) << " p" << k;
+        sep = ", ";
+    }
+    os << ") {\n";
+    for (int i = 0; i < (int)v_.size(); i++) {
+        const Value& v = v_[i];
+        if (v.op == Op::Param || isConstOp(v.op) || hasSideEffects(v.op)) continue;
+        os << "    " << type(i) << " " << ref(i) << ";\n";
+    }
+    match_ = matchRegions(v_);
+    exitLabel_.assign(v_.size(), false);
+    for (int i = 0; i < (int)v_.size(); i++)
+        if (!statement(i)) return false;
+    if (depth_ != 1 || failed_) return false;
+    os << body_.str() << "}\n";
+    out = os.str();
+    return true;
+}
+
+} // namespace
+
+std::string kernelC(const ModuleFunction& f, const std::string& cname, const std::string& attrs) {
+    std::string out;
+    if (!KernelEmitter(f).emit(cname, attrs, out)) return "";
+    return out;
+}
+
+bool isLaneWiseOp(const ValueIR& values, const Value& v) {
+    switch (v.op) {
+    case Op::Add: case Op::Sub: case Op::Mul:
+    case Op::And: case Op::Or: case Op::Xor:
+    case Op::Shl: case Op::Shr_S: case Op::Shr_U:
+        return v.type == ValueType::I32;
+    // f32 還沒有 vector typedef，留在純量
+    case Op::F64Add: case Op::F64Sub: case Op::F64Mul: case Op::F64Div:
+    case Op::F64Neg: case Op::F64Abs: case Op::F64Sqrt:
+        return v.type != ValueType::F32;
+    case Op::F64ConvertI32S: case Op::F64ConvertI32U:
+        return v.type != ValueType::F32 && values[v.lhs].type == ValueType::I32;
+    // 照 wasm 的 NaN / ±0 規則要逐 lane 呼叫 w2s_fmin，--fast-math 才值得向量化
+    case Op::F64Min: case Op::F64Max:
+        return v.type != ValueType::F32 && v.fast_math;
+    default:
+        return false;
+    }
+}
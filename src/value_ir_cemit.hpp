@@ -0,0 +1,40 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include <string>
+
+// ============================================================
+// ValueIR → C：向量 kernel 直接寫成 C
+// ============================================================
+//
+// dstogov/ir 沒有向量型別，value_ir_vectorize 拆出來的 kernel 不經過
+// bridge，在這裡寫成 GCC / clang 的 vector extension：
+//
+//   typedef double w2s_f64x2 __attribute__((vector_size(16)));
+//   v12 = v10 * v11;          // w2s_f64x2 → mulpd
+//
+// 本身就用 v128 的 wasm 函式（value_ir_vectorize 的 routeSimdFunctions）
+// 也整個從這裡出去，所以控制流比 kernel 需要的多一點：If / Else 與 merge
+// phi、loop 的 phi 只有 {入口, 一個 back-edge}（Br / Br_if 回到最內層的
+// loop）、跳出外層 loop 的 Br_if 用 goto。另外認純運算、i32 / f64 的
+// load / store、Splat / ExtractLane / Pack / Shuffle 等 lane 操作、global、
+// Return；call、除法、memory.* 都不認。
+//
+// 每個節點一個 C 變數 vN，在函式開頭宣告。i32 / i64 用 unsigned（wasm 的
+// 整數運算 wrap，C 的 signed overflow 是 UB），有號的比較 / 移位再轉型。
+// 記憶體存取都是 memcpy：沒有對齊的假設、不違反 strict aliasing，compiler
+// 會變成一般的 mov / movupd。
+
+// vector typedef 與 kernel 共用的小函式，放在所有 kernel 之前（一次）
+std::string kernelPreludeC();
+
+// f 的 C 定義 `static <ret> cname([uintptr_t mem,] p0, ...)`，attrs 放在
+// 最前面（`__attribute__((target("avx2")))`）。有認不得的節點時回傳空字串。
+std::string kernelC(const ModuleFunction& f, const std::string& cname, const std::string& attrs);
+
+// kernel 參數 / 回傳值的 C 型別（跟 bridge 產生的 caller 一致）
+const char* kernelParamCType(ValueType t);
+
+// v 可以 lane-wise 做（lanes > 1 時這裡寫得出來）：i32 的 + - * & | ^ 移位、
+// f64 的 + - * / neg abs sqrt、i32 → f64、標了 fast_math 的 f64 min / max
+bool isLaneWiseOp(const ValueIR& values, const Value& v);
@@ -0,0 +1,598 @@
+#include "value_ir_deps.hpp"
+#include "value_ir_util.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <set>
+
+namespace {
+
+// ============================================================
+// 位址多項式
+// ============================================================
+
+using Monomial = std::vector<std::string>;   // 排序過的 atom；iv 是 "#<loop>"
+using Poly = std::map<Monomial, int64_t>;
+
+constexpr size_t kMaxTerms = 32;
+constexpr size_t kMaxDegree = 4;
+
+void addPoly(Poly& p, const Poly& q, int64_t scale) {
+    for (const auto& [m, c] : q) {
+        int64_t& t = p[m];
+        t += c * scale;
+        if (t == 0) p.erase(m);
+    }
+}
+
+bool mulPoly(const Poly& a, const Poly& b, Poly& out) {
+    out.clear();
+    for (const auto& [ma, ca] : a)
+        for (const auto& [mb, cb] : b) {
+            Monomial m = ma;
+            m.insert(m.end(), mb.begin(), mb.end());
+            if (m.size() > kMaxDegree) return false;
+            std::sort(m.begin(), m.end());
+            int64_t& t = out[m];
+            t += ca * cb;
+            if (t == 0) out.erase(m);
+        }
+    return out.size() <= kMaxTerms;
+}
+
+bool isDivRem(Op op) {
+    return op == Op::Div_S || op == Op::Div_U || op == Op::Rem_S || op == Op::Rem_U;
+}
+
+// 一個存取的位址：包住它的 loop 的 iv 是變數，其他在最外層 loop 外面
+// 就決定的值是 symbol
+class AddressDecomposer {
+public:
+    AddressDecomposer(const ValueIR& values, const std::vector<LoopShape>& loops,
+                      const std::vector<int>& enclosing)
+        : values_(values), loops_(loops), enclosing_(enclosing) {}
+
+    bool poly(int id, Poly& out, int depth) const;
+
+private:
+    bool invariant(int id, int depth) const;
+    std::string key(int id, int depth) const;
+
+    const ValueIR& values_;
+    const std::vector<LoopShape>& loops_;
+    const std::vector<int>& enclosing_;
+};
+
+bool AddressDecomposer::invariant(int id, int depth) const {
+    if (id < 0 || depth > 16) return false;
+    if (enclosing_.empty()) return true;
+    const LoopShape& outer = loops_[enclosing_[0]];
+    if (id < outer.loop || id > outer.end) return true;
+    const Value& v = values_[id];
+    if (v.op == Op::Param || isConstOp(v.op)) return true;
+    if (!(isPureOp(v.op) || isDivRem(v.op)) || v.op == Op::Select) return false;
+    bool ok = true;
+    forEachOperand(v, [&](int ref) { ok = ok && invariant(ref, depth + 1); });
+    return ok;
+}
+
+// 不變量的結構 key：兩個存取各自算出的 `n * 8` 要一樣
+std::string AddressDecomposer::key(int id, int depth) const {
+    const Value& v = values_[id];
+    switch (v.op) {
+    case Op::Param: return "p" + std::to_string(v.paramIndex);
+    case Op::I32Const: case Op::I64Const: return std::to_string(v.constValue);
+    default: break;
+    }
+    if (depth < 8 && (isPureOp(v.op) || isDivRem(v.op)) && v.op != Op::Select &&
+        v.op != Op::F64Const) {
+        std::string k = std::string(opToString(v.op)) + "(";
+        bool first = true;
+        forEachOperand(v, [&](int ref) {
+            k += (first ? "" : ",") + key(ref, depth + 1);
+            first = false;
+        });
+        return k + ")";
+    }
+    return "v" + std::to_string(id);
+}
+
+bool AddressDecomposer::poly(int id, Poly& out, int depth) const {
+    out.clear();
+    if (id < 0 || depth > 32) return false;
+    const Value& v = values_[id];
+    if (v.op == Op::I32Const || v.op == Op::I64Const) {
+        if (v.constValue != 0) out[{}] = v.constValue;
+        return true;
+    }
+    for (int l : enclosing_)
+        if (loops_[l].iv == id) {
+            out[{"#" + std::to_string(l)}] = 1;
+            return true;
+        }
+    Poly a, b;
+    switch (v.op) {
+    case Op::Add: case Op::Sub:
+        if (!poly(v.lhs, a, depth + 1) || !poly(v.rhs, b, depth + 1)) return false;
+        out = a;
+        addPoly(out, b, v.op == Op::Add ? 1 : -1);
+        return out.size() <= kMaxTerms;
+    case Op::Mul:
+        if (!poly(v.lhs, a, depth + 1) || !poly(v.rhs, b, depth + 1)) return false;
+        return mulPoly(a, b, out);
+    case Op::Shl:
+        if (v.rhs >= 0 && values_[v.rhs].op == Op::I32Const &&
+            values_[v.rhs].constValue >= 0 && values_[v.rhs].constValue < 32) {
+            if (!poly(v.lhs, a, depth + 1)) return false;
+            addPoly(out, a, int64_t(1) << values_[v.rhs].constValue);
+            return true;
+        }
+        break;
+    default:
+        break;
+    }
+    if (!invariant(id, 0)) return false;
+    out[{key(id, 0)}] = 1;
+    return true;
+}
+
+int64_t gcd64(int64_t a, int64_t b) {
+    return std::gcd(std::llabs(a), std::llabs(b));
+}
+
+// loop l 的 iv 在 body 裡的範圍 [lo, hi]（含兩端），用 loop 外面決定的
+// atom 表示。只認看得出上下界的 `iv = init; iv < bound; iv += step` 形狀
+bool ivRange(const ValueIR& values, const std::vector<LoopShape>& loops, int l, Poly& lo, Poly& hi) {
+    const LoopShape& s = loops[l];
+    if (!s.simple || !s.hasIV() || s.step == 0) return false;
+    std::vector<int> enclosing;
+    for (int p = l; p >= 0; p = loops[p].parent) enclosing.insert(enclosing.begin(), p);
+    AddressDecomposer dec(values, loops, enclosing);
+    Poly init, bound;
+    if (!dec.poly(values[s.iv].operands[0], init, 0)) return false;
+    if (s.bound >= 0 ? !dec.poly(s.bound, bound, 0) : !s.boundIsConst) return false;
+    if (s.bound < 0 && s.boundConst != 0) bound[{}] = s.boundConst;
+
+    const bool up = s.step > 0;
+    int64_t adjust;   // 繼續條件的 bound 換成最後一輪的 iv
+    switch (s.cmp) {
+    case LoopCmp::LtS: case LoopCmp::LtU: if (!up) return false; adjust = -1; break;
+    case LoopCmp::LeS: case LoopCmp::LeU: if (!up) return false; adjust = 0; break;
+    case LoopCmp::GtS: case LoopCmp::GtU: if (up) return false; adjust = 1; break;
+    case LoopCmp::GeS: case LoopCmp::GeU: if (up) return false; adjust = 0; break;
+    case LoopCmp::Ne:
+        if (s.step != 1 && s.step != -1) return false;
+        adjust = up ? -1 : 1;
+        break;
+    default:
+        return false;
+    }
+    addPoly(bound, Poly{{{}, adjust}}, 1);
+    lo = up ? init : bound;
+    hi = up ? bound : init;
+    return true;
+}
+
+bool isConstPoly(const Poly& p, int64_t& value) {
+    value = 0;
+    for (const auto& [m, c] : p) {
+        if (!m.empty()) return false;
+        value = c;
+    }
+    return true;
+}
+
+std::vector<std::string> splitAtoms(const std::string& symbol) {
+    std::vector<std::string> atoms;
+    size_t begin = 0;
+    while (!symbol.empty()) {
+        size_t star = symbol.find('*', begin);
+        atoms.push_back(symbol.substr(begin, star - begin));
+        if (star == std::string::npos) break;
+        begin = star + 1;
+    }
+    std::sort(atoms.begin(), atoms.end());
+    return atoms;
+}
+
+} // namespace
+
+// ============================================================
+// DependenceAnalysis
+// ============================================================
+
+DependenceAnalysis::DependenceAnalysis(const ValueIR& values, const std::vector<LoopShape>& loops,
+                                       const AliasAnalysis& aa)
+    : values_(values), loops_(loops), aa_(aa) {
+    for (int i = 0; i < (int)values.size(); i++) {
+        const Value& v = values[i];
+        if (!isMemoryRead(v.op) && v.op != Op::Store && v.op != Op::F64Store) continue;
+        AffineAccess a;
+        a.node = i;
+        a.write = !isMemoryRead(v.op);
+        a.size = memAccessBytes(v);
+        for (int l = 0; l < (int)loops.size(); l++)
+            if (loops[l].loop < i && i < loops[l].end) a.loops.push_back(l);
+
+        AddressDecomposer dec(values, loops, a.loops);
+        Poly p;
+        a.affine = dec.poly(v.lhs, p, 0);
+        if (a.affine) {
+            addPoly(p, Poly{{{}, (int64_t)(uint32_t)v.mem_offset}}, 1);
+            for (const auto& [m, c] : p) {
+                int loop = -1;
+                std::string symbol;
+                for (const std::string& atom : m) {
+                    if (atom[0] == '#') {
+                        if (loop >= 0) a.affine = false;   // 兩個 iv 相乘
+                        loop = std::atoi(atom.c_str() + 1);
+                    } else {
+                        symbol += (symbol.empty() ? "" : "*") + atom;
+                    }
+                }
+                a.terms[{loop, symbol}] += c;
+            }
+            if (!a.affine) a.terms.clear();
+        }
+        byNode_[i] = accesses_.size();
+        accesses_.push_back(std::move(a));
+    }
+}
+
+const AffineAccess* DependenceAnalysis::access(int node) const {
+    auto it = byNode_.find(node);
+    return it == byNode_.end() ? nullptr : &accesses_[it->second];
+}
+
+bool DependenceAnalysis::test(const AffineAccess& a, const AffineAccess& b, Dependence& out) const {
+    std::vector<int> common;
+    for (size_t k = 0; k < a.loops.size() && k < b.loops.size() && a.loops[k] == b.loops[k]; k++)
+        common.push_back(a.loops[k]);
+    const size_t n = common.size();
+    std::vector<int64_t> delta(n, kUnknownDistance);
+
+    if (a.affine && b.affine) {
+        // 跟 iv 相乘過的 symbol 是一個維度；其他 symbol 是固定的位移（base 指標…）
+        std::set<std::string> dims;
+        for (const auto* acc : {&a, &b})
+            for (const auto& [t, c] : acc->terms)
+                if (t.first >= 0) dims.insert(t.second);
+        struct Group {
+            std::map<int, std::pair<int64_t, int64_t>> coef;   // loop → (a 的係數, b 的係數)
+            int64_t ka = 0, kb = 0;
+        };
+        std::map<std::string, Group> groups;
+        groups[""];
+        std::map<std::string, int64_t> offA, offB;
+        for (int side = 0; side < 2; side++) {
+            const AffineAccess& acc = side == 0 ? a : b;
+            for (const auto& [t, c] : acc.terms) {
+                auto& [loop, symbol] = t;
+                if (loop >= 0) {
+                    auto& pc = groups[symbol].coef[loop];
+                    (side == 0 ? pc.first : pc.second) += c;
+                } else if (symbol.empty() || dims.count(symbol)) {
+                    (side == 0 ? groups[symbol].ka : groups[symbol].kb) += c;
+                } else {
+                    (side == 0 ? offA : offB)[symbol] += c;
+                }
+            }
+        }
+
+        // delinearization 的假設要證得出來：維度從 "" 開始一次多乘一個 atom
+        // （"" → "p2" → "p1*p2"），第 j 維的下標（用 iv 的上下界算）落在
+        // [0, u·X)，X 是下一維多乘的 atom、u 是更高維所有係數的 gcd。
+        // 證不出來就不拆維度：符號的 stride 沒辦法線性地解，距離全部不確定
+        auto delinearizable = [&]() {
+            std::vector<std::string> chain{""};
+            std::vector<std::string> next;   // chain[j + 1] 比 chain[j] 多乘的 atom
+            std::vector<std::string> order(dims.begin(), dims.end());
+            order.erase(std::remove(order.begin(), order.end(), std::string()), order.end());
+            std::sort(order.begin(), order.end(), [](const std::string& x, const std::string& y) {
+                return splitAtoms(x).size() < splitAtoms(y).size();
+            });
+            for (const std::string& d : order) {
+                std::vector<std::string> lower = splitAtoms(chain.back()), upper = splitAtoms(d);
+                if (upper.size() != lower.size() + 1 ||
+                    !std::includes(upper.begin(), upper.end(), lower.begin(), lower.end()))
+                    return false;
+                std::vector<std::string> extra;
+                std::set_difference(upper.begin(), upper.end(), lower.begin(), lower.end(),
+                                    std::back_inserter(extra));
+                next.push_back(extra[0]);
+                chain.push_back(d);
+            }
+            for (size_t j = 0; j + 1 < chain.size(); j++) {
+                int64_t u = 0;
+                for (size_t k = j + 1; k < chain.size(); k++) {
+                    const Group& g = groups[chain[k]];
+                    u = gcd64(gcd64(u, g.ka), g.kb);
+                    for (const auto& [loop, c] : g.coef) u = gcd64(gcd64(u, c.first), c.second);
+                }
+                if (u == 0) return false;
+                const Group& g = groups[chain[j]];
+                for (int side = 0; side < 2; side++) {
+                    const int64_t k = side == 0 ? g.ka : g.kb;
+                    Poly lo{{{}, k}}, hi{{{}, k}};
+                    for (const auto& [loop, c] : g.coef) {
+                        const int64_t cc = side == 0 ? c.first : c.second;
+                        if (cc == 0) continue;
+                        Poly ivLo, ivHi;
+                        if (!ivRange(values_, loops_, loop, ivLo, ivHi)) return false;
+                        addPoly(lo, cc > 0 ? ivLo : ivHi, cc);
+                        addPoly(hi, cc > 0 ? ivHi : ivLo, cc);
+                    }
+                    Poly room{{{next[j]}, u}, {{}, -1}};   // u·X − 1 − hi >= 0
+                    addPoly(room, hi, -1);
+                    int64_t low, slack;
+                    if (!isConstPoly(lo, low) || low < 0 || !isConstPoly(room, slack) || slack < 0)
+                        return false;
+                }
+            }
+            return true;
+        };
+        if (!delinearizable()) groups.clear();
+
+        std::vector<char> fixed(n, 0);
+        auto commonPos = [&](int loop) {
+            auto it = std::find(common.begin(), common.end(), loop);
+            return it == common.end() ? -1 : int(it - common.begin());
+        };
+        for (const auto& [symbol, g] : groups) {
+            const bool isConst = symbol.empty();
+            // 常數那一維：寬度相同、都對齊時「重疊」就是「位址相等」
+            bool aligned = a.size == b.size && a.size > 0 && (g.ka - g.kb) % a.size == 0;
+            bool free = isConst && offA != offB;
+            std::vector<std::pair<int, int64_t>> vars;   // (common 的位置, 係數)
+            for (const auto& [loop, c] : g.coef) {
+                if (c.first == 0 && c.second == 0) continue;
+                if (isConst && (c.first % std::max(a.size, 1) || c.second % std::max(a.size, 1)))
+                    aligned = false;
+                int pos = commonPos(loop);
+                if (pos < 0 || c.first != c.second) free = true;
+                else vars.push_back({pos, c.first});
+            }
+            if (free) continue;
+            const int64_t rhs = g.ka - g.kb;   // Σ c·(iv_b − iv_a) = ka − kb
+            if (isConst && !aligned) {
+                if (vars.empty() && !(g.ka < g.kb + b.size && g.kb < g.ka + a.size)) return false;
+                continue;
+            }
+            if (vars.empty()) {
+                if (rhs != 0) return false;
+            } else if (vars.size() == 1) {
+                auto [pos, c] = vars[0];
+                if (rhs % c != 0) return false;
+                if (fixed[pos] && delta[pos] != rhs / c) return false;
+                fixed[pos] = 1;
+                delta[pos] = rhs / c;
+            } else {
+                int64_t g2 = 0;
+                for (auto& var : vars) g2 = gcd64(g2, var.second);
+                if (rhs % g2 != 0) return false;
+            }
+        }
+        // iv 的差換成迭代數
+        for (size_t k = 0; k < n; k++) {
+            if (!fixed[k]) continue;
+            int64_t step = loops_[common[k]].step;
+            if (step == 0 || delta[k] % step != 0) return false;
+            delta[k] /= step;
+        }
+    }
+
+    bool allZero = std::all_of(delta.begin(), delta.end(), [](int64_t d) { return d == 0; });
+    if (a.node == b.node && allZero) return false;   // 同一輪迭代的自己
+
+    // 先執行的當 src：第一個確定不是 0 的距離是負的就反過來
+    bool swap = false;
+    for (int64_t d : delta) {
+        if (d == kUnknownDistance) break;
+        if (d != 0) {
+            swap = d < 0;
+            break;
+        }
+    }
+    if (allZero) swap = a.node > b.node;
+    if (swap)
+        for (auto& d : delta)
+            if (d != kUnknownDistance) d = -d;
+    const AffineAccess& src = swap ? b : a;
+    const AffineAccess& dst = swap ? a : b;
+    out.src = src.node;
+    out.dst = dst.node;
+    out.kind = src.write ? (dst.write ? Dependence::Output : Dependence::Flow) : Dependence::Anti;
+    out.loops = common;
+    out.distance = delta;
+    return true;
+}
+
+std::vector<Dependence> DependenceAnalysis::dependences(int begin, int end) const {
+    std::vector<const AffineAccess*> in;
+    for (const auto& a : accesses_)
+        if (a.node >= begin && a.node <= end) in.push_back(&a);
+    std::vector<Dependence> deps;
+    for (size_t i = 0; i < in.size(); i++)
+        for (size_t j = i; j < in.size(); j++) {
+            const AffineAccess& a = *in[i];
+            const AffineAccess& b = *in[j];
+            if (!a.write && !b.write) continue;
+            if (i != j && !aa_.mayAlias(a.node, b.node)) continue;
+            Dependence d;
+            if (test(a, b, d)) deps.push_back(std::move(d));
+        }
+    return deps;
+}
+
+AffineAccess renameLoop(const AffineAccess& a, int from, int to) {
+    AffineAccess r = a;
+    for (int& l : r.loops)
+        if (l == from) l = to;
+    r.terms.clear();
+    for (const auto& [t, c] : a.terms) r.terms[{t.first == from ? to : t.first, t.second}] += c;
+    return r;
+}
+
+// ============================================================
+// 方向向量
+// ============================================================
+
+std::vector<std::vector<int>> directionVectors(const Dependence& d) {
+    std::vector<std::vector<int>> choices;
+    for (int64_t x : d.distance) {
+        if (x == kUnknownDistance) choices.push_back({-1, 0, 1});
+        else choices.push_back({x < 0 ? -1 : (x > 0 ? 1 : 0)});
+    }
+    std::set<std::vector<int>> result;
+    std::vector<int> v(choices.size());
+    std::function<void(size_t)> walk = [&](size_t k) {
+        if (k == choices.size()) {
+            auto nz = std::find_if(v.begin(), v.end(), [](int s) { return s != 0; });
+            if (nz == v.end()) return;
+            std::vector<int> w = v;
+            if (*nz < 0)
+                for (int& s : w) s = -s;
+            result.insert(w);
+            return;
+        }
+        for (int s : choices[k]) {
+            v[k] = s;
+            walk(k + 1);
+        }
+    };
+    walk(0);
+    return {result.begin(), result.end()};
+}
+
+namespace {
+
+// band 在 d.loops 裡的位置；band 有一層不是共同的 loop 時回傳空的
+std::vector<int> bandPositions(const Dependence& d, const std::vector<int>& band) {
+    std::vector<int> pos;
+    for (int l : band) {
+        auto it = std::find(d.loops.begin(), d.loops.end(), l);
+        if (it == d.loops.end()) return {};
+        pos.push_back(int(it - d.loops.begin()));
+    }
+    return pos;
+}
+
+bool carriedOutside(const std::vector<int>& v, int bandStart) {
+    for (int k = 0; k < bandStart; k++)
+        if (v[k] != 0) return true;
+    return false;
+}
+
+} // namespace
+
+bool permutationPreservesDependences(const std::vector<Dependence>& deps,
+                                     const std::vector<int>& band,
+                                     const std::vector<int>& order) {
+    for (const Dependence& d : deps) {
+        std::vector<int> pos = bandPositions(d, band);
+        if (pos.empty()) return false;
+        for (const auto& v : directionVectors(d)) {
+            if (carriedOutside(v, pos[0])) continue;
+            std::vector<int> w = v;
+            for (size_t k = 0; k < pos.size(); k++) w[pos[k]] = v[pos[order[k]]];
+            auto nz = std::find_if(w.begin(), w.end(), [](int s) { return s != 0; });
+            if (nz != w.end() && *nz < 0) return false;
+        }
+    }
+    return true;
+}
+
+bool bandFullyPermutable(const std::vector<Dependence>& deps, const std::vector<int>& band) {
+    for (const Dependence& d : deps) {
+        std::vector<int> pos = bandPositions(d, band);
+        if (pos.empty()) return false;
+        for (const auto& v : directionVectors(d)) {
+            if (carriedOutside(v, pos[0])) continue;
+            for (int p : pos)
+                if (v[p] < 0) return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================
+// 輸出
+// ============================================================
+
+namespace {
+
+std::string termsToString(const AffineAccess& a) {
+    std::string out;
+    for (const auto& [t, c] : a.terms) {
+        std::string factors = t.second;
+        if (t.first >= 0) factors += (factors.empty() ? "L" : "*L") + std::to_string(t.first);
+        std::string term;
+        if (factors.empty()) term = std::to_string(c);
+        else if (c == 1) term = factors;
+        else if (c == -1) term = "-" + factors;
+        else term = std::to_string(c) + "*" + factors;
+        if (!out.empty()) out += term[0] == '-' ? " - " + term.substr(1) : " + " + term;
+        else out = term;
+    }
+    return out.empty() ? "0" : out;
+}
+
+const char* kindName(Dependence::Kind k) {
+    switch (k) {
+    case Dependence::Flow: return "flow";
+    case Dependence::Anti: return "anti";
+    case Dependence::Output: return "output";
+    }
+    return "?";
+}
+
+} // namespace
+
+void dumpDependences(const ValueIR& values, const std::vector<LoopShape>& loops,
+                     const DependenceAnalysis& deps) {
+    for (size_t l = 0; l < loops.size(); l++) {
+        const LoopShape& s = loops[l];
+        std::cout << "// L" << l << " = v" << s.loop;
+        if (s.parent >= 0) std::cout << " in L" << s.parent;
+        if (s.hasIV()) std::cout << ", iv v" << s.iv << " step " << s.step;
+        else std::cout << ", no iv";
+        std::cout << "\n";
+    }
+    for (const AffineAccess& a : deps.accesses()) {
+        std::cout << "v" << a.node << " = " << opToString(values[a.node].op) << "  ["
+                  << (a.affine ? termsToString(a) : "non-affine") << ", " << a.size << "B";
+        if (!a.loops.empty()) {
+            std::cout << ", in";
+            for (int l : a.loops) std::cout << " L" << l;
+        }
+        std::cout << "]\n";
+    }
+    if (deps.accesses().empty()) return;
+    for (const Dependence& d : deps.dependences(0, (int)values.size() - 1)) {
+        std::cout << kindName(d.kind) << " v" << d.src << " -> v" << d.dst;
+        if (d.loops.empty()) {
+            std::cout << "  (no common loop)\n";
+            continue;
+        }
+        std::cout << "  loops (";
+        for (size_t k = 0; k < d.loops.size(); k++) std::cout << (k ? ", L" : "L") << d.loops[k];
+        std::cout << ")  distance (";
+        for (size_t k = 0; k < d.distance.size(); k++) {
+            if (k) std::cout << ", ";
+            if (d.distance[k] == kUnknownDistance) std::cout << "*";
+            else std::cout << d.distance[k];
+        }
+        std::cout << ")  direction";
+        auto dirs = directionVectors(d);
+        if (dirs.empty()) std::cout << " (loop-independent)";
+        for (const auto& v : dirs) {
+            std::cout << " (";
+            for (size_t k = 0; k < v.size(); k++)
+                std::cout << (k ? ", " : "") << (v[k] > 0 ? "<" : v[k] < 0 ? ">" : "=");
+            std::cout << ")";
+        }
+        std::cout << "\n";
+    }
+}
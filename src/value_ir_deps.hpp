@@ -0,0 +1,95 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+#include "value_ir_loops.hpp"
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================
+// Dependence analysis：loop nest 裡記憶體存取之間的相依
+// ============================================================
+//
+// 每個 load/store 的位址拆成包住它的 loop 的 induction variable 的多項式
+//
+//     addr = Σ coef · iv_l · symbol + Σ coef · symbol + const
+//
+// symbol 是 loop 不變量的乘積（參數 nk、loop 外面算好的指標……），
+// `A[i*nk + k]`（double）就是 8·nk·i + 8·k + A。
+//
+// 兩個存取的相依用 delinearization 求解：跟 iv 相乘的 symbol（nk）是
+// 一個陣列維度，每個維度的下標各自相等。這要下標不越出自己那一維：
+// 從 iv 的上下界（LoopShape 的 init / bound）證得出 `0 <= k < nk` 才拆，
+// 證不出來（bound 不是那個 symbol、負的位移……）距離一律當成不確定。
+// 每一維是一條一次方程式：只有一個 iv 時解出距離，多個 iv 用 GCD 判斷
+// 有沒有解。兩個存取碰不碰到同一個陣列交給 AliasAnalysis。
+
+struct AffineAccess {
+    int node = -1;
+    bool write = false;
+    int size = 0;
+    std::vector<int> loops;   // 包住它的 loop（findLoops 的 index），外 → 內
+    bool affine = false;
+    // (loop, symbol) → 係數。loop = -1 是不含 iv 的項；symbol "" 是 1，
+    // 多個不變量相乘用 '*' 接起來（"p2*p3"）
+    std::map<std::pair<int, std::string>, int64_t> terms;
+};
+
+constexpr int64_t kUnknownDistance = INT64_MIN;
+
+struct Dependence {
+    enum Kind { Flow, Anti, Output };   // store→load / load→store / store→store
+    Kind kind = Flow;
+    int src = -1, dst = -1;             // 存取節點；src 先執行（距離不確定時是程式順序）
+    std::vector<int> loops;             // 共同的 loop，外 → 內
+    std::vector<int64_t> distance;      // dst 的迭代 − src 的迭代；kUnknownDistance = 不確定
+};
+
+class DependenceAnalysis {
+public:
+    DependenceAnalysis(const ValueIR& values, const std::vector<LoopShape>& loops,
+                       const AliasAnalysis& aa);
+
+    const std::vector<AffineAccess>& accesses() const { return accesses_; }
+    const AffineAccess* access(int node) const;
+
+    // 節點範圍 [begin, end] 裡的存取之間所有可能的相依（至少一邊是 store）
+    std::vector<Dependence> dependences(int begin, int end) const;
+    // a、b 之間有沒有相依；有的話填 out
+    bool test(const AffineAccess& a, const AffineAccess& b, Dependence& out) const;
+
+private:
+    const ValueIR& values_;
+    const std::vector<LoopShape>& loops_;
+    const AliasAnalysis& aa_;
+    std::vector<AffineAccess> accesses_;
+    std::map<int, size_t> byNode_;
+};
+
+// a 的 loop from 換成 to。兩個並排、範圍一樣的 loop 裡的存取可以當成同一個
+// loop 交給 test 比較；各自裡面的 loop 不算共同的 loop。
+AffineAccess renameLoop(const AffineAccess& a, int from, int to);
+
+// d 可能的方向向量（每層 -1 / 0 / +1），換成 lexicographically 正的
+// （先執行的一邊當 src）。同一輪迭代裡的相依（全 0）不列。
+std::vector<std::vector<int>> directionVectors(const Dependence& d);
+
+// band 是一段連續的巢狀 loop（findLoops 的 index，外 → 內），deps 都在
+// band 最內層的 body 裡。band 外面的 loop 已經決定先後的相依不受影響。
+//
+// band 照 order 重排（新的第 k 層是原本的第 order[k] 層）之後每個相依
+// 的方向還是正的：loop interchange 的合法條件。
+bool permutationPreservesDependences(const std::vector<Dependence>& deps,
+                                     const std::vector<int>& band,
+                                     const std::vector<int>& order);
+// band 裡每一層的方向都 >= 0（fully permutable）：tiling 的合法條件
+bool bandFullyPermutable(const std::vector<Dependence>& deps, const std::vector<int>& band);
+
+// --print-after=deps：每個存取的 affine 位址（iv 寫成 L<loop>）與相依的
+// 距離 / 方向向量
+void dumpDependences(const ValueIR& values, const std::vector<LoopShape>& loops,
+                     const DependenceAnalysis& deps);
@@ -4,6 +4,9 @@
 void dumpValueIR(const ValueIR& values) {
     for (auto& v : values) {
         std::cout << "v" << v.id << " = " << opToString(v.op);
+        if (v.lanes > 1) std::cout << "<" << v.lanes << ">";
+        if (v.type == ValueType::F32) std::cout << ".f32";   // 共用 F64* op 的單精度
+        if (v.fast_math) std::cout << ".fast";
 
         switch (v.op) {
         case Op::Param:
@@ -108,6 +111,8 @@ void dumpValueIR(const ValueIR& values) {
         case Op::I32TruncF64U:
         case Op::I64TruncF64S:
         case Op::I64TruncF64U:
+        case Op::F32DemoteF64:
+        case Op::F64PromoteF32:
         case Op::I32WrapI64:
         case Op::I64ExtendI32S:
         case Op::I64ExtendI32U:
@@ -120,6 +125,7 @@ void dumpValueIR(const ValueIR& values) {
         case Op::Else:
             break;
         case Op::Loop:
+            if (v.doall) std::cout << "(doall)";
             break;
         case Op::End:
             if (v.constValue == 0) std::cout << "(loop)";
@@ -127,6 +133,14 @@ void dumpValueIR(const ValueIR& values) {
             else if (v.constValue == 2) std::cout << "(if)";
             break;
 
+        case Op::F64Fma:
+            // a * b + c
+            if (v.operands.size() == 3) {
+                std::cout << "(v" << v.operands[0] << ", v"
+                         << v.operands[1] << ", v" << v.operands[2] << ")";
+            }
+            break;
+
         case Op::Select:
             // Select(condition, false_val, true_val)
             if (v.operands.size() >= 3) {
@@ -182,6 +196,7 @@ void dumpValueIR(const ValueIR& values) {
         // ---- Call：原本完全沒印被呼叫函式與參數，補上 ----
         case Op::Call:
             std::cout << "(callee=" << v.callee_name << ", args=(";
+            if (v.pass_memory) std::cout << "__mem" << (v.operands.empty() ? "" : ", ");
             for (size_t i = 0; i < v.operands.size(); i++) {
                 if (i > 0) std::cout << ", ";
                 std::cout << "v" << v.operands[i];
@@ -196,6 +211,34 @@ void dumpValueIR(const ValueIR& values) {
         case Op::Unreachable:
             break;
 
+        case Op::Splat:
+            std::cout << "(v" << v.lhs << ")";
+            break;
+        case Op::ExtractLane:
+            std::cout << "(v" << v.lhs << ", lane=" << v.constValue << ")";
+            break;
+        case Op::Pack:
+            std::cout << "(";
+            for (size_t i = 0; i < v.operands.size(); i++)
+                std::cout << (i > 0 ? ", " : "") << "v" << v.operands[i];
+            std::cout << ")";
+            break;
+        case Op::V128Const:
+        case Op::Shuffle:
+            std::cout << "(";
+            if (v.op == Op::Shuffle) std::cout << "v" << v.lhs << ", v" << v.rhs << ", ";
+            for (int i = 0; i < 16; i++) std::cout << (i > 0 ? " " : "") << (int)v.v128[i];
+            std::cout << ")";
+            break;
+        case Op::Bitcast:
+        case Op::AnyTrue:
+        case Op::AllTrue:
+            std::cout << "(v" << v.lhs << ")";
+            break;
+        case Op::ReplaceLane:
+            std::cout << "(v" << v.lhs << ", lane=" << v.constValue << ", v" << v.rhs << ")";
+            break;
+
         // ---- memory bulk 操作：原本完全沒印，補上 ----
         case Op::MemorySize:
             break;
@@ -1,24 +1,390 @@
 #include "value_ir_eval.hpp"
+#include "value_ir_util.hpp"
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
-int evalValueIR(const ValueIR& ir, const std::vector<int>& params) {
-    std::vector<int> vals(ir.size(), 0);
-    for (auto& v : ir) {
-        switch (v.op) {
-        case Op::Param:
-            vals[v.id] = params.at(v.paramIndex);
+namespace {
+
+// 每個函式的結構資訊，遞迴呼叫時重複用
+struct Layout {
+    std::vector<int> match;     // matchRegions
+    std::vector<int> elsePos;   // If → Else（沒有 else 為 -1）
+    std::vector<int> owner;     // Phi → 所屬 Loop / If
+    bool ok = true;
+};
+
+Layout buildLayout(const ValueIR& values) {
+    Layout L;
+    const int n = (int)values.size();
+    L.match = matchRegions(values);
+    L.elsePos.assign(n, -1);
+    L.owner.assign(n, -1);
+    for (int k = 0; k < n; k++) {
+        const Value& v = values[k];
+        if (v.op == Op::Else) {
+            if (L.match[k] < 0) L.ok = false;
+            else L.elsePos[L.match[k]] = k;
+        } else if ((v.op == Op::Loop || v.op == Op::If) && L.match[k] < 0) {
+            L.ok = false;
+        } else if (v.op == Op::Phi) {
+            int j = k - 1;
+            if (v.local_index >= 0) {
+                while (j >= 0 && values[j].op != Op::Loop) j--;
+                L.owner[k] = j;
+            } else {
+                while (j >= 0 && values[j].op == Op::Phi) j--;
+                if (j >= 0 && values[j].op == Op::End && values[j].constValue == 2)
+                    L.owner[k] = L.match[j];
+            }
+            if (L.owner[k] < 0) L.ok = false;
+        }
+    }
+    return L;
+}
+
+int64_t wrap32(int64_t x) { return (int64_t)(int32_t)(uint32_t)(uint64_t)x; }
+
+class Evaluator {
+public:
+    Evaluator(const std::vector<ModuleFunction>& funcs, const EvalOptions& opts)
+        : funcs_(funcs), opts_(opts), layouts_(funcs.size()) {
+        for (int i = 0; i < (int)funcs.size(); i++) byName_[funcs[i].name] = i;
+    }
+
+    EvalResult run(int f, const std::vector<EvalValue>& args, int depth) {
+        EvalResult res;
+        if (depth > opts_.maxCallDepth) { res.status = EvalStatus::StepLimit; return res; }
+        const ValueIR& ir = funcs_[f].values;
+        if (!layouts_[f]) layouts_[f].reset(new Layout(buildLayout(ir)));
+        const Layout& L = *layouts_[f];
+        if (!L.ok || args.size() != funcs_[f].numParams) return res;
+        // Param 節點的 type 沒填（一律 I32），寬度只能看 signature
+        const auto& ptypes = funcs_[f].paramTypes;
+        if (!ptypes.empty() && ptypes.size() != args.size()) return res;
+
+        const int n = (int)ir.size();
+        std::vector<EvalValue> v(n);
+        std::vector<char> taken(n, 0);
+        // back-edge 時算好、下一輪 phi 要取的值（loop → (phi, 值)）
+        std::unordered_map<int, std::vector<std::pair<int, EvalValue>>> pending;
+
+        auto backedge = [&](int loop) {
+            auto& upd = pending[loop];
+            upd.clear();
+            for (int k = loop + 1; k < n; k++) {
+                if (ir[k].op == Op::Phi && L.owner[k] == loop)
+                    upd.push_back({k, ir[k].operands.size() >= 2 ? v[ir[k].operands[1]] : v[k]});
+                if (ir[k].op == Op::End && L.match[k] == loop) break;
+            }
+            return loop + 1;
+        };
+
+        int pc = 0;
+        while (pc < n) {
+            if (++steps_ > opts_.maxSteps) { res.status = EvalStatus::StepLimit; return res; }
+            const Value& x = ir[pc];
+            EvalValue r;
+            switch (x.op) {
+            case Op::Param:
+                if (x.paramIndex < 0 || x.paramIndex >= (int)args.size()) return res;
+                r = args[x.paramIndex];
+                r.wide = !ptypes.empty() && ptypes[x.paramIndex] == ValueType::I64;
+                if (!r.wide) r.i = wrap32(r.i);
+                break;
+            case Op::I32Const: r.i = x.constValue; break;
+            case Op::I64Const: r.i = x.constValue; r.wide = true; break;
+            case Op::F64Const: r.d = x.fconst; break;
+            case Op::Call: {
+                auto it = byName_.find(x.callee_name);
+                if (it == byName_.end()) return res;   // import
+                std::vector<EvalValue> a;
+                for (int o : x.operands) a.push_back(v[o]);
+                EvalResult sub = run(it->second, a, depth + 1);
+                if (sub.status != EvalStatus::Ok) return sub;
+                r = sub.value;
+                break;
+            }
+            case Op::Loop: pending.erase(pc); break;
+            case Op::Phi:
+                if (x.local_index >= 0) {
+                    // 入口值從 ir_VAR 讀的 phi 跟外層 loop 的 carry 綁在一起，不模擬
+                    if (x.use_vload_entry) return res;
+                    bool found = false;
+                    auto pit = pending.find(L.owner[pc]);
+                    if (pit != pending.end())
+                        for (const auto& [id, val] : pit->second)
+                            if (id == pc) { r = val; found = true; }
+                    if (!found) r = v[x.operands[0]];
+                } else {
+                    size_t k = taken[L.owner[pc]] ? 0 : 1;
+                    if (k >= x.operands.size()) return res;
+                    r = v[x.operands[k]];
+                }
+                break;
+            case Op::If:
+                taken[pc] = (int32_t)v[x.lhs].i != 0;
+                if (!taken[pc]) {
+                    pc = (L.elsePos[pc] >= 0 ? L.elsePos[pc] : L.match[pc]) + 1;
+                    continue;
+                }
+                break;
+            case Op::Else: pc = L.match[L.match[pc]] + 1; continue;
+            case Op::End: break;
+            case Op::Br_if:
+                if (x.constValue == 1) {
+                    if ((int32_t)v[x.lhs].i == 0) { pc = L.match[x.rhs] + 1; continue; }
+                } else if ((int32_t)v[x.lhs].i != 0) {
+                    pc = backedge(x.rhs);
+                    continue;
+                }
+                break;
+            case Op::Br:
+                if (x.lhs >= 0) { pc = backedge(x.lhs); continue; }
+                break;
+            case Op::Return:
+                res.status = EvalStatus::Ok;
+                if (x.lhs >= 0) res.value = v[x.lhs];
+                return res;
+            case Op::LocalSet: break;   // 值已經在 SSA 裡，只有 use_vload_entry 會讀 ir_VAR
+            case Op::LocalTee: r = v[x.lhs]; break;
+            case Op::Unreachable: res.status = EvalStatus::Trap; return res;
+            default: {
+                EvalStatus st = compute(x, v, r);
+                if (st != EvalStatus::Ok) { res.status = st; return res; }
+                break;
+            }
+            }
+            v[pc] = r;
+            pc++;
+        }
+        res.status = EvalStatus::Ok;   // 沒有 Return：void
+        return res;
+    }
+
+private:
+    // 純運算（含會 trap 的除法 / trunc）
+    static EvalStatus compute(const Value& x, const std::vector<EvalValue>& v, EvalValue& r) {
+        const bool wide = x.type == ValueType::I64;
+        auto I = [&](uint64_t val) { r.i = wide ? (int64_t)val : wrap32((int64_t)val); };
+        const EvalValue a = x.lhs >= 0 ? v[x.lhs] : EvalValue{};
+        const EvalValue b = x.rhs >= 0 ? v[x.rhs] : EvalValue{};
+        // 比較的寬度跟著 operand 的值走（結果永遠是 i32）；Param / Phi 節點的
+        // type 不可靠，兩邊寬度對不上就當成不知道
+        const bool wideArgs = a.wide;
+        if (x.rhs >= 0 && b.wide != a.wide && x.op != Op::Select) return EvalStatus::NotConstant;
+        const int64_t sa = wideArgs ? a.i : wrap32(a.i), sb = wideArgs ? b.i : wrap32(b.i);
+        const uint64_t ua = wideArgs ? (uint64_t)a.i : (uint32_t)a.i;
+        const uint64_t ub = wideArgs ? (uint64_t)b.i : (uint32_t)b.i;
+        const uint64_t xa = wide ? (uint64_t)a.i : (uint32_t)a.i;
+        const uint64_t xb = wide ? (uint64_t)b.i : (uint32_t)b.i;
+        const unsigned bits = wide ? 64 : 32;
+        const unsigned sh = (unsigned)(xb & (bits - 1));
+        const int64_t smin = wide ? std::numeric_limits<int64_t>::min() : INT32_MIN;
+
+        switch (x.op) {
+        case Op::Add: I((uint64_t)a.i + (uint64_t)b.i); break;
+        case Op::Sub: I((uint64_t)a.i - (uint64_t)b.i); break;
+        case Op::Mul: I((uint64_t)a.i * (uint64_t)b.i); break;
+        case Op::Div_S: {
+            int64_t p = wide ? a.i : wrap32(a.i), q = wide ? b.i : wrap32(b.i);
+            if (q == 0 || (p == smin && q == -1)) return EvalStatus::Trap;
+            I((uint64_t)(p / q));
+            break;
+        }
+        case Op::Rem_S: {
+            int64_t p = wide ? a.i : wrap32(a.i), q = wide ? b.i : wrap32(b.i);
+            if (q == 0) return EvalStatus::Trap;
+            I(q == -1 ? 0 : (uint64_t)(p % q));
             break;
-        case Op::I32Const:
-            vals[v.id] = v.constValue;
+        }
+        case Op::Div_U: if (xb == 0) return EvalStatus::Trap; I(xa / xb); break;
+        case Op::Rem_U: if (xb == 0) return EvalStatus::Trap; I(xa % xb); break;
+        case Op::And: I((uint64_t)(a.i & b.i)); break;
+        case Op::Or:  I((uint64_t)(a.i | b.i)); break;
+        case Op::Xor: I((uint64_t)(a.i ^ b.i)); break;
+        case Op::Shl: I(xa << sh); break;
+        case Op::Shr_U: I(xa >> sh); break;
+        case Op::Shr_S: I((uint64_t)((wide ? a.i : wrap32(a.i)) >> sh)); break;
+        case Op::Rotl: I(sh ? (xa << sh) | (xa >> (bits - sh)) : xa); break;
+        case Op::Rotr: I(sh ? (xa >> sh) | (xa << (bits - sh)) : xa); break;
+        case Op::Clz: {
+            unsigned c = 0;
+            for (int k = (int)bits - 1; k >= 0 && !((xa >> k) & 1); k--) c++;
+            I(c);
             break;
-        case Op::Add:
-            vals[v.id] = vals[v.lhs] + vals[v.rhs];
+        }
+        case Op::Ctz: {
+            unsigned c = 0;
+            for (unsigned k = 0; k < bits && !((xa >> k) & 1); k++) c++;
+            I(c);
             break;
-        case Op::Return:
-            return vals[v.lhs];
-        default:
+        }
+        case Op::Popcnt: {
+            unsigned c = 0;
+            for (uint64_t t = xa; t; t &= t - 1) c++;
+            I(c);
+            break;
+        }
+        case Op::Eq:   r.i = sa == sb; break;
+        case Op::Ne:   r.i = sa != sb; break;
+        case Op::Lt_S: r.i = sa < sb; break;
+        case Op::Gt_S: r.i = sa > sb; break;
+        case Op::Le_S: r.i = sa <= sb; break;
+        case Op::Ge_S: r.i = sa >= sb; break;
+        case Op::Lt_U: r.i = ua < ub; break;
+        case Op::Gt_U: r.i = ua > ub; break;
+        case Op::Le_U: r.i = ua <= ub; break;
+        case Op::Ge_U: r.i = ua >= ub; break;
+        case Op::Eqz:  r.i = ua == 0; break;
+        case Op::Select: {
+            if (x.operands.size() != 3) return EvalStatus::NotConstant;
+            r = (int32_t)v[x.operands[0]].i ? v[x.operands[1]] : v[x.operands[2]];
             break;
         }
+        case Op::I32WrapI64:    r.i = wrap32(a.i); break;
+        case Op::I64ExtendI32S: r.i = wrap32(a.i); break;
+        case Op::I64ExtendI32U: r.i = (uint32_t)a.i; break;
+
+        case Op::F64Add: r.d = a.d + b.d; break;
+        case Op::F64Sub: r.d = a.d - b.d; break;
+        case Op::F64Mul: r.d = a.d * b.d; break;
+        case Op::F64Div: r.d = a.d / b.d; break;
+        case Op::F64Neg: r.d = -a.d; break;
+        case Op::F64Abs: r.d = std::fabs(a.d); break;
+        case Op::F64Sqrt: r.d = std::sqrt(a.d); break;   // IEEE 規定正確捨入，跟執行時一樣
+        case Op::F64Min: case Op::F64Max: {
+            // wasm：有 NaN 就是 NaN，-0 < +0
+            const bool isMin = x.op == Op::F64Min;
+            if (std::isnan(a.d) || std::isnan(b.d)) r.d = std::numeric_limits<double>::quiet_NaN();
+            else if (a.d == b.d) r.d = (std::signbit(a.d) == isMin) ? a.d : b.d;
+            else r.d = ((a.d < b.d) == isMin) ? a.d : b.d;
+            break;
+        }
+        case Op::F64Eq: r.i = a.d == b.d; break;
+        case Op::F64Ne: r.i = a.d != b.d; break;
+        case Op::F64Lt: r.i = a.d < b.d; break;
+        case Op::F64Gt: r.i = a.d > b.d; break;
+        case Op::F64Le: r.i = a.d <= b.d; break;
+        case Op::F64Ge: r.i = a.d >= b.d; break;
+        case Op::F64ConvertI32S: r.d = (double)(int32_t)a.i; break;
+        case Op::F64ConvertI32U: r.d = (double)(uint32_t)a.i; break;
+        // i64 → f32 直接轉，先轉 double 再捨入成 float 會捨入兩次
+        case Op::F64ConvertI64S:
+            r.d = x.type == ValueType::F32 ? (double)(float)a.i : (double)a.i;
+            break;
+        case Op::F64ConvertI64U:
+            r.d = x.type == ValueType::F32 ? (double)(float)(uint64_t)a.i : (double)(uint64_t)a.i;
+            break;
+        case Op::F32DemoteF64: r.d = (float)a.d; break;
+        case Op::F64PromoteF32: r.d = a.d; break;
+        case Op::I32TruncF64S:
+            if (!(a.d > -2147483649.0 && a.d < 2147483648.0)) return EvalStatus::Trap;
+            r.i = (int32_t)a.d;
+            break;
+        case Op::I32TruncF64U:
+            if (!(a.d > -1.0 && a.d < 4294967296.0)) return EvalStatus::Trap;
+            r.i = wrap32((int64_t)(uint32_t)a.d);
+            break;
+        case Op::I64TruncF64S:
+            if (!(a.d >= -9223372036854775808.0 && a.d < 9223372036854775808.0)) return EvalStatus::Trap;
+            r.i = (int64_t)a.d;
+            break;
+        case Op::I64TruncF64U:
+            if (!(a.d > -1.0 && a.d < 18446744073709551616.0)) return EvalStatus::Trap;
+            r.i = (int64_t)(uint64_t)a.d;
+            break;
+
+        // 記憶體 / global / ir_VAR / libm：編譯期不知道（或不保證一樣）
+        default:
+            return EvalStatus::NotConstant;
+        }
+        // f32 用 double 算再捨入成 float：+ - * / sqrt 的 double 結果捨入
+        // 一次就等於 float 上正確捨入的結果
+        if (x.type == ValueType::F32) r.d = (float)r.d;
+        if (x.op != Op::Select) r.wide = wide;
+        return EvalStatus::Ok;
+    }
+
+    const std::vector<ModuleFunction>& funcs_;
+    EvalOptions opts_;
+    uint64_t steps_ = 0;
+    std::unordered_map<std::string, int> byName_;
+    std::vector<std::unique_ptr<Layout>> layouts_;
+};
+
+// 求值結果 → 常數節點
+bool resultConst(ValueType t, const EvalValue& r, Value& c) {
+    c.type = t;
+    switch (t) {
+    case ValueType::I32:
+        c.op = Op::I32Const;
+        c.constValue = (int32_t)r.i;
+        return true;
+    case ValueType::I64:
+        c.op = Op::I64Const;
+        c.constValue = r.i;
+        return true;
+    case ValueType::F32: case ValueType::F64:
+        c.op = Op::F64Const;
+        c.fconst = r.d;
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+EvalResult evalFunction(const std::vector<ModuleFunction>& funcs, int f,
+                        const std::vector<EvalValue>& args, const EvalOptions& opts) {
+    Evaluator ev(funcs, opts);
+    return ev.run(f, args, 0);
+}
+
+int evalValueIR(const ValueIR& ir, const std::vector<int>& params) {
+    std::vector<ModuleFunction> one(1);
+    one[0].numParams = params.size();
+    one[0].values = ir;
+    std::vector<EvalValue> args(params.size());
+    for (size_t k = 0; k < params.size(); k++) args[k].i = params[k];
+    EvalResult r = evalFunction(one, 0, args);
+    return r.status == EvalStatus::Ok ? (int)r.value.i : 0;
+}
+
+int foldConstantCalls(std::vector<ModuleFunction>& funcs, const EvalOptions& opts) {
+    std::unordered_map<std::string, int> byName;
+    for (int i = 0; i < (int)funcs.size(); i++) byName[funcs[i].name] = i;
+
+    int folded = 0;
+    for (auto& caller : funcs) {
+        // 依程式順序：內層 call 折完，外層 call 的引數就變常數了
+        for (size_t i = 0; i < caller.values.size(); i++) {
+            Value& v = caller.values[i];
+            if (!isPureCall(v) || v.type == ValueType::Void) continue;
+            auto it = byName.find(v.callee_name);
+            if (it == byName.end()) continue;
+            std::vector<EvalValue> args;
+            bool allConst = true;
+            for (int o : v.operands) {
+                const Value& a = caller.values[o];
+                if (!isConstOp(a.op)) { allConst = false; break; }
+                EvalValue e;
+                if (a.op == Op::F64Const) e.d = a.fconst;
+                else e.i = a.constValue;
+                args.push_back(e);
+            }
+            if (!allConst) continue;
+
+            // 每個 call 各自有步數預算；trap / 太久的 call 留給執行時
+            EvalResult r = evalFunction(funcs, it->second, args, opts);
+            Value c;
+            if (r.status != EvalStatus::Ok || !resultConst(v.type, r.value, c)) continue;
+            turnIntoConst(v, c);
+            folded++;
+        }
     }
-    return vals.back();
-}
\ No newline at end of file
+    return folded;
+}
@@ -1,4 +1,48 @@
 #pragma once
 #include "value_ir.hpp"
+#include <cstdint>
+#include <vector>
 
-int evalValueIR(const ValueIR& ir, const std::vector<int>& params);
\ No newline at end of file
+// ============================================================
+// ValueIR 直譯器：編譯期求值（partial evaluation）用
+// ============================================================
+//
+// 照 bridge 的控制流約定執行 ValueIR（Loop / Br / Br_if / If / Else /
+// End、loop phi 與 if-merge phi），整數運算照 wasm 的 mod 2^n、除以零 /
+// 溢位 / trunc 越界當成 trap。編譯期看不到的東西一律放棄（NotConstant）：
+// 記憶體、global、ir_VAR 以外的 local 讀取、import、libm 超越函式
+// （exp / log / sin / cos / pow 的結果跟執行時的 libm 不保證一樣）。
+
+struct EvalValue {
+    int64_t i = 0;     // i32 存成 sign-extend 後的 64 位元
+    double d = 0.0;
+    bool wide = false; // i64：比較 / eqz 的寬度跟著 operand 的值走
+};
+
+enum class EvalStatus {
+    Ok,
+    NotConstant,   // 碰到副作用 / 編譯期不知道的值
+    Trap,          // 執行會 trap：不能折疊，留給執行時
+    StepLimit,     // 超過步數或呼叫深度上限
+};
+
+struct EvalOptions {
+    uint64_t maxSteps = 1000000;   // 所有呼叫加起來的節點執行數
+    int maxCallDepth = 64;
+};
+
+struct EvalResult {
+    EvalStatus status = EvalStatus::NotConstant;
+    EvalValue value;
+};
+
+// 執行 funcs[f]。Call 到 funcs 裡的函式會遞迴求值，其他 call 都是 NotConstant。
+EvalResult evalFunction(const std::vector<ModuleFunction>& funcs, int f,
+                        const std::vector<EvalValue>& args, const EvalOptions& opts = {});
+
+// 單一函式、只有 i32 參數的簡便版；不是常數時回傳 0
+int evalValueIR(const ValueIR& ir, const std::vector<int>& params);
+
+// Partial evaluation：引數全是常數、摘要說什麼都不碰（value_ir_ipa 標過
+// call_effects）的 call，在編譯期算出結果換成常數。回傳折疊的 call 數。
+int foldConstantCalls(std::vector<ModuleFunction>& funcs, const EvalOptions& opts = {});
@@ -0,0 +1,54 @@
+#include "value_ir_fastmath.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <vector>
+
+int markFastMath(ValueIR& values) {
+    int n = 0;
+    for (Value& v : values) {
+        switch (v.op) {
+        case Op::F64Add: case Op::F64Sub: case Op::F64Mul: case Op::F64Div:
+        case Op::F64Min: case Op::F64Max:
+            v.fast_math = true;
+            n++;
+            break;
+        default:
+            break;
+        }
+    }
+    return n;
+}
+
+int contractMulAdd(ValueIR& values) {
+    std::vector<int> uses(values.size(), 0);
+    for (const Value& v : values)
+        forEachOperand(v, [&](int ref) { uses[ref]++; });
+
+    // a * b 只給這個 add 用，型別 / lane 數跟 add 一樣
+    auto fusible = [&](const Value& add, int ref) {
+        const Value& m = values[ref];
+        return m.op == Op::F64Mul && uses[ref] == 1 && m.type == add.type && m.lanes == add.lanes;
+    };
+
+    int n = 0;
+    for (Value& v : values) {
+        if (v.op != Op::F64Add || v.lhs < 0 || v.rhs < 0) continue;
+        int mul = -1, other = -1;
+        if (fusible(v, v.lhs)) {
+            mul = v.lhs;
+            other = v.rhs;
+        } else if (fusible(v, v.rhs)) {
+            mul = v.rhs;
+            other = v.lhs;
+        } else {
+            continue;
+        }
+        v.op = Op::F64Fma;
+        v.operands = {values[mul].lhs, values[mul].rhs, other};
+        v.lhs = v.rhs = -1;
+        uses[mul] = 0;   // 變成死的，同一個 mul 不會再被別的 add 拿走
+        n++;
+    }
+    if (n > 0) values = cleanupValueIR(values);
+    return n;
+}
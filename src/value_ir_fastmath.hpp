@@ -0,0 +1,31 @@
+#pragma once
+
+#include "value_ir.hpp"
+
+// ============================================================
+// --fast-math / --fp-contract=fast：放寬 wasm 的浮點語意
+// ============================================================
+//
+// wasm 的 f64 運算每一步都照 IEEE 捨入、min / max 要處理 NaN 與 ±0，
+// 所以預設不能把 `s += A[i] * B[i]` 換順序（向量化 / 平行化的部分和）
+// 也不能合併成 FMA。使用者接受結果的最後幾個 bit 會變時才打開：
+//
+//   --fp-contract=fast   a * b + c → F64Fma（只捨入一次）
+//   --fast-math          上面那個 + 浮點運算標 fast_math：
+//                          · f64 的 + * 可以當 reduction（value_ir_outline 的
+//                            classifyCarried），vectorize / parallelize 各自累積
+//                            部分和再合併
+//                          · f64.min / f64.max 不管 NaN / ±0，直接是 minsd /
+//                            maxsd（cemit；bridge 的 ir_MIN_D 本來就是），
+//                            loop vectorizer 也把它們當 lane-wise 的運算
+//
+// 標記在 lowering 之後、module pass 之前（inline 複製過去的節點帶著標記）；
+// contraction 在最後，其他 pass 都不用認 F64Fma。
+
+// 浮點的 + - * / min max 標上 fast_math，回傳標了幾個
+int markFastMath(ValueIR& values);
+
+// F64Add(F64Mul(a, b), c)（任一邊）→ F64Fma{a, b, c}，mul 只給這個 add 用、
+// lane 數跟型別一樣時才合併。add 原地改寫，mul 留給 cleanupValueIR 刪。
+// 回傳合併的個數；有合併時 values 跑過 cleanupValueIR。
+int contractMulAdd(ValueIR& values);
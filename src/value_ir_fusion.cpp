@@ -0,0 +1,479 @@
+#include "value_ir_fusion.hpp"
+#include "value_ir_deps.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_rebuild.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr int kMaxFusedNodes = 400;      // 併完的 loop（含裡面的 loop）最多幾個節點
+constexpr int64_t kCacheLine = 64;
+constexpr int kMaxStatements = 64;       // distribution 的 statement 用 bitmask 表示
+constexpr int64_t kMinDistributeTrip = 64;
+
+int entryOf(const ValueIR& values, const LoopShape& s) {
+    return values[s.iv].operands[0];
+}
+
+// step 1 的 `iv < n`，唯一的 loop-carried 值是 iv，loop 外面只用到
+// 裡面的 Param / 常數
+bool countedLoop(const ValueIR& values, const LoopShape& s) {
+    return s.simple && s.hasIV() && s.step == 1 && (s.cmp == LoopCmp::LtS || s.cmp == LoopCmp::LtU) &&
+           s.phis.size() == 1 && s.bound >= 0 && values[s.iv].type != ValueType::I64 &&
+           loopNestSelfContained(values, s);
+}
+
+// header 只有 iv 跟算條件的 Param / 純運算
+bool plainHeader(const ValueIR& values, const LoopShape& s) {
+    for (int i = s.header(); i < s.exitBr; i++)
+        if (i != s.iv && values[i].op != Op::Param && !isPureOp(values[i].op)) return false;
+    return true;
+}
+
+// 一定相等的兩個值：同一個節點、同一個 Param、一樣的常數，或一樣的純運算
+bool sameValue(const ValueIR& values, int a, int b, int depth = 0) {
+    if (a == b) return true;
+    if (a < 0 || b < 0 || depth > 8) return false;
+    const Value& x = values[a];
+    const Value& y = values[b];
+    if (x.op != y.op || x.type != y.type) return false;
+    if (x.op == Op::Param) return x.paramIndex == y.paramIndex;
+    if (isConstOp(x.op)) return sameConst(x, y);
+    if (!isPureOp(x.op) || x.constValue != y.constValue || x.operands.size() != y.operands.size())
+        return false;
+    if (!sameValue(values, x.lhs, y.lhs, depth + 1) || !sameValue(values, x.rhs, y.rhs, depth + 1))
+        return false;
+    for (size_t k = 0; k < x.operands.size(); k++)
+        if (!sameValue(values, x.operands[k], y.operands[k], depth + 1)) return false;
+    return true;
+}
+
+// loops[k] 自己帶的相依（外層 loop 已經決定先後的不算）
+bool carriesDependence(const std::vector<Dependence>& deps, int k) {
+    for (const Dependence& d : deps) {
+        auto it = std::find(d.loops.begin(), d.loops.end(), k);
+        if (it == d.loops.end()) return true;
+        const size_t p = it - d.loops.begin();
+        for (const auto& dir : directionVectors(d)) {
+            bool outer = false;
+            for (size_t m = 0; m < p; m++) outer |= dir[m] != 0;
+            if (!outer && dir[p] != 0) return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================
+// Fusion：合法性與 locality
+// ============================================================
+
+// 位址的形狀：前 depth 層（外層 loop 與要併的那層）照原樣，各自裡面的
+// loop 換成它在 nest 裡的深度，常數項另外拿出來
+using AccessShape = std::map<std::pair<int, std::string>, int64_t>;
+
+AccessShape shapeOf(const AffineAccess& a, size_t depth, int64_t& constant) {
+    AccessShape shape;
+    constant = 0;
+    for (const auto& [t, c] : a.terms) {
+        if (t.first < 0 && t.second.empty()) {
+            constant += c;
+            continue;
+        }
+        auto it = std::find(a.loops.begin(), a.loops.end(), t.first);
+        size_t pos = it - a.loops.begin();
+        shape[{t.first >= 0 && pos >= depth ? -2 - (int)pos : t.first, t.second}] += c;
+    }
+    return shape;
+}
+
+// 兩個存取碰到同一個陣列、下標一樣（最多差一條 cache line）：先跑的
+// loop 帶進 cache 的資料，併起來之後另一個馬上就用到
+bool sharesLines(const AffineAccess& a, const AffineAccess& b, size_t depth, const AliasAnalysis& aa) {
+    if (!a.affine || !b.affine) return false;
+    MemLocation la = aa.location(a.node), lb = aa.location(b.node);
+    if (la.kind == MemLocation::Unknown || la.kind != lb.kind || la.base != lb.base) return false;
+    int64_t ca = 0, cb = 0;
+    if (shapeOf(a, depth, ca) != shapeOf(b, depth, cb)) return false;
+    return std::llabs(ca - cb) < kCacheLine;
+}
+
+// group（已經決定要併的 loop，第一個留下來）後面接 next：兩邊的存取都換成
+// group[0] 之後，每個相依都要是 group 的第 i 輪 → next 的第 i + d 輪、d >= 0
+bool fusable(const std::vector<LoopShape>& loops, const DependenceAnalysis& deps,
+             const AliasAnalysis& aa, const std::vector<int>& group, int next, bool& reuse) {
+    const int first = group[0];
+    std::vector<AffineAccess> before, after;
+    for (const AffineAccess& a : deps.accesses()) {
+        for (int g : group)
+            if (a.node > loops[g].loop && a.node < loops[g].end) before.push_back(renameLoop(a, g, first));
+        if (a.node > loops[next].loop && a.node < loops[next].end)
+            after.push_back(renameLoop(a, next, first));
+    }
+    reuse = false;
+    for (const AffineAccess& a : before)
+        for (const AffineAccess& b : after) {
+            auto at = std::find(a.loops.begin(), a.loops.end(), first);
+            if (!reuse && sharesLines(a, b, at - a.loops.begin() + 1, aa)) reuse = true;
+            if (!a.write && !b.write) continue;
+            if (!aa.mayAlias(a.node, b.node)) continue;
+            Dependence d;
+            if (!deps.test(a, b, d)) continue;
+            auto it = std::find(d.loops.begin(), d.loops.end(), first);
+            if (it == d.loops.end()) return false;
+            const size_t p = it - d.loops.begin();
+            bool carried = false;
+            for (size_t m = 0; m < p; m++)
+                carried |= d.distance[m] != 0 && d.distance[m] != kUnknownDistance;
+            if (carried) continue;
+            int64_t dist = d.distance[p];
+            if (dist == kUnknownDistance) return false;
+            // test 把先執行的當 src；換回 b − a
+            if (d.src != a.node) dist = -dist;
+            if (dist < 0) return false;
+        }
+    return true;
+}
+
+// 同一層、在 c 後面的下一個 loop（findLoops 的 index），沒有時 -1
+int nextSibling(const std::vector<LoopShape>& loops, int c) {
+    for (int k = c + 1; k < (int)loops.size(); k++) {
+        if (loops[k].loop < loops[c].end) continue;
+        return loops[k].parent == loops[c].parent ? k : -1;
+    }
+    return -1;
+}
+
+// 兩個 loop 中間只有純運算 / Param / LocalSet：併的時候搬到前面
+bool onlyGlue(const ValueIR& values, int from, int to) {
+    for (int i = from; i < to; i++) {
+        const Value& v = values[i];
+        bool ok = (v.op == Op::End && v.constValue == 1) || v.op == Op::Param ||
+                  v.op == Op::LocalSet || isPureOp(v.op);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+std::vector<int> planFusion(const ValueIR& values, const std::vector<LoopShape>& loops,
+                            const DependenceAnalysis& deps, const AliasAnalysis& aa, int k) {
+    const LoopShape& s = loops[k];
+    std::vector<int> group;
+    if (!countedLoop(values, s) || !plainHeader(values, s)) return group;
+    group.push_back(k);
+    int size = s.end - s.loop;
+    // 最內層的 loop 才管 recurrence：外層 loop 併起來換到的 locality 比較重要
+    const bool carries = s.innermost && carriesDependence(deps.dependences(s.loop, s.end), k);
+    for (int c = nextSibling(loops, k); c >= 0; c = nextSibling(loops, c)) {
+        const LoopShape& n = loops[c];
+        if (!countedLoop(values, n) || !plainHeader(values, n) || n.cmp != s.cmp) break;
+        if (!onlyGlue(values, loops[group.back()].end + 1, n.loop)) break;
+        if (!sameValue(values, entryOf(values, s), entryOf(values, n)) ||
+            !sameValue(values, s.bound, n.bound))
+            break;
+        size += n.end - n.loop;
+        if (size > kMaxFusedNodes) break;
+        if (s.innermost && n.innermost && carriesDependence(deps.dependences(n.loop, n.end), c) != carries)
+            break;
+        bool reuse = false;
+        if (!fusable(loops, deps, aa, group, c, reuse) || !reuse) break;
+        group.push_back(c);
+    }
+    if (group.size() < 2) group.clear();
+    return group;
+}
+
+// ============================================================
+// Fusion：重建
+// ============================================================
+
+class Fuser : public ValueIRRebuilder {
+public:
+    Fuser(const ValueIR& in, const std::vector<LoopShape>& loops, const std::vector<std::vector<int>>& groups)
+        : ValueIRRebuilder(in), loops_(loops), groups_(groups) {}
+
+    ValueIR run() {
+        std::vector<std::pair<int, int>> regions;
+        for (const auto& g : groups_) regions.push_back({loops_[g.front()].loop, loops_[g.back()].end});
+        return ValueIRRebuilder::run(regions);
+    }
+
+private:
+    void emitRegion(size_t k) override;
+
+    const std::vector<LoopShape>& loops_;
+    const std::vector<std::vector<int>>& groups_;
+};
+
+void Fuser::emitRegion(size_t k) {
+    const std::vector<int>& g = groups_[k];
+    const LoopShape& first = loops_[g[0]];
+
+    // header 裡的 Param / 常數、loop 之間的純運算先放在前面
+    for (int c : g)
+        for (int i = loops_[c].header(); i < loops_[c].exitBr; i++)
+            if (in_[i].op == Op::Param || isConstOp(in_[i].op)) copyVerbatim(i, i, nullptr);
+    for (size_t j = 1; j < g.size(); j++)
+        copyUnmapped(loops_[g[j - 1]].end + 1, loops_[g[j]].loop - 1, true);
+
+    const int lm = emit(in_[first.loop]);
+    Value phi = in_[first.iv];
+    phi.operands = {mapOutside(entryOf(in_, first))};
+    const int iv = emit(phi);
+    for (int c : g) {
+        map_[loops_[c].loop] = lm;
+        map_[loops_[c].iv] = iv;
+    }
+    copyUnmapped(first.header(), first.exitBr, true);
+    copyUnmapped(first.bodyBegin(), first.backBr - 1, false);
+    // 後面的 loop：header 剩下的純運算放進 body，iv 都是同一個
+    for (size_t j = 1; j < g.size(); j++) {
+        const LoopShape& s = loops_[g[j]];
+        copyUnmapped(s.header(), s.exitBr - 1, true);
+        copyUnmapped(s.bodyBegin(), s.backBr - 1, false);
+    }
+    setBack(iv, map_[in_[first.iv].operands[1]]);
+    Value back = in_[first.backBr];
+    back.lhs = lm;
+    back.rhs = iv;
+    emit(back);
+    const int end = emit(in_[first.end]);
+    for (int c : g) map_[loops_[c].end] = end;
+}
+
+// ============================================================
+// Distribution：statement 與相依圖
+// ============================================================
+
+struct DistPlan {
+    int loop = -1;                        // findLoops 的 index
+    std::vector<int> stores;              // body 裡所有的 store
+    std::vector<std::vector<int>> parts;  // 每個新 loop 留下的 store，照執行順序
+};
+
+using StmtMask = uint64_t;
+
+bool planDistribution(const ValueIR& values, const std::vector<LoopShape>& loops,
+                      const DependenceAnalysis& deps, int k, DistPlan& plan) {
+    const LoopShape& s = loops[k];
+    if (!s.innermost || !countedLoop(values, s) || !plainHeader(values, s)) return false;
+    if (s.tripCount >= 0 && s.tripCount < kMinDistributeTrip) return false;
+
+    // statement = 一個 store 加上算出它的位址 / 值的節點
+    const int b = s.bodyBegin(), e = s.backBr;
+    std::vector<int> stores;
+    for (int i = b; i < e; i++) {
+        const Value& v = values[i];
+        bool ok = (v.op == Op::End && v.constValue == 1) || v.op == Op::Param ||
+                  v.op == Op::LocalSet || isPureOp(v.op) || isMemoryRead(v.op) ||
+                  v.op == Op::Store || v.op == Op::F64Store;
+        if (!ok) return false;
+        if (v.op == Op::Store || v.op == Op::F64Store) stores.push_back(i);
+    }
+    const int m = (int)stores.size();
+    if (m < 2 || m > kMaxStatements) return false;
+
+    // 每個節點屬於哪些 statement；沒有 store 用到的 load 每個新 loop 都有
+    std::vector<StmtMask> mask(e - b, 0);
+    for (int i = e - 1; i >= b; i--) {
+        auto st = std::find(stores.begin(), stores.end(), i);
+        if (st != stores.end()) mask[i - b] |= StmtMask(1) << (st - stores.begin());
+        forEachOperand(values[i], [&](int ref) {
+            if (ref >= b && ref < e) mask[ref - b] |= mask[i - b];
+        });
+    }
+    const StmtMask all = m == 64 ? ~StmtMask(0) : (StmtMask(1) << m) - 1;
+    auto maskOf = [&](int node) { return mask[node - b] ? mask[node - b] : all; };
+
+    // 相依圖：x → y 表示 statement x 要在 y 之前（不同 loop 時 x 的 loop 在前）
+    std::vector<StmtMask> succ(m, 0);
+    std::vector<std::pair<int, int>> carriedEdges;
+    auto addEdges = [&](StmtMask from, StmtMask to, bool carried) {
+        for (int x = 0; x < m; x++) {
+            if (!(from >> x & 1)) continue;
+            for (int y = 0; y < m; y++) {
+                if (!(to >> y & 1)) continue;
+                if (x != y) succ[x] |= StmtMask(1) << y;
+                if (carried) carriedEdges.push_back({x, y});
+            }
+        }
+    };
+    for (const Dependence& d : deps.dependences(s.loop, s.end)) {
+        auto it = std::find(d.loops.begin(), d.loops.end(), k);
+        if (it == d.loops.end()) return false;
+        const size_t p = it - d.loops.begin();
+        bool outer = false;
+        for (size_t q = 0; q < p; q++)
+            outer |= d.distance[q] != 0 && d.distance[q] != kUnknownDistance;
+        if (outer) continue;
+        const StmtMask ms = maskOf(d.src), md = maskOf(d.dst);
+        const int64_t dk = d.distance[p];
+        if (dk == kUnknownDistance) {
+            addEdges(ms, md, true);
+            addEdges(md, ms, true);
+        } else if (dk > 0) {
+            addEdges(ms, md, true);
+        } else if (dk < 0) {
+            addEdges(md, ms, true);
+        } else {
+            // 同一輪裡：程式順序
+            addEdges(maskOf(std::min(d.src, d.dst)), maskOf(std::max(d.src, d.dst)), false);
+        }
+    }
+
+    // SCC：互相走得到的 statement
+    std::vector<StmtMask> reach = succ;
+    for (int z = 0; z < m; z++)
+        for (int x = 0; x < m; x++)
+            if (reach[x] >> z & 1) reach[x] |= reach[z];
+    std::vector<int> comp(m);
+    for (int x = 0; x < m; x++) {
+        comp[x] = x;
+        for (int y = 0; y < x; y++)
+            if ((reach[x] >> y & 1) && (reach[y] >> x & 1)) {
+                comp[x] = comp[y];
+                break;
+            }
+    }
+    std::vector<char> recurrent(m, 0);
+    for (auto [x, y] : carriedEdges)
+        if (comp[x] == comp[y]) recurrent[comp[x]] = 1;
+
+    // SCC 拓撲排序，能選的時候先放原本比較前面的；同一種而且相鄰的併成一個 loop
+    std::vector<char> placed(m, 0);
+    std::vector<std::pair<char, std::vector<int>>> parts;
+    for (int done = 0; done < m;) {
+        int pick = -1;
+        for (int c = 0; c < m && pick < 0; c++) {
+            if (comp[c] != c || placed[c]) continue;
+            bool ready = true;
+            for (int x = 0; x < m && ready; x++)
+                if (!placed[x] && comp[x] != c && (reach[x] >> c & 1))
+                    ready = false;
+            if (ready) pick = c;
+        }
+        if (pick < 0) return false;
+        std::vector<int> members;
+        for (int x = 0; x < m; x++)
+            if (comp[x] == pick) {
+                placed[x] = 1;
+                members.push_back(stores[x]);
+                done++;
+            }
+        if (parts.empty() || parts.back().first != recurrent[pick]) parts.push_back({recurrent[pick], {}});
+        auto& dst = parts.back().second;
+        dst.insert(dst.end(), members.begin(), members.end());
+    }
+    if (parts.size() < 2) return false;
+
+    plan.loop = k;
+    plan.stores = stores;
+    for (auto& [rec, members] : parts) {
+        std::sort(members.begin(), members.end());
+        plan.parts.push_back(members);
+    }
+    return true;
+}
+
+// ============================================================
+// Distribution：重建
+// ============================================================
+
+class Distributor : public ValueIRRebuilder {
+public:
+    Distributor(const ValueIR& in, const std::vector<LoopShape>& loops, const std::vector<DistPlan>& plans)
+        : ValueIRRebuilder(in), loops_(loops), plans_(plans) {}
+
+    ValueIR run() {
+        std::vector<std::pair<int, int>> regions;
+        for (const DistPlan& p : plans_) regions.push_back({loops_[p.loop].loop, loops_[p.loop].end});
+        return ValueIRRebuilder::run(regions);
+    }
+
+private:
+    void emitRegion(size_t k) override;
+
+    const std::vector<LoopShape>& loops_;
+    const std::vector<DistPlan>& plans_;
+};
+
+// 每個 part 複製一整個 loop，別的 part 的 store 不放；用不到的 load /
+// 運算交給 cleanupValueIR
+void Distributor::emitRegion(size_t k) {
+    const DistPlan& p = plans_[k];
+    const LoopShape& s = loops_[p.loop];
+    for (const std::vector<int>& part : p.parts) {
+        std::vector<char> skip(in_.size(), 0);
+        for (int st : p.stores) skip[st] = 1;
+        for (int st : part) skip[st] = 0;
+
+        const int lm = emit(in_[s.loop]);
+        LocalMap state;
+        std::vector<int> phis = emitPhis(s, state, CopyScope{});
+        LocalMap cur;
+        CopyScope sc{{&cur, &state}};
+        copyRange(s.header(), s.exitBr, cur, sc);
+        Value exit = in_[s.exitBr];
+        exit.lhs = lookup(exit.lhs, sc);
+        exit.rhs = lm;
+        emit(exit);
+        copyRange(s.bodyBegin(), s.backBr, cur, sc, &skip);
+        setBack(phis[0], lookup(in_[s.iv].operands[1], sc));
+        Value back = in_[s.backBr];
+        back.lhs = lm;
+        back.rhs = phis[0];
+        emit(back);
+        map_[s.end] = emit(in_[s.end]);
+    }
+}
+
+} // namespace
+
+int fuseLoops(ValueIR& values, const AliasAnalysis& aa) {
+    for (const Value& v : values)
+        if (v.op == Op::Phi && v.use_vload_entry) return 0;
+    std::vector<LoopShape> loops = findLoops(values);
+    if (loops.size() < 2) return 0;
+    DependenceAnalysis deps(values, loops, aa);
+
+    std::vector<std::vector<int>> groups;
+    int skipUntil = -1, fused = 0;
+    for (int k = 0; k < (int)loops.size(); k++) {
+        if (loops[k].loop < skipUntil) continue;
+        std::vector<int> g = planFusion(values, loops, deps, aa, k);
+        if (g.empty()) continue;
+        skipUntil = loops[g.back()].end;
+        fused += (int)g.size() - 1;
+        groups.push_back(std::move(g));
+    }
+    if (groups.empty()) return 0;
+
+    ValueIR out = Fuser(values, loops, groups).run();
+    values = cleanupValueIR(out);
+    return fused;
+}
+
+int distributeLoops(ValueIR& values, const AliasAnalysis& aa) {
+    for (const Value& v : values)
+        if (v.op == Op::Phi && v.use_vload_entry) return 0;
+    std::vector<LoopShape> loops = findLoops(values);
+    if (loops.empty()) return 0;
+    DependenceAnalysis deps(values, loops, aa);
+
+    std::vector<DistPlan> plans;
+    for (int k = 0; k < (int)loops.size(); k++) {
+        DistPlan plan;
+        if (planDistribution(values, loops, deps, k, plan)) plans.push_back(std::move(plan));
+    }
+    if (plans.empty()) return 0;
+
+    ValueIR out = Distributor(values, loops, plans).run();
+    values = cleanupValueIR(out);
+    return (int)plans.size();
+}
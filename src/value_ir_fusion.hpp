@@ -0,0 +1,47 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+
+// ============================================================
+// Loop fusion / distribution
+// ============================================================
+//
+// Fusion：gemver 的 `x[i] += beta·A[j][i]·y[j]` 跟 `x[i] += z[i]`、mvt
+// interchange 之後的兩個 nest 都是範圍一樣、一個接一個的 loop，每個各自
+// 把陣列整個掃一遍。併成一個 loop 之後，第一個 loop 剛碰過的 cache line
+// 在第二個用到時還在：
+//
+//   for (i = 0; i < n; i++) S1(i);        for (i = 0; i < n; i++) {
+//   for (i = 0; i < n; i++) S2(i);   →      S1(i);
+//                                           S2(i);
+//                                         }
+//
+// 對象：同一層、中間只有純運算 / LocalSet 的兩個 step 1 counted loop，
+// 起點跟 bound 一樣（同一個值，或一樣的 Param / 常數算出來），唯一的
+// loop-carried 值是 iv。併起來之後 S2(i) 比 S1(i') 先跑的只有 i < i'，
+// 所以兩個 loop 之間的每個相依都要是 S1(i) → S2(i + d)、d >= 0
+// （renameLoop 把兩個 loop 當成同一個，交給 DependenceAnalysis 求 d）。
+//
+// Distribution：反過來把最內層 loop 的 body 照 store 拆成幾個 statement，
+// 依相依排成 SCC：有 loop-carried 相依的（`A[i] = A[i-1] + …` 的
+// recurrence）跟沒有的分到不同的 loop，後者之後可以整個向量化 / 平行。
+//
+//   for (i = 1; i < n; i++) {             for (i = 1; i < n; i++) A[i] = A[i-1] + B[i];
+//     A[i] = A[i-1] + B[i];          →    for (i = 1; i < n; i++) C[i] = A[i] * 2;
+//     C[i] = A[i] * 2;
+//   }
+//
+// 兩邊用同一個 locality cost model，互相不會抵銷：
+//   - fusion 只在兩個 loop 碰到同一個陣列、下標一樣（差不到一條 cache
+//     line）時做，併完 body 不超過 kMaxFusedNodes 個節點；最內層的 loop
+//     一個有 loop-carried 相依、另一個沒有時不併（那正是 distribution 拆開的）
+//   - distribution 只在拆得出「有 recurrence」跟「沒有」兩種時做，同一種
+//     而且相鄰的 SCC 留在同一個 loop 裡
+
+// 回傳併掉的 loop 數；有改寫時 values 重建並跑過 cleanupValueIR。
+// 併完之後裡面的 loop 可能變成相鄰的，呼叫端可以重建 alias 再跑一次。
+int fuseLoops(ValueIR& values, const AliasAnalysis& aa);
+
+// 回傳拆開的 loop 數；有改寫時 values 重建並跑過 cleanupValueIR。
+int distributeLoops(ValueIR& values, const AliasAnalysis& aa);
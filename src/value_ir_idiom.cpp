@@ -0,0 +1,257 @@
+#include "value_ir_idiom.hpp"
+#include "value_ir_deps.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace {
+
+bool isStore(Op op) {
+    return op == Op::Store || op == Op::F64Store;
+}
+
+struct IdiomPlan {
+    LoopShape s;
+    int store = -1;
+    int load = -1;        // 複製的來源；填值時是 -1
+    int fill = -1;        // store8 填的值（舊 id），直接給 memory.fill
+    int fillByte = -1;    // 常數填值：每個 byte 的值
+    int bytes = 0;        // 每一輪存取的寬度
+    bool ivUsedAfter = false;
+};
+
+// 位址對 loops[k] 的 iv 連續（係數 = 存取寬度），其他項跟 iv 無關
+bool contiguous(const DependenceAnalysis& deps, int node, int k, int bytes) {
+    const AffineAccess* a = deps.access(node);
+    if (!a || !a->affine) return false;
+    int64_t coef = 0;
+    for (const auto& [key, c] : a->terms) {
+        if (key.first != k || c == 0) continue;
+        if (!key.second.empty()) return false;
+        coef = c;
+    }
+    return coef == bytes;
+}
+
+// 常數存進記憶體的 bytes 都一樣時回傳那個 byte，否則 -1
+int splatByte(const Value& c, const Value& store, int bytes) {
+    uint64_t bits;
+    if (c.op == Op::I32Const || c.op == Op::I64Const) {
+        bits = (uint64_t)(int64_t)c.constValue;
+    } else if (c.op == Op::F64Const && memAccessType(store) == ValueType::F32) {
+        float f = (float)c.fconst;
+        uint32_t b;
+        std::memcpy(&b, &f, sizeof b);
+        bits = b;
+    } else if (c.op == Op::F64Const) {
+        std::memcpy(&bits, &c.fconst, sizeof bits);
+    } else {
+        return -1;
+    }
+    const int byte = (int)(bits & 0xff);
+    for (int k = 1; k < bytes; k++)
+        if ((int)((bits >> (8 * k)) & 0xff) != byte) return -1;
+    return byte;
+}
+
+// 複製的 load → store：只能是同一輪，或先讀後寫
+bool copyDependencesAllow(const DependenceAnalysis& deps, const LoopShape& s, int k) {
+    for (const Dependence& d : deps.dependences(s.loop, s.end)) {
+        if (d.loops.empty() || d.loops.back() != k) return false;
+        const int64_t dist = d.distance.back();
+        if (dist == kUnknownDistance) return false;
+        if (dist != 0 && d.kind != Dependence::Anti) return false;
+    }
+    return true;
+}
+
+bool planIdiom(const ValueIR& values, const std::vector<LoopShape>& loops,
+               const DependenceAnalysis& deps, int k, IdiomPlan& p) {
+    const LoopShape& s = loops[k];
+    if (!s.simple || !s.innermost || !s.hasIV() || s.step != 1 || s.cmp != LoopCmp::LtS)
+        return false;
+    if (s.phis.size() != 1 || s.bound < 0 || values[s.iv].type != ValueType::I32) return false;
+    if (!isLoopInvariant(values, s, values[s.iv].operands[0]) || !isLoopInvariant(values, s, s.bound))
+        return false;
+
+    std::map<int, int> uses;
+    for (int i = s.header(); i < s.backBr; i++) {
+        const Value& v = values[i];
+        if (i == s.exitBr || i == s.iv) continue;
+        if (isStore(v.op)) {
+            if (p.store >= 0 || v.lanes > 1) return false;
+            p.store = i;
+        } else if (v.op == Op::Load || v.op == Op::F64Load) {
+            if (p.load >= 0 || v.lanes > 1) return false;
+            p.load = i;
+        } else if (v.op != Op::Param && v.op != Op::LocalSet && !isPureOp(v.op)) {
+            return false;
+        }
+        if (v.op != Op::LocalSet) forEachOperand(v, [&](int ref) { uses[ref]++; });
+    }
+    if (p.store < 0) return false;
+    const Value& st = values[p.store];
+    p.bytes = memAccessBytes(st);
+    if (!contiguous(deps, p.store, k, p.bytes)) return false;
+
+    if (p.load >= 0) {
+        // 複製：load 只給這個 store 存
+        const Value& ld = values[p.load];
+        if (st.rhs != p.load || uses[p.load] != 1 || memAccessBytes(ld) != p.bytes) return false;
+        if ((ld.op == Op::F64Load) != (st.op == Op::F64Store)) return false;
+        if (!contiguous(deps, p.load, k, p.bytes)) return false;
+        if (!copyDependencesAllow(deps, s, k)) return false;
+    } else {
+        // 填值：每個 byte 一樣，store8 的值 memory.fill 自己會取最低的 byte
+        if (!isLoopInvariant(values, s, st.rhs)) return false;
+        const Value& val = values[st.rhs];
+        if (p.bytes == 1 && st.op == Op::Store) {
+            p.fill = st.rhs;
+        } else {
+            p.fillByte = splatByte(val, st, p.bytes);
+            if (p.fillByte < 0) return false;
+        }
+    }
+
+    // loop 之後只能用到 iv（最後的值）
+    std::vector<int> repl;
+    if (!exitValueMap(values, s, repl)) return false;
+    for (int i = 0; i < (int)values.size(); i++) {
+        if (i >= s.loop && i <= s.end) continue;
+        bool bad = false;
+        forEachOperand(values[i], [&](int ref) {
+            if (ref < s.loop || ref > s.end) return;
+            if (ref == s.iv || repl[ref] == s.iv) p.ivUsedAfter = true;
+            else if (!isConstOp(values[ref].op) && values[ref].op != Op::Param) bad = true;
+        });
+        if (bad) return false;
+    }
+    p.s = s;
+    return true;
+}
+
+} // namespace
+
+int recognizeMemIdioms(ValueIR& values, const AliasAnalysis& aa) {
+    for (const auto& v : values)
+        if (v.op == Op::Phi && v.use_vload_entry) return 0;
+
+    const std::vector<LoopShape> loops = findLoops(values);
+    std::map<int, IdiomPlan> plans;   // Loop 節點 → plan
+    {
+        DependenceAnalysis deps(values, loops, aa);
+        for (int k = 0; k < (int)loops.size(); k++) {
+            IdiomPlan p;
+            if (planIdiom(values, loops, deps, k, p)) plans.emplace(loops[k].loop, p);
+        }
+    }
+    if (plans.empty()) return 0;
+
+    ValueIR out;
+    std::vector<int> map(values.size(), -1);
+    struct Fixup { int node; size_t k; int ref; };
+    std::vector<Fixup> fixups;
+    auto emit = [&](Value v) {
+        v.id = (int)out.size();
+        out.push_back(v);
+        return v.id;
+    };
+    auto konst = [&](int c) {
+        Value v;
+        v.op = Op::I32Const;
+        v.constValue = c;
+        return emit(v);
+    };
+    auto binary = [&](Op op, int lhs, int rhs) {
+        Value v;
+        v.op = op;
+        v.lhs = lhs;
+        v.rhs = rhs;
+        return emit(v);
+    };
+    auto select = [&](int cond, int t, int f) {
+        Value v;
+        v.op = Op::Select;
+        v.operands = {cond, t, f};
+        return emit(v);
+    };
+
+    for (int i = 0; i < (int)values.size(); i++) {
+        auto pit = plans.find(i);
+        if (pit == plans.end()) {
+            Value v = values[i];
+            if (v.op == Op::Phi && v.local_index >= 0) {
+                for (size_t k = 0; k < v.operands.size(); k++) {
+                    int ref = v.operands[k];
+                    if (ref >= i) fixups.push_back({(int)out.size(), k, ref});
+                    else if (ref >= 0) v.operands[k] = map[ref];
+                }
+            } else {
+                forEachOperand(v, [&](int& ref) { ref = map[ref]; });
+            }
+            forEachControlRef(v, [&](int& ref) { ref = map[ref]; });
+            map[i] = emit(v);
+            continue;
+        }
+
+        // loop 裡用到的值照抄到 loop 前面：iv 換成起點，其他的都跟迭代無關
+        const IdiomPlan& p = pit->second;
+        const LoopShape& s = p.s;
+        std::map<int, int> local;
+        std::function<int(int)> materialize = [&](int id) -> int {
+            if (id < s.loop || id > s.end) return map[id];
+            auto it = local.find(id);
+            if (it != local.end()) return it->second;
+            if (id == s.iv) return local[id] = materialize(values[id].operands[0]);
+            Value v = values[id];
+            forEachOperand(v, [&](int& ref) { ref = materialize(ref); });
+            return local[id] = emit(v);
+        };
+        const int init = materialize(s.iv);
+        const int bound = materialize(s.bound);
+        const int runs = binary(Op::Lt_S, init, bound);
+        const int cnt = select(runs, binary(Op::Sub, bound, init), konst(0));
+        // 次數已知時長度直接是常數，bridge 可以展開成 store
+        int len;
+        if (s.tripCount >= 0 && s.tripCount * p.bytes <= INT32_MAX)
+            len = konst((int)(s.tripCount * p.bytes));
+        else
+            len = p.bytes == 1 ? cnt : binary(Op::Mul, cnt, konst(p.bytes));
+        auto address = [&](int node) {
+            int a = materialize(values[node].lhs);
+            if (values[node].mem_offset != 0) a = binary(Op::Add, a, konst(values[node].mem_offset));
+            return a;
+        };
+
+        Value mem;
+        mem.type = ValueType::Void;
+        const int dst = address(p.store);
+        if (p.load >= 0) {
+            mem.op = Op::MemoryCopy;
+            mem.operands = {dst, address(p.load), len};
+        } else {
+            mem.op = Op::MemoryFill;
+            mem.operands = {dst, p.fill >= 0 ? materialize(p.fill) : konst(p.fillByte), len};
+        }
+        emit(mem);
+
+        // loop 之後的 iv：跑過時是 n，沒跑是起點
+        if (p.ivUsedAfter) {
+            const int last = select(runs, bound, init);
+            map[s.iv] = map[values[s.iv].operands[1]] = last;
+        }
+        // loop 裡的 Param / 常數 loop 之後還可能用到
+        for (int k = s.header(); k < s.end; k++)
+            if (values[k].op == Op::Param || isConstOp(values[k].op)) map[k] = materialize(k);
+        i = s.end;
+    }
+    for (const Fixup& f : fixups) out[f.node].operands[f.k] = map[f.ref];
+
+    values = cleanupValueIR(out);
+    return (int)plans.size();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+
+// ============================================================
+// Loop idiom recognition：填值 / 複製的 loop 換成 memory.fill / memory.copy
+// ============================================================
+//
+// PolyBench 的初始化、2mm / 3mm 的 `C[i][j] = 0` 這種 loop 每一輪一個
+// store，bridge 出來的 C 經過 __mem 存取，C compiler 不會認成 memset：
+//
+//   for (i = b; i < n; i++)            cnt = b < n ? n - b : 0
+//     A[i] = 0;                  →     MemoryFill(&A[b], 0, cnt * 8)
+//
+//   for (i = b; i < n; i++)
+//     A[i] = B[i];               →     MemoryCopy(&A[b], &B[b], cnt * 4)
+//
+// bridge 把 MemoryFill / MemoryCopy 寫成 libc 的 memset / memmove；大小是
+// 不超過 kInlineBytes 的常數時直接展開成 8-byte 的 store（MemoryFillNode）。
+//
+// 對象：findLoops 的 simple loop，最內層、step 1 的 `i < n`，只帶 iv，起點
+// 跟 n 在 loop 外面就決定了；body 除了位址運算（純運算、Param、常數）、
+// LocalSet 之外只有一個 store，位址對 i 連續（係數 = 存取寬度）：
+//   - 填值：存的值跟 i 無關，而且每個 byte 都一樣（0、-1、store8 的任意值）
+//   - 複製：存的值是同樣寬度、位址也連續的 load（只給這個 store 用）。
+//     DependenceAnalysis 的相依只能是同一輪的，或先讀後寫（dst 在 src
+//     前面：往前複製跟 memmove 的結果一樣）；不知道重不重疊時不換
+// loop 之後用到 iv 的改成最後的值（b < n ? n : b）。bridge 的 VLOAD 入口
+// phi（use_vload_entry）會讀 LocalSet 寫的 ir_VAR，有的話整個函式不做。
+//
+// 越界時原本的 loop 寫到一半才 trap，換完之後一開始就 trap。
+// 回傳換掉的 loop 數；有改寫時 values 重建並跑過 cleanupValueIR。
+int recognizeMemIdioms(ValueIR& values, const AliasAnalysis& aa);
@@ -0,0 +1,262 @@
+#include "value_ir_ifconvert.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 兩邊加起來最多多算幾個運算（常數、Param、LocalSet 不算）
+constexpr int kMaxSpeculated = 8;
+
+bool isAccess(Op op) {
+    return op == Op::Load || op == Op::F64Load || op == Op::Store || op == Op::F64Store;
+}
+
+// arm 裡最後一個 LocalSet(local) 寫的值（舊 id），沒寫過是 -1
+struct LocalWrite {
+    int set = -1;           // 留下來照抄的 LocalSet
+    int then_val = -1, else_val = -1;
+    int phi = -1;           // 對到的 merge phi；兩邊寫一樣的值時是 -1
+};
+
+struct Candidate {
+    int ifIdx = -1, elseIdx = -1, endIdx = -1;
+    int phiBegin = -1, phiEnd = -1;   // [phiBegin, phiEnd] 是 merge phi
+    std::map<int, LocalWrite> writes;
+};
+
+class IfConverter {
+public:
+    explicit IfConverter(const ValueIR& values)
+        : values_(values), match_(matchRegions(values)) {}
+
+    bool plan(int ifIdx, Candidate& c) const;
+
+private:
+    std::string addressKey(int id, int depth) const;
+    bool dominates(int x, int at) const;
+    bool safeToSpeculate(int load, int ifIdx) const;
+
+    const ValueIR& values_;
+    std::vector<int> match_;
+};
+
+// 位址的結構 key：arm 裡重算的 `path + (i * n + j) * 4` 跟條件裡讀的要一樣。
+// 純運算往下拆，Param / 常數照值，其他節點照 SSA id。
+std::string IfConverter::addressKey(int id, int depth) const {
+    if (id < 0 || depth > 16) return "";
+    const Value& v = values_[id];
+    switch (v.op) {
+    case Op::Param: return "p" + std::to_string(v.paramIndex);
+    case Op::I32Const: return "c" + std::to_string(v.constValue);
+    case Op::I64Const: return "C" + std::to_string(v.constValue);
+    default: break;
+    }
+    if (isPureOp(v.op) && v.op != Op::F64Const) {
+        std::string key = std::string(opToString(v.op)) + "(";
+        bool ok = true;
+        forEachOperand(v, [&](int ref) {
+            std::string sub = addressKey(ref, depth + 1);
+            if (sub.empty()) ok = false;
+            key += sub + ",";
+        });
+        return ok ? key + ")" : "";
+    }
+    return "v" + std::to_string(id);
+}
+
+// 每次走到 at 之前 x 都一定先跑過：中間沒有把 x 關起來的 End，也沒有
+// x 那個 If 的 Else
+bool IfConverter::dominates(int x, int at) const {
+    int depth = 0;
+    for (int k = x + 1; k < at; k++) {
+        const Value& v = values_[k];
+        if (v.op == Op::If || v.op == Op::Loop) {
+            depth++;
+        } else if (v.op == Op::Else) {
+            if (depth == 0) return false;
+        } else if (v.op == Op::End && v.constValue != 1) {
+            if (depth == 0) return false;
+            depth--;
+        }
+    }
+    return true;
+}
+
+// arm 裡的 load 提到 If 外面不會多出 trap：If 之前一定先讀 / 寫過同一個位置
+bool IfConverter::safeToSpeculate(int load, int ifIdx) const {
+    const Value& l = values_[load];
+    std::string key = addressKey(l.lhs, 0);
+    if (key.empty()) return false;
+    for (int x = 0; x < ifIdx; x++) {
+        const Value& v = values_[x];
+        if (!isAccess(v.op) || v.lanes > 1) continue;
+        if (v.mem_offset != l.mem_offset || memAccessBytes(v) != memAccessBytes(l)) continue;
+        if (addressKey(v.lhs, 0) != key) continue;
+        if (dominates(x, ifIdx)) return true;
+    }
+    return false;
+}
+
+bool IfConverter::plan(int ifIdx, Candidate& c) const {
+    const int end = match_[ifIdx];
+    if (end < 0 || values_[ifIdx].lhs < 0) return false;
+    c.ifIdx = ifIdx;
+    c.endIdx = end;
+
+    int cost = 0;
+    bool inElse = false;
+    for (int k = ifIdx + 1; k < end; k++) {
+        const Value& v = values_[k];
+        if (v.lanes > 1) return false;
+        if (v.op == Op::Else && match_[k] == ifIdx) {
+            c.elseIdx = k;
+            inElse = true;
+            continue;
+        }
+        if (v.op == Op::LocalSet) {
+            LocalWrite& w = c.writes[v.local_index];
+            w.set = k;
+            (inElse ? w.else_val : w.then_val) = v.lhs;
+            continue;
+        }
+        if (v.op == Op::Param || isConstOp(v.op)) continue;
+        if (v.op == Op::Load || v.op == Op::F64Load) {
+            if (!safeToSpeculate(k, ifIdx)) return false;
+        } else if (!isPureOp(v.op)) {
+            // 巢狀的 If / Loop、store、call、會 trap 的除法都不行
+            return false;
+        }
+        if (++cost > kMaxSpeculated) return false;
+    }
+
+    int k = end + 1;
+    while (k < (int)values_.size() && values_[k].op == Op::Phi && values_[k].local_index < 0) {
+        const Value& p = values_[k];
+        if (p.operands.size() != 2 || p.operands[0] < 0 || p.operands[1] < 0 || p.lanes > 1) return false;
+        k++;
+    }
+    if (k == end + 1) return false;
+    c.phiBegin = end + 1;
+    c.phiEnd = k - 1;
+
+    // arm 裡寫的 local 對到 merge phi：另一邊沒寫時 phi 的那個 operand 是
+    // If 之前的值，所以只比有寫的那邊。對不到、對到好幾個就不換
+    std::set<int> claimed;
+    for (auto& [local, w] : c.writes) {
+        if (w.then_val >= 0 && w.then_val == w.else_val) continue;
+        int found = -1;
+        for (int p = c.phiBegin; p <= c.phiEnd; p++) {
+            const Value& phi = values_[p];
+            if (w.then_val >= 0 && phi.operands[0] != w.then_val) continue;
+            if (w.else_val >= 0 && phi.operands[1] != w.else_val) continue;
+            if (found >= 0) return false;
+            found = p;
+        }
+        if (found < 0 || !claimed.insert(found).second) return false;
+        w.phi = found;
+    }
+    return true;
+}
+
+// scalar 的 Phi / Param 沒記型別：Param 看函式簽章，Phi 往前看它的
+// operand（loop phi 的 back-edge 是 forward ref，不看）
+ValueType valueType(const ValueIR& values, const std::vector<ValueType>& paramTypes, int id,
+                    int depth) {
+    const Value& v = values[id];
+    if (v.op == Op::Param)
+        return v.paramIndex >= 0 && v.paramIndex < (int)paramTypes.size()
+             ? paramTypes[v.paramIndex] : ValueType::I32;
+    if (v.op != Op::Phi) return resultTypeOf(v);
+    if (depth < 16)
+        for (int ref : v.operands)
+            if (ref >= 0 && ref < id) return valueType(values, paramTypes, ref, depth + 1);
+    return v.type;
+}
+
+// merge phi 的型別：先看不是常數的那一邊，兩邊都是常數才看常數
+ValueType selectType(const ValueIR& values, const std::vector<ValueType>& paramTypes,
+                     const Value& phi) {
+    for (int ref : phi.operands)
+        if (!isConstOp(values[ref].op)) return valueType(values, paramTypes, ref, 0);
+    return resultTypeOf(values[phi.operands[0]]);
+}
+
+} // namespace
+
+int convertIfsToSelects(ValueIR& values, const std::vector<ValueType>& paramTypes) {
+    IfConverter ic(values);
+    std::map<int, Candidate> cands;
+    for (int i = 0; i < (int)values.size(); i++) {
+        if (values[i].op != Op::If) continue;
+        Candidate c;
+        if (ic.plan(i, c)) cands.emplace(i, std::move(c));
+    }
+    if (cands.empty()) return 0;
+
+    // 整個拿掉的節點：If / Else / End 跟 arm 裡的 LocalSet
+    std::vector<char> drop(values.size(), 0);
+    std::map<int, const Candidate*> phiEnds;
+    for (const auto& [i, c] : cands) {
+        drop[c.ifIdx] = drop[c.endIdx] = 1;
+        if (c.elseIdx >= 0) drop[c.elseIdx] = 1;
+        for (int k = c.ifIdx + 1; k < c.endIdx; k++)
+            if (values[k].op == Op::LocalSet) drop[k] = 1;
+        phiEnds[c.phiEnd] = &c;
+    }
+
+    ValueIR out;
+    std::vector<int> map(values.size(), -1);
+    std::map<int, int> condOf;   // merge phi → 條件（舊 id）
+    for (const auto& [i, c] : cands)
+        for (int p = c.phiBegin; p <= c.phiEnd; p++) condOf[p] = values[c.ifIdx].lhs;
+    struct Fixup { int node; size_t k; int ref; };
+    std::vector<Fixup> fixups;
+    auto emit = [&](Value v) {
+        v.id = (int)out.size();
+        out.push_back(v);
+        return v.id;
+    };
+
+    for (int i = 0; i < (int)values.size(); i++) {
+        if (drop[i]) continue;
+        Value v = values[i];
+
+        auto cit = condOf.find(i);
+        if (cit != condOf.end()) {
+            Value sel;
+            sel.op = Op::Select;
+            sel.type = selectType(values, paramTypes, v);
+            sel.operands = {map[cit->second], map[v.operands[0]], map[v.operands[1]]};
+            map[i] = emit(sel);
+        } else {
+            if (v.op == Op::Phi && v.local_index >= 0) {
+                for (size_t k = 0; k < v.operands.size(); k++) {
+                    int ref = v.operands[k];
+                    if (ref >= i) fixups.push_back({(int)out.size(), k, ref});
+                    else if (ref >= 0) v.operands[k] = map[ref];
+                }
+            } else {
+                forEachOperand(v, [&](int& ref) { ref = map[ref]; });
+            }
+            forEachControlRef(v, [&](int& ref) { ref = map[ref]; });
+            map[i] = emit(v);
+        }
+
+        // bridge 的 local 變數照舊更新成挑出來的值
+        auto eit = phiEnds.find(i);
+        if (eit == phiEnds.end()) continue;
+        for (const auto& [local, w] : eit->second->writes) {
+            Value set = values[w.set];
+            set.lhs = w.phi >= 0 ? map[w.phi] : map[w.then_val];
+            emit(set);
+        }
+    }
+    for (const Fixup& f : fixups) out[f.node].operands[f.k] = map[f.ref];
+
+    values = cleanupValueIR(out);
+    return (int)cands.size();
+}
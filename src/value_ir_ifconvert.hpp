@@ -0,0 +1,36 @@
+#pragma once
+
+#include "value_ir.hpp"
+
+// ============================================================
+// If-conversion：只算出值的小 if / else 換成 Select
+// ============================================================
+//
+// rewriteBlockBrIf 把 clang -O0 的三元運算式還原成 If / Else，每一邊只是
+// 算個值 LocalSet 進同一個 local，End 後面的 merge phi 挑一個。floyd-warshall
+// 的 `path[i][j] < sum ? path[i][j] : sum` 每一輪都是這樣，bridge 產生
+// ir_IF / ir_MERGE，分支猜不準時很貴：
+//
+//   v = If(c)                          ...then 的運算
+//     ...then 的運算                    ...else 的運算
+//     LocalSet(8, a)            →       p = Select(c, a, b)
+//   Else                                 LocalSet(8, p)
+//     ...else 的運算
+//     LocalSet(8, b)
+//   End(if)
+//   p = Phi(a, b)
+//
+// 兩邊都先算、最後用 Select（bridge 的 ir_COND，x86 上是 cmov）挑。條件：
+//   - arm 裡沒有巢狀的 If / Loop，只有純運算（不會 trap）、Param、常數、
+//     LocalSet；load 只能讀 If 之前一定先存取過的同一個位置（同樣的位址
+//     算式、offset、寬度），多讀一次不會 trap
+//   - 兩邊加起來最多 kMaxSpeculated 個運算，多算的比省下的分支便宜
+//   - End 後面至少一個 merge phi；arm 裡的 LocalSet 都對得到唯一的 phi
+//     （改成在 Select 後面 LocalSet 那個 Select）
+//
+// 一次改寫所有最內層（arm 裡沒有巢狀 If）的候選；巢狀的 if / else 換掉
+// 裡面那層之後外層就變成候選，呼叫端可以再跑一次。
+// 回傳換掉的 If 數；有改寫時 values 重建並跑過 cleanupValueIR。
+// paramTypes 是函式簽章（ModuleFunction::paramTypes），Select 的型別要
+// 從 Param 來時用。
+int convertIfsToSelects(ValueIR& values, const std::vector<ValueType>& paramTypes);
@@ -0,0 +1,260 @@
+#include "value_ir_inline.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+// callee 能不能直接接進 caller，以及接的時候需要的資訊
+struct CalleeShape {
+    bool ok = false;
+    int cost = 0;
+    int firstReturn = -1;    // 第一個 Return；之後只會有 Return（隱含的 void return）
+    int retValue = -1;       // 該 Return 的值，-1 = void
+    bool hasLoop = false;
+};
+
+CalleeShape analyzeCallee(const ModuleFunction& f) {
+    CalleeShape s;
+    const ValueIR& values = f.values;
+    for (size_t i = 0; i < values.size(); i++) {
+        const Value& v = values[i];
+        if (v.op == Op::Return) {
+            if (s.firstReturn < 0) s.firstReturn = (int)i;
+            continue;
+        }
+        if (s.firstReturn >= 0) return s;         // Return 後面還有節點：多出口
+        if (v.op == Op::Unreachable) return s;
+        if (v.op == Op::Param && v.paramIndex >= (int)f.numParams) return s;
+        if (v.op == Op::Loop) s.hasLoop = true;
+    }
+    if (s.firstReturn < 0) return s;
+    s.retValue = values[s.firstReturn].lhs;
+    s.cost = inlineCost(values);
+    s.ok = true;
+    return s;
+}
+
+// 用過的最大 local 編號（idx >= 2000 是 ir_bridge 的 wasm_global_N，不算）
+int maxLocalIndex(const ModuleFunction& f) {
+    int m = (int)f.numParams - 1;
+    for (const auto& v : f.values) {
+        int idx = -1;
+        if (v.op == Op::Param || v.op == Op::LocalGet ||
+            v.op == Op::LocalSet || v.op == Op::LocalTee)
+            idx = v.paramIndex;
+        else if (v.op == Op::Phi)
+            idx = v.local_index;
+        if (idx < 2000) m = std::max(m, idx);
+    }
+    return m;
+}
+
+// 把 callee 接在 caller[site]（Call）的位置，回傳新的 caller
+ValueIR spliceCall(const ValueIR& caller, int site, const ModuleFunction& callee,
+                   const CalleeShape& shape, int localBase) {
+    const std::vector<int> args = caller[site].operands;
+    const ValueIR& body = callee.values;
+
+    ValueIR out(caller.begin(), caller.begin() + site);
+    out.reserve(caller.size() + body.size() + 8);
+    auto emit = [&](Value v) {
+        v.id = (int)out.size();
+        out.push_back(std::move(v));
+        return (int)out.size() - 1;
+    };
+
+    // callee 有 loop 時，bridge 會透過 ir_VAR 讀 local（use_vload_entry）。
+    // 單獨編譯時 VAR 在函式入口被初始化成參數 / 0；展開後是 caller 的
+    // 新 local，要在這裡補上同樣的初始化（call site 在 loop 裡時每次
+    // 都要重設）。
+    if (shape.hasLoop) {
+        std::map<int, ValueType> vars;
+        for (const auto& v : body) {
+            if (v.op == Op::Phi && v.local_index >= 0 && !vars.count(v.local_index))
+                vars[v.local_index] = ValueType::I32;
+            if (v.op == Op::LocalSet && v.lhs >= 0 && v.lhs < (int)body.size())
+                if (!vars.count(v.paramIndex) || body[v.lhs].type != ValueType::I32)
+                    vars[v.paramIndex] = body[v.lhs].type;
+        }
+        std::map<ValueType, int> zeros;
+        for (const auto& [local, type] : vars) {
+            int init;
+            if (local < (int)args.size()) {
+                init = args[local];
+            } else {
+                auto z = zeros.find(type);
+                if (z == zeros.end()) {
+                    Value c;
+                    c.op = type == ValueType::F64 || type == ValueType::F32 ? Op::F64Const
+                         : type == ValueType::I64 ? Op::I64Const : Op::I32Const;
+                    c.type = type;
+                    z = zeros.emplace(type, emit(c)).first;
+                }
+                init = z->second;
+            }
+            Value set;
+            set.op = Op::LocalSet;
+            set.paramIndex = localBase + local;
+            set.lhs = init;
+            emit(set);
+        }
+    }
+
+    // callee 節點的新位置：Param 直接換成引數，其餘依序接在後面
+    std::vector<int> map(body.size(), -1);
+    int next = (int)out.size();
+    for (int k = 0; k < shape.firstReturn; k++)
+        map[k] = (body[k].op == Op::Param) ? args[body[k].paramIndex] : next++;
+
+    for (int k = 0; k < shape.firstReturn; k++) {
+        if (body[k].op == Op::Param) continue;
+        Value v = body[k];
+        auto remap = [&](int& ref) { ref = (ref < (int)map.size()) ? map[ref] : -1; };
+        forEachOperand(v, remap);
+        forEachControlRef(v, remap);
+        if (v.op == Op::LocalGet || v.op == Op::LocalSet || v.op == Op::LocalTee)
+            v.paramIndex += localBase;
+        if (v.op == Op::Phi && v.local_index >= 0)
+            v.local_index += localBase;
+        emit(std::move(v));
+    }
+
+    // caller 剩下的部分往後挪；所有對 call 的 use 改成 callee 的回傳值
+    int ret = (shape.retValue >= 0) ? map[shape.retValue] : -1;
+    int shift = (int)out.size() - site - 1;
+    std::vector<int> cmap(caller.size());
+    for (int j = 0; j < (int)caller.size(); j++)
+        cmap[j] = (j < site) ? j : (j == site) ? ret : j + shift;
+    auto remapCaller = [&](Value& v) {
+        auto r = [&](int& ref) { if (ref < (int)cmap.size()) ref = cmap[ref]; };
+        forEachOperand(v, r);
+        forEachControlRef(v, r);
+    };
+    for (int j = 0; j < site; j++) remapCaller(out[j]);
+    for (int j = site + 1; j < (int)caller.size(); j++) {
+        Value v = caller[j];
+        remapCaller(v);
+        emit(std::move(v));
+    }
+    return out;
+}
+
+} // namespace
+
+int inlineCost(const ValueIR& values) {
+    int cost = 0;
+    for (const auto& v : values) {
+        switch (v.op) {
+        case Op::Param: case Op::I32Const: case Op::I64Const: case Op::F64Const:
+        case Op::Return: case Op::Else: case Op::End: case Op::LocalSet:
+            break;
+        case Op::Call:
+            cost += 4 + (int)v.operands.size();   // 還留著的呼叫本身就不便宜
+            break;
+        default:
+            cost++;
+            break;
+        }
+    }
+    return cost;
+}
+
+int inlineCalls(std::vector<ModuleFunction>& funcs, const InlineOptions& opts) {
+    const int n = (int)funcs.size();
+    std::unordered_map<std::string, int> byName;
+    for (int f = 0; f < n; f++) byName[funcs[f].name] = f;
+
+    // ---- call graph ----
+    std::vector<std::vector<int>> callees(n);
+    std::vector<int> siteCount(n, 0);
+    for (int f = 0; f < n; f++)
+        for (const auto& v : funcs[f].values) {
+            if (v.op != Op::Call) continue;
+            auto it = byName.find(v.callee_name);
+            if (it == byName.end()) continue;   // import / 外部函式
+            callees[f].push_back(it->second);
+            siteCount[it->second]++;
+        }
+
+    // reaches[a][b]：a 經過零或多次呼叫會到 b。reaches[g][f] 成立時
+    // 把 g 展開進 f 會無窮展開（遞迴），跳過。
+    std::vector<std::vector<bool>> reaches(n, std::vector<bool>(n, false));
+    for (int f = 0; f < n; f++) {
+        std::vector<int> work{f};
+        reaches[f][f] = true;
+        while (!work.empty()) {
+            int x = work.back(); work.pop_back();
+            for (int c : callees[x])
+                if (!reaches[f][c]) { reaches[f][c] = true; work.push_back(c); }
+        }
+    }
+
+    // 由下往上：callee 先處理完，展開進 caller 的是已經展開過的版本
+    std::vector<int> order;
+    std::vector<bool> visited(n, false);
+    std::function<void(int)> visit = [&](int f) {
+        visited[f] = true;
+        for (int c : callees[f]) if (!visited[c]) visit(c);
+        order.push_back(f);
+    };
+    for (int f = 0; f < n; f++) if (!visited[f]) visit(f);
+
+    int total = 0;
+    for (int f : order) {
+        ValueIR& values = funcs[f].values;
+        int inlined = 0;
+        int loopDepth = 0;
+        int i = 0;
+        while (i < (int)values.size()) {
+            const Value& v = values[i];
+            if (v.op == Op::Loop) loopDepth++;
+            else if (v.op == Op::End && v.constValue == 0) loopDepth--;
+
+            auto it = (v.op == Op::Call) ? byName.find(v.callee_name) : byName.end();
+            if (it == byName.end() || reaches[it->second][f]) { i++; continue; }
+            const ModuleFunction& callee = funcs[it->second];
+            if (v.operands.size() != callee.numParams) { i++; continue; }
+            CalleeShape shape = analyzeCallee(callee);
+            if (!shape.ok) { i++; continue; }
+
+            // ---- cost model ----
+            int budget = opts.smallCalleeCost * (loopDepth > 0 ? opts.loopFactor : 1);
+            for (int a : v.operands)
+                if (a >= 0 && isConstOp(values[a].op)) budget += opts.constArgBonus;
+            // 唯一的 call site 展開後 callee 就可以丟掉、不會多一份程式碼；
+            // export 的函式外面還會呼叫，留著的那份照樣在
+            if (siteCount[it->second] == 1 && !callee.exported)
+                budget = std::max(budget, opts.singleSiteCost);
+            if (shape.cost > budget ||
+                (int)(values.size() + callee.values.size()) > opts.maxCallerSize) {
+                i++;
+                continue;
+            }
+            int localBase = maxLocalIndex(funcs[f]) + 1;
+            if (localBase + maxLocalIndex(callee) + 1 >= 2000) { i++; continue; }
+
+            // call site 數跟著更新：這個 site 沒了，callee 裡還留著的 call 多了一份
+            siteCount[it->second]--;
+            for (const auto& cv : callee.values) {
+                if (cv.op != Op::Call) continue;
+                auto c = byName.find(cv.callee_name);
+                if (c != byName.end()) siteCount[c->second]++;
+            }
+            size_t before = values.size();
+            values = spliceCall(values, i, callee, shape, localBase);
+            // 接進來的節點在 callee 裡已經處理過了，直接跳過
+            i += (int)(values.size() + 1 - before);
+            inlined++;
+        }
+        if (inlined > 0) {
+            values = cleanupValueIR(values);
+            total += inlined;
+        }
+    }
+    return total;
+}
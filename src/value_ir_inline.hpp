@@ -0,0 +1,35 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include <vector>
+
+// ============================================================
+// Inlining：把小函式 / 只被呼叫一次的函式展開進 caller
+// ============================================================
+//
+// CallNode 一律產生真正的 ir_CALL_N，而且不傳 __mem，熱迴圈裡的小
+// accessor 付的是呼叫成本加上「caller 看不到 callee 在做什麼」。這裡在
+// ValueIR 上直接把 callee 的節點接進 caller：
+//
+//   - callee 的 Param(k)   → call 的第 k 個引數
+//   - callee 的 local N    → caller 沒用過的新 local（LocalSet / loop phi）
+//   - callee 結尾的 Return → call 節點本身的值
+//
+// 依 call graph 由下往上處理（callee 先展開完才輪到 caller），互相遞迴
+// 的函式彼此不展開。callee 必須是單一出口（Return 只出現在最後）、沒有
+// Unreachable，才能直接接進 caller 的結構化控制流。
+
+struct InlineOptions {
+    int smallCalleeCost = 16;    // 任何 call site 都展開的 callee 大小上限
+    int singleSiteCost = 256;    // 整個 module 只有一個 call site、又沒有 export 時的上限
+    int loopFactor = 2;          // call site 在 loop 裡：小 callee 上限乘上這個
+    int constArgBonus = 4;       // 每個常數引數加的額度（展開後可折疊）
+    int maxCallerSize = 8192;    // caller 展開後的節點數上限
+};
+
+// callee 的大小：不算 Param / 常數 / Return / 結構標記這些不產生指令的節點
+int inlineCost(const ValueIR& values);
+
+// 對整個 module 做 inlining，回傳展開的 call site 數。
+// 被改過的函式最後會再跑一次 cleanupValueIR。
+int inlineCalls(std::vector<ModuleFunction>& funcs, const InlineOptions& opts = {});
@@ -0,0 +1,199 @@
+#include "value_ir_interchange.hpp"
+#include "value_ir_deps.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_rebuild.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+namespace {
+
+constexpr int64_t kCacheLine = 64;
+
+struct Plan {
+    std::vector<int> band;    // findLoops 的 index，原本的順序（外 → 內）
+    std::vector<int> order;   // 新的第 m 層是 band[order[m]]
+};
+
+// 一個存取在 loop 的一輪迭代裡往前走多少 bytes（cache line 為上限）
+int64_t strideCost(const AffineAccess& a, int loop) {
+    if (!a.affine) return kCacheLine;
+    int64_t stride = 0;
+    for (const auto& [t, c] : a.terms) {
+        if (t.first != loop || c == 0) continue;
+        if (!t.second.empty()) return kCacheLine;   // `i * n`
+        stride += c;
+    }
+    return std::min<int64_t>(std::llabs(stride), kCacheLine);
+}
+
+// header 裡的節點只用到自己的 iv、自己 header 的值與 nest 外面的值
+// （搬到別的位置也一樣）
+bool headerMovable(const ValueIR& values, const LoopShape& s, const LoopShape& outer) {
+    bool ok = true;
+    for (int i = s.header(); i < s.exitBr && ok; i++) {
+        if (i == s.iv) continue;
+        forEachOperand(values[i], [&](int ref) {
+            if (ref == s.iv || (ref >= s.header() && ref < s.exitBr)) return;
+            if (!isLoopInvariant(values, outer, ref)) ok = false;
+        });
+    }
+    return ok;
+}
+
+bool planNest(const ValueIR& values, const std::vector<LoopShape>& loops,
+              const DependenceAnalysis& deps, const std::vector<int>& band, Plan& plan) {
+    const LoopShape& outer = loops[band[0]];
+    const LoopShape& last = loops[band.back()];
+    if (!last.innermost || !loopNestSelfContained(values, outer)) return false;
+    for (int l : band)
+        if (!headerMovable(values, loops[l], outer)) return false;
+
+    std::vector<const AffineAccess*> accs;
+    for (const AffineAccess& a : deps.accesses())
+        if (a.node > last.loop && a.node < last.end) accs.push_back(&a);
+    if (accs.empty()) return false;
+
+    const size_t n = band.size();
+    std::vector<int64_t> cost(n, 0);
+    for (size_t k = 0; k < n; k++)
+        for (const AffineAccess* a : accs) cost[k] += strideCost(*a, band[k]);
+
+    // 最內層往外的 cost 字典序，越小越好
+    auto key = [&](const std::vector<int>& order) {
+        std::vector<int64_t> v;
+        for (size_t m = n; m-- > 0;) v.push_back(cost[order[m]]);
+        return v;
+    };
+    std::vector<int> identity(n);
+    std::iota(identity.begin(), identity.end(), 0);
+    std::vector<std::vector<int>> orders;
+    std::vector<int> order = identity;
+    do {
+        orders.push_back(order);
+    } while (std::next_permutation(order.begin(), order.end()));
+    std::stable_sort(orders.begin(), orders.end(),
+                     [&](const std::vector<int>& a, const std::vector<int>& b) { return key(a) < key(b); });
+
+    const auto base = key(identity);
+    std::vector<Dependence> ds = deps.dependences(outer.loop, outer.end);
+    for (const auto& o : orders) {
+        if (!(key(o) < base)) return false;
+        if (!permutationPreservesDependences(ds, band, o)) continue;
+        plan.band = band;
+        plan.order = o;
+        return true;
+    }
+    return false;
+}
+
+// ============================================================
+// 重建
+// ============================================================
+//
+// 新的順序一層層開 loop（原本那一層的 phi、header、Br_if），最內層依序
+// 放原本每一層的 pre、最內層的 body、每一層的 post，再一層層關起來；
+// iv 的遞增在各自那一層的 back-edge 前面重算。
+
+class Interchanger : public ValueIRRebuilder {
+public:
+    Interchanger(const ValueIR& in, const std::vector<LoopShape>& loops, const std::vector<Plan>& plans)
+        : ValueIRRebuilder(in), loops_(loops), plans_(plans) {}
+
+    ValueIR run() {
+        std::vector<std::pair<int, int>> regions;
+        for (const Plan& p : plans_) {
+            const LoopShape& s = loops_[p.band[0]];
+            regions.push_back({s.loop, s.end});
+        }
+        return ValueIRRebuilder::run(regions);
+    }
+
+private:
+    void emitRegion(size_t k) override;
+
+    const std::vector<LoopShape>& loops_;
+    const std::vector<Plan>& plans_;
+};
+
+void Interchanger::emitRegion(size_t k) {
+    const Plan& p = plans_[k];
+    const size_t n = p.band.size();
+
+    // header 裡的 Param / 常數跟位置無關，先拿出來給每一層的入口值用
+    for (int l : p.band) {
+        const LoopShape& s = loops_[l];
+        for (int i = s.header(); i < s.exitBr; i++)
+            if (in_[i].op == Op::Param || isConstOp(in_[i].op)) copyVerbatim(i, i, nullptr);
+    }
+    for (int l : p.band) {
+        int ref = in_[loops_[l].iv].operands[0];
+        if (ref > loops_[p.band[0]].loop && map_[ref] < 0) copyVerbatim(ref, ref, nullptr);
+    }
+
+    std::vector<int> phis(n);
+    for (size_t m = 0; m < n; m++) {
+        const LoopShape& s = loops_[p.band[p.order[m]]];
+        map_[s.loop] = emit(in_[s.loop]);
+        Value phi = in_[s.iv];
+        phi.operands = {mapOutside(phi.operands[0])};
+        phis[m] = emit(phi);
+        map_[s.iv] = phis[m];
+        copyUnmapped(s.header(), s.exitBr - 1, false);
+        Value exit = in_[s.exitBr];
+        exit.lhs = map_[exit.lhs];
+        exit.rhs = map_[s.loop];
+        map_[s.exitBr] = emit(exit);
+    }
+
+    for (size_t l = 0; l + 1 < n; l++) {
+        const LoopShape& s = loops_[p.band[l]];
+        copyUnmapped(s.bodyBegin(), loops_[p.band[l + 1]].loop - 1, true);
+    }
+    const LoopShape& last = loops_[p.band.back()];
+    copyUnmapped(last.bodyBegin(), last.backBr - 1, false);
+    for (size_t l = n - 1; l-- > 0;) {
+        const LoopShape& s = loops_[p.band[l]];
+        copyUnmapped(loops_[p.band[l + 1]].end + 1, s.backBr - 1, true);
+    }
+
+    for (size_t m = n; m-- > 0;) {
+        const LoopShape& s = loops_[p.band[p.order[m]]];
+        int one = emitOp(Op::I32Const, -1, -1, 1);
+        setBack(phis[m], emitOp(Op::Add, phis[m], one));
+        Value back = in_[s.backBr];
+        back.lhs = map_[s.loop];
+        back.rhs = phis[m];
+        map_[s.backBr] = emit(back);
+        map_[s.end] = emit(in_[s.end]);
+    }
+}
+
+} // namespace
+
+int interchangeLoops(ValueIR& values, const AliasAnalysis& aa) {
+    for (const Value& v : values)
+        if (v.op == Op::Phi && v.use_vload_entry) return 0;
+    std::vector<LoopShape> loops = findLoops(values);
+    if (loops.empty()) return 0;
+    DependenceAnalysis deps(values, loops, aa);
+
+    std::vector<Plan> plans;
+    int skipUntil = -1;
+    for (int k = 0; k < (int)loops.size(); k++) {
+        if (loops[k].loop < skipUntil) continue;
+        std::vector<int> band = rectangularBand(values, loops, k);
+        if (band.size() < 2) continue;
+        Plan plan;
+        if (!planNest(values, loops, deps, band, plan)) continue;
+        plans.push_back(std::move(plan));
+        skipUntil = loops[k].end;
+    }
+    if (plans.empty()) return 0;
+
+    ValueIR out = Interchanger(values, loops, plans).run();
+    values = cleanupValueIR(out);
+    return (int)plans.size();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+
+// ============================================================
+// Loop interchange：讓最內層 loop 的記憶體存取是連續的
+// ============================================================
+//
+// atax / bicg / mvt 的 `for (i) for (j) ... A[j][i]` 每一輪內層迭代跳
+// 一整列，每次都是新的 cache line。把 loop 的順序換掉，最內層變成
+// stride 1：
+//
+//   for (i) for (j) x[i] += A[j][i]     →     for (j) for (i) x[i] += A[j][i]
+//
+// 對象是 value_ir_loops.hpp 的 rectangularBand，最後一層是最內層 loop。
+// 上層 body 裡的純運算都搬到最內層（之後由 CSE / GCM 提出去）。
+//
+// cost model：每個 loop 放在最內層時，band 裡每個存取每一輪碰到的新
+// 資料量（stride 的 bytes，最多一條 cache line；stride 含參數時算一整條，
+// 跟這個 loop 無關時是 0）。順序從最內層往外依 cost 由小到大排；不合法
+// （DependenceAnalysis 的相依換完之後方向變負）時試下一個，比原本的
+// 順序好才換。
+
+// 回傳換了順序的 nest 數；有改寫時 values 重建並跑過 cleanupValueIR。
+int interchangeLoops(ValueIR& values, const AliasAnalysis& aa);
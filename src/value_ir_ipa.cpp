@@ -0,0 +1,327 @@
+#include "value_ir_ipa.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+std::unordered_map<std::string, int> indexByName(const std::vector<ModuleFunction>& funcs) {
+    std::unordered_map<std::string, int> byName;
+    for (int f = 0; f < (int)funcs.size(); f++) byName[funcs[f].name] = f;
+    return byName;
+}
+
+// 函式本身（不算 callee）的副作用
+unsigned localEffects(const Value& v) {
+    switch (v.op) {
+    case Op::Load: case Op::F64Load: case Op::MemorySize:
+        return CallReadsMemory;
+    case Op::Store: case Op::F64Store: case Op::MemoryFill:
+        return CallWritesMemory;
+    case Op::MemoryCopy:
+        return CallReadsMemory | CallWritesMemory;
+    case Op::GlobalGet:
+        return CallReadsGlobals;
+    case Op::GlobalSet:
+        return CallWritesGlobals;
+    // idx >= 2000 的 local 是 ir_bridge 的 wasm_global_N
+    case Op::LocalGet:
+        return v.paramIndex >= 2000 ? (unsigned)CallReadsGlobals : 0u;
+    case Op::LocalSet: case Op::LocalTee:
+        return v.paramIndex >= 2000 ? (unsigned)CallWritesGlobals : 0u;
+    case Op::Unreachable:
+        return CallMayTrap;
+    default:
+        return 0;
+    }
+}
+
+// 在最前面插入 consts，所有 ref 往後挪。常數在 bridge 裡跟位置無關，
+// 放最前面就一定在所有 use 之前。
+void prependConsts(ValueIR& values, const std::vector<Value>& consts) {
+    const int k = (int)consts.size();
+    ValueIR out;
+    out.reserve(values.size() + k);
+    for (const auto& c : consts) {
+        out.push_back(c);
+        out.back().id = (int)out.size() - 1;
+    }
+    for (auto& v : values) {
+        Value nv = std::move(v);
+        auto shift = [&](int& ref) { ref += k; };
+        forEachOperand(nv, shift);
+        forEachControlRef(nv, shift);
+        nv.id = (int)out.size();
+        out.push_back(std::move(nv));
+    }
+    values = std::move(out);
+}
+
+// 常數引數：沒有 export 的函式，所有 call site 的第 k 個引數都是同一個常數
+int propagateConstArgs(std::vector<ModuleFunction>& funcs,
+                       const std::unordered_map<std::string, int>& byName) {
+    const int n = (int)funcs.size();
+    // argConst[f][k]：第一個 call site 傳的常數（id = -1 表示還沒看到）；valid[f][k] = false 表示
+    // 不是常數或不一致
+    std::vector<std::vector<Value>> argConst(n);
+    std::vector<std::vector<bool>> valid(n);
+    std::vector<bool> called(n, false);
+    for (int f = 0; f < n; f++) {
+        argConst[f].resize(funcs[f].numParams);
+        valid[f].assign(funcs[f].numParams, !funcs[f].exported);
+    }
+    for (const auto& caller : funcs)
+        for (const auto& v : caller.values) {
+            if (v.op != Op::Call) continue;
+            auto it = byName.find(v.callee_name);
+            if (it == byName.end()) continue;
+            int g = it->second;
+            called[g] = true;
+            if (v.operands.size() != funcs[g].numParams) {
+                valid[g].assign(funcs[g].numParams, false);
+                continue;
+            }
+            for (size_t k = 0; k < v.operands.size(); k++) {
+                if (!valid[g][k]) continue;
+                int a = v.operands[k];
+                if (a < 0 || !isConstOp(caller.values[a].op)) { valid[g][k] = false; continue; }
+                if (argConst[g][k].id < 0) argConst[g][k] = caller.values[a];   // 第一個
+                else if (!sameConst(argConst[g][k], caller.values[a])) valid[g][k] = false;
+            }
+        }
+
+    int changed = 0;
+    for (int g = 0; g < n; g++) {
+        if (!called[g]) continue;
+        for (auto& v : funcs[g].values) {
+            if (v.op != Op::Param || v.paramIndex < 0 ||
+                v.paramIndex >= (int)funcs[g].numParams || !valid[g][v.paramIndex])
+                continue;
+            turnIntoConst(v, argConst[g][v.paramIndex]);
+            changed++;
+        }
+    }
+    return changed;
+}
+
+// 回傳常數：call 沒有副作用就整個換成常數，有的話 call 留著、use 改成常數
+int propagateConstReturns(ModuleFunction& caller, const std::vector<ModuleFunction>& funcs,
+                          const std::vector<FunctionSummary>& sums,
+                          const std::unordered_map<std::string, int>& byName) {
+    ValueIR& values = caller.values;
+    std::vector<bool> hasUse(values.size(), false);
+    for (const auto& v : values)
+        forEachOperand(v, [&](int ref) { if (ref >= 0) hasUse[ref] = true; });
+
+    int changed = 0;
+    std::vector<Value> consts;
+    std::vector<int> repl(values.size(), -1);
+    for (size_t i = 0; i < values.size(); i++) {
+        Value& v = values[i];
+        if (v.op != Op::Call || !hasUse[i]) continue;
+        auto it = byName.find(v.callee_name);
+        if (it == byName.end() || !sums[it->second].returnsConst) continue;
+        if (v.operands.size() != funcs[it->second].numParams) continue;
+        const Value& c = sums[it->second].constReturn;
+        if (isRemovableCall(v)) {
+            turnIntoConst(v, c);
+        } else {
+            repl[i] = (int)consts.size();   // 第幾個常數 = prepend 之後的位置
+            consts.push_back(c);
+        }
+        changed++;
+    }
+    if (consts.empty()) return changed;
+
+    prependConsts(values, consts);
+    const int k = (int)consts.size();
+    for (auto& v : values)
+        forEachOperand(v, [&](int& ref) {
+            if (ref >= k && repl[ref - k] >= 0) ref = repl[ref - k];
+        });
+    return changed;
+}
+
+} // namespace
+
+std::vector<FunctionSummary> summarizeFunctions(const std::vector<ModuleFunction>& funcs) {
+    const int n = (int)funcs.size();
+    auto byName = indexByName(funcs);
+
+    std::vector<unsigned> own(n, 0);
+    std::vector<std::vector<int>> callees(n);
+    for (int f = 0; f < n; f++)
+        for (const auto& v : funcs[f].values) {
+            own[f] |= localEffects(v);
+            if (v.op != Op::Call) continue;
+            auto it = byName.find(v.callee_name);
+            if (it == byName.end()) own[f] |= CallEffectsUnknown;   // import
+            else callees[f].push_back(it->second);
+        }
+
+    std::vector<FunctionSummary> sums(n);
+    for (int f = 0; f < n; f++) sums[f].effects = own[f];
+
+    // 值的型別；Void = 還不知道（callee 的摘要還沒收斂）。Param / Phi 的
+    // type 沒填（一律 I32），Param 看 signature、Phi 看流進來的值
+    std::function<ValueType(int, int)> typeOf = [&](int f, int id) {
+        const ModuleFunction& fn = funcs[f];
+        const Value& r = fn.values[id];
+        switch (r.op) {
+        case Op::Call: {
+            auto it = byName.find(r.callee_name);
+            return it == byName.end() ? r.type : sums[it->second].returnType;
+        }
+        case Op::Param:
+            return r.paramIndex >= 0 && r.paramIndex < (int)fn.paramTypes.size()
+                 ? fn.paramTypes[r.paramIndex] : ValueType::I32;
+        case Op::Phi:
+            // 只往前看（入口值 / if 的兩邊），loop 的 back-edge 值不會比入口先知道
+            for (int o : r.operands) {
+                if (o < 0 || o >= id) continue;
+                ValueType t = typeOf(f, o);
+                if (t != ValueType::Void) return t;
+            }
+            return ValueType::Void;
+        default:
+            return resultTypeOf(r);
+        }
+    };
+
+    // 回傳型別：Return 的值是另一個 call 時要看 callee 的摘要，一起收斂
+    auto returnTypeOf = [&](int f) {
+        for (const auto& v : funcs[f].values) {
+            if (v.op != Op::Return || v.lhs < 0) continue;
+            ValueType t = typeOf(f, v.lhs);
+            if (t != ValueType::Void) return t;
+        }
+        return ValueType::Void;
+    };
+
+    // 副作用只會變多、型別只會從 Void 變成確定值，fixed point 一定收斂
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int f = 0; f < n; f++) {
+            unsigned e = own[f];
+            for (int g : callees[f]) e |= sums[g].effects;
+            ValueType t = returnTypeOf(f);
+            if (e != sums[f].effects || t != sums[f].returnType) {
+                sums[f].effects = e;
+                sums[f].returnType = t;
+                changed = true;
+            }
+        }
+    }
+
+    // 回傳常數：每個有值的 Return 都指向同一個常數
+    for (int f = 0; f < n; f++) {
+        const ValueIR& values = funcs[f].values;
+        const Value* c = nullptr;
+        bool ok = true;
+        for (const auto& v : values) {
+            if (v.op != Op::Return || v.lhs < 0) continue;
+            const Value& r = values[v.lhs];
+            if (!isConstOp(r.op) || (c && !sameConst(*c, r))) { ok = false; break; }
+            c = &r;
+        }
+        if (ok && c) {
+            sums[f].returnsConst = true;
+            sums[f].constReturn = *c;
+        }
+    }
+    return sums;
+}
+
+void annotateCalls(std::vector<ModuleFunction>& funcs, const std::vector<FunctionSummary>& sums) {
+    auto byName = indexByName(funcs);
+    for (auto& f : funcs)
+        for (auto& v : f.values) {
+            if (v.op != Op::Call) continue;
+            auto it = byName.find(v.callee_name);
+            if (it == byName.end()) continue;
+            v.call_effects = sums[it->second].effects;
+            v.type = sums[it->second].returnType;
+        }
+}
+
+void annotateCallReturnTypes(std::vector<ModuleFunction>& funcs,
+                             const std::vector<FunctionSummary>& sums) {
+    auto byName = indexByName(funcs);
+    for (auto& f : funcs)
+        for (auto& v : f.values) {
+            if (v.op != Op::Call) continue;
+            auto it = byName.find(v.callee_name);
+            if (it == byName.end()) continue;
+            ValueType t = sums[it->second].returnType;
+            if (t == ValueType::I64 || t == ValueType::F32 || t == ValueType::F64) v.type = t;
+        }
+}
+
+void annotateCallMemory(std::vector<ModuleFunction>& funcs) {
+    auto byName = indexByName(funcs);
+    // pass_memory 會讓 caller 自己也變成要 __mem；往上傳到不再有變化
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto& f : funcs) {
+            if (f.vector.isKernel) continue;
+            for (auto& v : f.values) {
+                if (v.op != Op::Call || v.pass_memory) continue;
+                auto it = byName.find(v.callee_name);
+                if (it == byName.end() || funcs[it->second].vector.isKernel) continue;
+                if (!usesMemoryParam(funcs[it->second].values)) continue;
+                v.pass_memory = true;
+                changed = true;
+            }
+        }
+    }
+}
+
+int propagateConstantsInterprocedural(std::vector<ModuleFunction>& funcs,
+                                      const std::vector<FunctionSummary>& sums) {
+    auto byName = indexByName(funcs);
+    int total = 0;
+    // 換進來的常數可能又變成下一層的常數引數；每一輪至少多往下傳一層
+    for (size_t round = 0; round <= funcs.size(); round++) {
+        int changed = propagateConstArgs(funcs, byName);
+        for (auto& f : funcs)
+            changed += propagateConstReturns(f, funcs, sums, byName);
+        if (changed == 0) break;
+        total += changed;
+    }
+    if (total > 0)
+        for (auto& f : funcs) f.values = cleanupValueIR(f.values);
+    return total;
+}
+
+void dumpFunctionSummaries(const std::vector<ModuleFunction>& funcs,
+                           const std::vector<FunctionSummary>& sums) {
+    static const char* const kTypeNames[] = { "i32", "i64", "f32", "f64", "void" };
+    for (size_t f = 0; f < funcs.size(); f++) {
+        const FunctionSummary& s = sums[f];
+        std::cout << "// " << funcs[f].name << ": ";
+        if (s.effects == 0) std::cout << "pure";
+        else if (s.effects == CallEffectsUnknown) std::cout << "unknown";
+        else {
+            const char* sep = "";
+            auto flag = [&](unsigned bit, const char* name) {
+                if (s.effects & bit) { std::cout << sep << name; sep = ","; }
+            };
+            flag(CallReadsMemory, "reads-mem");
+            flag(CallWritesMemory, "writes-mem");
+            flag(CallReadsGlobals, "reads-globals");
+            flag(CallWritesGlobals, "writes-globals");
+            flag(CallMayTrap, "traps");
+        }
+        std::cout << "  ret=" << kTypeNames[(int)s.returnType];
+        if (s.returnsConst) {
+            std::cout << "  const-ret=";
+            if (s.constReturn.op == Op::F64Const) std::cout << s.constReturn.fconst;
+            else std::cout << s.constReturn.constValue;
+        }
+        if (funcs[f].exported) std::cout << "  exported";
+        std::cout << "\n";
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include <vector>
+
+// ============================================================
+// Interprocedural analysis：副作用摘要 + 常數引數 / 回傳值傳播
+// ============================================================
+//
+// lowerWasmToSsa 一次只看一個函式，Call 對後面的 pass 來說是什麼都可能
+// 做的黑盒子：load-elim 遇到就清空、DCE 不敢刪。這裡在整個 module 上
+// 沿著 call graph 算每個函式的摘要：
+//
+//   - 副作用（CallEffect）：讀 / 寫記憶體、讀 / 寫 global、unreachable。
+//     遞迴（含互相遞迴）用 fixed point 收斂；import 一律 unknown。
+//   - 回傳型別：標回 Call 節點，bridge 才能用正確的 ir_CALL 型別。
+//   - 回傳常數：每個 Return 都回傳同一個常數時，call 的結果直接換成常數。
+//
+// 以及常數引數傳播：沒有 export 的函式，module 裡每個 call site 的第 k
+// 個引數都是同一個常數（PolyBench 的問題大小常常這樣傳），callee 裡的
+// Param(k) 就換成那個常數。函式簽章不變，caller 照樣傳。
+
+struct FunctionSummary {
+    unsigned effects = CallEffectsUnknown;
+    ValueType returnType = ValueType::Void;
+    bool returnsConst = false;
+    Value constReturn;          // returnsConst 時：回傳的常數節點（I32/I64/F64Const）
+};
+
+// funcs[i] 的摘要在回傳值的第 i 個
+std::vector<FunctionSummary> summarizeFunctions(const std::vector<ModuleFunction>& funcs);
+
+// 把摘要標到每個 Call 節點上（call_effects、type）。callee 不在 module 裡的不動。
+void annotateCalls(std::vector<ModuleFunction>& funcs,
+                   const std::vector<FunctionSummary>& sums);
+
+// 只標 bridge 一定要知道的回傳型別（i64 / f32 / f64）；call_effects 維持
+// Unknown，void / i32 的 call 不動。沒有 pass 要看摘要時用這個。
+void annotateCallReturnTypes(std::vector<ModuleFunction>& funcs,
+                             const std::vector<FunctionSummary>& sums);
+
+// 呼叫 module 裡要 __mem 的函式（自己有 load / store，或再往下呼叫要 __mem
+// 的函式），Call 標上 pass_memory，bridge 才會把 __mem 當第一個引數傳下去。
+// 要在所有單函式 pass 跑完之後、bridge 之前呼叫：callee 的 load / store
+// 可能被 pass 刪光。kernel（vector.isKernel）不經過 bridge，不動。
+void annotateCallMemory(std::vector<ModuleFunction>& funcs);
+
+// 常數引數 / 回傳常數傳播，重複到不再有變化。回傳被換成常數的節點數；
+// 有改到的函式最後會再跑一次 cleanupValueIR（沒用到的 pure call 順便刪掉）。
+int propagateConstantsInterprocedural(std::vector<ModuleFunction>& funcs,
+                                      const std::vector<FunctionSummary>& sums);
+
+// --print-after=ipa：每個函式一行摘要
+void dumpFunctionSummaries(const std::vector<ModuleFunction>& funcs,
+                           const std::vector<FunctionSummary>& sums);
@@ -0,0 +1,142 @@
+#include "value_ir_load_elim.hpp"
+#include "value_ir_util.hpp"
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace {
+
+// 純運算的 value numbering key
+struct ExprKey {
+    Op op;
+    ValueType type;
+    int lhs, rhs;
+    int64_t constValue;
+    uint64_t fbits;
+    std::vector<int> operands;
+    std::string callee;     // Call.lhs 在 cleanup 之後不可靠，用名字分辨
+
+    bool operator<(const ExprKey& o) const {
+        return std::tie(op, type, lhs, rhs, constValue, fbits, operands, callee) <
+               std::tie(o.op, o.type, o.lhs, o.rhs, o.constValue, o.fbits, o.operands, o.callee);
+    }
+};
+
+ExprKey makeKey(const Value& v) {
+    ExprKey k{v.op, v.type, v.lhs, v.rhs, v.constValue, 0, v.operands, v.callee_name};
+    std::memcpy(&k.fbits, &v.fconst, sizeof(k.fbits));
+    // 可交換運算：operand 排序，a+b 與 b+a 視為同一個
+    switch (v.op) {
+    case Op::Add: case Op::Mul: case Op::And: case Op::Or: case Op::Xor:
+    case Op::Eq: case Op::Ne:
+        if (k.lhs > k.rhs) std::swap(k.lhs, k.rhs);
+        break;
+    default:
+        break;
+    }
+    return k;
+}
+
+// 記憶體內容的一筆已知事實：mem 節點（load 或 store）的位址上存的是 value
+struct Available {
+    int mem;
+    int value;
+};
+
+// load / store 以完整寬度存取自己的型別時才可以互相轉送；sub-word 與
+// 被收成 I32Load 的 i64 存取都需要截斷 / 延伸，這裡不處理。
+bool isFullWidth(const Value& v, ValueType type) {
+    return memAccessBytes(v) == typeBytes(type);
+}
+
+constexpr size_t kMaxAvailable = 64;
+
+} // namespace
+
+int eliminateRedundantLoads(ValueIR& values, const AliasAnalysis& aa) {
+    std::vector<int> repl(values.size(), -1);
+    std::map<ExprKey, int> exprs;
+    std::vector<Available> avail;
+    int replaced = 0;
+
+    for (size_t i = 0; i < values.size(); i++) {
+        Value& v = values[i];
+        // 先把 operand 換成代表值，後面的 key / alias 查詢才看得到等價關係
+        forEachOperand(v, [&](int& ref) { ref = resolveReplacement(repl, ref); });
+
+        switch (v.op) {
+        case Op::Else: case Op::End:
+            exprs.clear();
+            avail.clear();
+            continue;
+        case Op::Loop: case Op::Br:
+        case Op::Return: case Op::Unreachable:
+            avail.clear();
+            continue;
+        case Op::Call:
+            // 摘要（value_ir_ipa）說什麼都不碰的 call：同 callee 同引數就是同一個值
+            if (isPureCall(v) && v.type != ValueType::Void) {
+                auto [it, inserted] = exprs.emplace(makeKey(v), (int)i);
+                if (!inserted) {
+                    repl[i] = it->second;
+                    replaced++;
+                }
+            }
+            if (v.call_effects & CallWritesMemory) avail.clear();
+            continue;
+        case Op::MemoryFill: case Op::MemoryCopy:
+            avail.clear();
+            continue;
+        default:
+            break;
+        }
+
+        if (isPureOp(v.op)) {
+            auto [it, inserted] = exprs.emplace(makeKey(v), (int)i);
+            if (!inserted) {
+                repl[i] = it->second;
+                replaced++;
+            }
+            continue;
+        }
+
+        if (isMemoryRead(v.op)) {
+            ValueType t = memAccessType(v);
+            int hit = -1;
+            if (isFullWidth(v, t)) {
+                for (auto e = avail.rbegin(); e != avail.rend(); ++e) {
+                    const Value& src = values[e->value];
+                    if (src.type != t || memAccessType(values[e->mem]) != t) continue;
+                    if (aa.alias(e->mem, (int)i) == AliasResult::MustAlias) {
+                        hit = e->value;
+                        break;
+                    }
+                }
+            }
+            if (hit >= 0) {
+                repl[i] = hit;
+                replaced++;
+            } else if (avail.size() < kMaxAvailable) {
+                avail.push_back({(int)i, (int)i});
+            }
+            continue;
+        }
+
+        if (v.op == Op::Store || v.op == Op::F64Store) {
+            std::vector<Available> kept;
+            kept.reserve(avail.size() + 1);
+            for (const auto& e : avail)
+                if (!aa.mayAlias(e.mem, (int)i)) kept.push_back(e);
+            avail.swap(kept);
+            ValueType t = memAccessType(v);
+            if (v.rhs >= 0 && isFullWidth(v, t) && avail.size() < kMaxAvailable)
+                avail.push_back({(int)i, v.rhs});
+            continue;
+        }
+    }
+
+    // loop phi 的 back-edge 是 forward ref，掃描當下還沒有替代值
+    replaceAllUses(values, repl);
+    return replaced;
+}
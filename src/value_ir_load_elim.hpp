@@ -0,0 +1,18 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+
+// Redundant load elimination + store-to-load forwarding + 區域內的 CSE。
+//
+// 依程式順序掃一次，維護「目前已知的記憶體內容」（哪個位址 = 哪個 SSA
+// value）。store 只會讓 AliasAnalysis 判定 may-alias 的項目失效，所以
+// 兩個指標參數之間能不能互相穿越，完全取決於 alias 分析的結果。
+//
+// 保守處理控制流：Loop / Else / End / Br 一律清空（back-edge 或另一條
+// 分支的 store 這裡看不到），memory.fill / memory.copy 以及摘要裡會寫記憶體
+// 的 Call 清空記憶體項目；不碰記憶體也不碰 global 的 Call 跟純運算一樣 CSE。
+// 被取代的節點只改寫 use，實際刪除交給之後的 cleanupValueIR。
+//
+// 回傳被取代的節點數。
+int eliminateRedundantLoads(ValueIR& values, const AliasAnalysis& aa);
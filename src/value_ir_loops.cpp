@@ -0,0 +1,366 @@
+#include "value_ir_loops.hpp"
+#include "value_ir_util.hpp"
+
+namespace {
+
+bool isCompare(Op op) {
+    switch (op) {
+    case Op::Lt_S: case Op::Lt_U: case Op::Le_S: case Op::Le_U:
+    case Op::Gt_S: case Op::Gt_U: case Op::Ge_S: case Op::Ge_U:
+    case Op::Ne: case Op::Eq:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Eq 沒有對應的 LoopCmp（只會跑 0 或 1 次），回傳 false
+bool toLoopCmp(Op op, bool negate, bool swap, LoopCmp& out) {
+    if (swap) {
+        switch (op) {
+        case Op::Lt_S: op = Op::Gt_S; break;
+        case Op::Lt_U: op = Op::Gt_U; break;
+        case Op::Le_S: op = Op::Ge_S; break;
+        case Op::Le_U: op = Op::Ge_U; break;
+        case Op::Gt_S: op = Op::Lt_S; break;
+        case Op::Gt_U: op = Op::Lt_U; break;
+        case Op::Ge_S: op = Op::Le_S; break;
+        case Op::Ge_U: op = Op::Le_U; break;
+        default: break;
+        }
+    }
+    if (negate) {
+        switch (op) {
+        case Op::Lt_S: op = Op::Ge_S; break;
+        case Op::Lt_U: op = Op::Ge_U; break;
+        case Op::Le_S: op = Op::Gt_S; break;
+        case Op::Le_U: op = Op::Gt_U; break;
+        case Op::Gt_S: op = Op::Le_S; break;
+        case Op::Gt_U: op = Op::Le_U; break;
+        case Op::Ge_S: op = Op::Lt_S; break;
+        case Op::Ge_U: op = Op::Lt_U; break;
+        case Op::Eq: op = Op::Ne; break;
+        case Op::Ne: op = Op::Eq; break;
+        default: return false;
+        }
+    }
+    switch (op) {
+    case Op::Lt_S: out = LoopCmp::LtS; return true;
+    case Op::Lt_U: out = LoopCmp::LtU; return true;
+    case Op::Le_S: out = LoopCmp::LeS; return true;
+    case Op::Le_U: out = LoopCmp::LeU; return true;
+    case Op::Gt_S: out = LoopCmp::GtS; return true;
+    case Op::Gt_U: out = LoopCmp::GtU; return true;
+    case Op::Ge_S: out = LoopCmp::GeS; return true;
+    case Op::Ge_U: out = LoopCmp::GeU; return true;
+    case Op::Ne: out = LoopCmp::Ne; return true;
+    default: return false;
+    }
+}
+
+bool evalCmp(LoopCmp c, int32_t a, int32_t b) {
+    uint32_t ua = (uint32_t)a, ub = (uint32_t)b;
+    switch (c) {
+    case LoopCmp::LtS: return a < b;
+    case LoopCmp::LtU: return ua < ub;
+    case LoopCmp::LeS: return a <= b;
+    case LoopCmp::LeU: return ua <= ub;
+    case LoopCmp::GtS: return a > b;
+    case LoopCmp::GtU: return ua > ub;
+    case LoopCmp::GeS: return a >= b;
+    case LoopCmp::GeU: return ua >= ub;
+    case LoopCmp::Ne: return a != b;
+    }
+    return false;
+}
+
+// 步長方向跟比較方向一致，loop 才會結束（Ne 只收 ±1）
+bool stepMatches(LoopCmp c, int64_t step) {
+    switch (c) {
+    case LoopCmp::LtS: case LoopCmp::LtU: case LoopCmp::LeS: case LoopCmp::LeU:
+        return step > 0;
+    case LoopCmp::GtS: case LoopCmp::GtU: case LoopCmp::GeS: case LoopCmp::GeU:
+        return step < 0;
+    case LoopCmp::Ne:
+        return step == 1 || step == -1;
+    }
+    return false;
+}
+
+// phi 的 next 是 phi ± 常數（i32）時回傳步長，否則 0
+int64_t ivStep(const ValueIR& values, int phi) {
+    const Value& p = values[phi];
+    if (p.operands.size() != 2 || p.operands[1] < 0) return 0;
+    const Value& next = values[p.operands[1]];
+    if (next.type != ValueType::I32) return 0;
+    auto isConst = [&](int id) { return id >= 0 && values[id].op == Op::I32Const; };
+    if (next.op == Op::Add) {
+        if (next.lhs == phi && isConst(next.rhs)) return values[next.rhs].constValue;
+        if (next.rhs == phi && isConst(next.lhs)) return values[next.lhs].constValue;
+    } else if (next.op == Op::Sub && next.lhs == phi && isConst(next.rhs)) {
+        return -(int64_t)values[next.rhs].constValue;
+    }
+    return 0;
+}
+
+// 已知 init / bound：直接照 i32 語意模擬（夠小才算）
+int64_t countTrips(LoopCmp c, int32_t init, int32_t bound, int64_t step) {
+    const int64_t limit = int64_t(1) << 24;
+    int64_t n = 0;
+    int32_t x = init;
+    while (evalCmp(c, x, bound)) {
+        if (++n > limit) return -1;
+        x = (int32_t)(uint32_t)((uint32_t)x + (uint32_t)step);
+    }
+    return n;
+}
+
+void matchIV(const ValueIR& values, LoopShape& s) {
+    int cond = values[s.exitBr].lhs;
+    if (cond < 0) return;
+    bool negate = false;
+    // Eqz 一層層剝掉
+    while (values[cond].op == Op::Eqz && values[cond].lhs >= 0) {
+        negate = !negate;
+        cond = values[cond].lhs;
+    }
+    auto isPhi = [&](int id) {
+        for (int p : s.phis) if (p == id) return true;
+        return false;
+    };
+
+    int iv = -1, bound = -1;
+    LoopCmp cmp;
+    const Value& c = values[cond];
+    if (isCompare(c.op)) {
+        bool swap = false;
+        if (isPhi(c.lhs) && ivStep(values, c.lhs) != 0) { iv = c.lhs; bound = c.rhs; }
+        else if (isPhi(c.rhs) && ivStep(values, c.rhs) != 0) { iv = c.rhs; bound = c.lhs; swap = true; }
+        else return;
+        if (!toLoopCmp(c.op, negate, swap, cmp)) return;
+    } else if (isPhi(cond) && ivStep(values, cond) != 0) {
+        // `while (i)`：i != 0；`while (!i)` 不是 counted loop
+        if (negate) return;
+        iv = cond;
+        cmp = LoopCmp::Ne;
+    } else {
+        return;
+    }
+
+    int64_t step = ivStep(values, iv);
+    if (!stepMatches(cmp, step)) return;
+    if (bound >= 0 && !isLoopInvariant(values, s, bound)) return;
+
+    s.iv = iv;
+    s.step = step;
+    s.cmp = cmp;
+    s.bound = bound;
+    s.boundIsConst = bound < 0 || values[bound].op == Op::I32Const;
+    s.boundConst = bound < 0 ? 0 : values[bound].constValue;
+    int init = values[iv].operands[0];
+    if (s.boundIsConst && init >= 0 && values[init].op == Op::I32Const)
+        s.tripCount = countTrips(cmp, values[init].constValue, (int32_t)s.boundConst, step);
+}
+
+void matchShape(const ValueIR& values, LoopShape& s) {
+    const int L = s.loop, E = s.end;
+    if (E < 0) return;
+
+    // header：phi（前面可能夾著 Param）、沒有副作用的運算（LocalSet 只寫 ir_VAR，可以）
+    int i = L + 1;
+    for (; i < E; i++) {
+        const Value& v = values[i];
+        if (v.op == Op::Br_if) break;
+        if (v.op == Op::Phi) {
+            if (v.local_index < 0 || v.use_vload_entry || v.operands.size() != 2) return;
+            if (!isLoopInvariant(values, s, v.operands[0])) return;
+            s.phis.push_back(i);
+        } else if (hasSideEffects(v.op) && v.op != Op::LocalSet) {
+            return;
+        }
+    }
+    if (i >= E || values[i].constValue != 1 || values[i].rhs != L) return;
+    s.exitBr = i;
+    if (values[E - 1].op != Op::Br || values[E - 1].lhs != L) return;
+    s.backBr = E - 1;
+
+    // body：跳轉只能跳到 body 裡的 loop，不能 return
+    for (int k = s.exitBr + 1; k < s.backBr; k++) {
+        const Value& v = values[k];
+        if (v.op == Op::Return || v.op == Op::Unreachable) return;
+        if (v.op == Op::Phi && v.local_index >= 0 && v.use_vload_entry) return;
+        if (v.op == Op::Br || v.op == Op::Br_if) {
+            int target = (v.op == Op::Br) ? v.lhs : v.rhs;
+            if (target <= s.exitBr || target >= s.backBr) return;
+        }
+    }
+    s.simple = true;
+    matchIV(values, s);
+}
+
+} // namespace
+
+bool isLoopInvariant(const ValueIR& values, const LoopShape& loop, int id) {
+    if (id < 0) return false;
+    if (id < loop.loop || id > loop.end) return true;
+    Op op = values[id].op;
+    return op == Op::Param || isConstOp(op);
+}
+
+std::vector<LoopShape> findLoops(const ValueIR& values) {
+    std::vector<int> match = matchRegions(values);
+    std::vector<LoopShape> loops;
+    std::vector<int> open;   // 目前所在的 loop（loops 的 index）
+    for (int i = 0; i < (int)values.size(); i++) {
+        while (!open.empty() && i > loops[open.back()].end) open.pop_back();
+        if (values[i].op != Op::Loop) continue;
+        LoopShape s;
+        s.loop = i;
+        s.end = match[i];
+        if (!open.empty()) {
+            s.parent = open.back();
+            loops[open.back()].innermost = false;
+        }
+        loops.push_back(s);
+        if (s.end >= 0) open.push_back((int)loops.size() - 1);
+    }
+    for (auto& s : loops) matchShape(values, s);
+    return loops;
+}
+
+bool exitValueMap(const ValueIR& values, const LoopShape& loop, std::vector<int>& repl) {
+    repl.assign(values.size(), -1);
+    for (int p : loop.phis) {
+        const Value& phi = values[p];
+        if (phi.operands.size() == 2 && phi.operands[1] > loop.exitBr && phi.operands[1] < loop.end)
+            repl[phi.operands[1]] = p;
+    }
+    bool ok = true;
+    for (int i = 0; i < (int)values.size() && ok; i++) {
+        if (i >= loop.loop && i <= loop.end) continue;
+        forEachOperand(values[i], [&](int ref) {
+            if (ref > loop.exitBr && ref < loop.end && repl[ref] < 0) ok = false;
+        });
+    }
+    return ok;
+}
+
+namespace {
+
+// band 的一層：step 1 的 `iv < n`，只帶 iv，起點與 n 在 outer 外面就決定了
+bool bandLevel(const ValueIR& values, const LoopShape& s, const LoopShape& outer) {
+    if (!s.simple || !s.hasIV() || s.step != 1) return false;
+    if (s.cmp != LoopCmp::LtS && s.cmp != LoopCmp::LtU) return false;
+    if (s.phis.size() != 1 || s.bound < 0) return false;
+    return isLoopInvariant(values, outer, values[s.iv].operands[0]) &&
+           isLoopInvariant(values, outer, s.bound);
+}
+
+// 上層 body 裡除了下一層 loop 以外的節點：沒有副作用，搬到哪一層都一樣
+bool movable(const Value& v) {
+    if (v.op == Op::End) return v.constValue == 1;
+    return v.op == Op::Param || v.op == Op::LocalSet || isPureOp(v.op);
+}
+
+// loops[k] 的 body 是「純運算 + 唯一的子 loop + 純運算」時回傳子 loop，否則 -1
+int onlyChild(const ValueIR& values, const std::vector<LoopShape>& loops, int k) {
+    const LoopShape& s = loops[k];
+    int child = -1;
+    for (int c = k + 1; c < (int)loops.size() && loops[c].loop < s.end; c++) {
+        if (loops[c].parent != k) continue;
+        if (child >= 0) return -1;
+        child = c;
+    }
+    if (child < 0) return -1;
+    const LoopShape& c = loops[child];
+    for (int i = s.bodyBegin(); i < s.backBr; i++) {
+        if (i == c.loop) i = c.end;
+        else if (!movable(values[i])) return -1;
+    }
+    return child;
+}
+
+} // namespace
+
+std::vector<int> rectangularBand(const ValueIR& values, const std::vector<LoopShape>& loops, int k) {
+    const LoopShape& outer = loops[k];
+    std::vector<int> band;
+    if (!bandLevel(values, outer, outer)) return band;
+    band.push_back(k);
+    for (;;) {
+        int c = onlyChild(values, loops, band.back());
+        if (c < 0 || !bandLevel(values, loops[c], outer)) break;
+        band.push_back(c);
+    }
+    return band;
+}
+
+bool loopNestSelfContained(const ValueIR& values, const LoopShape& s) {
+    bool ok = true;
+    for (int i = 0; i < (int)values.size() && ok; i++) {
+        if (i == s.loop) i = s.end;
+        else
+            forEachOperand(values[i], [&](int ref) {
+                if (ref > s.loop && ref <= s.end && values[ref].op != Op::Param &&
+                    !isConstOp(values[ref].op))
+                    ok = false;
+            });
+    }
+    for (int i = s.loop; i <= s.end && ok; i++) {
+        Op op = values[i].op;
+        if (op == Op::Call || op == Op::MemoryFill || op == Op::MemoryCopy) ok = false;
+    }
+    return ok;
+}
+
+namespace {
+
+bool addAffine(const ValueIR& values, int id, int64_t scale, AffineExpr& e,
+               const std::function<std::string(int)>& nameTerm, int depth) {
+    if (id < 0) return false;
+    const Value& v = values[id];
+    auto constOf = [&](int ref, int64_t& c) {
+        if (ref < 0 || (values[ref].op != Op::I32Const && values[ref].op != Op::I64Const)) return false;
+        c = values[ref].constValue;
+        return true;
+    };
+    int64_t c = 0;
+    if (constOf(id, c)) {
+        e.constant += scale * c;
+        return true;
+    }
+    if (depth < 32) {
+        switch (v.op) {
+        case Op::Add:
+            return addAffine(values, v.lhs, scale, e, nameTerm, depth + 1) &&
+                   addAffine(values, v.rhs, scale, e, nameTerm, depth + 1);
+        case Op::Sub:
+            return addAffine(values, v.lhs, scale, e, nameTerm, depth + 1) &&
+                   addAffine(values, v.rhs, -scale, e, nameTerm, depth + 1);
+        case Op::Mul:
+            if (constOf(v.rhs, c)) return addAffine(values, v.lhs, scale * c, e, nameTerm, depth + 1);
+            if (constOf(v.lhs, c)) return addAffine(values, v.rhs, scale * c, e, nameTerm, depth + 1);
+            break;
+        case Op::Shl:
+            if (constOf(v.rhs, c) && c >= 0 && c < 32)
+                return addAffine(values, v.lhs, scale * (int64_t(1) << c), e, nameTerm, depth + 1);
+            break;
+        default:
+            break;
+        }
+    }
+    std::string name = nameTerm(id);
+    if (name.empty()) return false;
+    e.terms[name] += scale;
+    if (e.terms[name] == 0) e.terms.erase(name);
+    return true;
+}
+
+} // namespace
+
+AffineExpr affineExpr(const ValueIR& values, int id,
+                      const std::function<std::string(int)>& nameTerm) {
+    AffineExpr e;
+    e.ok = addAffine(values, id, 1, e, nameTerm, 0);
+    return e;
+}
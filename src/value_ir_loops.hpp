@@ -0,0 +1,90 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Loop 結構分析：top-tested counted loop
+// ============================================================
+//
+// clang 的 `block; loop; <cond>; br_if 1; <body>; br 0; end; end` lower 完是
+//
+//   Loop
+//     phi_k = Phi(entry_k, next_k)      loop-carried local（local_index >= 0），
+//     <header>                          跟沒有副作用的運算一起算出繼續條件
+//     Br_if(cond, Loop, exit)           cond 為 0 時離開
+//     <body>                            可以有 If、巢狀 loop
+//     Br(Loop)
+//   End(loop)
+//
+// 只認這個形狀：唯一的出口是 header 之後的 Br_if、唯一的 back-edge 是
+// End 前面的 Br，body 裡的跳轉只能跳到 body 自己的巢狀 loop。unroll /
+// tiling 這類要複製或重排 loop 的 pass 都從這裡開始。
+
+// 繼續條件 iv <cmp> bound
+enum class LoopCmp { LtS, LtU, LeS, LeU, GtS, GtU, GeS, GeU, Ne };
+
+struct LoopShape {
+    int loop = -1;           // Loop 節點
+    int end = -1;            // 對應的 End(0)
+    int parent = -1;         // 外層 loop 在 findLoops 結果裡的位置，-1 = 最外層
+    bool innermost = true;   // body 裡沒有別的 loop
+    bool simple = false;     // 符合上面的形狀；false 時下面的欄位都沒有意義
+
+    int exitBr = -1;         // header 結尾的 Br_if(exit)
+    int backBr = -1;         // End 前的 Br
+    std::vector<int> phis;   // 這個 loop 的 loop-carried phi（都在 header 裡）
+
+    // induction variable：iv = Phi(init, iv ± c)，c 是 i32 常數
+    int iv = -1;
+    int64_t step = 0;
+    LoopCmp cmp = LoopCmp::Ne;
+    int bound = -1;          // loop invariant：loop 之前定義，或 header 裡的 Param / 常數
+    bool boundIsConst = false;
+    int64_t boundConst = 0;  // bound 是常數（或 `while (i)` 的隱含 0）時的值
+    int64_t tripCount = -1;  // init、bound 都是常數時的迭代次數，否則 -1
+
+    bool hasIV() const { return iv >= 0; }
+    int header() const { return loop + 1; }   // header 範圍 [header(), exitBr)，含 phi
+    int bodyBegin() const { return exitBr + 1; }
+};
+
+// 依 Loop 節點的順序列出所有 loop（外層在內層之前）
+std::vector<LoopShape> findLoops(const ValueIR& values);
+
+// id 是不是在 loop 外面就決定了（loop 之前定義，或跟位置無關的 Param / 常數）
+bool isLoopInvariant(const ValueIR& values, const LoopShape& loop, int id);
+
+// loop 裡定義、在 loop 外面被用到的值 → 代替它的 loop phi。
+// 離開 loop 時 phi 的值就是最後一輪的 next 值，所以 loop 之後對 next 的
+// 引用可以改成 phi（迭代 0 次時是入口值，也對）。其他 body 的值被 loop
+// 外面用到時回傳 false。header 的值在離開時才算，照原樣可以用，不列。
+bool exitValueMap(const ValueIR& values, const LoopShape& loop, std::vector<int>& repl);
+
+// loops[k] 開頭的矩形 perfect band（findLoops 的 index，外 → 內，k 自己
+// 不合格時是空的）。每一層是 step 1 的 `iv < n`，唯一的 loop-carried 值是
+// iv，起點與 n 在 loops[k] 外面就決定了；上層的 body 除了下一層 loop 之外
+// 只有純運算 / Param / LocalSet。最後一層的 body 沒有限制。tiling、
+// interchange 這類重排整個 nest 的 pass 從這裡挑 band。
+std::vector<int> rectangularBand(const ValueIR& values, const std::vector<LoopShape>& loops, int k);
+
+// loop 外面只用到 loop 裡的 Param / 常數（跟位置無關），loop 裡沒有
+// call、memory.fill、memory.copy（DependenceAnalysis 看不到的記憶體存取）
+bool loopNestSelfContained(const ValueIR& values, const LoopShape& loop);
+
+// 整數值的線性形式：Σ coef · term + constant。沿著 Add / Sub / 乘常數 /
+// 左移常數往下拆，拆不下去的節點交給 nameTerm 命名（同名的 term 合併，
+// 所以兩個各自算出 `i * nj` 的存取可以互相比較）。nameTerm 回傳空字串
+// 表示這個值不能當 term，整個 affineExpr 失敗（ok = false）。
+struct AffineExpr {
+    std::map<std::string, int64_t> terms;
+    int64_t constant = 0;
+    bool ok = false;
+};
+
+AffineExpr affineExpr(const ValueIR& values, int id,
+                      const std::function<std::string(int)>& nameTerm);
@@ -0,0 +1,323 @@
+#include "value_ir_outline.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <map>
+#include <set>
+
+ValueType paramTypeOf(const ModuleFunction& f, int k) {
+    return k < (int)f.paramTypes.size() ? f.paramTypes[k] : ValueType::I32;
+}
+
+namespace {
+
+// Param 看函式的簽章；loop phi 跟著入口值
+ValueType typeOf(const ModuleFunction& f, int id) {
+    for (int depth = 0; id >= 0 && depth < 64; depth++) {
+        const Value& v = f.values[id];
+        if (v.op == Op::Param) return paramTypeOf(f, v.paramIndex);
+        if (v.op != Op::Phi || v.operands.empty()) return v.type;
+        id = v.operands[0];
+    }
+    return ValueType::I32;
+}
+
+} // namespace
+
+bool isReductionOp(Op op) {
+    return op == Op::Add || op == Op::Mul || op == Op::And || op == Op::Or || op == Op::Xor ||
+           op == Op::F64Add || op == Op::F64Mul;
+}
+
+int64_t reductionIdentity(Op op) {
+    return op == Op::Mul || op == Op::F64Mul ? 1 : op == Op::And ? -1 : 0;
+}
+
+Value makeConst(ValueType t, int64_t c) {
+    Value v;
+    v.type = t;
+    if (t == ValueType::F64 || t == ValueType::F32) {
+        v.op = Op::F64Const;
+        v.fconst = (double)c;
+        return v;
+    }
+    v.op = t == ValueType::I64 ? Op::I64Const : Op::I32Const;
+    v.constValue = t == ValueType::I64 ? c : (int32_t)c;
+    return v;
+}
+
+bool classifyCarried(const ValueIR& values, const LoopShape& s, OutlinedLoop& r) {
+    for (int p : s.phis) {
+        if (p == s.iv) continue;
+        const Value& phi = values[p];
+        if (phi.operands.size() != 2 || phi.use_vload_entry) return false;
+        // 下一輪的值在 body 裡算（header 裡的在離開 loop 時還會多算一次）
+        if (phi.operands[1] <= s.exitBr || phi.operands[1] >= s.backBr) return false;
+        const Value& next = values[phi.operands[1]];
+        int other = next.lhs == p ? next.rhs : next.rhs == p ? next.lhs : -1;
+        if (other < 0 || next.lhs == next.rhs) return false;
+        if (next.op == Op::Add && next.type == ValueType::I32 && values[other].op == Op::I32Const) {
+            r.derived.push_back(p);
+        } else if (isReductionOp(next.op) &&
+                   (next.op == Op::F64Add || next.op == Op::F64Mul
+                        ? next.fast_math && next.type == ValueType::F64
+                        : next.type == ValueType::I32 || next.type == ValueType::I64)) {
+            if (r.red >= 0) return false;   // 新函式只回傳一個值
+            r.red = p;
+            r.redOp = next.op;
+            r.redType = next.type;
+        } else {
+            return false;
+        }
+    }
+    if (r.red < 0) return true;
+
+    // reduction 的值在 loop 裡只拿來算下一輪（LocalSet 不算用途）
+    const int next = values[r.red].operands[1];
+    for (int i = s.loop; i <= s.end; i++) {
+        if (values[i].op == Op::LocalSet || i == r.red || i == next) {
+            continue;
+        }
+        bool uses = false;
+        forEachOperand(values[i], [&](int ref) { uses |= (ref == r.red || ref == next); });
+        if (uses) return false;
+    }
+    return true;
+}
+
+bool usedOutsideOnlyAsResult(const ValueIR& values, const LoopShape& s, const OutlinedLoop& r) {
+    const int next = r.red >= 0 ? values[r.red].operands[1] : -1;
+    bool ok = true;
+    for (int i = 0; i < (int)values.size() && ok; i++) {
+        if (i == s.loop) {
+            i = s.end;
+            continue;
+        }
+        forEachOperand(values[i], [&](int ref) {
+            if (ref < s.loop || ref > s.end) return;
+            if (values[ref].op == Op::Param || isConstOp(values[ref].op)) return;
+            if (r.red < 0 || (ref != r.red && ref != next)) ok = false;
+        });
+    }
+    return ok;
+}
+
+void collectLiveIns(const ModuleFunction& f, const LoopShape& s, OutlinedLoop& r) {
+    const ValueIR& values = f.values;
+    std::set<int> seen, params, leaves;
+    std::vector<int> work;
+    auto need = [&](int ref) {
+        if (ref >= 0 && seen.insert(ref).second) work.push_back(ref);
+    };
+    // 新函式裡會用到的節點：header 的條件換成 `i < hi`，原本只拿來算條件的
+    // 值（n）不用傳
+    std::vector<char> live(s.end + 1, 0);
+    std::vector<int> roots;
+    for (int i = s.loop; i <= s.end; i++) {
+        if (i >= s.header() && i <= s.exitBr && values[i].op != Op::Phi) continue;
+        live[i] = 1;
+        roots.push_back(i);
+    }
+    while (!roots.empty()) {
+        int i = roots.back();
+        roots.pop_back();
+        if (values[i].op == Op::Param) params.insert(values[i].paramIndex);
+        forEachOperand(values[i], [&](int ref) {
+            if (ref >= s.loop && ref <= s.end) {
+                if (!live[ref]) roots.push_back(ref);
+                live[ref] = 1;
+            } else {
+                need(ref);
+            }
+        });
+    }
+    const int begin = values[s.iv].operands[0];
+    if (begin < s.loop || values[begin].op == Op::Param) need(begin);
+    while (!work.empty()) {
+        int id = work.back();
+        work.pop_back();
+        const Value& v = values[id];
+        if (v.op == Op::Param) {
+            params.insert(v.paramIndex);
+        } else if (isPureOp(v.op)) {
+            r.clones.push_back(id);
+            forEachOperand(v, need);
+        } else {
+            leaves.insert(id);
+        }
+    }
+    std::sort(r.clones.begin(), r.clones.end());
+    for (int p : params) r.leaves.push_back(-1 - p);
+    for (int id : leaves) r.leaves.push_back(id);
+}
+
+bool leavesSafeForAlias(const ValueIR& values, const LoopShape& s, const OutlinedLoop& r) {
+    std::vector<char> addr(values.size(), 0);
+    for (int i = s.end; i >= 0; i--) {
+        const Value& v = values[i];
+        if (i >= s.loop && (isMemoryRead(v.op) || v.op == Op::Store || v.op == Op::F64Store)) {
+            if (v.lhs >= 0) addr[v.lhs] = 1;
+        } else if (addr[i] && isPureOp(v.op)) {
+            forEachOperand(v, [&](int ref) { addr[ref] = 1; });
+        }
+    }
+    for (int leaf : r.leaves)
+        if (leaf >= 0 && addr[leaf]) return false;
+    return true;
+}
+
+unsigned effectsOf(const ValueIR& values) {
+    unsigned e = 0;
+    for (const Value& v : values) {
+        if (isMemoryRead(v.op)) e |= CallReadsMemory;
+        if (isMemoryWrite(v.op)) e |= CallWritesMemory;
+        if (v.op == Op::GlobalGet) e |= CallReadsGlobals;
+        if (v.op == Op::Call) e |= v.call_effects;
+    }
+    return e;
+}
+
+ModuleFunction outlineSignature(const ModuleFunction& f, const OutlinedLoop& r,
+                                ValueIR& src, std::vector<int>& leafParam) {
+    ModuleFunction t;
+    t.paramTypes = {ValueType::I32, ValueType::I32};
+    t.paramNames = {"lo", "hi"};
+    leafParam.assign(src.size(), -1);
+    std::map<int, int> paramOf;   // 原函式的參數編號 → 新函式的
+    for (int leaf : r.leaves) {
+        const int idx = (int)t.paramTypes.size();
+        if (leaf < 0) {
+            paramOf[-1 - leaf] = idx;
+            t.paramTypes.push_back(paramTypeOf(f, -1 - leaf));
+            t.paramNames.push_back(-1 - leaf < (int)f.paramNames.size()
+                                   ? f.paramNames[-1 - leaf] : "");
+        } else {
+            leafParam[leaf] = idx;
+            t.paramTypes.push_back(typeOf(f, leaf));
+            t.paramNames.push_back("");
+        }
+    }
+    for (auto& v : src) {
+        if (v.op != Op::Param) continue;
+        auto it = paramOf.find(v.paramIndex);
+        if (it == paramOf.end()) {
+            v.paramIndex = -1;   // 新函式用不到
+            continue;
+        }
+        v.paramIndex = it->second;
+        v.type = t.paramTypes[it->second];
+    }
+    t.numParams = t.paramTypes.size();
+    return t;
+}
+
+int OutlineBuilder::emitParam(int k) {
+    Value v;
+    v.op = Op::Param;
+    v.paramIndex = k;
+    v.type = types_[k];
+    return emit(v);
+}
+
+std::pair<int, int> OutlineBuilder::emitPrelude() {
+    const int lo = emitParam(0), hi = emitParam(1);
+    for (int i = 0; i < (int)leafParam_.size(); i++)
+        if (leafParam_[i] >= 0) map_[i] = emitParam(leafParam_[i]);
+    for (int i = 0; i < s_.loop; i++)
+        if (in_[i].op == Op::Param && in_[i].paramIndex >= 0) map_[i] = emitParam(in_[i].paramIndex);
+    for (int id : r_.clones) copyVerbatim(id, id, nullptr);
+    // header 裡的 Param / 常數：phi 的入口值可能用到
+    for (int i = s_.header(); i < s_.exitBr; i++)
+        if (in_[i].op == Op::Param || isConstOp(in_[i].op)) copyVerbatim(i, i, nullptr);
+    return {lo, hi};
+}
+
+ValueIR finishOutlinedBody(ValueIR body) {
+    for (Value& v : body)
+        if (v.op == Op::LocalSet) v = makeConst(ValueType::I32, 0);
+    return cleanupValueIR(body);
+}
+
+// ============================================================
+// 原函式：loop 換成 `_run` 的 call
+// ============================================================
+
+namespace {
+
+class Outliner : public ValueIRRebuilder {
+public:
+    Outliner(const ValueIR& in, const std::vector<LoopShape>& loops,
+             const std::vector<OutlinedLoop>& regions, const std::vector<std::string>& names,
+             const std::vector<unsigned>& effects, const std::vector<bool>& memory)
+        : ValueIRRebuilder(in), loops_(loops), regions_(regions), names_(names),
+          effects_(effects), memory_(memory) {}
+
+    ValueIR run() {
+        std::vector<std::pair<int, int>> ranges;
+        for (const OutlinedLoop& r : regions_) ranges.push_back({loops_[r.loop].loop, loops_[r.loop].end});
+        return ValueIRRebuilder::run(ranges);
+    }
+
+private:
+    void emitRegion(size_t k) override;
+
+    const std::vector<LoopShape>& loops_;
+    const std::vector<OutlinedLoop>& regions_;
+    const std::vector<std::string>& names_;
+    const std::vector<unsigned>& effects_;
+    const std::vector<bool>& memory_;
+};
+
+void Outliner::emitRegion(size_t k) {
+    const OutlinedLoop& r = regions_[k];
+    const LoopShape& s = loops_[r.loop];
+
+    // loop 裡的 Param / 常數在 loop 之後也可能用到
+    std::map<int, int> params;
+    for (int i = s.loop; i <= s.end; i++) {
+        if (in_[i].op != Op::Param && !isConstOp(in_[i].op)) continue;
+        copyVerbatim(i, i, nullptr);
+        if (in_[i].op == Op::Param) params[in_[i].paramIndex] = map_[i];
+    }
+
+    Value call;
+    call.op = Op::Call;
+    call.callee_name = names_[k] + "_run";
+    call.type = r.redType;
+    call.call_effects = effects_[k];
+    call.pass_memory = memory_[k];
+    call.operands = {mapOutside(in_[s.iv].operands[0]), mapOutside(s.bound)};
+    for (int leaf : r.leaves) {
+        if (leaf >= 0) {
+            call.operands.push_back(mapOutside(leaf));
+            continue;
+        }
+        auto it = params.find(-1 - leaf);
+        if (it == params.end()) {
+            Value p;
+            p.op = Op::Param;
+            p.paramIndex = -1 - leaf;
+            it = params.emplace(p.paramIndex, emit(p)).first;
+        }
+        call.operands.push_back(it->second);
+    }
+    const int result = emit(call);
+
+    if (r.red >= 0) {
+        int combined = emitOp(r.redOp, mapOutside(in_[r.red].operands[0]), result);
+        out_[combined].type = r.redType;
+        map_[r.red] = combined;
+        afterRepl_[in_[r.red].operands[1]] = r.red;
+    }
+}
+
+} // namespace
+
+ValueIR replaceOutlinedLoops(const ValueIR& in, const std::vector<LoopShape>& loops,
+                             const std::vector<OutlinedLoop>& outlined,
+                             const std::vector<std::string>& names,
+                             const std::vector<unsigned>& effects,
+                             const std::vector<bool>& memory) {
+    ValueIR out = Outliner(in, loops, outlined, names, effects, memory).run();
+    return cleanupValueIR(out);
+}
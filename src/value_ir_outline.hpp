@@ -0,0 +1,96 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_rebuild.hpp"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================
+// Loop 拆成新函式：value_ir_parallel 的 task、value_ir_vectorize 的 kernel 共用
+// ============================================================
+//
+// 新函式跑 [lo, hi) 那一段迭代，回傳 reduction 的部分結果：
+//
+//   p0 = lo, p1 = hi, p2... = live-in
+//
+// live-in 裡能在新函式裡重算的純運算（`A + 400`、`i * n`）搬進去，往下追到
+// 參數 / loop phi / load 這類「葉子」才當參數傳；新函式裡看得到原本的參數，
+// alias analysis 還是知道它們從哪裡來。原本的位置換成
+//
+//   r = <name>_run(__mem, begin, n, live-in...)
+//   s = s0 ⊕ r
+//
+// `_run` 由各自的 C glue 提供（thread pool / CPU feature dispatch）。
+
+struct OutlinedLoop {
+    int loop = -1;                // findLoops 的 index
+    int red = -1;                 // reduction phi，-1 = 沒有
+    Op redOp = Op::Add;
+    ValueType redType = ValueType::Void;
+    std::vector<int> derived;     // `p = Phi(e, p + c)`
+    // 新函式的參數（lo、hi 之後）：loop 外面定義、新函式裡不重算的值。
+    // 參數用 (-1 - 參數編號) 表示，同一個參數的不同 Param 節點只傳一次。
+    std::vector<int> leaves;
+    std::vector<int> clones;      // loop 外面、搬進新函式重算的純運算（id 遞增）
+};
+
+// Param 節點的 type 不一定對（lowering 一律 I32），看函式的簽章
+ValueType paramTypeOf(const ModuleFunction& f, int k);
+
+// 整數的 + * & | ^：部分結果可以任意順序合併。f64 的 + * 只有標了
+// fast_math 的才算（--fast-math，換了順序結果會差最後幾個 bit）
+bool isReductionOp(Op op);
+int64_t reductionIdentity(Op op);
+Value makeConst(ValueType t, int64_t c);
+
+// loop-carried 值：iv 以外只能是 reduction（`s = s ⊕ x`，s 在 loop 裡沒有
+// 別的用途）與線性 induction（`p = p + c`）
+bool classifyCarried(const ValueIR& values, const LoopShape& s, OutlinedLoop& r);
+// loop 外面只用到 reduction 的結果與 loop 裡的 Param / 常數
+bool usedOutsideOnlyAsResult(const ValueIR& values, const LoopShape& s, const OutlinedLoop& r);
+// 填 r.leaves / r.clones
+void collectLiveIns(const ModuleFunction& f, const LoopShape& s, OutlinedLoop& r);
+// --assume-noalias-params 把新函式的每個參數都當成不重疊的指標。從 load /
+// loop phi 來的葉子在原函式裡不是參數，變成參數之後不能拿來當位址。
+bool leavesSafeForAlias(const ValueIR& values, const LoopShape& s, const OutlinedLoop& r);
+// 新函式的 Call 摘要
+unsigned effectsOf(const ValueIR& values);
+
+// 新函式的簽章：lo、hi、葉子。src 是 f.values 的副本，裡面的 Param 改成
+// 新函式的編號（用不到的是 -1）；leafParam[id] 是葉子 id 變成的參數編號。
+ModuleFunction outlineSignature(const ModuleFunction& f, const OutlinedLoop& r,
+                                ValueIR& src, std::vector<int>& leafParam);
+
+// 新函式的 body 從這裡長出來：emitPrelude 放參數、搬進來的純運算、header
+// 裡的 Param / 常數，回傳 {lo, hi}。之後子類別用 map_ 複製 loop。
+class OutlineBuilder : public ValueIRRebuilder {
+public:
+    OutlineBuilder(const ValueIR& in, const LoopShape& s, const OutlinedLoop& r,
+                   const std::vector<int>& leafParam, const std::vector<ValueType>& types)
+        : ValueIRRebuilder(in), s_(s), r_(r), leafParam_(leafParam), types_(types) {}
+
+    ValueIR run() { return ValueIRRebuilder::run({{0, (int)in_.size() - 1}}); }
+
+protected:
+    std::pair<int, int> emitPrelude();
+    int emitParam(int k);
+
+    const LoopShape& s_;
+    const OutlinedLoop& r_;
+    const std::vector<int>& leafParam_;
+    const std::vector<ValueType>& types_;
+};
+
+// 新函式的 LocalSet 是沒人讀的寫入（local 的 VAR 只有 use_vload_entry 的
+// phi 會讀，有的話不拆），換成常數之後 cleanup
+ValueIR finishOutlinedBody(ValueIR body);
+
+// 原函式：outlined[k] 的 loop 換成 `names[k]_run` 的 call
+ValueIR replaceOutlinedLoops(const ValueIR& in, const std::vector<LoopShape>& loops,
+                             const std::vector<OutlinedLoop>& outlined,
+                             const std::vector<std::string>& names,
+                             const std::vector<unsigned>& effects,
+                             const std::vector<bool>& memory);
@@ -0,0 +1,317 @@
+#include "value_ir_parallel.hpp"
+#include "value_ir_deps.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_outline.hpp"
+#include "value_ir_util.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// ============================================================
+// 哪些 loop 可以拆
+// ============================================================
+
+struct Region : OutlinedLoop {
+    int64_t minIters = 2;
+};
+
+bool bodyAllowed(const ValueIR& values, const LoopShape& s) {
+    for (int i = s.loop; i <= s.end; i++) {
+        const Value& v = values[i];
+        switch (v.op) {
+        case Op::GlobalSet: case Op::MemoryFill: case Op::MemoryCopy:
+        case Op::Return: case Op::Unreachable: case Op::LocalTee:
+            return false;
+        case Op::Call:
+            if (!isPureCall(v)) return false;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+// 沒有一個相依由 loops[k] 帶到下一輪
+bool noCarriedDependence(const DependenceAnalysis& deps, const LoopShape& s, int k) {
+    for (const Dependence& d : deps.dependences(s.loop, s.end)) {
+        auto it = std::find(d.loops.begin(), d.loops.end(), k);
+        if (it == d.loops.end()) return false;
+        const size_t pos = it - d.loops.begin();
+        for (const auto& dir : directionVectors(d)) {
+            bool outer = false;
+            for (size_t m = 0; m < pos; m++) outer |= dir[m] != 0;
+            if (!outer && dir[pos] != 0) return false;
+        }
+    }
+    return true;
+}
+
+// 一輪迭代的節點數（巢狀 loop 乘上 trip count，不知道時當 64）
+int64_t iterationWork(const std::vector<LoopShape>& loops, int k) {
+    const LoopShape& s = loops[k];
+    std::vector<int64_t> mult(s.end - s.loop + 1, 1);
+    for (int c = k + 1; c < (int)loops.size() && loops[c].loop < s.end; c++) {
+        int64_t trips = loops[c].tripCount > 0 ? loops[c].tripCount : 64;
+        for (int i = loops[c].loop; i <= loops[c].end; i++)
+            mult[i - s.loop] = std::min<int64_t>(mult[i - s.loop] * trips, INT64_C(1) << 40);
+    }
+    int64_t body = 0;
+    for (int i = s.bodyBegin(); i < s.backBr; i++) body += mult[i - s.loop];
+    return std::max<int64_t>(1, std::min<int64_t>(body, INT64_C(1) << 40));
+}
+
+bool planLoop(const ModuleFunction& f, const std::vector<LoopShape>& loops,
+              const DependenceAnalysis& deps, int k, const AliasOptions& aopts,
+              const ParallelOptions& opts, Region& r) {
+    const ValueIR& values = f.values;
+    const LoopShape& s = loops[k];
+    if (!s.simple || !s.hasIV() || s.step != 1 || s.cmp != LoopCmp::LtS || s.bound < 0) return false;
+    if (values[s.iv].type == ValueType::I64) return false;
+    if (!isLoopInvariant(values, s, values[s.iv].operands[0]) || !isLoopInvariant(values, s, s.bound))
+        return false;
+    // trip count 不知道時由 runtime 判斷：迭代數少於 minIters 就不開 thread
+    const int64_t work = iterationWork(loops, k);
+    if (s.tripCount >= 0 && (s.tripCount < 2 || s.tripCount * work < opts.minWork)) return false;
+    r.minIters = std::max<int64_t>(2, (opts.minWork + work - 1) / work);
+
+    r.loop = k;
+    if (!classifyCarried(values, s, r)) return false;
+    if (!bodyAllowed(values, s) || !usedOutsideOnlyAsResult(values, s, r)) return false;
+    if (!values[s.loop].doall && !noCarriedDependence(deps, s, k)) return false;
+    collectLiveIns(f, s, r);
+    if (aopts.distinctParamsNoAlias && !leavesSafeForAlias(values, s, r)) return false;
+    return true;
+}
+
+// ============================================================
+// task：loop 本身搬出去，iv 從 lo 走到 hi
+// ============================================================
+//
+//   p0 = lo, p1 = hi, p2... = live-in
+//   <搬進來的純運算>
+//   Loop
+//     i = Phi(lo, i + 1)
+//     s = Phi(identity, s ⊕ x)
+//     q = Phi(e + (lo - begin)·c, q + c)
+//     <header>
+//     Br_if(i < hi)
+//     <body>
+//     Br
+//   End
+//   Return(s)
+
+class TaskBuilder : public OutlineBuilder {
+public:
+    using OutlineBuilder::OutlineBuilder;
+
+private:
+    void emitRegion(size_t) override;
+};
+
+void TaskBuilder::emitRegion(size_t) {
+    const auto [lo, hi] = emitPrelude();
+
+    LocalMap entry;
+    entry[s_.iv] = lo;
+    if (r_.red >= 0) entry[r_.red] = emit(makeConst(r_.redType, reductionIdentity(r_.redOp)));
+    const int begin = map_[in_[s_.iv].operands[0]];
+    for (int p : r_.derived) {
+        const Value& next = in_[in_[p].operands[1]];
+        int c = next.lhs == p ? next.rhs : next.lhs;
+        int skipped = emitOp(Op::Mul, emitOp(Op::Sub, lo, begin), emit(makeConst(ValueType::I32, in_[c].constValue)));
+        entry[p] = emitOp(Op::Add, map_[in_[p].operands[0]], skipped);
+    }
+
+    copyVerbatim(s_.loop, s_.exitBr - 1, &entry);
+    Value exit = in_[s_.exitBr];
+    exit.lhs = emitOp(Op::Lt_S, map_[s_.iv], hi);
+    exit.rhs = map_[s_.loop];
+    map_[s_.exitBr] = emit(exit);
+    copyVerbatim(s_.bodyBegin(), s_.end, nullptr);
+
+    Value ret;
+    ret.op = Op::Return;
+    ret.lhs = r_.red >= 0 ? map_[r_.red] : -1;
+    emit(ret);
+}
+
+} // namespace
+
+int parallelizeLoops(std::vector<ModuleFunction>& funcs, const AliasOptions& aopts,
+                     const ParallelOptions& opts) {
+    if (opts.threads <= 1) return 0;
+    int total = 0;
+    const size_t n = funcs.size();
+    for (size_t fi = 0; fi < n; fi++) {
+        ModuleFunction& f = funcs[fi];
+        if (f.parallel.isTask || f.vector.isKernel) continue;
+        bool vload = false;
+        for (const Value& v : f.values) vload |= v.op == Op::Phi && v.use_vload_entry;
+        if (vload) continue;
+        std::vector<LoopShape> loops = findLoops(f.values);
+        if (loops.empty()) continue;
+
+        std::vector<Region> regions;
+        {
+            AliasAnalysis aa(f.values, aopts);
+            DependenceAnalysis deps(f.values, loops, aa);
+            int skipUntil = -1;   // 已經拆掉的 loop 裡面
+            for (int k = 0; k < (int)loops.size(); k++) {
+                if (loops[k].loop < skipUntil) continue;
+                Region r;
+                if (!planLoop(f, loops, deps, k, aopts, opts, r)) continue;
+                regions.push_back(std::move(r));
+                skipUntil = loops[k].end;
+            }
+        }
+        if (regions.empty()) continue;
+
+        std::vector<ModuleFunction> tasks;
+        std::vector<std::string> names;
+        std::vector<unsigned> effects;
+        std::vector<bool> memory;
+        for (size_t k = 0; k < regions.size(); k++) {
+            const Region& r = regions[k];
+            const LoopShape& s = loops[r.loop];
+
+            ValueIR src = f.values;
+            std::vector<int> leafParam;
+            ModuleFunction t = outlineSignature(f, r, src, leafParam);
+            t.name = f.name + "__par" + std::to_string(k);
+            // local 的 VAR 只有 use_vload_entry 的 phi 會讀（有的話上面就不拆了），
+            // task 裡的 LocalSet 是沒人讀的寫入；留著的話每個 thread 都在寫同一個 static
+            t.values = finishOutlinedBody(TaskBuilder(src, s, r, leafParam, t.paramTypes).run());
+            t.origin = f.origin >= 0 ? f.origin : (int)fi;
+            t.parallel.isTask = true;
+            t.parallel.reduceOp = r.redOp;
+            t.parallel.resultType = r.redType;
+            t.parallel.threads = opts.threads;
+            t.parallel.minIters = r.minIters;
+
+            names.push_back(t.name);
+            effects.push_back(effectsOf(t.values));
+            memory.push_back(usesMemoryParam(t.values));
+            tasks.push_back(std::move(t));
+        }
+
+        f.values = replaceOutlinedLoops(f.values, loops,
+                                        std::vector<OutlinedLoop>(regions.begin(), regions.end()),
+                                        names, effects, memory);
+        total += (int)regions.size();
+        for (auto& t : tasks) funcs.push_back(std::move(t));
+    }
+    return total;
+}
+
+// ============================================================
+// C glue
+// ============================================================
+
+namespace {
+
+std::string cName(const std::string& name) {
+    if (!name.empty() && name[0] >= '0' && name[0] <= '9') return "func_" + name;
+    return name;
+}
+
+const char* cType(ValueType t) {
+    switch (t) {
+    case ValueType::I64: return "int64_t";
+    case ValueType::F32: return "float";
+    case ValueType::F64: return "double";
+    case ValueType::Void: return "void";
+    default: return "int32_t";
+    }
+}
+
+const char* cOperator(Op op) {
+    switch (op) {
+    case Op::Mul: case Op::F64Mul: return "*";
+    case Op::And: return "&";
+    case Op::Or: return "|";
+    case Op::Xor: return "^";
+    default: return "+";
+    }
+}
+
+} // namespace
+
+std::string parallelGlueC(const std::vector<ModuleFunction>& funcs) {
+    std::ostringstream os;
+    for (const ModuleFunction& t : funcs) {
+        if (!t.parallel.isTask) continue;
+        const std::string name = cName(t.name);
+        const bool mem = usesMemoryParam(t.values);
+        const bool red = t.parallel.resultType != ValueType::Void;
+        // 部分結果用 unsigned 累加：wasm 的整數運算 wrap，C 的 signed overflow 是 UB。
+        // f64 的（--fast-math）照樣是 double
+        const char* acc = t.parallel.resultType == ValueType::F64 ? "double"
+                        : t.parallel.resultType == ValueType::I64 ? "uint64_t" : "uint32_t";
+        const char* ret = cType(t.parallel.resultType);
+
+        os << "/* " << t.name << ": DOALL loop, iterations [p0, p1) */\n";
+        os << ret << " " << name << "(";
+        std::string sep;
+        if (mem) {
+            os << "uintptr_t";
+            sep = ", ";
+        }
+        for (ValueType p : t.paramTypes) {
+            os << sep << cType(p);
+            sep = ", ";
+        }
+        os << ");\n";
+
+        os << "typedef struct {\n";
+        if (mem) os << "    uintptr_t mem;\n";
+        for (size_t k = 2; k < t.paramTypes.size(); k++)
+            os << "    " << cType(t.paramTypes[k]) << " a" << k << ";\n";
+        if (red) os << "    " << acc << " part[W2S_MAX_THREADS];\n";
+        os << "} " << name << "_ctx;\n";
+
+        os << "static void " << name << "_task(void* c, int32_t lo, int32_t hi, int worker) {\n";
+        os << "    " << name << "_ctx* x = (" << name << "_ctx*)c;\n";
+        os << "    ";
+        if (red) os << acc << " r = (" << acc << ")";
+        os << name << "(";
+        sep.clear();
+        if (mem) {
+            os << "x->mem";
+            sep = ", ";
+        }
+        os << sep << "lo, hi";
+        for (size_t k = 2; k < t.paramTypes.size(); k++) os << ", x->a" << k;
+        os << ");\n";
+        if (red) os << "    x->part[worker] = x->part[worker] " << cOperator(t.parallel.reduceOp) << " r;\n";
+        else os << "    (void)worker;\n";
+        os << "}\n";
+
+        os << "static " << ret << " " << name << "_run(";
+        sep.clear();
+        if (mem) {
+            os << "uintptr_t mem";
+            sep = ", ";
+        }
+        os << sep << "int32_t lo, int32_t hi";
+        for (size_t k = 2; k < t.paramTypes.size(); k++) os << ", " << cType(t.paramTypes[k]) << " a" << k;
+        os << ") {\n";
+        os << "    " << name << "_ctx x;\n";
+        if (mem) os << "    x.mem = mem;\n";
+        for (size_t k = 2; k < t.paramTypes.size(); k++) os << "    x.a" << k << " = a" << k << ";\n";
+        const int64_t id = reductionIdentity(t.parallel.reduceOp);
+        const std::string idText = id < 0 ? std::string("~(") + acc + ")0" : std::to_string(id);
+        if (red) os << "    for (int w = 0; w < W2S_MAX_THREADS; w++) x.part[w] = " << idText << ";\n";
+        os << "    w2s_parallel_for(" << name << "_task, &x, lo, hi, " << t.parallel.threads << ", "
+           << t.parallel.minIters << ");\n";
+        if (red) {
+            os << "    " << acc << " r = " << idText << ";\n";
+            os << "    for (int w = 0; w < W2S_MAX_THREADS; w++) r = r "
+               << cOperator(t.parallel.reduceOp) << " x.part[w];\n";
+            os << "    return (" << ret << ")r;\n";
+        }
+        os << "}\n\n";
+    }
+    return os.str();
+}
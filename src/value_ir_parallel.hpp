@@ -0,0 +1,54 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// DOALL 平行化：迭代之間沒有相依的 loop 拆給 thread pool
+// ============================================================
+//
+// 對象是 value_ir_loops.hpp 的 counted loop，step 1 的 `i < n`（signed）。
+// 迭代之間可以獨立執行的條件：
+//
+//   - 記憶體：DependenceAnalysis 的相依沒有一個由這個 loop 帶到下一輪
+//     （方向向量在這一層之前都是 0 時，這一層也要是 0）。外層 loop 帶的
+//     相依不受影響：外層還是照順序跑，每一輪 fork / join 一次。
+//   - loop-carried 值：除了 iv 只能有
+//       · reduction：`s = s ⊕ x`（整數的 + * & | ^，--fast-math 時加上 f64
+//         的 + *），s 在 loop 裡沒有別的用途，loop 之後只用最後的值
+//       · 跟 iv 一起走的線性 induction：`p = p + c`（clang 的指標遞增）
+//   - loop 裡沒有 global.set、memory.fill / memory.copy、return、
+//     unreachable，call 只能是純的（value_ir_ipa 的摘要）
+//
+// 整個 loop 拆成一個新函式 `<f>__par<k>(lo, hi, live-in...)`，跑 [lo, hi)
+// 那一段迭代，回傳 reduction 的部分結果；原本的位置換成
+//
+//   r = <f>__par<k>_run(__mem, begin, n, live-in...)
+//   s = s0 ⊕ r
+//
+// `_run` 是 parallelGlueC 產生的 C：把 [begin, n) 切成 chunk 交給
+// runtime/w2s_runtime.c 的 work-stealing thread pool，每個 worker 累積
+// 自己的部分結果，最後依序合併。live-in 裡能在 task 裡重算的純運算
+// （`A + 400`、`i * n`）不當參數傳，task 裡看得到原本的參數，alias
+// analysis 還是知道它們從哪裡來。
+//
+// 太小的 loop 不拆：body 的節點數（巢狀 loop 乘上 trip count，不知道時
+// 當 64）乘上迭代次數低於 minWork 時，fork / join 的成本比省下的多。
+// trip count 不知道時換算成迭代數交給 runtime，執行時再決定要不要開 thread。
+
+struct ParallelOptions {
+    int threads = 1;               // --threads=N：大於 1 才平行化
+    int64_t minWork = 1 << 15;     // 估計的節點數 × 迭代次數
+};
+
+// 回傳拆出來的 loop 數。拆出來的 task 接在 funcs 後面（parallel.isTask，
+// origin 是原函式），原函式有改寫時重建並跑過 cleanupValueIR。
+int parallelizeLoops(std::vector<ModuleFunction>& funcs, const AliasOptions& aopts,
+                     const ParallelOptions& opts);
+
+// out.c 用的 C glue：每個 task 的 prototype、context struct 與 `_run`。
+// 要放在所有函式之前（`_run` 是 static），沒有 task 時是空字串。
+std::string parallelGlueC(const std::vector<ModuleFunction>& funcs);
@@ -0,0 +1,588 @@
+#include "value_ir_passes.hpp"
+#include "value_ir_alias.hpp"
+#include "value_ir_deps.hpp"
+#include "value_ir_dump.hpp"
+#include "value_ir_eval.hpp"
+#include "value_ir_fastmath.hpp"
+#include "value_ir_fusion.hpp"
+#include "value_ir_inline.hpp"
+#include "value_ir_interchange.hpp"
+#include "value_ir_ipa.hpp"
+#include "value_ir_load_elim.hpp"
+#include "value_ir_parallel.hpp"
+#include "value_ir_scalar_repl.hpp"
+#include "value_ir_ifconvert.hpp"
+#include "value_ir_idiom.hpp"
+#include "value_ir_rotate.hpp"
+#include "value_ir_unswitch.hpp"
+#include "value_ir_slp.hpp"
+#include "value_ir_stencil.hpp"
+#include "value_ir_tailrec.hpp"
+#include "value_ir_tile.hpp"
+#include "value_ir_unroll.hpp"
+#include "value_ir_vectorize.hpp"
+#include "value_ir_wavefront.hpp"
+#include "wasm_lower.hpp"
+#include "wasm_stack_promote.hpp"
+#include <cstdlib>
+#include <iostream>
+
+// "32768" / "32K" / "1M"（withUnit 時才認 K / M）
+static bool parseSize(const std::string& text, bool withUnit, int64_t& out) {
+    if (text.empty() || text[0] < '0' || text[0] > '9') return false;
+    char* end = nullptr;
+    long long n = std::strtoll(text.c_str(), &end, 10);
+    std::string unit(end);
+    if (withUnit && (unit == "K" || unit == "k")) n *= 1024;
+    else if (withUnit && (unit == "M" || unit == "m")) n *= 1024 * 1024;
+    else if (!unit.empty()) return false;
+    if (n <= 0) return false;
+    out = n;
+    return true;
+}
+
+bool parsePassOption(const std::string& arg, PassOptions& opts) {
+    if (arg == "-O0") {
+        opts.promoteStackSlots = false;
+        opts.loadElim = false;
+        opts.inboundsAddressing = false;
+        opts.inlineCalls = false;
+        opts.tailRecursion = false;
+        opts.ipcp = false;
+        opts.partialEval = false;
+        opts.specializeCalls = false;
+        opts.unroll = false;
+        opts.unrollAndJam = false;
+        opts.interchange = false;
+        opts.distribute = false;
+        opts.fuse = false;
+        opts.tile = false;
+        opts.scalarRepl = false;
+        opts.ifConvert = false;
+        opts.rotateLoops = false;
+        opts.loopIdiom = false;
+        opts.vectorize = false;
+        opts.slp = false;
+        opts.temporalBlocking = false;
+        opts.unswitch = false;
+    } else if (arg == "-O1" || arg == "-O2") {
+        opts.promoteStackSlots = true;
+        opts.loadElim = true;
+        opts.ifConvert = true;
+        opts.rotateLoops = true;
+        opts.loopIdiom = true;
+        opts.inboundsAddressing = (arg == "-O2");
+        opts.inlineCalls = true;
+        opts.tailRecursion = true;
+        opts.ipcp = true;
+        opts.partialEval = true;
+        opts.specializeCalls = (arg == "-O2");
+        opts.unroll = (arg == "-O2");
+        opts.unrollAndJam = (arg == "-O2");
+        opts.interchange = (arg == "-O2");
+        opts.distribute = (arg == "-O2");
+        opts.fuse = (arg == "-O2");
+        opts.tile = (arg == "-O2");
+        opts.scalarRepl = (arg == "-O2");
+        opts.vectorize = (arg == "-O2");
+        opts.slp = (arg == "-O2");
+        opts.temporalBlocking = (arg == "-O2");
+        opts.unswitch = (arg == "-O2");
+    } else if (arg == "--assume-inbounds-addressing") {
+        opts.inboundsAddressing = true;
+    } else if (arg == "--promote-stack-slots") {
+        opts.promoteStackSlots = true;
+    } else if (arg == "--tail-recursion") {
+        opts.tailRecursion = true;
+    } else if (arg == "--specialize-calls") {
+        opts.specializeCalls = true;
+    } else if (arg.rfind("--specialize=", 0) == 0) {
+        SpecializeSpec spec;
+        if (!parseSpecializeSpec(arg.substr(std::string("--specialize=").size()), spec))
+            return false;
+        opts.specialize.push_back(spec);
+    } else if (arg == "--ipcp") {
+        opts.ipcp = true;
+    } else if (arg == "--partial-eval") {
+        opts.partialEval = true;
+    } else if (arg == "--inline") {
+        opts.inlineCalls = true;
+    } else if (arg == "--unroll") {
+        opts.unroll = true;
+    } else if (arg == "--unroll-and-jam") {
+        opts.unrollAndJam = true;
+    } else if (arg == "--interchange") {
+        opts.interchange = true;
+    } else if (arg == "--distribute") {
+        opts.distribute = true;
+    } else if (arg == "--fuse") {
+        opts.fuse = true;
+    } else if (arg == "--tile") {
+        opts.tile = true;
+    } else if (arg == "--scalar-repl") {
+        opts.scalarRepl = true;
+    } else if (arg == "--vectorize") {
+        opts.vectorize = true;
+    } else if (arg == "--slp-vectorize") {
+        opts.slp = true;
+    } else if (arg == "--temporal-blocking") {
+        opts.temporalBlocking = true;
+    } else if (arg == "--unswitch") {
+        opts.unswitch = true;
+    } else if (arg.rfind("--tile-size=", 0) == 0) {
+        int64_t n;
+        if (!parseSize(arg.substr(std::string("--tile-size=").size()), false, n) || n < 2 ||
+            n > (1 << 20))
+            return false;
+        opts.tileSize = (int)n;
+    } else if (arg.rfind("--l1-cache-size=", 0) == 0) {
+        if (!parseSize(arg.substr(std::string("--l1-cache-size=").size()), true, opts.l1CacheSize))
+            return false;
+    } else if (arg.rfind("--l2-cache-size=", 0) == 0) {
+        if (!parseSize(arg.substr(std::string("--l2-cache-size=").size()), true, opts.l2CacheSize))
+            return false;
+    } else if (arg.rfind("--threads=", 0) == 0) {
+        int64_t n;
+        if (!parseSize(arg.substr(std::string("--threads=").size()), false, n) || n > 64)
+            return false;
+        opts.threads = (int)n;
+    } else if (arg == "--load-elim") {
+        opts.loadElim = true;
+    } else if (arg == "--if-convert") {
+        opts.ifConvert = true;
+    } else if (arg == "--rotate-loops") {
+        opts.rotateLoops = true;
+    } else if (arg == "--loop-idiom") {
+        opts.loopIdiom = true;
+    } else if (arg == "--assume-noalias-params") {
+        opts.noaliasParams = true;
+    } else if (arg == "--fast-math") {
+        opts.fastMath = true;
+        opts.fpContract = true;
+    } else if (arg == "--fp-contract=fast") {
+        opts.fpContract = true;
+    } else if (arg == "--fp-contract=off") {
+        opts.fpContract = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 會看 Call 摘要（call_effects / 回傳型別）的 pass。都沒開時不標，
+// -O0 的 Call 跟 lowering 出來的一樣
+static bool needsCallSummaries(const PassOptions& opts, const std::set<std::string>& printAfter) {
+    return opts.loadElim || opts.inlineCalls || opts.ipcp || opts.partialEval ||
+           opts.specializeCalls || !opts.specialize.empty() || opts.unroll ||
+           opts.unrollAndJam || opts.scalarRepl || opts.vectorize || opts.slp ||
+           opts.threads > 1 || printAfter.count("ipa");
+}
+
+static void printHeader(const char* pass, const std::string& funcName) {
+    std::cout << "\n// -----// IR Dump After " << pass << " ("
+              << funcName << ") //----- //\n";
+}
+
+InstrSeq runInstrSeqPasses(const InstrSeq& code, const PassOptions& opts) {
+    if (!opts.promoteStackSlots) return code;
+    int promoted = 0;
+    InstrSeq out = promoteShadowStackSlots(code, &promoted);
+    if (promoted > 0)
+        std::cout << "[PASS] promote-stack-slots: " << promoted << " slot(s)\n";
+    return out;
+}
+
+void runModulePasses(std::vector<ModuleFunction>& funcs, const PassOptions& opts,
+                     const std::set<std::string>& printAfter) {
+    // 最先標：inline / 平行化複製出去的節點帶著標記，reduction 看得到
+    if (opts.fastMath) {
+        int n = 0;
+        for (auto& f : funcs) n += markFastMath(f.values);
+        if (n > 0)
+            std::cout << "[PASS] fast-math: " << n << " floating-point op(s) relaxed\n";
+    }
+
+    // 先把自我遞迴改成 loop：改完就不再呼叫自己，inliner 可以把它展開進 caller
+    if (opts.tailRecursion) {
+        for (auto& f : funcs) {
+            if (!eliminateTailRecursion(f.values, f.name, f.numParams)) continue;
+            std::cout << "[PASS] tail-recursion: " << f.name << " -> loop\n";
+            if (printAfter.count("tailrec")) {
+                printHeader("TailRecursionElimination", f.name);
+                dumpValueIR(f.values);
+            }
+        }
+    }
+
+    // 常數引數的純 call 直接算出結果：要在 specialization / inlining 之前，
+    // 不然 call 已經變成 clone 或展開進 caller，就看不到整個 call 了。
+    // 哪些 call 是純的要先有摘要。
+    if (opts.partialEval) {
+        annotateCalls(funcs, summarizeFunctions(funcs));
+        int n = foldConstantCalls(funcs);
+        if (n > 0)
+            std::cout << "[PASS] partial-eval: " << n << " call(s) folded\n";
+        if (printAfter.count("partial-eval"))
+            for (const auto& f : funcs) {
+                printHeader("PartialEvaluation", f.name);
+                dumpValueIR(f.values);
+            }
+    }
+
+    // specialization 在 inlining 之前：只剩一個 call site 的 clone 可以直接展開
+    bool specialized = false;
+    for (const auto& spec : opts.specialize)
+        specialized |= applySpecializeSpec(funcs, spec);
+    if (opts.specializeCalls)
+        specialized |= specializeCallSites(funcs) > 0;
+    if (specialized && printAfter.count("specialize"))
+        for (const auto& f : funcs) {
+            printHeader("Specialization", f.name);
+            dumpValueIR(f.values);
+        }
+
+    if (opts.inlineCalls) {
+        int n = inlineCalls(funcs);
+        if (n > 0)
+            std::cout << "[PASS] inline: " << n << " call site(s)\n";
+        if (printAfter.count("inline"))
+            for (const auto& f : funcs) {
+                printHeader("Inliner", f.name);
+                dumpValueIR(f.values);
+            }
+    }
+
+    // Call 的回傳型別（void / i64 / f64）跟副作用只有這裡知道，後面的 pass 要用。
+    // 沒有 pass 要看時只補 bridge 非知道不可的回傳型別
+    if (!needsCallSummaries(opts, printAfter)) {
+        annotateCallReturnTypes(funcs, summarizeFunctions(funcs));
+        return;
+    }
+    std::vector<FunctionSummary> sums = summarizeFunctions(funcs);
+    annotateCalls(funcs, sums);
+    if (opts.ipcp) {
+        int n = propagateConstantsInterprocedural(funcs, sums);
+        if (n > 0) {
+            std::cout << "[PASS] ipcp: " << n << " value(s) folded\n";
+            // 刪掉的 call 可能讓 caller 變乾淨，重算一次
+            sums = summarizeFunctions(funcs);
+            annotateCalls(funcs, sums);
+        }
+    }
+    if (printAfter.count("ipa")) {
+        std::cout << "\n// -----// IR Dump After InterproceduralAnalysis //----- //\n";
+        dumpFunctionSummaries(funcs, sums);
+        if (opts.ipcp)
+            for (const auto& f : funcs) {
+                printHeader("IPCP", f.name);
+                dumpValueIR(f.values);
+            }
+    }
+
+    // 最後才拆 task：call 的副作用摘要要先有（loop 裡只能有純的 call），
+    // task 自己的 loop 之後照樣跑單函式的 interchange / tile / unroll
+    if (opts.threads > 1) {
+        AliasOptions aopts;
+        aopts.distinctParamsNoAlias = opts.noaliasParams;
+        // 兩層都帶相依的 nest 先排成波面，tile 那一層標成 doall 交給下面拆
+        WavefrontOptions wopts;
+        wopts.tileSize = opts.tileSize;
+        wopts.threads = opts.threads;
+        for (auto& f : funcs) {
+            if (f.vector.isKernel) continue;
+            int n;
+            {
+                AliasAnalysis aa(f.values, aopts);
+                n = wavefrontLoops(f.values, aa, wopts);
+            }
+            if (n > 0)
+                std::cout << "[PASS] wavefront: " << f.name << ": " << n << " loop nest(s)\n";
+            if (printAfter.count("wavefront")) {
+                printHeader("LoopWavefront", f.name);
+                dumpValueIR(f.values);
+            }
+        }
+
+        ParallelOptions popts;
+        popts.threads = opts.threads;
+        int n = parallelizeLoops(funcs, aopts, popts);
+        if (n > 0)
+            std::cout << "[PASS] parallelize: " << n << " loop(s), " << opts.threads << " threads\n";
+        if (printAfter.count("parallelize"))
+            for (const auto& f : funcs) {
+                printHeader("LoopParallelization", f.name);
+                dumpValueIR(f.values);
+            }
+    }
+}
+
+void runValueIRPasses(ModuleFunction& func, const PassOptions& opts,
+                      const std::set<std::string>& printAfter,
+                      std::vector<ModuleFunction>& kernels) {
+    ValueIR& values = func.values;
+    const std::string& funcName = func.name;
+    AliasOptions aopts;
+    aopts.distinctParamsNoAlias = opts.noaliasParams;
+    const size_t firstKernel = kernels.size();
+
+    if (printAfter.count("alias")) {
+        AliasAnalysis aa(values, aopts);
+        printHeader("AliasAnalysis", funcName);
+        dumpAliasInfo(values, aa);
+    }
+
+    if (printAfter.count("deps")) {
+        AliasAnalysis aa(values, aopts);
+        std::vector<LoopShape> loops = findLoops(values);
+        DependenceAnalysis deps(values, loops, aa);
+        printHeader("DependenceAnalysis", funcName);
+        dumpDependences(values, loops, deps);
+    }
+
+    // 最先換掉只算值的 if / else：arm 裡的運算回到 body 最上層，後面的
+    // scalar-repl / vectorize 看得到，bridge 也少一組 ir_IF / ir_MERGE
+    if (opts.ifConvert) {
+        int n = 0;
+        for (int round = 0; round < 3; round++) {
+            int k = convertIfsToSelects(values, func.paramTypes);
+            if (k == 0) break;
+            n += k;
+        }
+        if (n > 0)
+            std::cout << "[PASS] if-convert: " << n << " if(s) -> select\n";
+        if (printAfter.count("if-convert")) {
+            printHeader("IfConversion", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // 剩下的 If 條件跟 loop 無關時整個 loop 複製成兩份：每份的 body 沒有
+    // 分支，後面的 loop pass 看到的是一般的 loop nest
+    if (opts.unswitch) {
+        int n = unswitchLoops(values);
+        if (n > 0)
+            std::cout << "[PASS] unswitch: " << n << " invariant if(s) hoisted out of loops\n";
+        if (printAfter.count("unswitch")) {
+            printHeader("LoopUnswitching", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // 時間 loop 最先：sweep 還是 step 1 的 counted loop，interchange / tile 之後
+    // 就認不出來了。切好的 sweep 裡面照樣可以 tile / 展開
+    if (opts.temporalBlocking) {
+        StencilOptions sopts;
+        sopts.tileSize = opts.tileSize;
+        sopts.l2CacheSize = opts.l2CacheSize;
+        int n;
+        {
+            AliasAnalysis aa(values, aopts);
+            n = blockTimeLoops(values, aa, sopts);
+        }
+        if (n > 0)
+            std::cout << "[PASS] temporal-blocking: " << n << " time loop(s)\n";
+        if (printAfter.count("temporal-blocking")) {
+            printHeader("TemporalBlocking", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // 先拆開：recurrence 拆出去之後剩下的 loop nest 才是 perfect 的，
+    // interchange / tile 看得到
+    if (opts.distribute) {
+        int n;
+        {
+            AliasAnalysis aa(values, aopts);
+            n = distributeLoops(values, aa);
+        }
+        if (n > 0)
+            std::cout << "[PASS] distribute: " << n << " loop(s)\n";
+        if (printAfter.count("distribute")) {
+            printHeader("LoopDistribution", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // 先換順序再 tile：tile 的 point loop 照新的順序走
+    if (opts.interchange) {
+        int n;
+        {
+            AliasAnalysis aa(values, aopts);
+            n = interchangeLoops(values, aa);
+        }
+        if (n > 0)
+            std::cout << "[PASS] interchange: " << n << " loop nest(s)\n";
+        if (printAfter.count("interchange")) {
+            printHeader("LoopInterchange", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // interchange 之後再併：mvt 第二個 nest 換成 j 在外層之後，兩個 nest
+    // 的外層都走 A 的同一列。併完裡面的 loop 變成相鄰的，再跑一輪
+    if (opts.fuse) {
+        int n = 0;
+        for (int round = 0; round < 3; round++) {
+            AliasAnalysis aa(values, aopts);
+            int k = fuseLoops(values, aa);
+            if (k == 0) break;
+            n += k;
+        }
+        if (n > 0)
+            std::cout << "[PASS] fuse: " << n << " loop(s)\n";
+        if (printAfter.count("fuse")) {
+            printHeader("LoopFusion", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // tiling 在 unroll 之前：point loop 還是 counted loop，最內層照樣可以展開
+    if (opts.tile) {
+        TileOptions topts;
+        topts.tileSize = opts.tileSize;
+        topts.l1CacheSize = opts.l1CacheSize;
+        topts.l2CacheSize = opts.l2CacheSize;
+        int n;
+        {
+            AliasAnalysis aa(values, aopts);
+            n = tileLoops(values, aa, topts);
+        }
+        if (n > 0)
+            std::cout << "[PASS] tile: " << n << " loop nest(s)\n";
+        if (printAfter.count("tile")) {
+            printHeader("LoopTiling", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // tile 之後：tile 要 perfect nest，C[i][j] 的 load / store 搬到 k loop 外面
+    // 就不是了。換出來的 reduction phi 接著可以向量化 / 展開
+    if (opts.scalarRepl) {
+        int n = 0;
+        for (int round = 0; round < 3; round++) {
+            AliasAnalysis aa(values, aopts);
+            int k = scalarReplaceLoops(values, aa);
+            if (k == 0) break;
+            n += k;
+        }
+        if (n > 0)
+            std::cout << "[PASS] scalar-repl: " << n << " array element(s) -> phi\n";
+        if (printAfter.count("scalar-repl")) {
+            printHeader("ScalarReplacement", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // 填值 / 複製的 loop 在向量化之前換成 memory.fill / memory.copy：libc 的
+    // memset / memmove 比向量化的 store loop 快，也不用拆成 kernel
+    if (opts.loopIdiom) {
+        int n;
+        {
+            AliasAnalysis aa(values, aopts);
+            n = recognizeMemIdioms(values, aa);
+        }
+        if (n > 0)
+            std::cout << "[PASS] loop-idiom: " << n << " loop(s) -> memory.fill / memory.copy\n";
+        if (printAfter.count("loop-idiom")) {
+            printHeader("LoopIdiom", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // 向量化在展開之前：展開過的 loop step 不是 1，認不出來。拆出去的 kernel
+    // 不再跑下面的 pass，由 C compiler 處理
+    if (opts.vectorize) {
+        const size_t first = kernels.size();
+        int n = vectorizeLoops(func, aopts, kernels);
+        if (n > 0)
+            std::cout << "[PASS] vectorize: " << n << " loop(s)\n";
+        if (printAfter.count("vectorize")) {
+            printHeader("LoopVectorization", funcName);
+            dumpValueIR(values);
+            for (size_t k = first; k < kernels.size(); k++) {
+                printHeader("LoopVectorization", kernels[k].name);
+                dumpValueIR(kernels[k].values);
+            }
+        }
+    }
+
+    // 展開在 load-elim 之前：複本之間重複的 load（A[i][k]）跟位址運算交給它合併
+    if (opts.unroll || opts.unrollAndJam) {
+        UnrollOptions uopts;
+        uopts.unroll = opts.unroll;
+        uopts.jam = opts.unrollAndJam;
+        int n;
+        {
+            AliasAnalysis aa(values, aopts);
+            n = unrollLoops(values, aa, uopts);
+        }
+        if (n > 0)
+            std::cout << "[PASS] unroll: " << n << " loop(s)\n";
+        if (printAfter.count("unroll")) {
+            printHeader("LoopUnroll", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    if (opts.loadElim) {
+        int n;
+        {
+            AliasAnalysis aa(values, aopts);
+            n = eliminateRedundantLoads(values, aa);
+        }
+        if (n > 0) {
+            values = cleanupValueIR(values);
+            std::cout << "[PASS] load-elim: " << n << " value(s) replaced\n";
+        }
+        if (printAfter.count("load-elim")) {
+            printHeader("LoadElimination", funcName);
+            dumpValueIR(values);
+        }
+    }
+
+    // SLP 在最後：展開、load-elim 之後同構的純量運算才排在一起，kernel 的
+    // call 會讀寫記憶體，放前面會擋到 load-elim
+    if (opts.slp) {
+        const size_t first = kernels.size();
+        int n = slpVectorize(func, aopts, kernels);
+        if (n > 0)
+            std::cout << "[PASS] slp-vectorize: " << n << " block(s)\n";
+        if (printAfter.count("slp")) {
+            printHeader("SLPVectorization", funcName);
+            dumpValueIR(values);
+            for (size_t k = first; k < kernels.size(); k++) {
+                printHeader("SLPVectorization", kernels[k].name);
+                dumpValueIR(kernels[k].values);
+            }
+        }
+    }
+
+    // FMA 在最後：前面的 pass 都只認 F64Mul / F64Add。這個函式拆出來的
+    // kernel 也一起合併（它們不跑上面的 pass）
+    if (opts.fpContract) {
+        int n = contractMulAdd(values);
+        for (size_t k = firstKernel; k < kernels.size(); k++) n += contractMulAdd(kernels[k].values);
+        if (n > 0)
+            std::cout << "[PASS] fp-contract: " << n << " mul+add -> fma\n";
+        if (printAfter.count("fp-contract")) {
+            printHeader("FPContraction", funcName);
+            dumpValueIR(values);
+            for (size_t k = firstKernel; k < kernels.size(); k++) {
+                printHeader("FPContraction", kernels[k].name);
+                dumpValueIR(kernels[k].values);
+            }
+        }
+    }
+
+    // 最後才轉成 do-while：前面的 loop pass 都只認 top-tested 的形狀。
+    // 拆出去的 kernel 由 C compiler 處理，不轉
+    if (opts.rotateLoops) {
+        int n = rotateLoops(values);
+        if (n > 0)
+            std::cout << "[PASS] rotate-loops: " << n << " loop(s) -> do-while\n";
+        if (printAfter.count("rotate")) {
+            printHeader("LoopRotation", funcName);
+            dumpValueIR(values);
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "wasm_instr.hpp"
+#include "value_ir.hpp"
+#include "value_ir_specialize.hpp"
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+// ============================================================
+// 優化 pipeline：lowering 前後各一段，由命令列選項開關
+// ============================================================
+//
+// 預設（-O0）什麼都不做，輸出跟加 pass 之前完全一樣；唯一的例外是呼叫
+// module 裡回傳 i64 / f32 / f64 的函式的 Call，bridge 要知道回傳型別。
+
+struct PassOptions {
+    bool promoteStackSlots = false;   // --promote-stack-slots
+    bool loadElim = false;            // --load-elim
+    bool ifConvert = false;           // --if-convert
+    bool rotateLoops = false;         // --rotate-loops
+    bool loopIdiom = false;           // --loop-idiom
+    bool noaliasParams = false;       // --assume-noalias-params（不隨 -O 打開）
+    bool inboundsAddressing = false;  // --assume-inbounds-addressing（-O2），交給 IRBridge
+    bool inlineCalls = false;         // --inline
+    bool tailRecursion = false;       // --tail-recursion
+    bool ipcp = false;                // --ipcp
+    bool partialEval = false;         // --partial-eval
+    bool specializeCalls = false;     // --specialize-calls（-O2）
+    bool unroll = false;              // --unroll（-O2）
+    bool unrollAndJam = false;        // --unroll-and-jam（-O2）
+    bool interchange = false;         // --interchange（-O2）
+    bool distribute = false;          // --distribute（-O2）
+    bool fuse = false;                // --fuse（-O2）
+    bool tile = false;                // --tile（-O2）
+    bool scalarRepl = false;          // --scalar-repl（-O2）
+    bool vectorize = false;           // --vectorize（-O2）
+    bool slp = false;                 // --slp-vectorize（-O2）
+    bool temporalBlocking = false;    // --temporal-blocking（-O2）
+    bool unswitch = false;            // --unswitch（-O2）
+    int tileSize = 0;                 // --tile-size=N；0 = 依 cache 大小
+    int64_t l1CacheSize = 0;          // --l1-cache-size=N[K|M]；0 = 問 host
+    int64_t l2CacheSize = 0;          // --l2-cache-size=N[K|M]
+    int threads = 1;                  // --threads=N；> 1 時平行化 DOALL loop（不隨 -O 打開）
+    bool fpContract = false;          // --fp-contract=fast|off（不隨 -O 打開；跟 --fast-math 以後出現的為準）
+    bool fastMath = false;            // --fast-math（含 fpContract，不隨 -O 打開）
+    std::vector<SpecializeSpec> specialize;   // --specialize=func:param=value,...（可重複）
+};
+
+// 認得的選項回傳 true 並更新 opts；-O0 / -O1 / -O2 設定整組預設值
+bool parsePassOption(const std::string& arg, PassOptions& opts);
+
+// lowering 之前：InstrSeq 層級的改寫
+InstrSeq runInstrSeqPasses(const InstrSeq& code, const PassOptions& opts);
+
+// 所有函式都 lower 完之後：跨函式的改寫（tail recursion → loop、inlining、
+// 常數傳播、DOALL loop 拆成 task），以及每個 Call 的副作用 / 回傳型別摘要
+// （沒有 pass 要看摘要時只標 i64 / f32 / f64 的回傳型別）。
+void runModulePasses(std::vector<ModuleFunction>& funcs, const PassOptions& opts,
+                     const std::set<std::string>& printAfter);
+
+// lowering 之後：func 的 ValueIR 層級改寫。printAfter 裡有 pass 名稱時，
+// 在該 pass 之後印出 ValueIR（跟 --print-after=valueir 同格式）。
+// 向量化拆出來的 kernel 放進 kernels（不經過 bridge，見 value_ir_vectorize.hpp）。
+void runValueIRPasses(ModuleFunction& func, const PassOptions& opts,
+                      const std::set<std::string>& printAfter,
+                      std::vector<ModuleFunction>& kernels);
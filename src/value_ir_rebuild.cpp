@@ -0,0 +1,123 @@
+#include "value_ir_rebuild.hpp"
+#include "value_ir_util.hpp"
+
+ValueIRRebuilder::ValueIRRebuilder(const ValueIR& in)
+    : in_(in), map_(in.size(), -1), afterRepl_(in.size(), -1) {}
+
+int ValueIRRebuilder::emit(Value v) {
+    v.id = (int)out_.size();
+    out_.push_back(v);
+    return v.id;
+}
+
+int ValueIRRebuilder::emitOp(Op op, int lhs, int rhs, int c) {
+    Value v;
+    v.op = op;
+    v.type = ValueType::I32;
+    v.lhs = lhs;
+    v.rhs = rhs;
+    v.constValue = c;
+    return emit(v);
+}
+
+int ValueIRRebuilder::mapOutside(int ref) const {
+    if (ref < 0) return ref;
+    if (afterRepl_[ref] >= 0) ref = afterRepl_[ref];
+    return map_[ref];
+}
+
+int ValueIRRebuilder::resolveIn(int ref, int rb, int re) const {
+    if (ref >= rb && ref <= re) return map_[ref];
+    return mapOutside(ref);
+}
+
+int ValueIRRebuilder::lookup(int ref, const CopyScope& sc) const {
+    if (ref < 0) return ref;
+    if (sc.repl && (*sc.repl)[ref] >= 0) ref = (*sc.repl)[ref];
+    for (const LocalMap* f : sc.frames) {
+        auto it = f->find(ref);
+        if (it != f->end()) return it->second;
+    }
+    return mapOutside(ref);
+}
+
+void ValueIRRebuilder::copyNode(int i, LocalMap& into, const CopyScope& sc) {
+    Value v = in_[i];
+    forEachOperand(v, [&](int& ref) { ref = lookup(ref, sc); });
+    into[i] = emit(v);
+}
+
+// End(1) 在 ValueIR 裡沒有作用，複本裡不放
+void ValueIRRebuilder::copyRange(int b, int e, LocalMap& into, const CopyScope& sc,
+                          const std::vector<char>* skip) {
+    for (int i = b; i < e; i++) {
+        const Value& v = in_[i];
+        if (v.op == Op::Phi && v.local_index >= 0) continue;
+        if (v.op == Op::End && v.constValue == 1) continue;
+        if (skip && (*skip)[i]) continue;
+        copyNode(i, into, sc);
+    }
+}
+
+void ValueIRRebuilder::copyVerbatim(int rb, int re, const LocalMap* entry, bool skipBlockEnds) {
+    for (int i = rb; i <= re; i++) {
+        Value v = in_[i];
+        if (skipBlockEnds && v.op == Op::End && v.constValue == 1) continue;
+        int id = (int)out_.size();
+        if (v.op == Op::Phi && v.local_index >= 0) {
+            for (size_t k = 0; k < v.operands.size(); k++) {
+                int ref = v.operands[k];
+                if (k == 0 && entry && entry->count(i)) {
+                    v.operands[0] = entry->at(i);
+                } else if (k == 0 || ref < 0) {
+                    v.operands[k] = resolveIn(ref, rb, re);
+                } else {
+                    fixups_.push_back({id, k, ref, rb, re});
+                }
+            }
+        } else {
+            forEachOperand(v, [&](int& ref) { ref = resolveIn(ref, rb, re); });
+        }
+        forEachControlRef(v, [&](int& ref) { ref = map_[ref]; });
+        map_[i] = emit(v);
+    }
+}
+
+void ValueIRRebuilder::copyUnmapped(int b, int e, bool skipBlockEnds) {
+    for (int i = b; i <= e; i++)
+        if (map_[i] < 0) copyVerbatim(i, i, nullptr, skipBlockEnds);
+}
+
+std::vector<int> ValueIRRebuilder::emitPhis(const LoopShape& s, LocalMap& state, const CopyScope& entry) {
+    LocalMap params;
+    CopyScope sc = entry;
+    sc.frames.insert(sc.frames.begin(), &params);
+    for (int phi : s.phis) {
+        int ref = in_[phi].operands[0];
+        if (ref > s.loop && ref < s.end && !params.count(ref)) copyNode(ref, params, sc);
+    }
+    std::vector<int> ids;
+    for (int phi : s.phis) {
+        Value v = in_[phi];
+        v.operands = {lookup(v.operands[0], sc)};
+        int id = emit(v);
+        state[phi] = id;
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+ValueIR ValueIRRebuilder::run(const std::vector<std::pair<int, int>>& regions) {
+    size_t next = 0;
+    for (int i = 0; i < (int)in_.size(); i++) {
+        if (next < regions.size() && regions[next].first == i) {
+            emitRegion(next);
+            i = regions[next++].second;
+            continue;
+        }
+        copyVerbatim(i, i, nullptr);
+    }
+    for (const Fixup& f : fixups_)
+        out_[f.node].operands[f.k] = resolveIn(f.ref, f.rb, f.re);
+    return out_;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_loops.hpp"
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ============================================================
+// 重建 ValueIR：改寫 loop 結構的 pass 共用
+// ============================================================
+//
+// 從頭到尾複製一次 ValueIR，碰到指定的範圍就交給子類別產生新的節點。
+// 範圍外的節點、照原樣複製的 loop 用 map_（舊 id → 新 id）；同一段被
+// 複製好幾份時，每一份用自己的 LocalMap，一層層往外找，找不到再看
+// map_。loop phi 的 back operand 在後面，最後才補（fixups_）。
+
+using LocalMap = std::unordered_map<int, int>;
+
+struct CopyScope {
+    std::vector<const LocalMap*> frames;     // 先找前面的
+    const std::vector<int>* repl = nullptr;  // 先套這張替代表
+};
+
+class ValueIRRebuilder {
+public:
+    explicit ValueIRRebuilder(const ValueIR& in);
+    virtual ~ValueIRRebuilder() = default;
+
+    // regions 依開頭排序、互不重疊；每個 [first, second] 呼叫一次 emitRegion
+    ValueIR run(const std::vector<std::pair<int, int>>& regions);
+
+protected:
+    virtual void emitRegion(size_t k) = 0;
+
+    int emit(Value v);
+    int emitOp(Op op, int lhs, int rhs, int c = 0);
+    // 範圍外的 ref：先套 afterRepl_（loop 之後對 body 值的引用 → phi）
+    int mapOutside(int ref) const;
+    // 照原樣複製的範圍 [rb, re] 裡的 ref 不套 afterRepl_（那是 loop 自己的值）
+    int resolveIn(int ref, int rb, int re) const;
+    int lookup(int ref, const CopyScope& sc) const;
+    void copyNode(int i, LocalMap& into, const CopyScope& sc);
+    // 沒有巢狀 loop 的一段：略過 loop phi（呼叫端另外建）與 End(1)
+    void copyRange(int b, int e, LocalMap& into, const CopyScope& sc,
+                   const std::vector<char>* skip = nullptr);
+    // [rb, re] 照原樣複製進 map_；entry 有列的 loop phi 換掉入口值。
+    // skipBlockEnds 時不放 End(1)（搬進別的 loop 裡的片段用）。
+    void copyVerbatim(int rb, int re, const LocalMap* entry, bool skipBlockEnds = false);
+    // s 的 phi 換成新的（只有入口值，back operand 由呼叫端補）。入口值是
+    // header 裡的 Param / 常數時先在 phi 前面複製一份。
+    // [b, e] 一個一個照原樣複製進 map_，已經複製過的（先拿出來的 Param /
+    // 常數）跳過。重排 loop 順序的 pass 用。
+    void copyUnmapped(int b, int e, bool skipBlockEnds);
+    std::vector<int> emitPhis(const LoopShape& s, LocalMap& state, const CopyScope& entry);
+    void setBack(int phi, int value) { out_[phi].operands.push_back(value); }
+
+    const ValueIR& in_;
+    ValueIR out_;
+    std::vector<int> map_;
+    std::vector<int> afterRepl_;
+
+private:
+    struct Fixup { int node; size_t k; int ref; int rb, re; };
+    std::vector<Fixup> fixups_;
+};
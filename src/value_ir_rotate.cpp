@@ -0,0 +1,195 @@
+#include "value_ir_rotate.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace {
+
+// header 複本的大小上限（不含 phi）；每個 loop 多兩份
+constexpr int kMaxHeaderCopy = 8;
+
+struct RotatePlan {
+    LoopShape s;
+    bool guard = true;          // 可能一輪都不跑：外面包 If，loop 之後用 merge phi
+    std::vector<int> hoist;     // header 裡的 Param / 常數：搬到 loop（guard）前面
+    std::vector<int> header;    // 要複製的 header 節點（不含 phi、hoist），程式順序
+    std::vector<int> liveOut;   // loop 之後還會用到的 header 節點
+    std::vector<int> repl;      // exitValueMap：loop 之後用到的 body 值 → phi
+
+    // 改寫時用（out 裡的 id）
+    std::map<int, int> guardCopy, latchCopy;   // header 節點 → 複本
+};
+
+bool planRotation(const ValueIR& values, const LoopShape& s, RotatePlan& p) {
+    if (!s.simple || values[s.exitBr].lhs < 0) return false;
+    for (int ph : s.phis) {
+        const Value& v = values[ph];
+        if (v.use_vload_entry || v.operands.size() != 2 || v.lanes > 1) return false;
+    }
+    for (int k = s.header(); k < s.exitBr; k++) {
+        const Value& v = values[k];
+        if (v.op == Op::Phi) {
+            if (std::find(s.phis.begin(), s.phis.end(), k) == s.phis.end()) return false;
+            continue;
+        }
+        if (v.lanes > 1) return false;
+        if (v.op == Op::Param || isConstOp(v.op)) {
+            p.hoist.push_back(k);
+            continue;
+        }
+        if (!isPureOp(v.op) && !isMemoryRead(v.op)) return false;
+        p.header.push_back(k);
+    }
+    if ((int)p.header.size() > kMaxHeaderCopy) return false;
+    if (!exitValueMap(values, s, p.repl)) return false;
+
+    std::vector<char> usedAfter(values.size(), 0);
+    for (int i = s.end + 1; i < (int)values.size(); i++)
+        forEachOperand(values[i], [&](int ref) { usedAfter[ref] = 1; });
+    for (int k : p.header)
+        if (usedAfter[k]) p.liveOut.push_back(k);
+
+    p.s = s;
+    p.guard = s.tripCount < 1;
+    return true;
+}
+
+} // namespace
+
+int rotateLoops(ValueIR& values) {
+    std::map<int, RotatePlan> plans;   // Loop 節點 → plan
+    for (const LoopShape& s : findLoops(values)) {
+        RotatePlan p;
+        if (planRotation(values, s, p)) plans.emplace(s.loop, std::move(p));
+    }
+    if (plans.empty()) return 0;
+
+    std::map<int, RotatePlan*> byExit, byBack;
+    std::vector<char> hoisted(values.size(), 0);
+    for (auto& [loop, p] : plans) {
+        byExit[p.s.exitBr] = &p;
+        byBack[p.s.backBr] = &p;
+        for (int k : p.hoist) hoisted[k] = 1;
+    }
+    const std::vector<int> match = matchRegions(values);
+
+    ValueIR out;
+    std::vector<int> map(values.size(), -1);
+    // loop phi 的 back operand 在後面，走到那個 loop 的 End 再補：loop 裡
+    // 的值還沒被換成 loop 之後的版本（merge phi）
+    struct Fixup { int node; size_t k; int ref; };
+    std::map<int, std::vector<Fixup>> pending;   // Loop（舊 id）→ 還沒補的 operand
+    auto emit = [&](Value v) {
+        v.id = (int)out.size();
+        out.push_back(v);
+        return v.id;
+    };
+    auto isPhiOf = [&](const RotatePlan& p, int ref) {
+        return std::find(p.s.phis.begin(), p.s.phis.end(), ref) != p.s.phis.end();
+    };
+    // header 複本裡的 ref：複本自己的節點、這個 loop 的 phi（換成它的第
+    // operand 個 operand）、其他照 map
+    auto resolve = [&](const RotatePlan& p, const std::map<int, int>& copy, int operand, int ref) {
+        auto it = copy.find(ref);
+        if (it != copy.end()) return it->second;
+        if (isPhiOf(p, ref)) return map[values[ref].operands[operand]];
+        return map[ref];
+    };
+    // operand 0：入口值（guard），1：這一輪算出來的 next（latch）
+    auto copyHeader = [&](const RotatePlan& p, std::map<int, int>& copy, int operand) {
+        for (int k : p.header) {
+            Value c = values[k];
+            forEachOperand(c, [&](int& ref) { ref = resolve(p, copy, operand, ref); });
+            copy[k] = emit(c);
+        }
+        return resolve(p, copy, operand, values[p.s.exitBr].lhs);
+    };
+
+    int rotated = 0;
+    int lastLoop = -1;
+    for (int i = 0; i < (int)values.size(); i++) {
+        Value v = values[i];
+
+        // 跳過 guard 時 header 沒跑過，loop 之後還會用到的 Param / 常數先拿出來
+        if (hoisted[i]) continue;
+        auto pit = plans.find(i);
+        if (pit != plans.end()) {
+            for (int k : pit->second.hoist) map[k] = emit(values[k]);
+        }
+        if (pit != plans.end() && pit->second.guard) {
+            RotatePlan& p = pit->second;
+            Value g;
+            g.op = Op::If;
+            g.lhs = copyHeader(p, p.guardCopy, 0);
+            emit(g);
+        }
+
+        // 原本的 exit test 拿掉，latch 改成條件式的 back-edge
+        if (byExit.count(i)) continue;
+        auto bit = byBack.find(i);
+        if (bit != byBack.end()) {
+            RotatePlan& p = *bit->second;
+            Value br;
+            br.op = Op::Br_if;
+            br.lhs = copyHeader(p, p.latchCopy, 1);
+            br.rhs = map[p.s.loop];
+            br.constValue = 0;
+            map[i] = emit(br);
+            continue;
+        }
+
+        if (v.op == Op::Loop) lastLoop = i;
+        if (v.op == Op::End && v.constValue == 0 && match[i] >= 0) {
+            for (const Fixup& f : pending[match[i]]) out[f.node].operands[f.k] = map[f.ref];
+            pending.erase(match[i]);
+        }
+
+        if (v.op == Op::Phi && v.local_index >= 0) {
+            for (size_t k = 0; k < v.operands.size(); k++) {
+                int ref = v.operands[k];
+                if (ref >= i) pending[lastLoop].push_back({(int)out.size(), k, ref});
+                else if (ref >= 0) v.operands[k] = map[ref];
+            }
+        } else {
+            forEachOperand(v, [&](int& ref) { ref = map[ref]; });
+        }
+        forEachControlRef(v, [&](int& ref) { ref = map[ref]; });
+        map[i] = emit(v);
+
+        if (v.op != Op::End || v.constValue != 0 || match[i] < 0) continue;
+        auto eit = plans.find(match[i]);
+        if (eit == plans.end()) continue;
+        RotatePlan& p = eit->second;
+
+        // loop 之後：phi 是最後一輪的 next，header 的值是 latch 的複本；
+        // 有 guard 時再跟沒進 loop 的那條路合併
+        std::vector<std::pair<int, int>> after;   // 舊 id → (loop 那條路的值)
+        for (int ph : p.s.phis) after.push_back({ph, map[values[ph].operands[1]]});
+        for (int k : p.liveOut) after.push_back({k, p.latchCopy.at(k)});
+        if (p.guard) {
+            Value e;
+            e.op = Op::End;
+            e.constValue = 2;
+            emit(e);
+            for (auto& [old, loopVal] : after) {
+                Value phi;
+                phi.op = Op::Phi;
+                phi.type = values[old].type;
+                phi.local_index = -1;
+                int skipped = isPhiOf(p, old) ? map[values[old].operands[0]] : p.guardCopy.at(old);
+                phi.operands = {loopVal, skipped};
+                loopVal = emit(phi);
+            }
+        }
+        for (auto& [old, val] : after) map[old] = val;
+        for (int k = 0; k < (int)p.repl.size(); k++)
+            if (p.repl[k] >= 0) map[k] = map[p.repl[k]];
+        rotated++;
+    }
+
+    values = cleanupValueIR(out);
+    return rotated;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "value_ir.hpp"
+
+// ============================================================
+// Loop rotation：top-tested loop 改成有 guard 的 do-while
+// ============================================================
+//
+// clang -O0 的 `block; loop; <cond>; br_if 1; <body>; br 0` 每一輪都在
+// loop 開頭判斷一次（bridge 的 BrIfNode 是 header 上的 ir_IF），body
+// 最後再無條件跳回去。把條件搬到 latch：
+//
+//   Loop                                 <header 複本：phi → 入口值>
+//     i = Phi(i0, next)                  If(c0)
+//     c = Lt_S(i, n)                       Loop
+//     Br_if(c, exit)              →          i = Phi(i0, next)
+//     <body>                                 <body>
+//     next = Add(i, 1)                       next = Add(i, 1)
+//     Br(Loop)                               <header 複本：phi → next>
+//   End(loop)                                Br_if(c1, back)
+//                                          End(loop)
+//                                        End(if)
+//                                        i' = Phi(next, i0)      loop 之後用 i 的改用 i'
+//
+// 每一輪少一個分支，backend 也拿到 exit test 在 latch 的標準形狀。
+// trip count 已知至少一次時不用 guard（也不用 merge phi）。
+//
+// 對象：findLoops 的 simple loop，header 除了 phi 只有 Param、常數、純運算、
+// load（複製兩份，最多 kMaxHeaderCopy 個節點；照原本的順序執行，load 次數
+// 也一樣），loop 之後只用到 phi / header 的值（exitValueMap）。bridge 的
+// VLOAD 入口 phi（use_vload_entry）只有 Br 的 back-edge 會接，不轉。
+//
+// 改完不再是 findLoops 認得的形狀，所以放在所有 loop pass 之後、bridge 之前。
+// 回傳轉成 do-while 的 loop 數；有改寫時 values 重建並跑過 cleanupValueIR。
+int rotateLoops(ValueIR& values);
@@ -0,0 +1,362 @@
+#include "value_ir_scalar_repl.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+
+namespace {
+
+bool isAccess(Op op) {
+    return op == Op::Load || op == Op::F64Load || op == Op::Store || op == Op::F64Store;
+}
+
+bool isStore(Op op) {
+    return op == Op::Store || op == Op::F64Store;
+}
+
+// 同一個位置的一組存取（body 最上層，程式順序）
+struct Group {
+    std::string ptrKey;
+    int offset = 0, bytes = 0;
+    ValueType type = ValueType::I32;
+    std::vector<int> members;
+    bool hasStore = false;
+
+    int rep() const { return members.front(); }   // loop 前的 load、loop 後的 store 照它的位址
+
+    // 改寫時用（out 裡的 id）
+    int ptr = -1, entry = -1, phi = -1, current = -1;
+};
+
+struct LoopPlan {
+    LoopShape s;
+    std::vector<Group> groups;
+    std::vector<int> hoist;    // 搬到 loop 前面的位址運算（由小到大）
+};
+
+class ScalarReplacer {
+public:
+    ScalarReplacer(const ValueIR& values, const AliasAnalysis& aa)
+        : values_(values), aa_(aa) {}
+
+    bool plan(const std::vector<LoopShape>& loops, int k, LoopPlan& out) const;
+
+private:
+    std::string addressKey(const LoopShape& s, int id, int depth) const;
+    void collectHoist(const LoopShape& s, int id, std::set<int>& hoist) const;
+    bool runsOnce(const std::vector<LoopShape>& loops, int k) const;
+    bool accessedBefore(const LoopShape& s, const Group& g) const;
+    bool dominates(int x, int loop) const;
+
+    const ValueIR& values_;
+    const AliasAnalysis& aa_;
+};
+
+// 位址的結構 key：body 裡重算的 `C + (i * n + j) * 8` 跟 loop 前面算的要一樣。
+// 純運算往下拆，Param / 常數照值，其他 loop 外的節點照 SSA id；碰到
+// loop 裡每一輪會變的值（phi、load……）回傳空字串。
+std::string ScalarReplacer::addressKey(const LoopShape& s, int id, int depth) const {
+    if (id < 0 || depth > 16) return "";
+    const Value& v = values_[id];
+    switch (v.op) {
+    case Op::Param: return "p" + std::to_string(v.paramIndex);
+    case Op::I32Const: return "c" + std::to_string(v.constValue);
+    case Op::I64Const: return "C" + std::to_string(v.constValue);
+    default: break;
+    }
+    if (isPureOp(v.op) && v.op != Op::F64Const) {
+        std::string key = std::string(opToString(v.op)) + "(";
+        bool ok = true;
+        forEachOperand(v, [&](int ref) {
+            std::string sub = addressKey(s, ref, depth + 1);
+            if (sub.empty()) ok = false;
+            key += sub + ",";
+        });
+        return ok ? key + ")" : "";
+    }
+    if (id > s.loop && id < s.end) return "";
+    return "v" + std::to_string(id);
+}
+
+// addressKey 成功的位址裡、定義在 loop 裡的節點
+void ScalarReplacer::collectHoist(const LoopShape& s, int id, std::set<int>& hoist) const {
+    if (id <= s.loop || id >= s.end || hoist.count(id)) return;
+    hoist.insert(id);
+    forEachOperand(values_[id], [&](int ref) { collectHoist(s, ref, hoist); });
+}
+
+// loop 至少跑一次：trip count 已知，或外層有同一個 bound 的 `iv < n`，
+// iv 從 step 1、不小於這個 loop 的起點開始（外層 body 裡 init <= iv < n）
+bool ScalarReplacer::runsOnce(const std::vector<LoopShape>& loops, int k) const {
+    const LoopShape& s = loops[k];
+    if (s.tripCount >= 1) return true;
+    if (!s.hasIV() || s.bound < 0) return false;
+    if (s.cmp != LoopCmp::LtS && s.cmp != LoopCmp::LtU) return false;
+    auto constOf = [&](int id, int32_t& c) {
+        if (id < 0 || values_[id].op != Op::I32Const) return false;
+        c = values_[id].constValue;
+        return true;
+    };
+    auto sameValue = [&](int a, int b) {
+        if (a == b) return true;
+        const Value& x = values_[a];
+        const Value& y = values_[b];
+        if (x.op == Op::Param && y.op == Op::Param) return x.paramIndex == y.paramIndex;
+        return isConstOp(x.op) && sameConst(x, y);
+    };
+    int32_t init;
+    if (!constOf(values_[s.iv].operands[0], init)) return false;
+    for (int p = s.parent; p >= 0; p = loops[p].parent) {
+        const LoopShape& o = loops[p];
+        if (!o.simple || !o.hasIV() || o.step != 1 || o.cmp != s.cmp || o.bound < 0) continue;
+        if (!sameValue(o.bound, s.bound)) continue;
+        int32_t outer;
+        if (!constOf(values_[o.iv].operands[0], outer)) continue;
+        if (s.cmp == LoopCmp::LtS ? outer >= init : (uint32_t)outer >= (uint32_t)init) return true;
+    }
+    return false;
+}
+
+// x 在 loop 之前、每次走到 loop 都一定先跑過：中間沒有把 x 關起來的 End，
+// 也沒有 x 那個 If 的 Else
+bool ScalarReplacer::dominates(int x, int loop) const {
+    int depth = 0;
+    for (int k = x + 1; k < loop; k++) {
+        const Value& v = values_[k];
+        if (v.op == Op::If || v.op == Op::Loop) {
+            depth++;
+        } else if (v.op == Op::Else) {
+            if (depth == 0) return false;
+        } else if (v.op == Op::End && v.constValue != 1) {
+            if (depth == 0) return false;
+            depth--;
+        }
+    }
+    return true;
+}
+
+// loop 之前已經存取過同一個位置：迭代 0 次時多出來的 load / store 也不會
+// 碰到原本沒碰的記憶體
+bool ScalarReplacer::accessedBefore(const LoopShape& s, const Group& g) const {
+    for (int x = 0; x < s.loop; x++) {
+        const Value& v = values_[x];
+        if (!isAccess(v.op) || v.lanes > 1) continue;
+        if (v.mem_offset != g.offset || memAccessBytes(v) != g.bytes) continue;
+        if (addressKey(s, v.lhs, 0) != g.ptrKey) continue;
+        if (dominates(x, s.loop)) return true;
+    }
+    return false;
+}
+
+bool ScalarReplacer::plan(const std::vector<LoopShape>& loops, int k, LoopPlan& out) const {
+    const LoopShape& s = loops[k];
+    if (!s.simple) return false;
+
+    std::vector<int> accesses;
+    for (int i = s.loop + 1; i < s.end; i++) {
+        const Value& v = values_[i];
+        if (v.lanes > 1) return false;
+        if (v.op == Op::MemoryFill || v.op == Op::MemoryCopy) return false;
+        if (v.op == Op::Call && (v.call_effects & (CallReadsMemory | CallWritesMemory))) return false;
+        if (isAccess(v.op)) accesses.push_back(i);
+    }
+
+    // body 最上層的存取照位置分組
+    std::vector<Group> groups;
+    std::set<int> grouped;
+    int depth = 0;
+    for (int i = s.bodyBegin(); i < s.backBr; i++) {
+        const Value& v = values_[i];
+        if (v.op == Op::If || v.op == Op::Loop) { depth++; continue; }
+        if (v.op == Op::End && v.constValue != 1) { depth--; continue; }
+        if (depth > 0 || !isAccess(v.op)) continue;
+        ValueType t = memAccessType(v);
+        if (memAccessBytes(v) != typeBytes(t)) continue;
+        std::string key = addressKey(s, v.lhs, 0);
+        if (key.empty()) continue;
+        auto it = std::find_if(groups.begin(), groups.end(), [&](const Group& g) {
+            return g.ptrKey == key && g.offset == v.mem_offset && g.type == t;
+        });
+        if (it == groups.end()) {
+            Group g;
+            g.ptrKey = key;
+            g.offset = v.mem_offset;
+            g.bytes = memAccessBytes(v);
+            g.type = t;
+            groups.push_back(g);
+            it = groups.end() - 1;
+        }
+        it->members.push_back(i);
+        it->hasStore |= isStore(v.op);
+        grouped.insert(i);
+    }
+
+    std::set<int> hoist;
+    for (auto& g : groups) {
+        if (!g.hasStore) continue;
+        bool ok = true;
+        for (int x : accesses) {
+            if (std::find(g.members.begin(), g.members.end(), x) != g.members.end()) continue;
+            if (aa_.mayAlias(x, g.rep())) { ok = false; break; }
+        }
+        if (!ok) continue;
+        if (!runsOnce(loops, k) && !accessedBefore(s, g)) continue;
+        collectHoist(s, values_[g.rep()].lhs, hoist);
+        out.groups.push_back(g);
+    }
+    if (out.groups.empty()) return false;
+    out.s = s;
+    out.hoist.assign(hoist.begin(), hoist.end());
+    return true;
+}
+
+// 新 phi 的 local_index：跟其他 local 都不重複
+int freshLocal(const ValueIR& values) {
+    int next = 0;
+    for (const auto& v : values) {
+        if (v.op == Op::Param || v.op == Op::LocalSet || v.op == Op::LocalGet || v.op == Op::LocalTee)
+            next = std::max(next, v.paramIndex + 1);
+        if (v.op == Op::Phi) next = std::max(next, v.local_index + 1);
+    }
+    return next;
+}
+
+// rep 的位址上的 load / store（型別、寬度、offset 照 rep）
+Value makeAccess(const Value& rep, bool store, int ptr, int value) {
+    bool fp = rep.op == Op::F64Load || rep.op == Op::F64Store;
+    ValueType t = memAccessType(rep);
+    Value v;
+    v.op = store ? (fp ? Op::F64Store : Op::Store) : (fp ? Op::F64Load : Op::Load);
+    // F64Store 的 type 沒填（I32），F32 的才有記
+    v.type = (store && fp && t == ValueType::F64) ? ValueType::I32 : t;
+    v.lhs = ptr;
+    v.rhs = store ? value : -1;
+    v.mem_offset = rep.mem_offset;
+    v.mem_align = rep.mem_align;
+    v.mem_bytes = rep.mem_bytes;
+    return v;
+}
+
+} // namespace
+
+int scalarReplaceLoops(ValueIR& values, const AliasAnalysis& aa) {
+    std::vector<LoopShape> loops = findLoops(values);
+    ScalarReplacer sr(values, aa);
+
+    // 內層先挑，互相包含的只改一個
+    std::map<int, LoopPlan> plans;   // Loop 節點 → plan
+    std::vector<std::pair<int, int>> taken;
+    for (int k = (int)loops.size() - 1; k >= 0; k--) {
+        const LoopShape& s = loops[k];
+        bool overlaps = false;
+        for (const auto& [b, e] : taken)
+            if (s.loop <= e && b <= s.end) overlaps = true;
+        if (overlaps) continue;
+        LoopPlan p;
+        if (!sr.plan(loops, k, p)) continue;
+        taken.push_back({s.loop, s.end});
+        plans.emplace(s.loop, std::move(p));
+    }
+    if (plans.empty()) return 0;
+
+    // 每個存取屬於哪個 plan 的哪一組
+    std::map<int, std::pair<LoopPlan*, size_t>> member;
+    for (auto& [loop, p] : plans)
+        for (size_t g = 0; g < p.groups.size(); g++)
+            for (int m : p.groups[g].members) member[m] = {&p, g};
+
+    int local = freshLocal(values);
+    int replaced = 0;
+    ValueIR out;
+    std::vector<int> map(values.size(), -1);
+    struct Fixup { int node; size_t k; int ref; };
+    std::vector<Fixup> fixups;
+    auto emit = [&](Value v) {
+        v.id = (int)out.size();
+        out.push_back(v);
+        return v.id;
+    };
+    // 搬到 loop 前面的位址運算
+    std::map<int, int> hoisted;
+    auto mapRef = [&](int ref) {
+        auto it = hoisted.find(ref);
+        return it != hoisted.end() ? it->second : map[ref];
+    };
+    LoopPlan* cur = nullptr;
+    int storesAt = -1;
+
+    for (int i = 0; i < (int)values.size(); i++) {
+        Value v = values[i];
+
+        auto pit = plans.find(i);
+        if (pit != plans.end()) {
+            cur = &pit->second;
+            hoisted.clear();
+            for (int h : cur->hoist) {
+                Value c = values[h];
+                forEachOperand(c, [&](int& ref) { ref = mapRef(ref); });
+                hoisted[h] = emit(c);
+            }
+            for (auto& g : cur->groups) {
+                g.ptr = mapRef(values[g.rep()].lhs);
+                g.entry = emit(makeAccess(values[g.rep()], false, g.ptr, -1));
+            }
+            const LoopShape& s = cur->s;
+            storesAt = (s.end + 1 < (int)values.size() && values[s.end + 1].op == Op::End &&
+                        values[s.end + 1].constValue == 1) ? s.end + 1 : s.end;
+        }
+
+        if (cur) {
+            auto mit = member.find(i);
+            if (mit != member.end()) {
+                Group& g = mit->second.first->groups[mit->second.second];
+                if (isStore(v.op)) g.current = map[v.rhs];
+                else map[i] = g.current;
+                continue;
+            }
+            if (i == cur->s.backBr)
+                for (auto& g : cur->groups) out[g.phi].operands.push_back(g.current);
+        }
+
+        if (v.op == Op::Phi && v.local_index >= 0) {
+            for (size_t k = 0; k < v.operands.size(); k++) {
+                int ref = v.operands[k];
+                if (ref >= i) fixups.push_back({(int)out.size(), k, ref});
+                else if (ref >= 0) v.operands[k] = map[ref];
+            }
+        } else {
+            forEachOperand(v, [&](int& ref) { ref = map[ref]; });
+        }
+        forEachControlRef(v, [&](int& ref) { ref = map[ref]; });
+        map[i] = emit(v);
+
+        if (!cur) continue;
+        const LoopShape& s = cur->s;
+        int phisEnd = s.phis.empty() ? s.loop : s.phis.back();
+        if (i == phisEnd) {
+            for (auto& g : cur->groups) {
+                Value phi;
+                phi.op = Op::Phi;
+                phi.type = g.type;
+                phi.local_index = local++;
+                phi.operands = {g.entry};
+                g.phi = g.current = emit(phi);
+            }
+        }
+        if (i == storesAt) {
+            // 離開 loop 時 phi 就是最後一輪存進去的值
+            for (auto& g : cur->groups) {
+                emit(makeAccess(values[g.rep()], true, g.ptr, g.phi));
+                replaced++;
+            }
+            cur = nullptr;
+        }
+    }
+    for (const Fixup& f : fixups) out[f.node].operands[f.k] = map[f.ref];
+
+    values = cleanupValueIR(out);
+    return replaced;
+}
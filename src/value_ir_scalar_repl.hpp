@@ -0,0 +1,38 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+
+// ============================================================
+// Scalar replacement：loop 裡位址不變的陣列元素放進 loop phi
+// ============================================================
+//
+// gemm / syrk 的最內層 `C[i][j] += alpha * A[i][k] * B[k][j]`，每一輪 k
+// 都從記憶體讀 C[i][j]、算完再寫回去。load-elim 在 Loop 清空，看不到
+// 上一輪剛存的值；wasm 只有一塊 linear memory，C compiler 也不敢假設
+// C[i][j] 跟 A、B 不重疊。位址跟 k 無關時整個 loop 其實只需要讀一次、
+// 寫一次：
+//
+//   for (k = 0; k < n; k++)             c = C[i][j];
+//     C[i][j] += A[i][k] * B[k][j];  →  for (k = 0; k < n; k++)
+//                                         c += A[i][k] * B[k][j];   // c = Phi(入口, next)
+//                                       C[i][j] = c;
+//
+// 對象：findLoops 認得的 simple loop，body 最上層（不在 If / 巢狀 loop 裡，
+// 每一輪都會跑到）有位址不變的 load / store，而且至少有一個 store。同一個
+// 位置（MustAlias、同型別、完整寬度）的存取是一組；loop 裡其他的記憶體
+// 存取（含 header、巢狀 loop）都要跟它 NoAlias，不能有碰記憶體的 call /
+// memory.fill / memory.copy。位址算式在 body 裡重算的（wasm 每一輪都重算
+// `C + (i * n + j) * 8`）一起搬到 loop 前面。
+//
+// loop 前面多一個 load、後面多一個 store，迭代 0 次時原本不會碰這個位址，
+// 所以還要其中一個成立（不加 guard：If 包住 loop 會擋到後面的 pass）：
+//   - loop 至少跑一次：trip count 已知，或外層有 iv 從不小於它的起點、
+//     step 1、同一個 bound 的 `<` loop（gemm 的 i / j / k 都是 `< n`）
+//   - loop 前面、一定會先跑到的地方已經存取過同一個位置（gemm 的
+//     `C[i][j] *= beta`）
+//
+// 一次改寫互不包含的 loop；改完外層的 body 多了 load / store，呼叫端可以
+// 重建 alias 再跑一次（下一個 loop 前面就有存取過的位置了）。
+// 回傳換成 phi 的位置數；有改寫時 values 重建並跑過 cleanupValueIR。
+int scalarReplaceLoops(ValueIR& values, const AliasAnalysis& aa);
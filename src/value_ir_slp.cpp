@@ -0,0 +1,677 @@
+#include "value_ir_slp.hpp"
+#include "value_ir_cemit.hpp"
+#include "value_ir_outline.hpp"
+#include "value_ir_rebuild.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <map>
+#include <iterator>
+#include <set>
+
+namespace {
+
+constexpr int kVectorBytes = 16;   // 128-bit
+constexpr int kMaxDepth = 8;       // 從種子往 operand 長幾層
+constexpr int kMaxSeeds = 16;      // 一個 block 最多試幾個種子
+
+// ============================================================
+// 計畫：一個 block 的 pack 合成一張向量節點的 DAG
+// ============================================================
+
+struct VNode {
+    enum Kind : char { Splat, Pack, Load, Compute, Store } kind = Pack;
+    ValueType type = ValueType::I32;
+    std::vector<int> lanes;   // 每個 lane 原本的節點（Splat / Pack 是 lane 的值）
+    int lhs = -1, rhs = -1;   // 子節點（VNode 編號）；Store 的值放 rhs
+};
+
+struct Seed {
+    std::vector<int> lanes;   // store：位址由低到高；reduction：全部的 leaf
+    int root = -1;            // reduction 的根；store 是 -1
+    Op op = Op::Add;
+    int vf = 0;
+    std::vector<int> inner;   // reduction 樹裡的節點（含根）
+};
+
+struct Plan {
+    std::vector<VNode> nodes;
+    std::map<std::vector<int>, int> memo;   // lanes → VNode
+    std::vector<int> seeds;                 // 收進來的種子
+    std::vector<int> stores;                // Store 的 VNode，依原本最早的 lane 排序（kernel 照這個順序寫）
+    int red = -1;                           // reduction 種子
+    std::vector<int> redGroups;             // reduction leaf 的向量（VNode）
+    int at = -1;                            // kernel 的位置：最後一個 root
+};
+
+ValueType laneOf(const Value& v) {
+    if (v.lanes != 1) return ValueType::Void;
+    switch (v.op) {
+    case Op::Load: case Op::Store:
+        return v.type == ValueType::I32 && memAccessBytes(v) == 4 ? ValueType::I32 : ValueType::Void;
+    case Op::F64Load: case Op::F64Store:
+        return memAccessType(v) == ValueType::F64 && memAccessBytes(v) == 8 ? ValueType::F64 : ValueType::Void;
+    default:
+        return ValueType::Void;
+    }
+}
+
+int laneBytes(ValueType t) {
+    return t == ValueType::F64 ? 8 : 4;
+}
+
+bool isCommutative(Op op) {
+    return op == Op::Add || op == Op::Mul || op == Op::And || op == Op::Or || op == Op::Xor ||
+           op == Op::F64Add || op == Op::F64Mul;
+}
+
+bool isStoreOp(Op op) {
+    return op == Op::Store || op == Op::F64Store;
+}
+
+// 位址的線性形式 Σ coef·leaf + c（含 mem_offset）。展開出來的複本是
+// `(i + k) << 2`，AliasAnalysis 的 index 每份不同，這裡攤平之後才比得出相鄰
+struct Linear {
+    std::map<int, int64_t> terms;
+    int64_t c = 0;
+};
+
+int log2Of(int n) {
+    int k = 0;
+    while ((1 << k) < n) k++;
+    return k;
+}
+
+class BlockSlp {
+public:
+    BlockSlp(const ValueIR& values, const AliasAnalysis& aa,
+             const std::vector<std::vector<int>>& users, int b, int e)
+        : values_(values), aa_(aa), users_(users), b_(b), e_(e) {}
+
+    // 省最多的計畫；沒有划算的回傳 false
+    bool best(Plan& out, std::vector<Seed>& seeds);
+
+private:
+    std::vector<Seed> collectSeeds(int vfI32) const;
+    bool chained(int x, Op op) const;
+    void flatten(int n, Seed& s) const;
+    bool addSeed(Plan& p, const std::vector<Seed>& seeds, int k) const;
+    int build(Plan& p, const std::vector<int>& lanes, ValueType t, int depth) const;
+    bool adjacent(const std::vector<int>& lanes, ValueType t) const;
+    bool legal(const Plan& p, const std::vector<Seed>& seeds) const;
+    int profit(const Plan& p, const std::vector<Seed>& seeds) const;
+    bool inBlock(int id) const { return id >= b_ && id < e_; }
+    const Linear& linear(int id) const;
+    Linear address(int mem) const;
+    bool mayOverlap(int a, int b) const;
+
+    const ValueIR& values_;
+    const AliasAnalysis& aa_;
+    const std::vector<std::vector<int>>& users_;
+    const int b_, e_;
+    mutable std::map<int, Linear> linear_;
+};
+
+const Linear& BlockSlp::linear(int id) const {
+    auto it = linear_.find(id);
+    if (it != linear_.end()) return it->second;
+    const Value& v = values_[id];
+    Linear l;
+    auto scaled = [&](int ref, int64_t k) {
+        const Linear& x = linear(ref);
+        for (const auto& [leaf, c] : x.terms) l.terms[leaf] += c * k;
+        l.c += x.c * k;
+    };
+    auto constOf = [&](int ref, int64_t& c) {
+        if (ref < 0 || values_[ref].op != Op::I32Const) return false;
+        c = values_[ref].constValue;
+        return true;
+    };
+    int64_t k = 0;
+    if (v.op == Op::I32Const) {
+        l.c = v.constValue;
+    } else if (v.op == Op::Add || v.op == Op::Sub) {
+        scaled(v.lhs, 1);
+        scaled(v.rhs, v.op == Op::Add ? 1 : -1);
+    } else if (v.op == Op::Shl && constOf(v.rhs, k) && k >= 0 && k < 31) {
+        scaled(v.lhs, int64_t(1) << k);
+    } else if (v.op == Op::Mul && constOf(v.rhs, k)) {
+        scaled(v.lhs, k);
+    } else if (v.op == Op::Mul && constOf(v.lhs, k)) {
+        scaled(v.rhs, k);
+    } else {
+        l.terms[id] = 1;
+    }
+    for (auto t = l.terms.begin(); t != l.terms.end();)
+        t = t->second == 0 ? l.terms.erase(t) : std::next(t);
+    return linear_[id] = l;
+}
+
+Linear BlockSlp::address(int mem) const {
+    Linear l = linear(values_[mem].lhs);
+    l.c += values_[mem].mem_offset;
+    return l;
+}
+
+// 線性形式只差常數時直接比範圍，其他的問 AliasAnalysis
+bool BlockSlp::mayOverlap(int a, int b) const {
+    const Linear la = address(a), lb = address(b);
+    if (la.terms == lb.terms)
+        return la.c < lb.c + memAccessBytes(values_[b]) && lb.c < la.c + memAccessBytes(values_[a]);
+    return aa_.mayAlias(a, b);
+}
+
+// lanes 是同一種 load / store，位址由低到高一個接一個
+bool BlockSlp::adjacent(const std::vector<int>& lanes, ValueType t) const {
+    const Linear l0 = address(lanes[0]);
+    for (size_t k = 0; k < lanes.size(); k++) {
+        const Value& v = values_[lanes[k]];
+        if (v.op != values_[lanes[0]].op || laneOf(v) != t || !inBlock(lanes[k])) return false;
+        const Linear l = address(lanes[k]);
+        if (l.terms != l0.terms || l.c != l0.c + (int64_t)k * laneBytes(t)) return false;
+    }
+    return true;
+}
+
+// x 是 reduction 樹裡面的節點：同一種 op、只給樹裡用
+bool BlockSlp::chained(int x, Op op) const {
+    const Value& w = values_[x];
+    return w.op == op && w.type == ValueType::I32 && w.lanes == 1 && inBlock(x) && users_[x].size() == 1;
+}
+
+// leaf 照由左到右的順序
+void BlockSlp::flatten(int n, Seed& s) const {
+    s.inner.push_back(n);
+    for (int x : {values_[n].lhs, values_[n].rhs}) {
+        if (chained(x, s.op)) flatten(x, s);
+        else s.lanes.push_back(x);
+    }
+}
+
+std::vector<Seed> BlockSlp::collectSeeds(int vfI32) const {
+    std::vector<Seed> seeds;
+
+    // 位址連續的 store：線性形式除了常數都一樣的依常數排好，一段一段切成
+    // VF 個一組。同一個位址寫好幾次的（展開的 `C[i] = ...; C[i] += ...`）
+    // 第 j 次的放在一起
+    std::map<std::pair<std::map<int, int64_t>, int>, std::map<int64_t, std::vector<int>>> groups;
+    for (int i = b_; i < e_; i++) {
+        const ValueType t = laneOf(values_[i]);
+        if (!isStoreOp(values_[i].op) || t == ValueType::Void) continue;
+        const Linear l = address(i);
+        groups[{l.terms, (int)t}][l.c].push_back(i);
+    }
+    for (auto& [key, byOffset] : groups) {
+        const ValueType t = (ValueType)key.second;
+        const int vf = t == ValueType::F64 ? kVectorBytes / 8 : vfI32;
+        for (size_t layer = 0;; layer++) {
+            std::vector<std::pair<int64_t, int>> list;
+            for (const auto& [c, stores] : byOffset)
+                if (layer < stores.size()) list.push_back({c, stores[layer]});
+            if (list.empty()) break;
+            size_t run = 0;
+            for (size_t k = 1; k <= list.size(); k++) {
+                if (k < list.size() && list[k].first == list[k - 1].first + laneBytes(t)) continue;
+                for (size_t c = run; c + vf <= k; c += vf) {
+                    Seed s;
+                    s.vf = vf;
+                    for (size_t l = c; l < c + vf; l++) s.lanes.push_back(list[l].second);
+                    seeds.push_back(s);
+                }
+                run = k;
+            }
+        }
+    }
+
+    // 整數 reduction 樹：根是最上面那個（user 不是同一種 op）
+    std::vector<Seed> reds;
+    for (int r = b_; r < e_; r++) {
+        const Value& v = values_[r];
+        if (!isReductionOp(v.op) || v.type != ValueType::I32 || v.lanes != 1) continue;
+        if (chained(r, v.op)) {
+            const Value& u = values_[users_[r][0]];
+            if (u.op == v.op && u.type == ValueType::I32 && u.lanes == 1 && inBlock(users_[r][0])) continue;
+        }
+        Seed s;
+        s.root = r;
+        s.op = v.op;
+        s.vf = vfI32;
+        flatten(r, s);
+        if ((int)s.lanes.size() < 4 || (int)s.lanes.size() % vfI32 != 0) continue;
+        reds.push_back(s);
+    }
+    std::stable_sort(reds.begin(), reds.end(),
+                     [](const Seed& a, const Seed& b) { return a.lanes.size() > b.lanes.size(); });
+    seeds.insert(seeds.end(), reds.begin(), reds.end());
+    if ((int)seeds.size() > kMaxSeeds) seeds.resize(kMaxSeeds);
+    return seeds;
+}
+
+int BlockSlp::build(Plan& p, const std::vector<int>& lanes, ValueType t, int depth) const {
+    auto it = p.memo.find(lanes);
+    if (it != p.memo.end()) return it->second;
+
+    VNode n;
+    n.type = t;
+    n.lanes = lanes;
+    const Value& v0 = values_[lanes[0]];
+    bool same = true, iso = depth < kMaxDepth;
+    for (int x : lanes) {
+        const Value& v = values_[x];
+        same &= x == lanes[0];
+        iso &= inBlock(x) && v.op == v0.op && v.lanes == 1 && resultTypeOf(v) == t;
+    }
+    if (same) {
+        n.kind = VNode::Splat;
+    } else if (iso && (v0.op == Op::Load || v0.op == Op::F64Load) && adjacent(lanes, t)) {
+        n.kind = VNode::Load;
+    } else if (iso && isLaneWiseOp(values_, v0)) {
+        std::vector<int> lhs, rhs;
+        for (int x : lanes) {
+            int a = values_[x].lhs, b = values_[x].rhs;
+            // 可交換的 op：左邊的 op 跟第一個 lane 對不上、右邊對得上就換邊
+            if (isCommutative(v0.op) && !lhs.empty() && values_[a].op != values_[lhs[0]].op &&
+                values_[b].op == values_[lhs[0]].op)
+                std::swap(a, b);
+            lhs.push_back(a);
+            rhs.push_back(b);
+        }
+        const ValueType in = v0.op == Op::F64ConvertI32S || v0.op == Op::F64ConvertI32U ? ValueType::I32 : t;
+        n.kind = VNode::Compute;
+        n.lhs = build(p, lhs, in, depth + 1);
+        if (v0.rhs >= 0) n.rhs = build(p, rhs, in, depth + 1);
+    } else {
+        n.kind = VNode::Pack;
+    }
+    p.nodes.push_back(n);
+    return p.memo[lanes] = (int)p.nodes.size() - 1;
+}
+
+bool BlockSlp::addSeed(Plan& p, const std::vector<Seed>& seeds, int k) const {
+    const Seed& s = seeds[k];
+    Plan q = p;
+    if (s.root < 0) {
+        const ValueType t = laneOf(values_[s.lanes[0]]);
+        VNode st;
+        st.kind = VNode::Store;
+        st.type = t;
+        st.lanes = s.lanes;
+        std::vector<int> vals;
+        for (int x : s.lanes) vals.push_back(values_[x].rhs);
+        st.rhs = build(q, vals, t, 1);
+        q.nodes.push_back(st);
+        auto first = [&](int node) { return *std::min_element(q.nodes[node].lanes.begin(), q.nodes[node].lanes.end()); };
+        const int node = (int)q.nodes.size() - 1;
+        q.stores.insert(std::upper_bound(q.stores.begin(), q.stores.end(), node,
+                                         [&](int a, int b) { return first(a) < first(b); }),
+                        node);
+        for (int x : s.lanes) q.at = std::max(q.at, x);
+    } else {
+        if (q.red >= 0) return false;   // kernel 只回傳一個值
+        q.red = k;
+        for (size_t g = 0; g < s.lanes.size(); g += s.vf) {
+            std::vector<int> lanes(s.lanes.begin() + g, s.lanes.begin() + g + s.vf);
+            q.redGroups.push_back(build(q, lanes, ValueType::I32, 1));
+        }
+        q.at = std::max(q.at, s.root);
+    }
+    q.seeds.push_back(k);
+    if (!legal(q, seeds)) return false;
+    p = std::move(q);
+    return true;
+}
+
+// kernel 在 p.at 執行：裡面的 load 從原本的位置延到 p.at、store 也是，
+// 中間的記憶體存取不能跟它們重疊。kernel 先把 load 跟運算做完才寫 store
+bool BlockSlp::legal(const Plan& p, const std::vector<Seed>& seeds) const {
+    std::set<int> stores, loads;
+    std::vector<int> owner(e_ - b_, -1);
+    for (size_t k = 0; k < p.stores.size(); k++)
+        for (int x : p.nodes[p.stores[k]].lanes) {
+            stores.insert(x);
+            owner[x - b_] = (int)k;
+        }
+    for (const VNode& n : p.nodes)
+        if (n.kind == VNode::Load) loads.insert(n.lanes.begin(), n.lanes.end());
+
+    if (p.red >= 0)
+        for (int u : users_[seeds[p.red].root])
+            if (u <= p.at) return false;
+
+    auto touchesMemory = [&](const Value& v) {
+        return isMemoryRead(v.op) || isMemoryWrite(v.op) ||
+               (v.op == Op::Call && (v.call_effects & (CallReadsMemory | CallWritesMemory)));
+    };
+    for (int l : loads) {
+        for (int n = l + 1; n < p.at; n++) {
+            const Value& v = values_[n];
+            if (stores.count(n) || !(isMemoryWrite(v.op) || v.op == Op::Call)) continue;
+            if (v.op == Op::Call && !(v.call_effects & CallWritesMemory)) continue;
+            if (!isStoreOp(v.op) || mayOverlap(l, n)) return false;
+        }
+        for (int s : stores)
+            if (s < l && mayOverlap(s, l)) return false;
+    }
+    for (int s : stores) {
+        for (int n = s + 1; n < p.at; n++) {
+            const Value& v = values_[n];
+            if (stores.count(n) || loads.count(n) || !touchesMemory(v)) continue;
+            if (v.op == Op::Call || v.op == Op::MemoryFill || v.op == Op::MemoryCopy) return false;
+            if (mayOverlap(s, n)) return false;
+        }
+        // 不同組的 store 在 kernel 裡照組的順序寫：重疊的兩個要跟原本一樣先後
+        for (int t : stores)
+            if (t > s && owner[t - b_] < owner[s - b_] && mayOverlap(s, t)) return false;
+    }
+    return true;
+}
+
+// 省下來的純量節點 - 多出來的向量節點
+int BlockSlp::profit(const Plan& p, const std::vector<Seed>& seeds) const {
+    std::set<int> covered, kept;
+    int cost = 0;
+    for (const VNode& n : p.nodes) {
+        switch (n.kind) {
+        case VNode::Splat:
+            kept.insert(n.lanes[0]);
+            cost += 1;
+            break;
+        case VNode::Pack: {
+            bool consts = true;
+            for (int x : n.lanes) {
+                kept.insert(x);
+                consts &= isConstOp(values_[x].op);
+            }
+            cost += consts ? 1 : (int)n.lanes.size();
+            break;
+        }
+        case VNode::Load: case VNode::Store:
+            kept.insert(values_[n.lanes[0]].lhs);
+            covered.insert(n.lanes.begin(), n.lanes.end());
+            cost += 1;
+            break;
+        case VNode::Compute:
+            covered.insert(n.lanes.begin(), n.lanes.end());
+            cost += 1;
+            break;
+        }
+    }
+    int root = -1;
+    if (p.red >= 0) {
+        const Seed& s = seeds[p.red];
+        root = s.root;
+        covered.insert(s.inner.begin(), s.inner.end());
+        cost += (int)p.redGroups.size() - 1 + 2 * log2Of(s.vf) + 1;   // 直的合併 + shuffle / add + 取出
+    }
+
+    // 只剩 kernel 裡用到的才算省下來（reduction 的根換成 call 的結果）
+    std::set<int> dead;
+    for (auto it = covered.rbegin(); it != covered.rend(); ++it) {
+        const int x = *it;
+        if (kept.count(x)) continue;
+        bool all = true;
+        for (int u : users_[x]) all &= dead.count(u) > 0;
+        if (all || x == root) dead.insert(x);
+    }
+    return (int)dead.size() - cost;
+}
+
+bool BlockSlp::best(Plan& out, std::vector<Seed>& outSeeds) {
+    int bestProfit = 0;
+    for (int vf : {kVectorBytes / 4, 2}) {
+        std::vector<Seed> seeds = collectSeeds(vf);
+        if (seeds.empty()) continue;
+        // 一個種子單獨做不合法（例如中間還有另一組寫同一個位址）可能在別的
+        // 種子進來之後就可以了，加到沒有變化為止
+        Plan p;
+        std::vector<bool> taken(seeds.size(), false);
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (int k = 0; k < (int)seeds.size(); k++)
+                if (!taken[k] && addSeed(p, seeds, k)) taken[k] = changed = true;
+        }
+
+        // 拿掉讓總成本變差的種子（一次拿一個，拿掉之後最好的）
+        int cur = profit(p, seeds);
+        for (;;) {
+            Plan bestPlan;
+            int bestGain = cur;
+            for (int drop : p.seeds) {
+                Plan q;
+                for (int k : p.seeds)
+                    if (k != drop) addSeed(q, seeds, k);
+                const int g = q.seeds.empty() ? 0 : profit(q, seeds);
+                if (g > bestGain) {
+                    bestGain = g;
+                    bestPlan = std::move(q);
+                }
+            }
+            if (bestGain <= cur) break;
+            p = std::move(bestPlan);
+            cur = bestGain;
+        }
+        if (!p.seeds.empty() && cur > bestProfit) {
+            bestProfit = cur;
+            out = std::move(p);
+            outSeeds = std::move(seeds);
+        }
+    }
+    return bestProfit > 0;
+}
+
+// ============================================================
+// kernel
+// ============================================================
+
+struct Kernel {
+    ModuleFunction fn;
+    std::vector<int> args;   // 原函式裡的節點，依參數順序
+    int at = -1;
+    int root = -1;           // reduction 的根（換成 call 的結果）
+    std::vector<int> stores; // 原本的 store（刪掉）
+};
+
+Kernel buildKernel(const ValueIR& values, const Plan& p, const std::vector<Seed>& seeds) {
+    Kernel k;
+    k.at = p.at;
+    ModuleFunction& t = k.fn;
+    ValueIR& out = t.values;
+    auto emit = [&](Value v) {
+        v.id = (int)out.size();
+        out.push_back(v);
+        return v.id;
+    };
+
+    // 參數：每個 leaf 一個（常數直接放進 kernel）
+    std::map<int, int> leaf;
+    auto need = [&](int id, ValueType ty) {
+        if (leaf.count(id)) return;
+        if (isConstOp(values[id].op)) {
+            Value c = values[id];
+            c.operands.clear();
+            leaf[id] = emit(c);
+            return;
+        }
+        Value prm;
+        prm.op = Op::Param;
+        prm.type = ty;
+        prm.paramIndex = (int)k.args.size();
+        k.args.push_back(id);
+        t.paramTypes.push_back(ty);
+        t.paramNames.push_back("");
+        leaf[id] = emit(prm);
+    };
+    for (const VNode& n : p.nodes) {
+        if (n.kind == VNode::Splat) need(n.lanes[0], n.type);
+        if (n.kind == VNode::Pack)
+            for (int x : n.lanes) need(x, n.type);
+        if (n.kind == VNode::Load || n.kind == VNode::Store) need(values[n.lanes[0]].lhs, ValueType::I32);
+    }
+    t.numParams = t.paramTypes.size();
+
+    std::vector<int> kid(p.nodes.size(), -1);
+    std::vector<int> order;
+    for (size_t i = 0; i < p.nodes.size(); i++)
+        if (p.nodes[i].kind != VNode::Store) order.push_back((int)i);
+    order.insert(order.end(), p.stores.begin(), p.stores.end());
+    for (int i : order) {
+        const VNode& n = p.nodes[i];
+        const int lanes = (int)n.lanes.size();
+        Value v;
+        switch (n.kind) {
+        case VNode::Splat:
+            v.op = Op::Splat;
+            v.type = n.type;
+            v.lhs = leaf[n.lanes[0]];
+            break;
+        case VNode::Pack:
+            v.op = Op::Pack;
+            v.type = n.type;
+            for (int x : n.lanes) v.operands.push_back(leaf[x]);
+            break;
+        case VNode::Load:
+            v = values[n.lanes[0]];
+            v.lhs = leaf[values[n.lanes[0]].lhs];
+            break;
+        case VNode::Compute:
+            v = values[n.lanes[0]];
+            v.lhs = kid[n.lhs];
+            v.rhs = n.rhs >= 0 ? kid[n.rhs] : -1;
+            break;
+        case VNode::Store:
+            v = values[n.lanes[0]];
+            v.lhs = leaf[values[n.lanes[0]].lhs];
+            v.rhs = kid[n.rhs];
+            k.stores.insert(k.stores.end(), n.lanes.begin(), n.lanes.end());
+            break;
+        }
+        v.lanes = lanes;
+        kid[i] = emit(v);
+    }
+
+    Value ret;
+    ret.op = Op::Return;
+    if (p.red >= 0) {
+        const Seed& s = seeds[p.red];
+        k.root = s.root;
+        auto combine = [&](int a, int b, int lanes) {
+            Value c;
+            c.op = s.op;
+            c.type = ValueType::I32;
+            c.lhs = a;
+            c.rhs = b;
+            c.lanes = lanes;
+            return emit(c);
+        };
+        int acc = kid[p.redGroups[0]];
+        for (size_t g = 1; g < p.redGroups.size(); g++) acc = combine(acc, kid[p.redGroups[g]], s.vf);
+        int sum = -1;
+        for (int l = 0; l < s.vf; l++) {
+            Value x;
+            x.op = Op::ExtractLane;
+            x.type = ValueType::I32;
+            x.lhs = acc;
+            x.constValue = l;
+            const int e = emit(x);
+            sum = sum < 0 ? e : combine(sum, e, 1);
+        }
+        ret.lhs = sum;
+    }
+    emit(ret);
+    return k;
+}
+
+// ============================================================
+// 原函式：store / reduction 換成 kernel 的 call
+// ============================================================
+
+class SlpRewriter : public ValueIRRebuilder {
+public:
+    SlpRewriter(const ValueIR& in, const std::vector<Kernel>& kernels, const std::vector<std::string>& names)
+        : ValueIRRebuilder(in), kernels_(kernels), names_(names) {}
+
+    ValueIR run() {
+        std::vector<std::pair<int, int>> ranges;
+        for (size_t k = 0; k < kernels_.size(); k++) {
+            for (int s : kernels_[k].stores) at_[s] = (int)k;
+            if (kernels_[k].root >= 0) at_[kernels_[k].root] = (int)k;
+        }
+        for (const auto& [pos, k] : at_) ranges.push_back({pos, pos});
+        order_ = ranges;
+        return ValueIRRebuilder::run(ranges);
+    }
+
+private:
+    void emitRegion(size_t r) override {
+        const int pos = order_[r].first;
+        const Kernel& k = kernels_[at_[pos]];
+        if (pos != k.at) return;   // 一起在 k.at 做
+        Value call;
+        call.op = Op::Call;
+        call.callee_name = names_[at_[pos]] + "_run";
+        call.type = k.root >= 0 ? ValueType::I32 : ValueType::Void;
+        call.call_effects = effectsOf(k.fn.values);
+        call.pass_memory = usesMemoryParam(k.fn.values);
+        for (int a : k.args) call.operands.push_back(mapOutside(a));
+        const int id = emit(call);
+        if (k.root >= 0) map_[k.root] = id;
+    }
+
+    const std::vector<Kernel>& kernels_;
+    const std::vector<std::string>& names_;
+    std::map<int, int> at_;   // 要換掉的節點 → kernel
+    std::vector<std::pair<int, int>> order_;
+};
+
+bool isBlockBoundary(Op op) {
+    switch (op) {
+    case Op::If: case Op::Else: case Op::End: case Op::Loop:
+    case Op::Br: case Op::Br_if: case Op::Return: case Op::Unreachable:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+int slpVectorize(ModuleFunction& f, const AliasOptions& aopts, std::vector<ModuleFunction>& kernels) {
+    if (f.vector.isKernel) return 0;
+    const ValueIR& values = f.values;
+    std::vector<std::vector<int>> users(values.size());
+    for (int i = 0; i < (int)values.size(); i++)
+        forEachOperand(values[i], [&](int ref) { users[ref].push_back(i); });
+
+    std::vector<Kernel> found;
+    std::vector<std::string> names;
+    {
+        AliasAnalysis aa(values, aopts);
+        int b = 0;
+        for (int i = 0; i <= (int)values.size(); i++) {
+            if (i < (int)values.size() && !isBlockBoundary(values[i].op)) continue;
+            if (i - b >= 2) {
+                BlockSlp block(values, aa, users, b, i);
+                Plan p;
+                std::vector<Seed> seeds;
+                if (block.best(p, seeds)) {
+                    Kernel k = buildKernel(values, p, seeds);
+                    k.fn.name = f.name + "__slp" + std::to_string(found.size());
+                    k.fn.origin = f.origin;
+                    k.fn.vector.isKernel = true;
+                    k.fn.vector.straightLine = true;
+                    if (!kernelC(k.fn, k.fn.name, "").empty()) {
+                        names.push_back(k.fn.name);
+                        found.push_back(std::move(k));
+                    }
+                }
+            }
+            b = i + 1;
+        }
+    }
+    if (found.empty()) return 0;
+
+    ValueIR out = SlpRewriter(f.values, found, names).run();
+    f.values = cleanupValueIR(out);
+    for (Kernel& k : found) kernels.push_back(std::move(k.fn));
+    return (int)names.size();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+#include <vector>
+
+// ============================================================
+// SLP vectorization：同一個 basic block 裡相鄰、同構的純量運算合成向量
+// ============================================================
+//
+// 展開過的 loop、手寫展開的程式（tests/matmul_2x2_unrolled.wat）常常是
+//
+//   C[0] = A[0] * B[0] + A[1] * B[2];          C[0:2] = splat(A[0]) * B[0:2]
+//   C[1] = A[0] * B[1] + A[1] * B[3];    →            + splat(A[1]) * B[2:4]
+//   s = C[0] + C[1] + ...                      s = hsum(...)
+//
+// 種子有兩種：
+//   - 位址連續的 i32 / f64 store（位址的線性形式只差常數，差存取寬度），
+//     每 VF 個一組；同一個位址寫好幾次的，第 j 次的放一組
+//   - 同一種整數 reduction（+ * & | ^）串起來的樹，leaf 個數是 VF 的倍數：
+//     leaf 分成幾個向量，先一個 lane 一個 lane 合併，最後再橫向合併
+// 從種子往 operand 長：每個 lane 的 op 一樣（可交換的 op 會換邊對齊）就變
+// 向量運算；位址連續的 load 合成一個寬的 load；每個 lane 是同一個值就
+// Splat；其他的用 Pack 一個一個放進去。
+//
+// 一個 block 裡的 pack 全部放進同一個 kernel（value_ir_cemit 寫成 C 的
+// vector extension，128-bit：SSE2 / NEON 都有，不用 runtime dispatch），
+// 在最後一個 store / reduction 的位置呼叫。load 會晚一點讀、前面的 store
+// 會晚一點寫，中間有可能重疊的記憶體存取（AliasAnalysis）就不做；kernel
+// 裡先讀完再照原本的順序寫。
+// cost model 數省下來的純量節點（其他地方還在用的不算）跟多出來的向量
+// 節點，i32 的 VF 試 4 跟 2，挑省最多的。
+//
+// 在 load-elim 之後跑：重複的 load、store 之後馬上讀回來的值都已經換掉了。
+// kernel 的 call 會讀寫記憶體，放在最後才不會擋到前面的 pass。
+
+// 回傳建出來的 kernel 數。kernel 放進 kernels（vector.isKernel、
+// vector.straightLine），f 有改寫時重建並跑過 cleanupValueIR。
+int slpVectorize(ModuleFunction& f, const AliasOptions& aopts, std::vector<ModuleFunction>& kernels);
@@ -0,0 +1,293 @@
+#include "value_ir_specialize.hpp"
+#include "value_ir_util.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+ValueType paramType(const ModuleFunction& f, int k) {
+    return k < (int)f.paramTypes.size() ? f.paramTypes[k] : ValueType::I32;
+}
+
+bool parseConst(ValueType t, const std::string& text, Value& c) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    c.type = t;
+    if (t == ValueType::F64 || t == ValueType::F32) {
+        c.op = Op::F64Const;
+        c.fconst = std::strtod(text.c_str(), &end);
+        if (t == ValueType::F32) c.fconst = (float)c.fconst;
+    } else {
+        c.op = (t == ValueType::I64) ? Op::I64Const : Op::I32Const;
+        errno = 0;
+        c.constValue = std::strtoll(text.c_str(), &end, 0);
+        if (errno == ERANGE) return false;
+        // i32 收 -2^31 .. 2^32-1（無號寫法也行），存 sign-extend 後的值
+        if (t == ValueType::I32) {
+            if (c.constValue < INT32_MIN || c.constValue > (int64_t)UINT32_MAX) return false;
+            c.constValue = (int32_t)(uint32_t)c.constValue;
+        }
+    }
+    return end && *end == '\0';
+}
+
+// "ni" / "2" / "p2" → 參數編號，找不到回傳 -1
+int resolveParam(const ModuleFunction& f, const std::string& name) {
+    std::string digits = (name.size() > 1 && name[0] == 'p') ? name.substr(1) : name;
+    if (!digits.empty() && digits.find_first_not_of("0123456789") == std::string::npos) {
+        int k = std::atoi(digits.c_str());
+        return k < (int)f.numParams ? k : -1;
+    }
+    std::string bare = (!name.empty() && name[0] == '$') ? name.substr(1) : name;
+    for (size_t k = 0; k < f.paramNames.size(); k++)
+        if (f.paramNames[k] == bare) return (int)k;
+    return -1;
+}
+
+bool hasLoop(const ValueIR& values) {
+    for (const auto& v : values)
+        if (v.op == Op::Loop) return true;
+    return false;
+}
+
+bool returnsValue(const ValueIR& values) {
+    for (const auto& v : values)
+        if (v.op == Op::Return && v.lhs >= 0) return true;
+    return false;
+}
+
+ModuleFunction cloneWithConsts(const std::vector<ModuleFunction>& funcs, int f,
+                               const std::string& name, const std::map<int, Value>& consts) {
+    ModuleFunction c = funcs[f];
+    c.name = name;
+    c.exported = false;
+    c.origin = funcs[f].origin >= 0 ? funcs[f].origin : f;
+    for (auto& v : c.values) {
+        if (v.op != Op::Param) continue;
+        auto it = consts.find(v.paramIndex);
+        if (it != consts.end()) turnIntoConst(v, it->second);
+    }
+    return c;
+}
+
+std::string constText(const Value& c) {
+    std::ostringstream os;
+    if (c.op == Op::F64Const) os << c.fconst;
+    else os << c.constValue;
+    return os.str();
+}
+
+// call site 的常數引數：參數編號 → 常數節點
+std::map<int, Value> constArgs(const ValueIR& values, const Value& call) {
+    std::map<int, Value> out;
+    for (size_t k = 0; k < call.operands.size(); k++) {
+        int a = call.operands[k];
+        if (a >= 0 && isConstOp(values[a].op)) out[(int)k] = values[a];
+    }
+    return out;
+}
+
+std::string bindingKey(const std::map<int, Value>& consts) {
+    std::string key;
+    for (const auto& [k, c] : consts)
+        key += std::to_string(k) + "=" + opToString(c.op) + ":" + constText(c) + ";";
+    return key;
+}
+
+// call 改成呼叫 clone。clone 沒有 wasm 函式索引，lhs 清掉。
+void redirect(Value& call, const std::string& name) {
+    call.callee_name = name;
+    call.lhs = -1;
+}
+
+} // namespace
+
+bool parseSpecializeSpec(const std::string& text, SpecializeSpec& out) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos || colon == 0) return false;
+    out.func = text.substr(0, colon);
+    out.args.clear();
+    std::stringstream ss(text.substr(colon + 1));
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos || eq == 0 || eq + 1 == item.size()) return false;
+        out.args.emplace_back(item.substr(0, eq), item.substr(eq + 1));
+    }
+    return !out.args.empty();
+}
+
+bool applySpecializeSpec(std::vector<ModuleFunction>& funcs, const SpecializeSpec& spec) {
+    int f = -1;
+    for (int i = 0; i < (int)funcs.size(); i++)
+        if (funcs[i].name == spec.func && funcs[i].origin < 0) f = i;
+    if (f < 0) {
+        std::cerr << "Error: --specialize: no function named " << spec.func << "\n";
+        return false;
+    }
+    std::map<int, Value> consts;
+    for (const auto& [name, text] : spec.args) {
+        int k = resolveParam(funcs[f], name);
+        Value c;
+        if (k < 0 || !parseConst(paramType(funcs[f], k), text, c)) {
+            std::cerr << "Error: --specialize: bad parameter " << name << "=" << text
+                      << " for " << spec.func << "\n";
+            return false;
+        }
+        consts[k] = c;
+    }
+
+    const std::string specName = spec.func + "__spec";
+    const std::string genericName = spec.func + "__generic";
+    ModuleFunction specFn = cloneWithConsts(funcs, f, specName, consts);
+    ModuleFunction genericFn = cloneWithConsts(funcs, f, genericName, {});
+    const bool hasResult = returnsValue(funcs[f].values);
+    const ValueType retType = hasResult ? ValueType::I32 : ValueType::Void;  // annotateCalls 會補正
+
+    // 原函式變成 dispatcher
+    ValueIR d;
+    auto emit = [&](Value v) {
+        v.id = (int)d.size();
+        d.push_back(std::move(v));
+        return (int)d.size() - 1;
+    };
+    std::vector<int> params(funcs[f].numParams);
+    for (size_t k = 0; k < params.size(); k++) {
+        Value p;
+        p.op = Op::Param;
+        p.paramIndex = (int)k;
+        p.type = paramType(funcs[f], (int)k);
+        params[k] = emit(p);
+    }
+    int cond = -1;
+    for (const auto& [k, c] : consts) {
+        int ci = emit(c);
+        Value eq;
+        eq.op = (c.type == ValueType::F64 || c.type == ValueType::F32) ? Op::F64Eq : Op::Eq;
+        eq.lhs = params[k];
+        eq.rhs = ci;
+        int e = emit(eq);
+        if (cond < 0) { cond = e; continue; }
+        Value both;
+        both.op = Op::And;
+        both.lhs = cond;
+        both.rhs = e;
+        cond = emit(both);
+    }
+    auto emitCall = [&](const std::string& name) {
+        Value call;
+        call.op = Op::Call;
+        call.callee_name = name;
+        call.operands = params;
+        call.type = retType;
+        return emit(call);
+    };
+    Value ifv;
+    ifv.op = Op::If;
+    ifv.lhs = cond;
+    emit(ifv);
+    int r1 = emitCall(specName);
+    Value elsev;
+    elsev.op = Op::Else;
+    emit(elsev);
+    int r2 = emitCall(genericName);
+    Value endv;
+    endv.op = Op::End;
+    endv.constValue = 2;
+    emit(endv);
+    Value ret;
+    ret.op = Op::Return;
+    if (hasResult) {
+        Value phi;
+        phi.op = Op::Phi;
+        phi.operands = {r1, r2};
+        ret.lhs = emit(phi);
+    }
+    emit(ret);
+
+    funcs[f].values = std::move(d);
+    funcs.push_back(std::move(specFn));
+    funcs.push_back(std::move(genericFn));
+
+    // module 裡引數剛好吻合的 call site 不用經過 dispatcher
+    int direct = 0;
+    for (auto& caller : funcs) {
+        if (caller.name == spec.func) continue;
+        for (auto& v : caller.values) {
+            if (v.op != Op::Call || v.callee_name != spec.func) continue;
+            std::map<int, Value> args = constArgs(caller.values, v);
+            bool match = true;
+            for (const auto& [k, c] : consts) {
+                auto it = args.find(k);
+                if (it == args.end() || !sameConst(it->second, c)) { match = false; break; }
+            }
+            if (match) { redirect(v, specName); direct++; }
+        }
+    }
+    std::cout << "[PASS] specialize: " << spec.func << " -> " << specName;
+    if (direct > 0) std::cout << " (" << direct << " direct call site(s))";
+    std::cout << "\n";
+    return true;
+}
+
+int specializeCallSites(std::vector<ModuleFunction>& funcs, const SpecializeOptions& opts) {
+    std::unordered_map<std::string, int> byName;
+    for (int i = 0; i < (int)funcs.size(); i++) byName[funcs[i].name] = i;
+
+    // 沒有 export、而且每個 call site 的常數都一樣的函式交給 --ipcp 原地處理
+    std::map<int, std::set<std::string>> patterns;
+    for (const auto& caller : funcs)
+        for (const auto& v : caller.values) {
+            if (v.op != Op::Call) continue;
+            auto it = byName.find(v.callee_name);
+            if (it != byName.end()) patterns[it->second].insert(bindingKey(constArgs(caller.values, v)));
+        }
+
+    std::map<std::string, int> cloneByKey;
+    std::vector<int> clonesOf(funcs.size(), 0);
+    int made = 0;
+    // clone 本身也可能再用常數呼叫別人，所以 funcs 會邊跑邊變長
+    for (size_t f = 0; f < funcs.size(); f++) {
+        for (size_t i = 0; i < funcs[f].values.size(); i++) {
+            const Value& v = funcs[f].values[i];
+            if (v.op != Op::Call) continue;
+            auto it = byName.find(v.callee_name);
+            if (it == byName.end()) continue;
+            const int g = it->second;
+            const ModuleFunction& callee = funcs[g];
+            if (callee.origin >= 0 || v.operands.size() != callee.numParams) continue;
+            if (!hasLoop(callee.values) || (int)callee.values.size() > opts.maxCalleeSize) continue;
+            std::map<int, Value> consts = constArgs(funcs[f].values, v);
+            if (consts.empty()) continue;
+            if (!callee.exported && patterns[g].size() == 1) continue;
+
+            std::string key = callee.name + "|" + bindingKey(consts);
+            auto c = cloneByKey.find(key);
+            if (c == cloneByKey.end()) {
+                if (clonesOf[g] >= opts.maxClonesPerFunction) continue;
+                std::string name = callee.name + "__spec" + std::to_string(clonesOf[g]++);
+                ModuleFunction clone = cloneWithConsts(funcs, g, name, consts);
+                std::cout << "[PASS] specialize: " << callee.name << " -> " << name << " (";
+                const char* sep = "";
+                for (const auto& [k, cv] : consts) {
+                    std::cout << sep << "p" << k << "=" << constText(cv);
+                    sep = ", ";
+                }
+                std::cout << ")\n";
+                c = cloneByKey.emplace(key, (int)funcs.size()).first;
+                byName[name] = (int)funcs.size();
+                clonesOf.push_back(0);
+                funcs.push_back(std::move(clone));   // v 之後不能再用
+                made++;
+            }
+            redirect(funcs[f].values[i], funcs[c->second].name);
+        }
+    }
+    return made;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================
+// Function specialization：常數引數 → clone
+// ============================================================
+//
+// PolyBench 的 driver 用常數大小（ni / nj / nk）呼叫 kernel_*，kernel
+// 本身卻是照一般的邊界編譯的。這裡複製一份函式，把指定的參數換成
+// 常數（Param → I32Const / I64Const / F64Const），clone 跟其他函式一樣
+// 跑完整的 module / 單函式 pass；dstogov/ir 建圖時會把常數邊界折疊掉，
+// trip count 就是已知的。
+//
+//   - call site 自動（--specialize-calls）：module 裡的 call 傳常數給帶
+//     loop 的函式時，依「哪些參數 = 哪些常數」產生 clone，call 直接改呼叫
+//     clone。原函式保留給其他 call site / export。
+//   - 使用者指定（--specialize=kernel_gemm:ni=1000,nj=1100）：外面的
+//     呼叫者看不到，所以原函式改成 dispatcher：
+//
+//       f(p) = (p.ni == 1000 && p.nj == 1100) ? f__spec(p) : f__generic(p)
+//
+//     module 裡引數剛好吻合的 call site 直接呼叫 f__spec。
+
+struct SpecializeSpec {
+    std::string func;
+    // 參數名稱（name section）或編號（"2" / "p2"）→ 值
+    std::vector<std::pair<std::string, std::string>> args;
+};
+
+// "kernel_gemm:ni=1000,nj=1100"；格式不對回傳 false
+bool parseSpecializeSpec(const std::string& text, SpecializeSpec& out);
+
+struct SpecializeOptions {
+    int maxClonesPerFunction = 4;   // 同一個函式最多幾個 call-site clone
+    int maxCalleeSize = 4096;       // 超過這個節點數的函式不複製
+};
+
+// 使用者指定的 specialization。函式 / 參數找不到時印錯誤並回傳 false。
+bool applySpecializeSpec(std::vector<ModuleFunction>& funcs, const SpecializeSpec& spec);
+
+// call site 自動 specialization，回傳產生的 clone 數
+int specializeCallSites(std::vector<ModuleFunction>& funcs, const SpecializeOptions& opts = {});
@@ -0,0 +1,396 @@
+#include "value_ir_stencil.hpp"
+#include "value_ir_deps.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_rebuild.hpp"
+#include "value_ir_tile.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace {
+
+// ============================================================
+// 辨認：時間 loop + 並排的 sweep
+// ============================================================
+
+struct Plan {
+    int time = -1;                // findLoops 的 index
+    std::vector<int> sweeps;      // 時間 loop 的子 loop，照順序
+    int skew = 0;                 // σ
+    int steps = 0;                // H：一個 tile 跑的時間步
+    int width = 0;                // W
+};
+
+int entryOf(const ValueIR& values, const LoopShape& s) {
+    return values[s.iv].operands[0];
+}
+
+int sweepOf(const Plan& p, const std::vector<LoopShape>& loops, int node) {
+    for (size_t s = 0; s < p.sweeps.size(); s++)
+        if (loops[p.sweeps[s]].loop < node && node < loops[p.sweeps[s]].end) return (int)s;
+    return -1;
+}
+
+// 在時間 loop 外面就決定、或 loop 裡只由 Param / 常數 / 外面的值算出來
+// （`n - 1`）：改寫時搬到最前面
+bool timeInvariant(const ValueIR& values, const LoopShape& t, const Plan& p,
+                   const std::vector<LoopShape>& loops, int id, int depth = 0) {
+    if (id < 0 || depth > 16) return false;
+    if (id < t.loop || id > t.end) return true;
+    const Value& v = values[id];
+    if (v.op == Op::Param || isConstOp(v.op)) return true;
+    if (!isPureOp(v.op) || v.op == Op::Phi || sweepOf(p, loops, id) >= 0) return false;
+    bool ok = true;
+    forEachOperand(v, [&](int ref) { ok = ok && timeInvariant(values, t, p, loops, ref, depth + 1); });
+    return ok;
+}
+
+bool sweepShape(const ValueIR& values, const LoopShape& s) {
+    return s.simple && s.hasIV() && s.step == 1 && s.cmp == LoopCmp::LtS && s.phis.size() == 1 &&
+           s.bound >= 0 && values[s.iv].type != ValueType::I64;
+}
+
+bool recognize(const ValueIR& values, const std::vector<LoopShape>& loops, int k, Plan& p) {
+    const LoopShape& t = loops[k];
+    if (!sweepShape(values, t)) return false;
+    if (!isLoopInvariant(values, t, entryOf(values, t)) || !isLoopInvariant(values, t, t.bound))
+        return false;
+    if (!loopNestSelfContained(values, t)) return false;
+    p.time = k;
+    for (int c = k + 1; c < (int)loops.size() && loops[c].loop < t.end; c++)
+        if (loops[c].parent == k) p.sweeps.push_back(c);
+    if (p.sweeps.empty()) return false;
+
+    // header 只有 t 跟算條件的純運算；sweep 之間只有純運算 / LocalSet
+    for (int i = t.header(); i < t.exitBr; i++)
+        if (i != t.iv && !isPureOp(values[i].op) && values[i].op != Op::Param) return false;
+    size_t next = 0;
+    for (int i = t.bodyBegin(); i < t.backBr; i++) {
+        if (next < p.sweeps.size() && i == loops[p.sweeps[next]].loop) {
+            i = loops[p.sweeps[next++]].end;
+            continue;
+        }
+        const Value& v = values[i];
+        bool ok = (v.op == Op::End && v.constValue == 1) || v.op == Op::Param ||
+                  v.op == Op::LocalSet || isPureOp(v.op);
+        if (!ok) return false;
+        // sweep 裡算的值不能在 sweep 外面用
+        forEachOperand(v, [&](int ref) {
+            if (ref >= 0 && sweepOf(p, loops, ref) >= 0 && values[ref].op != Op::Param &&
+                !isConstOp(values[ref].op))
+                ok = false;
+        });
+        if (!ok) return false;
+    }
+
+    for (int c : p.sweeps) {
+        const LoopShape& s = loops[c];
+        if (!sweepShape(values, s)) return false;
+        if (!timeInvariant(values, t, p, loops, entryOf(values, s)) ||
+            !timeInvariant(values, t, p, loops, s.bound))
+            return false;
+    }
+    return true;
+}
+
+// ============================================================
+// 合法性：斜切係數 σ
+// ============================================================
+
+// 先執行的一邊到後執行的一邊：空間距離 di、虛擬時間差 dtau > 0 時要
+// di + σ·dtau >= 0；回傳需要的最小 σ
+int64_t skewFor(int64_t di, int64_t dtau) {
+    if (dtau <= 0 || di >= 0) return 0;
+    return (-di + dtau - 1) / dtau;
+}
+
+// 一個方向（first 先、second 後）：時間步的差 dt（可能不確定）、sweep 的差 ds
+int64_t orientedSkew(int64_t di, int64_t dt, int64_t ds, int64_t K) {
+    if (dt == kUnknownDistance) {
+        int64_t m = ((ds % K) + K) % K;
+        return skewFor(di, m == 0 ? K : m);
+    }
+    return skewFor(di, dt * K + ds);
+}
+
+bool chooseSkew(const std::vector<LoopShape>& loops, const DependenceAnalysis& deps,
+                const AliasAnalysis& aa, Plan& p) {
+    const LoopShape& t = loops[p.time];
+    const int first = p.sweeps[0];
+    const int64_t K = (int64_t)p.sweeps.size();
+    std::vector<std::pair<AffineAccess, int>> accs;   // (改名後的存取, sweep)
+    for (const AffineAccess& a : deps.accesses()) {
+        if (a.node < t.loop || a.node > t.end) continue;
+        int s = sweepOf(p, loops, a.node);
+        if (s < 0 || !a.affine) return false;
+        // 時間步只決定先後，位址跟 t 無關（不然是一般的 loop nest，交給 tile）
+        for (const auto& [term, c] : a.terms)
+            if (term.first == p.time && c != 0) return false;
+        // 每個 sweep 的 loop 換成第一個 sweep：當成同一個空間 loop 比較
+        accs.push_back({renameLoop(a, p.sweeps[s], first), s});
+    }
+    int64_t sigma = 0;
+    for (size_t x = 0; x < accs.size(); x++)
+        for (size_t y = x; y < accs.size(); y++) {
+            const auto& [a, sa] = accs[x];
+            const auto& [b, sb] = accs[y];
+            if (!a.write && !b.write) continue;
+            if (x != y && !aa.mayAlias(a.node, b.node)) continue;
+            Dependence d;
+            if (!deps.test(a, b, d)) continue;
+            auto pt = std::find(d.loops.begin(), d.loops.end(), p.time);
+            auto ps = std::find(d.loops.begin(), d.loops.end(), first);
+            if (pt == d.loops.end() || ps == d.loops.end()) return false;
+            // 外層 loop 帶走的相依不管
+            bool carried = false;
+            for (auto it = d.loops.begin(); it != pt; it++) {
+                int64_t o = d.distance[it - d.loops.begin()];
+                carried |= o != 0 && o != kUnknownDistance;
+            }
+            if (carried) continue;
+            int64_t dt = d.distance[pt - d.loops.begin()];
+            int64_t di = d.distance[ps - d.loops.begin()];
+            if (di == kUnknownDistance) return false;
+            // test 把先執行的當 src；換回 b − a
+            if (d.src == b.node && a.node != b.node) {
+                di = -di;
+                if (dt != kUnknownDistance) dt = -dt;
+            }
+            const int64_t rdt = dt == kUnknownDistance ? dt : -dt;
+            sigma = std::max(sigma, orientedSkew(di, dt, sb - sa, K));
+            sigma = std::max(sigma, orientedSkew(-di, rdt, sa - sb, K));
+            if (sigma > 4) return false;
+        }
+    p.skew = (int)sigma;
+    return true;
+}
+
+// ============================================================
+// tile 大小
+// ============================================================
+
+// 一個空間點（sweep 的一輪，裡面的 loop 整個跑完）碰到的 bytes：
+// 每個陣列算一次，裡面的 loop 不知道 trip count 時當 256
+int64_t bytesPerPoint(const std::vector<LoopShape>& loops, const DependenceAnalysis& deps,
+                      const AliasAnalysis& aa, const Plan& p) {
+    const LoopShape& t = loops[p.time];
+    std::map<std::pair<int, int>, int64_t> arrays;
+    for (const AffineAccess& a : deps.accesses()) {
+        if (a.node < t.loop || a.node > t.end) continue;
+        MemLocation loc = aa.location(a.node);
+        std::pair<int, int> key = loc.kind == MemLocation::Unknown
+                                  ? std::make_pair(-1, a.node) : std::make_pair((int)loc.kind, loc.base);
+        int64_t bytes = a.size;
+        for (int l : a.loops) {
+            // 時間 loop 裡除了 sweep 之外的 loop 都在某個 sweep 裡面
+            bool inner = loops[l].loop > t.loop &&
+                         std::find(p.sweeps.begin(), p.sweeps.end(), l) == p.sweeps.end();
+            if (inner) bytes *= loops[l].tripCount > 0 ? loops[l].tripCount : 256;
+        }
+        arrays[key] = std::max(arrays[key], bytes);
+    }
+    int64_t total = 0;
+    for (const auto& [k, b] : arrays) total += b;
+    return std::max<int64_t>(1, total);
+}
+
+bool chooseTile(const std::vector<LoopShape>& loops, const DependenceAnalysis& deps,
+                const AliasAnalysis& aa, const StencilOptions& opts, Plan& p) {
+    const LoopShape& t = loops[p.time];
+    if (t.tripCount >= 0 && t.tripCount < 2) return false;
+    const int64_t K = (int64_t)p.sweeps.size();
+    int64_t H = t.tripCount > 0 ? std::min<int64_t>(t.tripCount, 16) : 16;
+    int64_t cache = opts.l2CacheSize > 0 ? opts.l2CacheSize : hostCacheSize(2);
+    int64_t W = opts.tileSize;
+    if (W <= 0) {
+        const int64_t point = bytesPerPoint(loops, deps, aa, p);
+        W = 4096;
+        while (W > 8 && W * point > cache / 2) W /= 2;
+        if (W * point > cache / 2) return false;   // 一列就放不下
+    }
+    // 斜切多出來的 σ·H·K 不要比 tile 本身寬
+    if (p.skew > 0)
+        H = std::min<int64_t>(H, std::max<int64_t>(2, W / (2 * p.skew * K)));
+
+    // 每個 sweep 都已知很短時整個 grid 就放得進 cache
+    bool small = true;
+    for (int c : p.sweeps)
+        if (loops[c].tripCount < 0 || loops[c].tripCount > W) small = false;
+    if (small) return false;
+    p.steps = (int)H;
+    p.width = (int)W;
+    return true;
+}
+
+// ============================================================
+// 重建
+// ============================================================
+
+class TimeBlocker : public ValueIRRebuilder {
+public:
+    TimeBlocker(const ValueIR& in, const std::vector<LoopShape>& loops, const std::vector<Plan>& plans)
+        : ValueIRRebuilder(in), loops_(loops), plans_(plans) {}
+
+    ValueIR run() {
+        std::vector<std::pair<int, int>> regions;
+        for (const Plan& p : plans_) regions.push_back({loops_[p.time].loop, loops_[p.time].end});
+        return ValueIRRebuilder::run(regions);
+    }
+
+private:
+    void emitRegion(size_t k) override;
+    void hoist(int ref, const LoopShape& t);
+    int konst(int c) { return emitOp(Op::I32Const, -1, -1, c); }
+    int select(int cond, int a, int b) {
+        Value v;
+        v.op = Op::Select;
+        v.type = ValueType::I32;
+        v.operands = {cond, a, b};
+        return emit(v);
+    }
+    int minS(int a, int b) { return a == b ? a : select(emitOp(Op::Lt_S, a, b), a, b); }
+    int maxS(int a, int b) { return a == b ? a : select(emitOp(Op::Gt_S, a, b), a, b); }
+    std::pair<int, int> openLoop(const LoopShape& like, int init, int bound);
+    void closeLoop(const LoopShape& like, std::pair<int, int> l, int step);
+    int openCopy(const LoopShape& s, int init, int bound);
+    void closeCopy(const LoopShape& s);
+
+    const std::vector<LoopShape>& loops_;
+    const std::vector<Plan>& plans_;
+};
+
+void TimeBlocker::hoist(int ref, const LoopShape& t) {
+    if (ref < t.loop || ref > t.end || map_[ref] >= 0) return;
+    forEachOperand(in_[ref], [&](int r) { hoist(r, t); });
+    copyVerbatim(ref, ref, nullptr);
+}
+
+std::pair<int, int> TimeBlocker::openLoop(const LoopShape& like, int init, int bound) {
+    int lm = emit(in_[like.loop]);
+    Value phi = in_[like.iv];
+    phi.operands = {init};
+    int iv = emit(phi);
+    Value exit = in_[like.exitBr];
+    exit.lhs = emitOp(Op::Lt_S, iv, bound);
+    exit.rhs = lm;
+    emit(exit);
+    return {lm, iv};
+}
+
+void TimeBlocker::closeLoop(const LoopShape& like, std::pair<int, int> l, int step) {
+    setBack(l.second, emitOp(Op::Add, l.second, step));
+    Value back = in_[like.backBr];
+    back.lhs = l.first;
+    back.rhs = l.second;
+    emit(back);
+    emit(in_[like.end]);
+}
+
+int TimeBlocker::openCopy(const LoopShape& s, int init, int bound) {
+    map_[s.loop] = emit(in_[s.loop]);
+    Value phi = in_[s.iv];
+    phi.operands = {init};
+    int iv = emit(phi);
+    map_[s.iv] = iv;
+    for (int i = s.header(); i < s.exitBr; i++)
+        if (i != s.iv && map_[i] < 0) copyVerbatim(i, i, nullptr);
+    Value exit = in_[s.exitBr];
+    exit.lhs = emitOp(Op::Lt_S, iv, bound);
+    exit.rhs = map_[s.loop];
+    map_[s.exitBr] = emit(exit);
+    return iv;
+}
+
+void TimeBlocker::closeCopy(const LoopShape& s) {
+    setBack(map_[s.iv], map_[in_[s.iv].operands[1]]);
+    Value back = in_[s.backBr];
+    back.lhs = map_[s.loop];
+    back.rhs = map_[s.iv];
+    map_[s.backBr] = emit(back);
+    map_[s.end] = emit(in_[s.end]);
+}
+
+void TimeBlocker::emitRegion(size_t k) {
+    const Plan& p = plans_[k];
+    const LoopShape& t = loops_[p.time];
+
+    for (int i = t.header(); i < t.exitBr; i++)
+        if (in_[i].op == Op::Param || isConstOp(in_[i].op)) copyVerbatim(i, i, nullptr);
+    hoist(entryOf(in_, t), t);
+    hoist(t.bound, t);
+    std::vector<int> lo, hi;
+    for (int c : p.sweeps) {
+        hoist(entryOf(in_, loops_[c]), t);
+        hoist(loops_[c].bound, t);
+        lo.push_back(mapOutside(entryOf(in_, loops_[c])));
+        hi.push_back(mapOutside(loops_[c].bound));
+    }
+    int loMin = lo[0], hiMax = hi[0];
+    for (size_t s = 1; s < lo.size(); s++) {
+        loMin = minS(loMin, lo[s]);
+        hiMax = maxS(hiMax, hi[s]);
+    }
+
+    const int K = (int)p.sweeps.size();
+    const int H = konst(p.steps), W = konst(p.width), sigma = konst(p.skew);
+    const int one = konst(1), tn = mapOutside(t.bound);
+
+    // 時間 block
+    auto tb = openLoop(t, mapOutside(entryOf(in_, t)), tn);
+    const int tbe = minS(emitOp(Op::Add, tb.second, H), tn);
+    const int taus = emitOp(Op::Mul, emitOp(Op::Sub, tbe, tb.second), konst(K));
+    const int xEnd = emitOp(Op::Add, hiMax, emitOp(Op::Mul, emitOp(Op::Sub, taus, one), sigma));
+
+    // 斜切後的空間 tile
+    auto xb = openLoop(t, loMin, xEnd);
+    const int xe = emitOp(Op::Add, xb.second, W);
+
+    const int tt = openCopy(t, tb.second, tbe);
+    const int base = emitOp(Op::Mul, emitOp(Op::Sub, tt, tb.second), konst(p.skew * K));
+    int prev = t.bodyBegin();
+    for (int s = 0; s < K; s++) {
+        const LoopShape& sw = loops_[p.sweeps[s]];
+        copyUnmapped(prev, sw.loop - 1, true);
+        const int off = emitOp(Op::Add, base, emitOp(Op::Mul, konst(s), sigma));
+        const int iLo = maxS(lo[s], emitOp(Op::Sub, xb.second, off));
+        const int iHi = minS(hi[s], emitOp(Op::Sub, xe, off));
+        openCopy(sw, iLo, iHi);
+        copyUnmapped(sw.bodyBegin(), sw.backBr - 1, false);
+        closeCopy(sw);
+        prev = sw.end + 1;
+    }
+    copyUnmapped(prev, t.backBr - 1, true);
+    closeCopy(t);
+
+    closeLoop(t, xb, W);
+    closeLoop(t, tb, H);
+}
+
+} // namespace
+
+int blockTimeLoops(ValueIR& values, const AliasAnalysis& aa, const StencilOptions& opts) {
+    for (const Value& v : values)
+        if (v.op == Op::Phi && v.use_vload_entry) return 0;
+    std::vector<LoopShape> loops = findLoops(values);
+    if (loops.empty()) return 0;
+    DependenceAnalysis deps(values, loops, aa);
+
+    std::vector<Plan> plans;
+    int skipUntil = -1;
+    for (int k = 0; k < (int)loops.size(); k++) {
+        if (loops[k].loop < skipUntil) continue;
+        Plan p;
+        if (!recognize(values, loops, k, p)) continue;
+        if (!chooseSkew(loops, deps, aa, p)) continue;
+        if (!chooseTile(loops, deps, aa, opts, p)) continue;
+        plans.push_back(std::move(p));
+        skipUntil = loops[k].end;
+    }
+    if (plans.empty()) return 0;
+
+    ValueIR out = TimeBlocker(values, loops, plans).run();
+    values = cleanupValueIR(out);
+    return (int)plans.size();
+}
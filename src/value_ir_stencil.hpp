@@ -0,0 +1,41 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+#include <cstdint>
+
+// ============================================================
+// Temporal blocking：iterative stencil 的時間步一起切 tile
+// ============================================================
+//
+// jacobi-1d / jacobi-2d / heat-3d 每個時間步都把整個 grid 掃一遍（一個
+// 或幾個並排的 sweep），grid 比 cache 大時每一步都從記憶體重新讀。
+//
+//   for (t = 0; t < T; t++) {                 for (tb = 0; tb < T; tb += H)
+//     for (i = 1; i < n-1; i++) B[i] = ..A..    for (xb = lo; xb < hi + σ·(H·K-1); xb += W)
+//     for (i = 1; i < n-1; i++) A[i] = ..B..      for (t = tb; t < min(tb+H, T); t++)
+//   }                                               for sweep s（照原本順序）
+//                                                     τ = (t - tb)·K + s
+//                                                     for (i = max(lo_s, xb - σ·τ);
+//                                                          i < min(hi_s, xb + W - σ·τ); i++)
+//
+// 把第 t 步的第 s 個 sweep 當成虛擬時間 τ = t·K + s（K = sweep 數），在
+// (τ, x = i + σ·τ) 上切 H·K × W 的平行四邊形 tile：一個 tile 在 W 寬的
+// 一段上連跑 H 個時間步，資料還在 cache 裡。
+//
+// 辨認：時間 loop 是 value_ir_loops.hpp 的 counted loop（step 1 的
+// `t < T`），唯一的 loop-carried 值是 t，body 是幾個並排的 sweep，中間只有
+// 純運算 / LocalSet。sweep 是 step 1 的 `i < n`，起點跟 n 跟 t 無關，
+// 裡面可以還有 loop（2-D / 3-D 的列整列跑完，只在最外一維切）。
+//
+// 合法性：兩個 sweep 裡的存取當成同一個空間 loop 交給 DependenceAnalysis
+// 求 i 的距離 d（要是常數），時間方向的距離不確定時取最小的 Δτ。每個
+// 相依斜切之後都要 d + σ·Δτ >= 0；σ 取最小的（最多 4）。
+
+struct StencilOptions {
+    int tileSize = 0;             // W；0 = 依 cache 大小決定
+    int64_t l2CacheSize = 0;      // bytes；0 = 問 host
+};
+
+// 回傳改寫的時間 loop 數；有改寫時 values 重建並跑過 cleanupValueIR。
+int blockTimeLoops(ValueIR& values, const AliasAnalysis& aa, const StencilOptions& opts = {});
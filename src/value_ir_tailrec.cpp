@@ -0,0 +1,307 @@
+#include "value_ir_tailrec.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+
+namespace {
+
+// 分析結果。range 都是 [begin, end)。
+struct TailRecShape {
+    int ifIdx = -1;
+    int cond = -1;
+    int baseBegin = 0, baseEnd = 0, baseValue = -1;   // 終止那一邊
+    int recBegin = 0, recEnd = 0, recValue = -1;      // 遞迴那一邊
+    bool recOnTrue = false;   // 遞迴在 then：條件成立時繼續 loop
+    int call = -1;
+    int acc = -1;             // 累加節點（⊕），-1 = 單純 tail call
+    int accOperand = -1;      // acc 另一邊的值 x(p)
+};
+
+bool isControl(Op op) {
+    switch (op) {
+    case Op::If: case Op::Else: case Op::End: case Op::Loop:
+    case Op::Br: case Op::Br_if: case Op::Return: case Op::Unreachable:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 結構上可以搬進 loop body / loop 之後的一段：巢狀 if 可以，loop / 跳轉 / return 不行
+bool plainRange(const ValueIR& values, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        Op op = values[i].op;
+        if (op == Op::Loop || op == Op::Br || op == Op::Br_if ||
+            op == Op::Return || op == Op::Unreachable)
+            return false;
+    }
+    return true;
+}
+
+bool isAccumulatorOp(const Value& v) {
+    if (v.type != ValueType::I32 && v.type != ValueType::I64) return false;
+    switch (v.op) {
+    case Op::Add: case Op::Mul: case Op::And: case Op::Or: case Op::Xor:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// from 是否（經過資料 operand）用到 target
+bool dependsOn(const ValueIR& values, int from, int target) {
+    std::vector<int> work{from};
+    std::vector<bool> seen(values.size(), false);
+    while (!work.empty()) {
+        int x = work.back(); work.pop_back();
+        if (x == target) return true;
+        if (x < 0 || x >= (int)values.size() || seen[x] || x < target) continue;
+        seen[x] = true;
+        forEachOperand(values[x], [&](int ref) { work.push_back(ref); });
+    }
+    return false;
+}
+
+bool matchShape(const ValueIR& values, const std::string& selfName,
+                size_t numParams, TailRecShape& s) {
+    const int n = (int)values.size();
+
+    // 恰好一個自我呼叫
+    for (int i = 0; i < n; i++) {
+        if (values[i].op != Op::Call || values[i].callee_name != selfName) continue;
+        if (s.call >= 0) return false;
+        s.call = i;
+    }
+    if (s.call < 0 || values[s.call].operands.size() != numParams) return false;
+
+    // 最前面一段沒有控制流，接著第一個 If
+    for (int i = 0; i < n && s.ifIdx < 0; i++) {
+        if (values[i].op == Op::If) s.ifIdx = i;
+        else if (isControl(values[i].op) || values[i].op == Op::Phi) return false;
+    }
+    if (s.ifIdx < 0) return false;
+    s.cond = values[s.ifIdx].lhs;
+
+    std::vector<int> match = matchRegions(values);
+    int endIdx = match[s.ifIdx];
+    if (endIdx < 0) return false;
+    int elseIdx = -1;
+    for (int i = s.ifIdx + 1; i < endIdx; i++)
+        if (values[i].op == Op::Else && match[i] == s.ifIdx) elseIdx = i;
+
+    // 結尾：第一個 Return 之後只能有 Return
+    int ret = -1;
+    for (int i = endIdx + 1; i < n; i++) {
+        if (values[i].op == Op::Return) { ret = i; break; }
+    }
+    if (ret < 0 || values[ret].lhs < 0) return false;   // 沒有回傳值的遞迴不處理
+    for (int i = ret + 1; i < n; i++)
+        if (values[i].op != Op::Return) return false;
+
+    int thenBegin = s.ifIdx + 1;
+    if (elseIdx >= 0) {
+        // if/else + merge phi：Return 的值必須是這個 if 的 merge phi
+        for (int i = endIdx + 1; i < ret; i++)
+            if (values[i].op != Op::Phi || values[i].local_index >= 0) return false;
+        const Value& r = values[values[ret].lhs];
+        if (values[ret].lhs <= endIdx || r.op != Op::Phi || r.operands.size() != 2) return false;
+        bool callInThen = s.call > s.ifIdx && s.call < elseIdx;
+        bool callInElse = s.call > elseIdx && s.call < endIdx;
+        if (!callInThen && !callInElse) return false;
+        s.recOnTrue = callInThen;
+        if (callInThen) {
+            s.recBegin = thenBegin; s.recEnd = elseIdx; s.recValue = r.operands[0];
+            s.baseBegin = elseIdx + 1; s.baseEnd = endIdx; s.baseValue = r.operands[1];
+        } else {
+            s.baseBegin = thenBegin; s.baseEnd = elseIdx; s.baseValue = r.operands[0];
+            s.recBegin = elseIdx + 1; s.recEnd = endIdx; s.recValue = r.operands[1];
+        }
+    } else {
+        // `if (c) { ...; return base; } ...; return f(...)`
+        int thenRet = endIdx - 1;
+        if (thenRet <= s.ifIdx || values[thenRet].op != Op::Return || values[thenRet].lhs < 0)
+            return false;
+        s.baseBegin = thenBegin; s.baseEnd = thenRet; s.baseValue = values[thenRet].lhs;
+        s.recBegin = endIdx + 1; s.recEnd = ret; s.recValue = values[ret].lhs;
+        s.recOnTrue = false;
+        if (s.call < s.recBegin || s.call >= s.recEnd) return false;
+    }
+    if (!plainRange(values, s.baseBegin, s.baseEnd) || !plainRange(values, s.recBegin, s.recEnd))
+        return false;
+
+    // 兩邊的值必須在各自的範圍（或 if 之前）算出來
+    auto inPrefixOr = [&](int id, int begin, int end) {
+        return (id >= 0 && id < s.ifIdx) || (id >= begin && id < end);
+    };
+    if (!inPrefixOr(s.baseValue, s.baseBegin, s.baseEnd)) return false;
+    if (!inPrefixOr(s.recValue, s.recBegin, s.recEnd)) return false;
+
+    // 兩邊不能互相引用（no-else 形狀下，if 之後的 merge phi 會引用 then 的值）
+    auto refersInto = [&](int begin, int end, int lo, int hi) {
+        bool found = false;
+        for (int i = begin; i < end; i++)
+            forEachOperand(values[i], [&](int ref) { if (ref >= lo && ref < hi) found = true; });
+        return found;
+    };
+    if (refersInto(s.recBegin, s.recEnd, s.baseBegin, s.baseEnd) ||
+        refersInto(s.baseBegin, s.baseEnd, s.recBegin, s.recEnd))
+        return false;
+
+    // 遞迴值：call 本身，或 x ⊕ call
+    if (s.recValue != s.call) {
+        const Value& a = values[s.recValue];
+        if (!isAccumulatorOp(a)) return false;
+        if (a.lhs == s.call) s.accOperand = a.rhs;
+        else if (a.rhs == s.call) s.accOperand = a.lhs;
+        else return false;
+        if (dependsOn(values, s.accOperand, s.call)) return false;
+        s.acc = s.recValue;
+    }
+
+    // call 的結果只給 recValue 用；call 之後只能是純運算。LocalSet 不算：
+    // 函式裡沒有 loop，ir_VAR 不會被讀，改寫時直接丟掉（見 copyRange）。
+    for (int i = 0; i < n; i++) {
+        if (values[i].op == Op::LocalSet) continue;
+        int uses = 0;
+        forEachOperand(values[i], [&](int ref) { if (ref == s.call) uses++; });
+        if (uses && i != s.recValue && !(values[i].op == Op::Phi && i > endIdx)) return false;
+        if (s.acc >= 0) {
+            int accUses = 0;
+            forEachOperand(values[i], [&](int ref) { if (ref == s.acc) accUses++; });
+            if (accUses && !(values[i].op == Op::Phi && i > endIdx) && values[i].op != Op::Return)
+                return false;
+        }
+    }
+    for (int i = s.call + 1; i < s.recEnd; i++)
+        if (!isPureOp(values[i].op) && values[i].op != Op::LocalSet) return false;
+    return true;
+}
+
+} // namespace
+
+bool eliminateTailRecursion(ValueIR& values, const std::string& selfName, size_t numParams) {
+    TailRecShape s;
+    if (!matchShape(values, selfName, numParams, s)) return false;
+
+    ValueIR out;
+    out.reserve(values.size() + numParams * 2 + 8);
+    auto emit = [&](Value v) {
+        v.id = (int)out.size();
+        out.push_back(std::move(v));
+        return (int)out.size() - 1;
+    };
+    auto make = [&](Op op) {
+        Value v;
+        v.op = op;
+        return v;
+    };
+
+    std::vector<int> map(values.size(), -1);
+
+    // loop 入口：參數與累加器的初值
+    std::vector<int> entry(numParams);
+    for (size_t p = 0; p < numParams; p++) {
+        Value v = make(Op::Param);
+        v.paramIndex = (int)p;
+        entry[p] = emit(v);
+    }
+    int identity = -1;
+    ValueType accType = ValueType::I32;
+    if (s.acc >= 0) {
+        const Value& a = values[s.acc];
+        accType = a.type;
+        Value c = make(a.type == ValueType::I64 ? Op::I64Const : Op::I32Const);
+        c.type = a.type;
+        c.constValue = (a.op == Op::Mul) ? 1 : (a.op == Op::And) ? -1 : 0;
+        identity = emit(c);
+    }
+
+    int loop = emit(make(Op::Loop));
+    std::vector<int> phis(numParams);
+    for (size_t p = 0; p < numParams; p++) {
+        Value v = make(Op::Phi);
+        v.local_index = (int)p;
+        v.operands = {entry[p]};
+        phis[p] = emit(v);
+    }
+    int accPhi = -1;
+    if (s.acc >= 0) {
+        int accLocal = (int)numParams;
+        for (const auto& v : values) {
+            if (v.op == Op::LocalSet || v.op == Op::LocalGet || v.op == Op::LocalTee)
+                accLocal = std::max(accLocal, v.paramIndex + 1);
+            if (v.op == Op::Phi) accLocal = std::max(accLocal, v.local_index + 1);
+        }
+        Value v = make(Op::Phi);
+        v.local_index = accLocal;
+        v.type = accType;
+        v.operands = {identity};
+        accPhi = emit(v);
+    }
+
+    auto copyRange = [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const Value& src = values[i];
+            if (src.op == Op::Param) {
+                map[i] = phis[src.paramIndex];
+                continue;
+            }
+            if (i == s.call || src.op == Op::LocalSet) continue;
+            Value v = src;
+            forEachOperand(v, [&](int& ref) {
+                if (ref == s.call) ref = accPhi;   // x ⊕ f(...) → x ⊕ acc
+                else ref = map[ref];
+            });
+            map[i] = emit(std::move(v));
+        }
+    };
+
+    // if 之前那段每一輪都算；條件成立（或不成立）就離開 loop
+    copyRange(0, s.ifIdx);
+    int cont = map[s.cond];
+    if (!s.recOnTrue) {
+        Value neg = make(Op::Eqz);
+        neg.lhs = cont;
+        cont = emit(neg);
+    }
+    Value exitBr = make(Op::Br_if);
+    exitBr.lhs = cont;
+    exitBr.rhs = loop;
+    exitBr.constValue = 1;
+    emit(exitBr);
+
+    // 遞迴那一邊：call 的引數變成下一輪的參數
+    copyRange(s.recBegin, s.recEnd);
+    const Value& call = values[s.call];
+    for (size_t p = 0; p < numParams; p++)
+        out[phis[p]].operands.push_back(map[call.operands[p]]);
+    if (accPhi >= 0) out[accPhi].operands.push_back(map[s.acc]);
+
+    Value back = make(Op::Br);
+    back.lhs = loop;
+    back.rhs = numParams > 0 ? phis[0] : accPhi;
+    emit(back);
+    Value endLoop = make(Op::End);
+    endLoop.constValue = 0;
+    emit(endLoop);
+    Value endBlock = make(Op::End);
+    endBlock.constValue = 1;
+    emit(endBlock);
+
+    // 離開 loop 之後：終止那一邊只算一次，再併上累加器
+    copyRange(s.baseBegin, s.baseEnd);
+    int result = map[s.baseValue];
+    if (accPhi >= 0) {
+        Value fold = make(values[s.acc].op);
+        fold.type = accType;
+        fold.lhs = accPhi;
+        fold.rhs = result;
+        result = emit(fold);
+    }
+    Value ret = make(Op::Return);
+    ret.lhs = result;
+    emit(ret);
+
+    values = cleanupValueIR(out);
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include <string>
+
+// ============================================================
+// Tail recursion → loop
+// ============================================================
+//
+// 自我遞迴每一層都是一次真正的 ir_CALL_N（factorial_rec.wat），輸入大
+// 一點就吃光 native stack。這裡認得「一個 if 分兩邊，一邊是終止條件，
+// 另一邊以呼叫自己結尾」的形狀：
+//
+//   f(p) = c(p) ? base(p) : f(g(p))              tail call
+//   f(p) = c(p) ? base(p) : x(p) ⊕ f(g(p))       累加器，⊕ ∈ {+, *, &, |, ^}
+//
+// （終止條件也可以寫成 `if (c) return base; ... return ...;`，遞迴也可以
+// 在 then 那一邊）改寫成
+//
+//   acc = identity(⊕)
+//   loop { p = phi(p0, g(p)); acc = phi(identity, acc ⊕ x(p));
+//          if (c(p)) break; ... }
+//   return acc ⊕ base(p)
+//
+// 整數的 ⊕ 在 mod 2^n 下可交換又可結合，所以把「回來時才算」改成
+// 「往下時先累加」結果一樣；浮點數不是，不處理。函式本身不能有 loop、
+// 不能有第二個自我呼叫，遞迴那一邊在呼叫之後只能有純運算。
+//
+// 成功改寫回傳 true。
+bool eliminateTailRecursion(ValueIR& values, const std::string& selfName, size_t numParams);
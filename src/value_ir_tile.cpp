@@ -0,0 +1,282 @@
+#include "value_ir_tile.hpp"
+#include "value_ir_deps.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_rebuild.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <unistd.h>
+
+int64_t hostCacheSize(int level) {
+    long n = -1;
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+    n = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE : _SC_LEVEL2_CACHE_SIZE);
+#endif
+    if (n > 0) return n;
+    return level == 1 ? 32 * 1024 : 1024 * 1024;
+}
+
+namespace {
+
+// ============================================================
+// Band
+// ============================================================
+
+struct Plan {
+    std::vector<int> band;   // findLoops 的 index，外 → 內
+    int tileSize = 0;
+};
+
+int entryOf(const ValueIR& values, const LoopShape& s) {
+    return values[s.iv].operands[0];
+}
+
+bool usesLoop(const AffineAccess& a, int loop) {
+    for (const auto& [t, c] : a.terms)
+        if (t.first == loop && c != 0) return true;
+    return false;
+}
+
+// tile 有沒有用：有存取跟某一層 band 無關（那一層的迭代之間重用同一份
+// 資料），或存取的連續方向（係數最小的 iv）不一樣（transpose）。
+bool hasReuse(const std::vector<const AffineAccess*>& accs, const std::vector<int>& band) {
+    std::set<int> fastest;
+    bool any = false;
+    for (const AffineAccess* a : accs) {
+        if (!a->affine) continue;
+        any = true;
+        for (int l : band)
+            if (!usesLoop(*a, l)) return true;
+        int best = -1;
+        int64_t stride = 0;
+        for (const auto& [t, c] : a->terms) {
+            if (t.first < 0 || !t.second.empty() || c == 0) continue;
+            if (std::find(band.begin(), band.end(), t.first) == band.end()) continue;
+            if (best < 0 || std::llabs(c) < stride) {
+                best = t.first;
+                stride = std::llabs(c);
+            }
+        }
+        fastest.insert(best);
+    }
+    return any && fastest.size() > 1;
+}
+
+// 一個 tile 用到的 bytes：每個存取（位移不同的算同一個）乘上它用到的
+// band 層數的 T，與 band 裡面的 loop 的 trip count（不知道時當 256）
+int64_t footprint(const std::vector<LoopShape>& loops, const std::vector<const AffineAccess*>& accs,
+                  const std::vector<int>& band, int64_t T) {
+    std::set<std::map<std::pair<int, std::string>, int64_t>> seen;
+    int64_t total = 0;
+    for (const AffineAccess* a : accs) {
+        if (!a->affine) continue;
+        auto key = a->terms;
+        key.erase({-1, ""});
+        if (!seen.insert(key).second) continue;
+        int64_t bytes = a->size;
+        for (int l : a->loops) {
+            if (l < band[0] || !usesLoop(*a, l)) continue;
+            if (std::find(band.begin(), band.end(), l) != band.end()) bytes *= T;
+            else bytes *= loops[l].tripCount > 0 ? loops[l].tripCount : 256;
+        }
+        total += bytes;
+    }
+    return total;
+}
+
+int chooseTileSize(const std::vector<LoopShape>& loops, const std::vector<const AffineAccess*>& accs,
+                   const std::vector<int>& band, const TileOptions& opts) {
+    if (opts.tileSize > 0) return opts.tileSize;
+    const LoopShape& last = loops[band.back()];
+    bool nested = !last.innermost;
+    int64_t cache = nested ? opts.l2CacheSize : opts.l1CacheSize;
+    if (cache <= 0) cache = hostCacheSize(nested ? 2 : 1);
+    for (int T = 256; T > 8; T /= 2)
+        if (footprint(loops, accs, band, T) <= cache / 2) return T;
+    return 8;
+}
+
+bool planBand(const ValueIR& values, const std::vector<LoopShape>& loops,
+              const DependenceAnalysis& deps, const std::vector<int>& band,
+              const TileOptions& opts, Plan& plan) {
+    const LoopShape& outer = loops[band[0]];
+    const LoopShape& last = loops[band.back()];
+    if (!loopNestSelfContained(values, outer)) return false;
+
+    std::vector<const AffineAccess*> accs;
+    for (const AffineAccess& a : deps.accesses())
+        if (a.node > last.loop && a.node < last.end) accs.push_back(&a);
+    if (!hasReuse(accs, band)) return false;
+    if (!bandFullyPermutable(deps.dependences(outer.loop, outer.end), band)) return false;
+
+    int T = chooseTileSize(loops, accs, band, opts);
+    bool small = true;
+    for (int l : band)
+        if (loops[l].tripCount < 0 || loops[l].tripCount > T) small = false;
+    if (small) return false;   // 整個 nest 就是一個 tile
+    plan.band = band;
+    plan.tileSize = T;
+    return true;
+}
+
+// ============================================================
+// 重建
+// ============================================================
+//
+//   Loop                              tile loop（每層一個，外 → 內）
+//     tt = Phi(init, e)
+//     Br_if(tt < n)
+//     e = (n - tt >u T) ? tt + T : n
+//     ...
+//       Loop                          point loop
+//         i = Phi(tt, i + 1)
+//         <header>
+//         Br_if(i < e)
+//         <pre> <下一層 point loop> <post>   或最內層的 body
+//         Br
+//       End
+//     ...
+//     Br
+//   End
+
+class Tiler : public ValueIRRebuilder {
+public:
+    Tiler(const ValueIR& in, const std::vector<LoopShape>& loops, const std::vector<Plan>& plans)
+        : ValueIRRebuilder(in), loops_(loops), plans_(plans) {}
+
+    ValueIR run() {
+        std::vector<std::pair<int, int>> regions;
+        for (const Plan& p : plans_) {
+            const LoopShape& s = loops_[p.band[0]];
+            regions.push_back({s.loop, s.end});
+        }
+        return ValueIRRebuilder::run(regions);
+    }
+
+private:
+    void emitRegion(size_t k) override;
+    void emitPoint(const Plan& p, size_t level);
+    Op lessThan(const LoopShape& s) const { return s.cmp == LoopCmp::LtU ? Op::Lt_U : Op::Lt_S; }
+
+    const std::vector<LoopShape>& loops_;
+    const std::vector<Plan>& plans_;
+    std::vector<int> tilePhis_, tileEnds_;
+};
+
+void Tiler::emitRegion(size_t k) {
+    const Plan& p = plans_[k];
+    const LoopShape& outer = loops_[p.band[0]];
+
+    // tile loop 用到的起點 / n 是 band 裡的 Param / 常數時先拿出來
+    for (int i = outer.header(); i < outer.exitBr; i++)
+        if (in_[i].op == Op::Param || isConstOp(in_[i].op)) copyVerbatim(i, i, nullptr);
+    for (int l : p.band)
+        for (int ref : {entryOf(in_, loops_[l]), loops_[l].bound})
+            if (ref > outer.loop && ref < outer.end && map_[ref] < 0) copyVerbatim(ref, ref, nullptr);
+
+    const int T = emitOp(Op::I32Const, -1, -1, p.tileSize);
+    std::vector<int> tileLoops;
+    tilePhis_.clear();
+    tileEnds_.clear();
+    for (int l : p.band) {
+        const LoopShape& s = loops_[l];
+        int lm = emit(in_[s.loop]);
+        Value phi = in_[s.iv];
+        phi.operands = {mapOutside(entryOf(in_, s))};
+        int tt = emit(phi);
+        int n = mapOutside(s.bound);
+        Value exit = in_[s.exitBr];
+        exit.lhs = emitOp(lessThan(s), tt, n);
+        exit.rhs = lm;
+        emit(exit);
+
+        int left = emitOp(Op::Sub, n, tt);
+        int full = emitOp(Op::Gt_U, left, T);
+        int next = emitOp(Op::Add, tt, T);
+        Value sel;
+        sel.op = Op::Select;
+        sel.type = ValueType::I32;
+        sel.operands = {full, next, n};
+        tileLoops.push_back(lm);
+        tilePhis_.push_back(tt);
+        tileEnds_.push_back(emit(sel));
+    }
+
+    emitPoint(p, 0);
+
+    for (size_t k2 = p.band.size(); k2-- > 0;) {
+        const LoopShape& s = loops_[p.band[k2]];
+        setBack(tilePhis_[k2], tileEnds_[k2]);
+        Value back = in_[s.backBr];
+        back.lhs = tileLoops[k2];
+        back.rhs = tilePhis_[k2];
+        emit(back);
+        emit(in_[s.end]);
+    }
+}
+
+void Tiler::emitPoint(const Plan& p, size_t level) {
+    const LoopShape& s = loops_[p.band[level]];
+    map_[s.loop] = emit(in_[s.loop]);
+    Value phi = in_[s.iv];
+    phi.operands = {tilePhis_[level]};
+    int iv = emit(phi);
+    map_[s.iv] = iv;
+    for (int i = s.header(); i < s.exitBr; i++)
+        if (i != s.iv && map_[i] < 0) copyVerbatim(i, i, nullptr);
+    Value exit = in_[s.exitBr];
+    exit.lhs = emitOp(lessThan(s), iv, tileEnds_[level]);
+    exit.rhs = map_[s.loop];
+    map_[s.exitBr] = emit(exit);
+
+    if (level + 1 < p.band.size()) {
+        const LoopShape& inner = loops_[p.band[level + 1]];
+        copyUnmapped(s.bodyBegin(), inner.loop - 1, true);
+        emitPoint(p, level + 1);
+        copyUnmapped(inner.end + 1, s.backBr - 1, true);
+    } else {
+        copyUnmapped(s.bodyBegin(), s.backBr - 1, false);
+    }
+
+    setBack(iv, map_[in_[s.iv].operands[1]]);
+    Value back = in_[s.backBr];
+    back.lhs = map_[s.loop];
+    back.rhs = iv;
+    map_[s.backBr] = emit(back);
+    map_[s.end] = emit(in_[s.end]);
+}
+
+} // namespace
+
+int tileLoops(ValueIR& values, const AliasAnalysis& aa, const TileOptions& opts) {
+    for (const Value& v : values)
+        if (v.op == Op::Phi && v.use_vload_entry) return 0;
+    std::vector<LoopShape> loops = findLoops(values);
+    if (loops.empty()) return 0;
+    DependenceAnalysis deps(values, loops, aa);
+
+    std::vector<Plan> plans;
+    int skipUntil = -1;   // 已經 tile 的 band 裡面的 loop
+    for (int k = 0; k < (int)loops.size(); k++) {
+        if (loops[k].loop < skipUntil) continue;
+        const LoopShape& outer = loops[k];
+        std::vector<int> chain = rectangularBand(values, loops, k);
+        // 最長的 band 優先；不合法或沒有重用時少 tile 內層
+        for (size_t len = chain.size(); len >= 2; len--) {
+            std::vector<int> band(chain.begin(), chain.begin() + len);
+            Plan plan;
+            if (!planBand(values, loops, deps, band, opts, plan)) continue;
+            plans.push_back(std::move(plan));
+            skipUntil = outer.end;
+            break;
+        }
+    }
+    if (plans.empty()) return 0;
+
+    ValueIR out = Tiler(values, loops, plans).run();
+    values = cleanupValueIR(out);
+    return (int)plans.size();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+#include <cstdint>
+
+// ============================================================
+// Loop tiling（cache blocking）
+// ============================================================
+//
+// 一段連續的巢狀 counted loop（band）切成 tile：外面一組 tile loop 每次
+// 跳 T，裡面的 point loop 只走一個 tile。
+//
+//   for (i = 0; i < n; i++)           for (ii = 0; ii < n; ii += T)
+//     for (j = 0; j < m; j++)    →      for (jj = 0; jj < m; jj += T)
+//       S(i, j);                          for (i = ii; i < min(ii+T, n); i++)
+//                                           for (j = jj; j < min(jj+T, m); j++)
+//                                             S(i, j);
+//
+// gemm 的 A[i][k]、B[k][j] 在一個 tile 裡被重複用到的部分留在 cache，
+// 不用每一輪外層迭代把整個矩陣從記憶體重新讀一次。
+//
+// band 的每一層：value_ir_loops.hpp 的 counted loop，step 1、`iv < n`，
+// 唯一的 loop-carried 值是 iv，起點和 n 跟 band 無關（矩形）。上層的
+// body 除了下一層 loop 之外只能有純運算；最內層的 body 沒有限制（可以
+// 有別的 loop）。imperfect nest（gemm 的 i 裡面先 scale 再跑 k、j）
+// 由 band 只取完美巢狀的那一段處理。
+//
+// 合法性：DependenceAnalysis 的相依在 band 的每一層方向都 >= 0（fully
+// permutable）。tile 大小：band 裡的存取在一個 tile 用到的資料量放得進
+// L1（band 裡面還有 loop 時用 L2）的一半，T 取 8 ~ 256 的 2 的次方。
+
+struct TileOptions {
+    int tileSize = 0;           // 0 = 依 cache 大小決定
+    int64_t l1CacheSize = 0;    // bytes；0 = 問 host（hostCacheSize）
+    int64_t l2CacheSize = 0;
+};
+
+// host 的 data cache 大小（level 1 / 2），查不到時用 32K / 1M
+int64_t hostCacheSize(int level);
+
+// 回傳 tile 的 band 數；有改寫時 values 重建並跑過 cleanupValueIR。
+int tileLoops(ValueIR& values, const AliasAnalysis& aa, const TileOptions& opts = {});
@@ -0,0 +1,630 @@
+#include "value_ir_unroll.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_rebuild.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <string>
+
+namespace {
+
+// ============================================================
+// Cost model
+// ============================================================
+
+// 會變成機器指令的節點（Param / 常數 / loop phi / LocalSet 不算）
+int nodeCost(Op op) {
+    switch (op) {
+    case Op::Param: case Op::I32Const: case Op::I64Const: case Op::F64Const:
+    case Op::Phi: case Op::LocalSet: case Op::LocalGet:
+    case Op::Else: case Op::End: case Op::Loop:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+int rangeCost(const ValueIR& values, int b, int e) {
+    int c = 0;
+    for (int i = b; i < e; i++) c += nodeCost(values[i].op);
+    return c;
+}
+
+// 佔一個暫存器的結果：0 = GPR，1 = xmm
+int regClass(const Value& v) {
+    switch (v.op) {
+    case Op::F64ConvertI32S: case Op::F64ConvertI32U:
+    case Op::F64ConvertI64S: case Op::F64ConvertI64U:
+        return 1;   // lowering 把型別標成 I32
+    default:
+        return v.type == ValueType::F64 || v.type == ValueType::F32 ? 1 : 0;
+    }
+}
+
+bool definesRegister(const Value& v) {
+    if (v.op == Op::Param || v.op == Op::I32Const || v.op == Op::I64Const) return false;
+    if (v.op == Op::Phi) return v.local_index < 0;   // loop phi 另外算
+    if (v.op == Op::Call) return v.type != ValueType::Void;
+    return !hasSideEffects(v.op);
+}
+
+struct Pressure {
+    int invariant[2] = {0, 0};   // loop 外面來的值（含 Param、浮點常數）
+    int perCopy[2] = {0, 0};     // unroll-and-jam：外層 loop 裡定義、每個外層複本各一份
+    int carried[2] = {0, 0};     // loop phi
+    int temps[2] = {0, 0};       // body 裡同時活著的暫存值最大數量
+};
+
+// s 的 header + body 的暫存器需求。perCopyFrom 之後定義的 loop 外的值算 perCopy。
+Pressure loopPressure(const ValueIR& values, const LoopShape& s, int perCopyFrom) {
+    Pressure p;
+    for (int phi : s.phis) p.carried[regClass(values[phi])]++;
+
+    const int b = s.loop + 1, e = s.backBr;
+    std::set<int> outside, params;
+    std::vector<int> last(values.size(), -1);
+    for (int i = b; i <= e; i++) {
+        const Value& v = values[i];
+        if (v.op == Op::Param) { params.insert(v.paramIndex); continue; }
+        if (v.op == Op::F64Const) { outside.insert(i); continue; }
+        auto use = [&](int ref) {
+            if (ref < 0) return;
+            if (ref < b || ref > e) {
+                Op op = values[ref].op;
+                if (op != Op::I32Const && op != Op::I64Const && op != Op::Param) outside.insert(ref);
+            } else {
+                last[ref] = std::max(last[ref], i);
+            }
+        };
+        if (v.op == Op::Phi && v.local_index >= 0) {
+            // back operand 活到 back-edge
+            if (v.operands.size() == 2 && v.operands[1] >= b && v.operands[1] <= e)
+                last[v.operands[1]] = e;
+            continue;
+        }
+        forEachOperand(v, use);
+    }
+    for (int idx : params) {
+        (void)idx;
+        p.invariant[0]++;
+    }
+    for (int id : outside) {
+        int cls = regClass(values[id]);
+        if (id > perCopyFrom) p.perCopy[cls]++;
+        else p.invariant[cls]++;
+    }
+
+    // 線性掃描：每個暫存值活在 [定義, 最後一次使用)
+    std::vector<int> delta[2] = {std::vector<int>(e - b + 2, 0), std::vector<int>(e - b + 2, 0)};
+    for (int i = b; i <= e; i++) {
+        if (last[i] <= i || !definesRegister(values[i])) continue;
+        int cls = regClass(values[i]);
+        delta[cls][i - b]++;
+        delta[cls][last[i] - b]--;
+    }
+    for (int cls = 0; cls < 2; cls++) {
+        int live = 0;
+        for (int d : delta[cls]) {
+            live += d;
+            p.temps[cls] = std::max(p.temps[cls], live);
+        }
+    }
+    return p;
+}
+
+// 相鄰的複本交錯排程，大約一半的暫存值會同時活著
+int unrolledTemps(int temps, int factor) {
+    return temps + (factor - 1) * ((temps + 1) / 2);
+}
+
+bool fitsRegisters(const UnrollOptions& opts, const int need[2]) {
+    return need[0] <= opts.intRegisters && need[1] <= opts.fpRegisters;
+}
+
+bool fitsUnroll(const Pressure& p, int factor, const UnrollOptions& opts) {
+    int need[2];
+    for (int cls = 0; cls < 2; cls++)
+        need[cls] = p.invariant[cls] + p.perCopy[cls] + p.carried[cls] +
+                    unrolledTemps(p.temps[cls], factor);
+    return fitsRegisters(opts, need);
+}
+
+// 內層 iv 共用一份，其他內層 phi 與外層 loop 裡的值每個複本各一份
+bool fitsJam(const Pressure& p, int factor, const UnrollOptions& opts) {
+    int need[2];
+    for (int cls = 0; cls < 2; cls++)
+        need[cls] = p.invariant[cls] + factor * p.perCopy[cls] +
+                    factor * p.carried[cls] + unrolledTemps(p.temps[cls], factor);
+    need[0] -= factor - 1;
+    return fitsRegisters(opts, need);
+}
+
+// ============================================================
+// 計畫
+// ============================================================
+
+struct Plan {
+    enum Kind { Full, Unroll, Jam } kind = Unroll;
+    const LoopShape* loop = nullptr;    // Jam：外層
+    const LoopShape* inner = nullptr;   // Jam：內層
+    int factor = 1;
+    bool remainder = true;
+    std::vector<int> exitRepl;          // loop 之後對 body 值的引用 → loop phi
+    std::vector<int> innerRepl;         // Jam：post 對內層 body 值的引用 → 內層 phi
+    std::vector<char> slice;            // Jam：post 裡算外層下一輪 phi 的節點
+};
+
+// (U-1)·|step| 放得進 i32 才能做 runtime guard
+bool guardable(const LoopShape& s, int factor) {
+    return std::llabs(s.step) * (factor - 1) < (int64_t(1) << 30);
+}
+
+bool planUnroll(const ValueIR& values, const LoopShape& s, const UnrollOptions& opts, Plan& plan) {
+    if (!s.simple || !s.innermost || !s.hasIV() || s.tripCount == 0) return false;
+    if (!exitValueMap(values, s, plan.exitRepl)) return false;
+    plan.loop = &s;
+
+    int header = rangeCost(values, s.loop + 1, s.exitBr + 1);
+    int body = rangeCost(values, s.bodyBegin(), s.backBr + 1);
+    if (s.tripCount > 0 && s.tripCount <= opts.maxFullUnrollTrips &&
+        s.tripCount * (header + body) + header <= opts.maxFullUnrollCost) {
+        plan.kind = Plan::Full;
+        plan.factor = (int)s.tripCount;
+        plan.remainder = false;
+        return true;
+    }
+
+    Pressure p = loopPressure(values, s, (int)values.size());
+    for (int u = opts.maxFactor; u >= 2; u /= 2) {
+        if (u * (header + body) > opts.maxUnrolledCost) continue;
+        if (s.tripCount > 0 && s.tripCount < u) continue;
+        if (!guardable(s, u) || !fitsUnroll(p, u, opts)) continue;
+        plan.kind = Plan::Unroll;
+        plan.factor = u;
+        plan.remainder = !(s.tripCount > 0 && s.tripCount % u == 0);
+        return true;
+    }
+    return false;
+}
+
+// ---- unroll-and-jam 的合法性 ----
+
+class JamChecker {
+public:
+    JamChecker(const ValueIR& values, const AliasAnalysis& aa, const LoopShape& outer,
+               const LoopShape& inner)
+        : values_(values), aa_(aa), o_(outer), i_(inner) {}
+
+    // pre / post 裡沒有記憶體以外的副作用、內層 iv 跟外層無關
+    bool structure(Plan& plan);
+    // factor 個外層迭代之間沒有記憶體相依
+    bool memory(int factor);
+
+private:
+    bool inInner(int id) const { return id >= i_.loop && id <= i_.end; }
+    bool condOperand(int id, int depth) const;
+    bool sliceOperand(int id, std::vector<char>& slice, int depth) const;
+    std::string invariantKey(int id, int depth) const;
+
+    const ValueIR& values_;
+    const AliasAnalysis& aa_;
+    const LoopShape& o_;
+    const LoopShape& i_;
+};
+
+// 內層的繼續條件只能看 iv 與外層 loop 不變量（每個外層複本的 trip count 一樣）
+bool JamChecker::condOperand(int id, int depth) const {
+    if (id == i_.iv || isLoopInvariant(values_, o_, id)) return true;
+    if (depth > 16 || id <= i_.loop || id >= i_.exitBr) return false;
+    const Value& v = values_[id];
+    if (!isPureOp(v.op)) return false;
+    bool ok = true;
+    forEachOperand(v, [&](int ref) { ok = ok && condOperand(ref, depth + 1); });
+    return ok;
+}
+
+// 外層 phi 的下一輪值：post 裡的部分要是純運算、不能碰內層 loop
+bool JamChecker::sliceOperand(int id, std::vector<char>& slice, int depth) const {
+    if (id < 0 || id <= i_.end || id >= o_.backBr) return !inInner(id);
+    if (slice[id]) return true;
+    const Value& v = values_[id];
+    if (depth > 64 || !(isPureOp(v.op) || v.op == Op::Param)) return false;
+    slice[id] = 1;
+    bool ok = true;
+    forEachOperand(v, [&](int ref) { ok = ok && sliceOperand(ref, slice, depth + 1); });
+    return ok;
+}
+
+bool JamChecker::structure(Plan& plan) {
+    if (!o_.simple || !o_.hasIV() || !i_.simple || !i_.hasIV() || !i_.innermost) return false;
+    // 內層 loop 在外層 body 的最上層（不在 If 裡）
+    int depth = 0;
+    for (int k = o_.bodyBegin(); k < i_.loop; k++) {
+        if (values_[k].op == Op::If) depth++;
+        else if (values_[k].op == Op::End && values_[k].constValue == 2) depth--;
+    }
+    if (depth != 0) return false;
+
+    for (int k = o_.loop; k <= o_.end; k++) {
+        const Value& v = values_[k];
+        if (v.op == Op::Phi && v.use_vload_entry) return false;
+        if (v.op == Op::GlobalSet || v.op == Op::MemoryFill || v.op == Op::MemoryCopy)
+            return false;
+        if (v.op == Op::Call && !isPureCall(v)) return false;
+        if (v.op == Op::Loop && k != o_.loop && k != i_.loop) return false;
+    }
+    // LocalSet 的順序會打亂：讀 ir_VAR 的 phi 存在時不做
+    for (const auto& v : values_)
+        if (v.op == Op::Phi && v.use_vload_entry) return false;
+
+    const Value& iv = values_[i_.iv];
+    if (!isLoopInvariant(values_, o_, iv.operands[0])) return false;
+    if (i_.bound >= 0 && !isLoopInvariant(values_, o_, i_.bound)) return false;
+    if (!condOperand(values_[i_.exitBr].lhs, 0)) return false;
+
+    plan.slice.assign(values_.size(), 0);
+    for (int phi : o_.phis)
+        if (!sliceOperand(values_[phi].operands[1], plan.slice, 0)) return false;
+
+    if (!exitValueMap(values_, o_, plan.exitRepl)) return false;
+    if (!exitValueMap(values_, i_, plan.innerRepl)) return false;
+    return true;
+}
+
+// 跟外層迭代無關的位址成分的結構 key：兩個存取各自算出 `i * nj` 時要一樣
+std::string JamChecker::invariantKey(int id, int depth) const {
+    if (id < 0 || depth > 16) return "";
+    const Value& v = values_[id];
+    switch (v.op) {
+    case Op::Param: return "p" + std::to_string(v.paramIndex);
+    case Op::I32Const: case Op::I64Const: return "c" + std::to_string(v.constValue);
+    case Op::GlobalGet: return "g" + std::to_string(v.globalIndex);   // loop 裡沒有 GlobalSet
+    default: break;
+    }
+    if (isPureOp(v.op) && v.op != Op::Select && v.op != Op::F64Const) {
+        std::string key = std::string(opToString(v.op)) + "(";
+        bool ok = true;
+        forEachOperand(v, [&](int ref) {
+            std::string sub = invariantKey(ref, depth + 1);
+            if (sub.empty()) ok = false;
+            key += sub + ",";
+        });
+        return ok ? key + ")" : "";
+    }
+    if (id < o_.loop) return "v" + std::to_string(id);
+    return "";
+}
+
+bool JamChecker::memory(int factor) {
+    std::vector<int> accesses;
+    for (int k = o_.bodyBegin(); k < o_.backBr; k++) {
+        Op op = values_[k].op;
+        if (isMemoryRead(op) || op == Op::Store || op == Op::F64Store) accesses.push_back(k);
+    }
+    auto nameTerm = [&](int id) -> std::string {
+        if (id == o_.iv) return "j";
+        if (id == i_.iv) return "k";
+        return invariantKey(id, 0);
+    };
+    auto address = [&](int id) {
+        AffineExpr e = affineExpr(values_, values_[id].lhs, nameTerm);
+        e.constant += (uint32_t)values_[id].mem_offset;
+        return e;
+    };
+
+    for (int s : accesses) {
+        const Value& st = values_[s];
+        if (st.op != Op::Store && st.op != Op::F64Store) continue;
+        AffineExpr as = address(s);
+        if (!as.ok || as.terms.count("k")) return false;
+        for (int x : accesses) {
+            if (x != s && !aa_.mayAlias(s, x)) continue;
+            AffineExpr ax = address(x);
+            if (!ax.ok || ax.terms.count("k")) return false;
+            auto cs = as.terms.find("j"), cx = ax.terms.find("j");
+            if (cs == as.terms.end() || cx == ax.terms.end() || cs->second != cx->second)
+                return false;
+            auto restS = as.terms, restX = ax.terms;
+            restS.erase("j");
+            restX.erase("j");
+            if (restS != restX) return false;
+            // 複本 u 的 store 與複本 u+t 的存取：位址差 c·t·step + Δ
+            int sizeS = memAccessBytes(st), sizeX = memAccessBytes(values_[x]);
+            for (int t = 1; t < factor; t++)
+                for (int sign : {1, -1}) {
+                    int64_t diff = cs->second * sign * t * o_.step + (ax.constant - as.constant);
+                    if (diff < sizeS && diff > -sizeX) return false;
+                }
+        }
+    }
+    return true;
+}
+
+bool planJam(const ValueIR& values, const std::vector<LoopShape>& loops, int oi,
+             const AliasAnalysis& aa, const UnrollOptions& opts, Plan& plan) {
+    const LoopShape& o = loops[oi];
+    int child = -1;
+    for (int k = oi + 1; k < (int)loops.size() && loops[k].loop < o.end; k++) {
+        if (loops[k].parent != oi || child >= 0) return false;
+        child = k;
+    }
+    if (child < 0) return false;
+    const LoopShape& in = loops[child];
+    JamChecker check(values, aa, o, in);
+    if (!check.structure(plan)) return false;
+
+    int innerCost = rangeCost(values, in.loop + 1, in.backBr + 1);
+    int outerCost = rangeCost(values, o.loop + 1, o.backBr + 1) - innerCost;
+    Pressure p = loopPressure(values, in, o.loop);
+    for (int u = opts.maxFactor; u >= 2; u /= 2) {
+        if (u * innerCost > opts.maxUnrolledCost || u * outerCost > opts.maxUnrolledCost) continue;
+        if (o.tripCount > 0 && o.tripCount < u) continue;
+        if (!guardable(o, u) || !fitsJam(p, u, opts) || !check.memory(u)) continue;
+        plan.kind = Plan::Jam;
+        plan.loop = &o;
+        plan.inner = &in;
+        plan.factor = u;
+        plan.remainder = !(o.tripCount > 0 && o.tripCount % u == 0);
+        return true;
+    }
+    return false;
+}
+
+// ============================================================
+// 重建
+// ============================================================
+
+class Rebuilder : public ValueIRRebuilder {
+public:
+    Rebuilder(const ValueIR& in, const std::vector<Plan>& plans)
+        : ValueIRRebuilder(in), plans_(plans) {
+        // 所有計畫的 exitRepl 合在一起（範圍互不重疊）
+        for (const Plan& p : plans)
+            for (size_t k = 0; k < p.exitRepl.size(); k++)
+                if (p.exitRepl[k] >= 0) afterRepl_[k] = p.exitRepl[k];
+    }
+
+    ValueIR run() {
+        std::vector<std::pair<int, int>> regions;
+        for (const Plan& p : plans_) regions.push_back({p.loop->loop, p.loop->end});
+        return ValueIRRebuilder::run(regions);
+    }
+
+private:
+    void emitRegion(size_t k) override {
+        const Plan& p = plans_[k];
+        switch (p.kind) {
+        case Plan::Full: emitFull(p); break;
+        case Plan::Unroll: emitUnroll(p); break;
+        case Plan::Jam: emitJam(p); break;
+        }
+    }
+
+    int emitGuard(const LoopShape& s, int factor, int cond, int iv, const CopyScope& sc);
+    void emitFull(const Plan& p);
+    void emitUnroll(const Plan& p);
+    void emitJam(const Plan& p);
+
+    const std::vector<Plan>& plans_;
+};
+
+// cond && 剩下的迭代數 >= factor
+int Rebuilder::emitGuard(const LoopShape& s, int factor, int cond, int iv, const CopyScope& sc) {
+    int bound = s.bound >= 0 ? lookup(s.bound, sc)
+                             : emitOp(Op::I32Const, -1, -1, (int)s.boundConst);
+    int64_t span = std::llabs(s.step) * (factor - 1);
+    if (s.cmp == LoopCmp::LeS || s.cmp == LoopCmp::LeU ||
+        s.cmp == LoopCmp::GeS || s.cmp == LoopCmp::GeU)
+        span -= 1;
+    int left = s.step > 0 ? emitOp(Op::Sub, bound, iv) : emitOp(Op::Sub, iv, bound);
+    int k = emitOp(Op::I32Const, -1, -1, (int)span);
+    int enough = emitOp(Op::Gt_U, left, k);
+    return emitOp(Op::And, cond, enough);
+}
+
+void Rebuilder::emitFull(const Plan& p) {
+    const LoopShape& s = *p.loop;
+    const int hb = s.header();
+    LocalMap state;
+    {
+        LocalMap params;
+        CopyScope sc{{&params}};
+        for (int phi : s.phis) {
+            int ref = in_[phi].operands[0];
+            if (ref > s.loop && ref < s.end && !params.count(ref)) copyNode(ref, params, sc);
+            state[phi] = lookup(ref, sc);
+        }
+    }
+    for (int u = 0;; u++) {
+        LocalMap cur;
+        CopyScope sc{{&cur, &state}};
+        copyRange(hb, s.exitBr, cur, sc);
+        if (u == p.factor) {
+            for (auto& [old, id] : cur) map_[old] = id;
+            break;
+        }
+        copyRange(s.bodyBegin(), s.backBr, cur, sc);
+        LocalMap next;
+        for (int phi : s.phis) next[phi] = lookup(in_[phi].operands[1], sc);
+        state = std::move(next);
+    }
+    for (int phi : s.phis) map_[phi] = state[phi];
+}
+
+void Rebuilder::emitUnroll(const Plan& p) {
+    const LoopShape& s = *p.loop;
+    const int hb = s.header();
+    Value loopNode = in_[s.loop];
+    int lm = emit(loopNode);
+    LocalMap state;
+    std::vector<int> phis = emitPhis(s, state, CopyScope{});
+
+    LocalMap first;
+    CopyScope firstScope{{&first, &state}};
+    copyRange(hb, s.exitBr, first, firstScope);
+    int cond = lookup(in_[s.exitBr].lhs, firstScope);
+    if (p.remainder) cond = emitGuard(s, p.factor, cond, state[s.iv], firstScope);
+    Value exit = in_[s.exitBr];
+    exit.lhs = cond;
+    exit.rhs = lm;
+    emit(exit);
+
+    LocalMap cur = state;
+    for (int u = 0; u < p.factor; u++) {
+        LocalMap copy = (u == 0) ? first : LocalMap();
+        CopyScope sc{{&copy, &cur}};
+        if (u > 0) copyRange(hb, s.exitBr, copy, sc);
+        copyRange(s.bodyBegin(), s.backBr, copy, sc);
+        LocalMap next;
+        for (int phi : s.phis) next[phi] = lookup(in_[phi].operands[1], sc);
+        cur = std::move(next);
+    }
+    for (size_t k = 0; k < phis.size(); k++) setBack(phis[k], cur[s.phis[k]]);
+    Value back = in_[s.backBr];
+    back.lhs = lm;
+    back.rhs = phis.empty() ? -1 : phis[0];
+    emit(back);
+    emit(in_[s.end]);
+
+    if (p.remainder) {
+        // 剩下不到 factor 次：原本的 loop，從 main loop 停下來的地方接著跑
+        copyVerbatim(s.loop, s.end, &state);
+    } else {
+        for (auto& [old, id] : state) map_[old] = id;
+        for (auto& [old, id] : first) map_[old] = id;
+    }
+}
+
+void Rebuilder::emitJam(const Plan& p) {
+    const LoopShape& o = *p.loop;
+    const LoopShape& in = *p.inner;
+    const int U = p.factor;
+    const int ohb = o.header();
+    const int ihb = in.header();
+
+    // ---- 外層 main loop ----
+    int lm = emit(in_[o.loop]);
+    LocalMap state;
+    std::vector<int> outerPhis = emitPhis(o, state, CopyScope{});
+
+    std::vector<LocalMap> outer(U);   // 每個外層複本：phi 狀態 + header + pre + slice
+    outer[0] = state;
+    copyRange(ohb, o.exitBr, outer[0], CopyScope{{&outer[0]}});
+    CopyScope s0{{&outer[0]}};
+    int cond = lookup(in_[o.exitBr].lhs, s0);
+    if (p.remainder) cond = emitGuard(o, U, cond, state[o.iv], s0);
+    Value exit = in_[o.exitBr];
+    exit.lhs = cond;
+    exit.rhs = lm;
+    emit(exit);
+    LocalMap mainHeader = outer[0];
+
+    std::vector<int> next;
+    for (int u = 0; u < U; u++) {
+        CopyScope sc{{&outer[u]}};
+        if (u > 0) {
+            for (size_t k = 0; k < o.phis.size(); k++) outer[u][o.phis[k]] = next[k];
+            copyRange(ohb, o.exitBr, outer[u], sc);
+        }
+        copyRange(o.bodyBegin(), in.loop, outer[u], sc);
+        for (int k = in.end + 1; k < o.backBr; k++)
+            if (p.slice[k]) copyNode(k, outer[u], sc);
+        next.clear();
+        for (int phi : o.phis) next.push_back(lookup(in_[phi].operands[1], sc));
+    }
+
+    // ---- 合併的內層 loop：iv 共用，其他 phi 每個複本一份 ----
+    int li = emit(in_[in.loop]);
+    std::vector<LocalMap> phi(U), header(U), body(U);
+    std::vector<int> innerPhis;
+    LocalMap params;
+    for (int ph : in.phis) {
+        int ref = in_[ph].operands[0];
+        if (ref > in.loop && ref < in.end && !params.count(ref)) copyNode(ref, params, CopyScope{{&params}});
+    }
+    {
+        Value iv = in_[in.iv];
+        iv.operands = {lookup(iv.operands[0], CopyScope{{&params, &outer[0]}})};
+        innerPhis.push_back(emit(iv));
+        for (int u = 0; u < U; u++) phi[u][in.iv] = innerPhis[0];
+    }
+    for (int u = 0; u < U; u++)
+        for (int ph : in.phis) {
+            if (ph == in.iv) continue;
+            Value v = in_[ph];
+            v.operands = {lookup(v.operands[0], CopyScope{{&params, &outer[u]}})};
+            int id = emit(v);
+            phi[u][ph] = id;
+            innerPhis.push_back(id);
+        }
+    for (int u = 0; u < U; u++)
+        copyRange(ihb, in.exitBr, header[u], CopyScope{{&header[u], &phi[u], &outer[u]}});
+    Value iexit = in_[in.exitBr];
+    iexit.lhs = lookup(iexit.lhs, CopyScope{{&header[0], &phi[0], &outer[0]}});
+    iexit.rhs = li;
+    emit(iexit);
+    for (int u = 0; u < U; u++)
+        copyRange(in.bodyBegin(), in.backBr, body[u],
+                  CopyScope{{&body[u], &header[u], &phi[u], &outer[u]}});
+    for (int u = 0; u < U; u++) {
+        CopyScope sc{{&body[u], &header[u], &phi[u], &outer[u]}};
+        for (int ph : in.phis) {
+            if (ph == in.iv && u > 0) continue;
+            setBack(phi[u][ph], lookup(in_[ph].operands[1], sc));
+        }
+    }
+    Value iback = in_[in.backBr];
+    iback.lhs = li;
+    iback.rhs = innerPhis[0];
+    emit(iback);
+    emit(in_[in.end]);
+
+    // ---- post：內層 body 的值改看離開時的 phi ----
+    for (int u = 0; u < U; u++) {
+        LocalMap post;
+        CopyScope sc{{&post, &header[u], &phi[u], &outer[u]}, &p.innerRepl};
+        copyRange(in.end + 1, o.backBr, post, sc, &p.slice);
+    }
+
+    for (size_t k = 0; k < outerPhis.size(); k++) setBack(outerPhis[k], next[k]);
+    Value back = in_[o.backBr];
+    back.lhs = lm;
+    back.rhs = outerPhis.empty() ? -1 : outerPhis[0];
+    emit(back);
+    emit(in_[o.end]);
+
+    if (p.remainder) {
+        copyVerbatim(o.loop, o.end, &state);
+    } else {
+        for (auto& [old, id] : mainHeader) map_[old] = id;
+    }
+}
+
+} // namespace
+
+int unrollLoops(ValueIR& values, const AliasAnalysis& aa, const UnrollOptions& opts) {
+    std::vector<LoopShape> loops = findLoops(values);
+    std::vector<Plan> plans;
+    std::vector<char> covered(loops.size(), 0);
+
+    // 外層優先：unroll-and-jam 成功的 nest 裡的內層 loop 不再單獨展開
+    for (int k = 0; k < (int)loops.size(); k++) {
+        if (covered[k]) continue;
+        Plan plan;
+        if (opts.jam && !loops[k].innermost && planJam(values, loops, k, aa, opts, plan)) {
+            plans.push_back(std::move(plan));
+            for (int c = k; c < (int)loops.size() && loops[c].loop <= loops[k].end; c++)
+                covered[c] = 1;
+        } else if (opts.unroll && planUnroll(values, loops[k], opts, plan)) {
+            plans.push_back(std::move(plan));
+            covered[k] = 1;
+        }
+    }
+    if (plans.empty()) return 0;
+
+    ValueIR out = Rebuilder(values, plans).run();
+    values = cleanupValueIR(out);
+    return (int)plans.size();
+}
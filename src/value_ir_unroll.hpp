@@ -0,0 +1,45 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+
+// ============================================================
+// Loop unrolling / unroll-and-jam
+// ============================================================
+//
+// 只處理 value_ir_loops.hpp 的 counted loop（有 induction variable）。
+//
+// 最內層 loop（--unroll）：body 複製 U 份，一輪走 U 次迭代。trip count
+// 不知道時 main loop 的條件改成「剩下至少 U 次」，後面接原本的 loop
+// 當 remainder：
+//
+//   loop { if (!(i < n && n - i > (U-1)·step)) break; body(i); body(i+s); ... }
+//   loop { if (!(i < n)) break; body(i); }                 ← remainder
+//
+// （n - i 用 unsigned 比較，i + (U-1)·step 不會 overflow。）已知 trip
+// count 而且整除時沒有 remainder；很小的時候整個攤平，loop 消失。
+//
+// 外層 loop（--unroll-and-jam）：外層展開 U 份，U 個內層 loop 合併成一個，
+// 內層 body 裡同時做 U 個外層迭代（gemm 的 B[k][j..j+U) 一起算，A[i][k]
+// 只 load 一次）。內層的 induction variable 要跟外層無關（矩形 nest），
+// 外層迭代之間不能有記憶體相依：所有 store 的位址都要是外層 iv 的線性
+// 函數、跟內層 iv 無關，而且 U 個外層迭代碰到的位元組互不重疊；碰不碰到
+// 別的陣列由 AliasAnalysis 決定（所以 PolyBench 要 --assume-noalias-params）。
+//
+// U 由 cost model 決定：展開後的 body 大小，以及估計的暫存器壓力（loop
+// 不變量 + loop-carried 值 + body 裡同時活著的暫存值，相鄰的複本排程後
+// 大約重疊一半）不超過 x86-64 的 GPR / xmm 數量。
+
+struct UnrollOptions {
+    bool unroll = true;           // 最內層 loop
+    bool jam = false;             // 外層 loop 的 unroll-and-jam
+    int maxFactor = 8;
+    int maxUnrolledCost = 128;    // 展開後 loop body 的指令數上限
+    int maxFullUnrollCost = 96;   // 整個攤平的指令數上限
+    int maxFullUnrollTrips = 16;
+    int intRegisters = 12;        // 16 個 GPR 扣掉 rsp / rbp / __mem / scratch
+    int fpRegisters = 14;         // 16 個 xmm 扣掉 scratch
+};
+
+// 回傳改寫的 loop 數；有改寫時 values 重建並跑過 cleanupValueIR。
+int unrollLoops(ValueIR& values, const AliasAnalysis& aa, const UnrollOptions& opts = {});
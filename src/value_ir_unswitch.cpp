@@ -0,0 +1,213 @@
+#include "value_ir_unswitch.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <set>
+#include <vector>
+
+namespace {
+
+// code-size budget：一次複製的 loop 大小、整個函式最多多出來的節點
+constexpr int kMaxLoopNodes = 200;
+constexpr int kMaxGrowth = 400;
+
+struct UnswitchPlan {
+    LoopShape s;
+    int cond = -1;              // If 的條件（舊 id）
+    std::vector<int> hoist;     // loop 裡算條件的節點：搬到 loop 前面，程式順序
+};
+
+// id 在 loop s 裡面跟迭代無關：loop 外定義，或只由 Param / 常數 / 純運算
+// 算出來（loop 裡的那些節點收進 cone）
+bool collectInvariant(const ValueIR& values, const LoopShape& s, int id, std::set<int>& cone,
+                      int depth) {
+    if (id < 0 || depth > 16) return false;
+    if (id < s.loop || id > s.end || cone.count(id)) return true;
+    const Value& v = values[id];
+    if (v.lanes > 1 || (v.op != Op::Param && !isPureOp(v.op))) return false;
+    cone.insert(id);
+    bool ok = true;
+    forEachOperand(v, [&](int ref) {
+        if (!collectInvariant(values, s, ref, cone, depth + 1)) ok = false;
+    });
+    return ok;
+}
+
+// 從最內層往外找第一個條件跟迭代無關、大小在 budget 裡的 simple loop
+// （loops 是外層在前，倒著看就是由內往外）
+bool planUnswitch(const ValueIR& values, const std::vector<LoopShape>& loops, int ifIdx,
+                  UnswitchPlan& p) {
+    const int cond = values[ifIdx].lhs;
+    if (cond < 0 || isConstOp(values[cond].op) || values[cond].lanes > 1) return false;
+    for (auto it = loops.rbegin(); it != loops.rend(); ++it) {
+        const LoopShape& s = *it;
+        if (!s.simple || s.loop >= ifIdx || s.end <= ifIdx) continue;
+        if (s.end - s.loop + 1 > kMaxLoopNodes) continue;
+        bool vload = false;
+        for (int k = s.loop; k <= s.end; k++)
+            if (values[k].op == Op::Phi && values[k].use_vload_entry) vload = true;
+        if (vload) continue;
+        std::set<int> cone;
+        if (!collectInvariant(values, s, cond, cone, 0)) continue;
+        p.s = s;
+        p.cond = cond;
+        p.hoist.assign(cone.begin(), cone.end());
+        return true;
+    }
+    return false;
+}
+
+// 照 plan 改寫；複本裡有對不到的 ref（被拿掉的 arm 裡的值）時不改，回傳 false
+bool unswitch(ValueIR& values, const UnswitchPlan& p) {
+    const std::vector<int> match = matchRegions(values);
+    const int n = (int)values.size();
+    const int L = p.s.loop, E = p.s.end;
+
+    // 兩份各自拿掉的節點；化掉的 If 後面的 merge phi 換成留下那邊的 operand
+    std::vector<char> dropThen(n, 0), dropElse(n, 0), merge(n, 0);
+    for (int f = L + 1; f < E; f++) {
+        if (values[f].op != Op::If || values[f].lhs != p.cond || match[f] < 0) continue;
+        const int end = match[f];
+        bool inElse = false;
+        for (int k = f + 1; k < end; k++) {
+            if (values[k].op == Op::Else && match[k] == f) {
+                inElse = true;
+                dropElse[k] = 1;
+            }
+            (inElse ? dropThen : dropElse)[k] = 1;
+        }
+        dropThen[f] = dropElse[f] = dropThen[end] = dropElse[end] = 1;
+        for (int k = end + 1; k < E && values[k].op == Op::Phi && values[k].local_index < 0; k++) {
+            if (values[k].operands.size() != 2) return false;
+            merge[k] = 1;
+        }
+    }
+    for (int k : p.hoist) dropThen[k] = dropElse[k] = 1;
+
+    ValueIR out;
+    std::vector<int> map(n, -1);
+    struct Fixup { int node; size_t k; int ref; };
+    bool ok = true;
+    auto emit = [&](Value v) {
+        v.id = (int)out.size();
+        out.push_back(v);
+        return v.id;
+    };
+    auto remap = [&](const std::vector<int>& m, int& ref) {
+        ref = m[ref];
+        if (ref < 0) ok = false;
+    };
+    // side：0 / 1 是 then / else 那份（merge phi 取那個 operand），-1 是 loop 外
+    auto copyRange = [&](int from, int to, std::vector<int>& m, const std::vector<char>* drop,
+                         int side) {
+        std::vector<Fixup> fixups;
+        for (int i = from; i < to; i++) {
+            if (drop && (*drop)[i]) continue;
+            if (side >= 0 && merge[i]) {
+                m[i] = m[values[i].operands[side]];
+                continue;
+            }
+            Value v = values[i];
+            if (v.op == Op::Phi && v.local_index >= 0) {
+                for (size_t k = 0; k < v.operands.size(); k++) {
+                    int ref = v.operands[k];
+                    if (ref >= i) fixups.push_back({(int)out.size(), k, ref});
+                    else if (ref >= 0) remap(m, v.operands[k]);
+                }
+            } else {
+                forEachOperand(v, [&](int& ref) { remap(m, ref); });
+            }
+            forEachControlRef(v, [&](int& ref) { remap(m, ref); });
+            m[i] = emit(v);
+        }
+        return fixups;
+    };
+    auto applyFixups = [&](const std::vector<Fixup>& fixups, const std::vector<int>& m) {
+        for (const Fixup& f : fixups) {
+            out[f.node].operands[f.k] = m[f.ref];
+            if (m[f.ref] < 0) ok = false;
+        }
+    };
+
+    std::vector<Fixup> outer = copyRange(0, L, map, nullptr, -1);
+
+    // 條件整串先算好，兩份 loop 都直接用
+    for (int k : p.hoist) {
+        Value v = values[k];
+        forEachOperand(v, [&](int& ref) { remap(map, ref); });
+        map[k] = emit(v);
+    }
+    Value br;
+    br.op = Op::If;
+    br.lhs = map[p.cond];
+    emit(br);
+
+    std::vector<int> thenMap = map;
+    applyFixups(copyRange(L, E + 1, thenMap, &dropThen, 0), thenMap);
+    Value els;
+    els.op = Op::Else;
+    emit(els);
+    std::vector<int> elseMap = map;
+    applyFixups(copyRange(L, E + 1, elseMap, &dropElse, 1), elseMap);
+    Value end;
+    end.op = Op::End;
+    end.constValue = 2;
+    emit(end);
+
+    // loop 之後（包括外層 loop phi 的 back operand）用到的值：兩份合併
+    std::vector<char> liveOut(n, 0);
+    for (int i = 0; i < n; i++) {
+        if (i >= L && i <= E) continue;
+        forEachOperand(values[i], [&](int ref) {
+            if (ref >= L && ref <= E) liveOut[ref] = 1;
+        });
+    }
+    for (int x = L; x <= E; x++) {
+        if (!liveOut[x]) continue;
+        Value phi;
+        phi.op = Op::Phi;
+        phi.type = values[x].op == Op::Phi ? values[x].type : resultTypeOf(values[x]);
+        phi.local_index = -1;
+        phi.lanes = values[x].lanes;
+        phi.operands = {thenMap[x], elseMap[x]};
+        if (thenMap[x] < 0 || elseMap[x] < 0) ok = false;
+        map[x] = emit(phi);
+    }
+
+    std::vector<Fixup> after = copyRange(E + 1, n, map, nullptr, -1);
+    outer.insert(outer.end(), after.begin(), after.end());
+    applyFixups(outer, map);
+
+    if (!ok) return false;
+    values = cleanupValueIR(out);
+    return true;
+}
+
+} // namespace
+
+int unswitchLoops(ValueIR& values) {
+    const int budget = (int)values.size() + kMaxGrowth;
+    int unswitched = 0;
+    std::set<int> failed;   // 改不了的 If（舊 id 在每次改寫後就失效，只擋這一輪）
+    for (;;) {
+        std::vector<LoopShape> loops = findLoops(values);
+        bool changed = false;
+        for (int i = 0; i < (int)values.size(); i++) {
+            if (values[i].op != Op::If || failed.count(i)) continue;
+            UnswitchPlan p;
+            if (!planUnswitch(values, loops, i, p)) continue;
+            const int size = p.s.end - p.s.loop + 1;
+            if ((int)values.size() + size > budget) continue;
+            if (!unswitch(values, p)) {
+                failed.insert(i);
+                continue;
+            }
+            unswitched++;
+            changed = true;
+            break;
+        }
+        if (!changed) break;
+        failed.clear();
+    }
+    return unswitched;
+}
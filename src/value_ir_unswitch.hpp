@@ -0,0 +1,36 @@
+#pragma once
+
+#include "value_ir.hpp"
+
+// ============================================================
+// Loop unswitching：條件跟 loop 無關的 If 提到 loop 外面
+// ============================================================
+//
+// kernel 常見 `for (...) { if (flag) A; else B; }`，flag 是參數或 loop
+// 之前算好的值，每一輪都在 bridge 產生一組 ir_IF / ir_MERGE，arm 裡有
+// store 時 if-convert 也換不掉。把整個 loop 複製兩份，各自只留一邊：
+//
+//   Loop                                 c' = <c 的純運算（照抄到 loop 前）>
+//     ...                                If(c')
+//     v = If(c)                            Loop  ...  A  ...  End(loop)
+//       A                         →      Else
+//     Else                                 Loop  ...  B  ...  End(loop)
+//       B                                End(if)
+//     End(if)                            x' = Phi(x_then, x_else)   loop 之後用到的值
+//     ...
+//   End(loop)
+//
+// 條件：
+//   - 條件在 loop 之前就定義，或 loop 裡只由 Param、常數、純運算（不會 trap）
+//     算出來，可以整串提到 loop 前面
+//   - 往外找第一個滿足上面條件的 findLoops simple loop（整個 nest 一起複製，
+//     每份都還是完整的 nest，後面的 interchange / tile 看得到）；同一個條件
+//     的其他 If 在兩份裡一起化掉
+//   - code-size budget：複製的 loop 最多 kMaxLoopNodes 個節點，整個函式
+//     最多多出 kMaxGrowth 個節點
+//   - bridge 的 VLOAD 入口 phi（use_vload_entry）只有 Br 的 back-edge 會接，
+//     有的話不複製
+//
+// 放在 if-convert 之後（能換成 Select 的已經不是分支了）、其他 loop pass 之前。
+// 回傳提出去的 If 數；有改寫時 values 重建並跑過 cleanupValueIR。
+int unswitchLoops(ValueIR& values);
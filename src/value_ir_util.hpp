@@ -0,0 +1,227 @@
+// src/value_ir_util.hpp
+#pragma once
+#include "value_ir.hpp"
+#include <cstring>
+#include <vector>
+
+// ValueIR 各 pass 共用的小工具。欄位分類跟 value_ir_verify.hpp 一致：
+// 只列「資料」operand（真正被當成 SSA value 使用的欄位），不含
+// Br/Br_if 指向 Loop 節點的結構性 ref，也不含 Call.lhs（callee index）。
+
+// 對 v 的每一個資料 operand 呼叫 f(int& ref)
+template <typename F>
+inline void forEachOperand(Value& v, F&& f) {
+    switch (v.op) {
+    case Op::Param: case Op::I32Const: case Op::I64Const: case Op::F64Const:
+    case Op::V128Const:
+    case Op::LocalGet: case Op::GlobalGet: case Op::Else: case Op::End:
+    case Op::Loop: case Op::Unreachable: case Op::MemorySize:
+        break;
+    case Op::Br:
+        break;
+    case Op::Br_if:
+    case Op::If:
+    case Op::Return:
+    case Op::LocalSet: case Op::LocalTee: case Op::GlobalSet:
+    case Op::Load: case Op::F64Load:
+        if (v.lhs >= 0) f(v.lhs);
+        break;
+    case Op::Call: case Op::Select: case Op::Phi: case Op::Pack: case Op::F64Fma:
+    case Op::MemoryFill: case Op::MemoryCopy:
+        for (int& op : v.operands) if (op >= 0) f(op);
+        break;
+    default:
+        // 一元 / 二元運算、Store / F64Store
+        if (v.lhs >= 0) f(v.lhs);
+        if (v.rhs >= 0) f(v.rhs);
+        break;
+    }
+}
+
+template <typename F>
+inline void forEachOperand(const Value& v, F&& f) {
+    Value& mv = const_cast<Value&>(v);
+    forEachOperand(mv, [&](int& ref) { int r = ref; f(r); });
+}
+
+// forEachOperand 不列的結構性 ref：Br.lhs（目標 Loop）/ Br.rhs（該 loop
+// 的第一個 phi）、Br_if.rhs（目標 Loop）。搬移 / 複製節點的 pass 要跟資料
+// operand 一起重新對應。
+template <typename F>
+inline void forEachControlRef(Value& v, F&& f) {
+    if (v.op == Op::Br) {
+        if (v.lhs >= 0) f(v.lhs);
+        if (v.rhs >= 0) f(v.rhs);
+    } else if (v.op == Op::Br_if) {
+        if (v.rhs >= 0) f(v.rhs);
+    }
+}
+
+// 有副作用、不能被 DCE / 重排 / 投機執行的 op
+inline bool hasSideEffects(Op op) {
+    switch (op) {
+    case Op::Store: case Op::F64Store:
+    case Op::Call: case Op::MemoryFill: case Op::MemoryCopy:
+    case Op::LocalSet: case Op::LocalTee: case Op::GlobalSet:
+    case Op::Return: case Op::Unreachable:
+    case Op::If: case Op::Else: case Op::End: case Op::Loop:
+    case Op::Br: case Op::Br_if:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 結果沒人用時可以整個刪掉的 call：callee 不寫記憶體 / global、不會
+// unreachable。不終止不算（clang 產生的 wasm 可以假設 loop 會結束）。
+inline bool isRemovableCall(const Value& v) {
+    return v.op == Op::Call &&
+           !(v.call_effects & (CallWritesMemory | CallWritesGlobals | CallMayTrap));
+}
+
+// 可以跟同樣引數的另一個 call 合併（CSE）的 call：除了 trap 以外什麼都不碰
+inline bool isPureCall(const Value& v) {
+    return v.op == Op::Call && !(v.call_effects & ~CallMayTrap);
+}
+
+inline bool isMemoryRead(Op op) {
+    return op == Op::Load || op == Op::F64Load;
+}
+
+inline bool isMemoryWrite(Op op) {
+    return op == Op::Store || op == Op::F64Store ||
+           op == Op::MemoryFill || op == Op::MemoryCopy;
+}
+
+// bridge 要不要替這個函式多開一個 __mem 參數：有 load / store / memory.fill /
+// memory.copy，或 call 要把 __mem 傳下去
+inline bool usesMemoryParam(const ValueIR& values) {
+    for (const auto& v : values)
+        if (v.op == Op::Load || v.op == Op::Store || v.op == Op::F64Load ||
+            v.op == Op::F64Store || v.op == Op::MemoryFill || v.op == Op::MemoryCopy ||
+            (v.op == Op::Call && v.pass_memory))
+            return true;
+    return false;
+}
+
+// 純運算：沒有副作用、不讀記憶體、不會 trap（除法 / 餘數會 trap，不算）、
+// 跟位置無關（Phi / Param / GlobalGet 不算）。可以安全地 CSE 或重算。
+inline bool isPureOp(Op op) {
+    switch (op) {
+    case Op::I32Const: case Op::I64Const: case Op::F64Const:
+    case Op::Add: case Op::Sub: case Op::Mul:
+    case Op::Eq: case Op::Ne:
+    case Op::Lt_S: case Op::Lt_U: case Op::Gt_S: case Op::Gt_U:
+    case Op::Le_S: case Op::Le_U: case Op::Ge_S: case Op::Ge_U:
+    case Op::Eqz:
+    case Op::And: case Op::Or: case Op::Xor:
+    case Op::Shl: case Op::Shr_S: case Op::Shr_U: case Op::Rotl: case Op::Rotr:
+    case Op::Clz: case Op::Ctz: case Op::Popcnt:
+    case Op::Select:
+    case Op::F64Add: case Op::F64Sub: case Op::F64Mul: case Op::F64Div:
+    case Op::F64Abs: case Op::F64Neg: case Op::F64Sqrt:
+    case Op::F64Min: case Op::F64Max: case Op::F64Fma:
+    case Op::F64Eq: case Op::F64Ne: case Op::F64Lt: case Op::F64Gt:
+    case Op::F64Le: case Op::F64Ge:
+    case Op::F64ConvertI32S: case Op::F64ConvertI32U:
+    case Op::F64ConvertI64S: case Op::F64ConvertI64U:
+    case Op::F32DemoteF64: case Op::F64PromoteF32:
+    case Op::I32WrapI64: case Op::I64ExtendI32S: case Op::I64ExtendI32U:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 節點的結果型別。wasm_lower 把 f64.convert_* 記成 I32（bridge 照 op 決定
+// 型別，用不到），要看真正的型別時用這個。f32.convert_* 記成 F32
+inline ValueType resultTypeOf(const Value& v) {
+    switch (v.op) {
+    case Op::F64ConvertI32S: case Op::F64ConvertI32U:
+    case Op::F64ConvertI64S: case Op::F64ConvertI64U:
+        return v.type == ValueType::F32 ? ValueType::F32 : ValueType::F64;
+    default:
+        return v.type;
+    }
+}
+
+inline bool isConstOp(Op op) {
+    return op == Op::I32Const || op == Op::I64Const || op == Op::F64Const;
+}
+
+// 兩個常數節點的值相同（F64 比 bit pattern，-0.0 跟 0.0 不同）
+inline bool sameConst(const Value& a, const Value& b) {
+    if (a.op != b.op || a.type != b.type) return false;
+    if (a.op == Op::F64Const) return std::memcmp(&a.fconst, &b.fconst, sizeof(double)) == 0;
+    return a.constValue == b.constValue;
+}
+
+// 把常數 c 原地蓋到 v 上（id 不變，use 不用改）：Param / Call 換成常數用
+inline void turnIntoConst(Value& v, const Value& c) {
+    v.op = c.op;
+    v.type = c.type;
+    v.constValue = c.constValue;
+    v.fconst = c.fconst;
+    v.paramIndex = -1;
+    v.lhs = v.rhs = -1;
+    v.operands.clear();
+    v.callee_name.clear();
+    v.call_effects = CallEffectsUnknown;
+}
+
+// 記憶體存取寬度（bytes）；不是 load/store 回傳 0
+inline int memAccessBytes(const Value& v) {
+    if (v.mem_bytes > 0 && (isMemoryRead(v.op) || v.op == Op::Store || v.op == Op::F64Store))
+        return v.mem_bytes;
+    switch (v.op) {
+    case Op::F64Load: case Op::F64Store: return 8;
+    case Op::Load: case Op::Store: return v.type == ValueType::I64 ? 8 : 4;
+    default: return 0;
+    }
+}
+
+// 純量型別的寬度（bytes）
+inline int typeBytes(ValueType t) {
+    return (t == ValueType::I64 || t == ValueType::F64) ? 8 : 4;
+}
+
+// load / store 存取的值的型別。F64Store 的 type 沒填（I32），F32 的才有記
+inline ValueType memAccessType(const Value& v) {
+    if (v.op == Op::F64Load || v.op == Op::F64Store)
+        return v.type == ValueType::F32 ? ValueType::F32 : ValueType::F64;
+    return v.type;
+}
+
+// 結構配對：Loop <-> End(0)、If <-> End(2)、Else -> If。
+// End(1)（block 結尾）在 ValueIR 裡沒有對應的開頭節點，保持 -1。
+inline std::vector<int> matchRegions(const ValueIR& values) {
+    std::vector<int> match(values.size(), -1);
+    std::vector<int> open;
+    for (size_t i = 0; i < values.size(); i++) {
+        Op op = values[i].op;
+        if (op == Op::Loop || op == Op::If) {
+            open.push_back((int)i);
+        } else if (op == Op::Else) {
+            if (!open.empty()) match[i] = open.back();
+        } else if (op == Op::End && values[i].constValue != 1) {
+            if (open.empty()) continue;
+            match[open.back()] = (int)i;
+            match[i] = open.back();
+            open.pop_back();
+        }
+    }
+    return match;
+}
+
+// 把 ref 依照 repl 表（repl[id] = 替代 id，-1 表示不換）解析到底
+inline int resolveReplacement(const std::vector<int>& repl, int id) {
+    while (id >= 0 && id < (int)repl.size() && repl[id] >= 0 && repl[id] != id)
+        id = repl[id];
+    return id;
+}
+
+// 依 repl 表改寫所有資料 operand
+inline void replaceAllUses(ValueIR& values, const std::vector<int>& repl) {
+    for (auto& v : values)
+        forEachOperand(v, [&](int& ref) { ref = resolveReplacement(repl, ref); });
+}
@@ -0,0 +1,506 @@
+#include "value_ir_vectorize.hpp"
+#include "value_ir_cemit.hpp"
+#include "value_ir_deps.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_outline.hpp"
+#include "value_ir_util.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// ============================================================
+// 合法性
+// ============================================================
+
+constexpr int kMaxBits = 256;     // 最寬的版本（AVX2）；相依距離照這個的 VF 檢查
+constexpr int64_t kMinTrip = 8;   // trip count 已知而且比這少時不拆
+
+// loop 裡的節點：跟 i 無關 / 隨 i 變的純量（只能拿來算位址）/ 向量
+enum class Kind : char { Uniform, Varying, Vector };
+
+struct Plan : OutlinedLoop {
+    int elemBits = 32;            // 最寬的 lane
+    std::vector<Kind> kind;       // 節點 → Kind（loop 外面的是 Uniform）
+};
+
+bool laneType(ValueType t) {
+    return t == ValueType::I32 || t == ValueType::F64;
+}
+
+// 存取寬度剛好是 lane 的 i32 / f64
+bool laneAccess(const Value& v) {
+    const ValueType t = memAccessType(v);
+    return laneType(t) && memAccessBytes(v) == typeBytes(t);
+}
+
+// 位址對 loops[k] 的 iv：連續（係數 = 存取寬度）回傳 1，跟 iv 無關回傳 0，
+// 其他（跨步、非 affine）回傳 -1
+int strideOf(const DependenceAnalysis& deps, int node, int k) {
+    const AffineAccess* a = deps.access(node);
+    if (!a || !a->affine) return -1;
+    int64_t coef = 0;
+    bool other = false;
+    for (const auto& [key, c] : a->terms) {
+        if (key.first != k || c == 0) continue;
+        if (key.second.empty()) coef = c;
+        else other = true;
+    }
+    if (other) return -1;
+    if (coef == 0) return 0;
+    return coef == a->size ? 1 : -1;
+}
+
+bool classifyNodes(const ValueIR& values, const LoopShape& s, int k,
+                   const DependenceAnalysis& deps, Plan& p) {
+    p.kind.assign(values.size(), Kind::Uniform);
+    p.kind[s.iv] = Kind::Varying;
+    if (p.red >= 0) p.kind[p.red] = Kind::Vector;
+    auto kindOf = [&](int ref) { return ref >= 0 ? p.kind[ref] : Kind::Uniform; };
+    auto widen = [&](ValueType t) { p.elemBits = std::max(p.elemBits, t == ValueType::F64 ? 64 : 32); };
+    bool stores = p.red >= 0;
+
+    for (int i = s.header(); i < s.backBr; i++) {
+        const Value& v = values[i];
+        if (i == s.exitBr || (v.op == Op::Phi && v.local_index >= 0)) continue;
+        switch (v.op) {
+        case Op::Param: case Op::I32Const: case Op::I64Const: case Op::F64Const:
+        case Op::LocalSet:
+            continue;
+        case Op::End:
+            if (v.constValue != 1) return false;
+            continue;
+        case Op::Load: case Op::F64Load: {
+            if (!laneAccess(v) || kindOf(v.lhs) == Kind::Vector) return false;
+            const int stride = strideOf(deps, i, k);
+            if (stride < 0) return false;
+            if (stride == 1) {
+                p.kind[i] = Kind::Vector;
+                widen(v.type);
+            }
+            continue;
+        }
+        case Op::Store: case Op::F64Store:
+            if (!laneAccess(v) || kindOf(v.lhs) == Kind::Vector) return false;
+            if (strideOf(deps, i, k) != 1 || kindOf(v.rhs) == Kind::Varying) return false;
+            p.kind[i] = Kind::Vector;
+            widen(memAccessType(v));
+            stores = true;
+            continue;
+        default:
+            break;
+        }
+        if (!isPureOp(v.op)) return false;
+        bool vec = false, varying = false;
+        forEachOperand(v, [&](int ref) {
+            vec |= kindOf(ref) == Kind::Vector;
+            varying |= kindOf(ref) == Kind::Varying;
+        });
+        if (!vec) {
+            p.kind[i] = varying ? Kind::Varying : Kind::Uniform;
+            continue;
+        }
+        // 隨 i 變的純量要變成每個 lane 不同的值，不做
+        if (varying || !isLaneWiseOp(values, v)) return false;
+        p.kind[i] = Kind::Vector;
+        widen(resultTypeOf(v));
+    }
+    return stores;
+}
+
+// loops[k] 帶的相依：距離 >= vf，或先執行的存取在 body 裡也在前面
+bool dependencesAllow(const DependenceAnalysis& deps, const LoopShape& s, int k, int vf) {
+    for (const Dependence& d : deps.dependences(s.loop, s.end)) {
+        auto it = std::find(d.loops.begin(), d.loops.end(), k);
+        if (it == d.loops.end()) return false;
+        const size_t pos = it - d.loops.begin();
+        for (const auto& dir : directionVectors(d)) {
+            bool outer = false;
+            for (size_t m = 0; m < pos; m++) outer |= dir[m] != 0;
+            if (outer || dir[pos] == 0) continue;
+            const int64_t dist = d.distance[pos];
+            if (dist == kUnknownDistance) return false;
+            const int first = dist > 0 ? d.src : d.dst, second = dist > 0 ? d.dst : d.src;
+            if (std::llabs(dist) < vf && first > second) return false;
+        }
+    }
+    return true;
+}
+
+bool planLoop(const ModuleFunction& f, const std::vector<LoopShape>& loops,
+              const DependenceAnalysis& deps, int k, const AliasOptions& aopts, Plan& p) {
+    const ValueIR& values = f.values;
+    const LoopShape& s = loops[k];
+    if (!s.simple || !s.innermost || !s.hasIV() || s.step != 1 || s.cmp != LoopCmp::LtS || s.bound < 0)
+        return false;
+    if (values[s.iv].type != ValueType::I32) return false;
+    if (!isLoopInvariant(values, s, values[s.iv].operands[0]) || !isLoopInvariant(values, s, s.bound))
+        return false;
+    if (s.tripCount >= 0 && s.tripCount < kMinTrip) return false;
+
+    p.loop = k;
+    if (!classifyCarried(values, s, p) || !p.derived.empty()) return false;
+    if (p.red >= 0 && p.redType != ValueType::I32 && p.redType != ValueType::F64) return false;
+    if (!usedOutsideOnlyAsResult(values, s, p)) return false;
+    if (!classifyNodes(values, s, k, deps, p)) return false;
+    if (!dependencesAllow(deps, s, k, kMaxBits / p.elemBits)) return false;
+    collectLiveIns(f, s, p);
+    if (aopts.distinctParamsNoAlias && !leavesSafeForAlias(values, s, p)) return false;
+    return true;
+}
+
+// ============================================================
+// kernel：向量 loop + 純量的 remainder
+// ============================================================
+//
+//   p0 = lo, p1 = hi, p2... = live-in
+//   <搬進來的純運算>
+//   end = lo + (max(hi - lo, 0) & -VF)
+//   Loop
+//     i = Phi(lo, i + VF)
+//     acc = Phi(splat(identity), acc ⊕ x)        x 是向量
+//     Br_if(i < end)
+//     <body：Kind::Vector 的節點 lanes = VF，其他照原樣>
+//     Br
+//   End
+//   Loop                                        原本的 loop，從 i 走到 hi
+//     j = Phi(i, j + 1)
+//     s = Phi(acc[0] ⊕ … ⊕ acc[VF-1], s ⊕ x)
+//     ...
+//   End
+//   Return(s)
+
+class KernelBuilder : public OutlineBuilder {
+public:
+    KernelBuilder(const ValueIR& in, const LoopShape& s, const Plan& p,
+                  const std::vector<int>& leafParam, const std::vector<ValueType>& types, int vf)
+        : OutlineBuilder(in, s, p, leafParam, types), p_(p), vf_(vf) {}
+
+private:
+    void emitRegion(size_t) override;
+    int konst(int c) { return emit(makeConst(ValueType::I32, c)); }
+    int splat(int scalar);
+    // 向量 loop 裡的純量 / 向量；不變量第一次當向量用時 splat
+    int scalarOf(int ref) const;
+    int vectorOf(int ref);
+    void emitVector(int i);
+
+    const Plan& p_;
+    const int vf_;
+    LocalMap scalar_, vector_, splats_;
+};
+
+int KernelBuilder::splat(int scalar) {
+    Value v;
+    v.op = Op::Splat;
+    v.type = resultTypeOf(out_[scalar]);
+    v.lanes = vf_;
+    v.lhs = scalar;
+    return emit(v);
+}
+
+int KernelBuilder::scalarOf(int ref) const {
+    auto it = scalar_.find(ref);
+    return it != scalar_.end() ? it->second : mapOutside(ref);
+}
+
+int KernelBuilder::vectorOf(int ref) {
+    auto it = vector_.find(ref);
+    if (it != vector_.end()) return it->second;
+    it = splats_.find(ref);
+    if (it != splats_.end()) return it->second;
+    return splats_[ref] = splat(scalarOf(ref));
+}
+
+void KernelBuilder::emitVector(int i) {
+    Value v = in_[i];
+    v.lanes = vf_;
+    switch (v.op) {
+    case Op::Load: case Op::F64Load:
+        v.lhs = scalarOf(v.lhs);
+        break;
+    case Op::Store: case Op::F64Store:
+        v.lhs = scalarOf(v.lhs);
+        v.rhs = vectorOf(v.rhs);
+        break;
+    default:
+        forEachOperand(v, [&](int& ref) { ref = vectorOf(ref); });
+        break;
+    }
+    vector_[i] = emit(v);
+}
+
+void KernelBuilder::emitRegion(size_t) {
+    const auto [lo, hi] = emitPrelude();
+    const int zero = konst(0);
+    Value sel;
+    sel.op = Op::Select;
+    sel.type = ValueType::I32;
+    sel.operands = {emitOp(Op::Gt_S, hi, lo), emitOp(Op::Sub, hi, lo), zero};
+    const int vecEnd = emitOp(Op::Add, lo, emitOp(Op::And, emit(sel), konst(-vf_)));
+    const int init = p_.red >= 0 ? splat(emit(makeConst(p_.redType, reductionIdentity(p_.redOp)))) : -1;
+
+    const int lm = emit(in_[s_.loop]);
+    Value phi = in_[s_.iv];
+    phi.operands = {lo};
+    const int iv = emit(phi);
+    scalar_[s_.iv] = iv;
+    int acc = -1;
+    if (p_.red >= 0) {
+        // lowering 出來的 loop phi 一律是 I32（bridge 看 local 的型別），f64 的
+        // reduction（--fast-math）在這裡要看得出來
+        phi = in_[p_.red];
+        phi.operands = {init};
+        phi.type = p_.redType;
+        phi.lanes = vf_;
+        acc = emit(phi);
+        vector_[p_.red] = acc;
+    }
+    Value exit = in_[s_.exitBr];
+    exit.lhs = emitOp(Op::Lt_S, iv, vecEnd);
+    exit.rhs = lm;
+    emit(exit);
+
+    for (int i = s_.header(); i < s_.backBr; i++) {
+        const Value& v = in_[i];
+        if (i == s_.exitBr || (v.op == Op::Phi && v.local_index >= 0)) continue;
+        if (v.op == Op::LocalSet || v.op == Op::End) continue;
+        if (p_.kind[i] == Kind::Vector) {
+            emitVector(i);
+            continue;
+        }
+        Value c = v;
+        forEachOperand(c, [&](int& ref) { ref = scalarOf(ref); });
+        scalar_[i] = emit(c);
+    }
+    setBack(iv, emitOp(Op::Add, iv, konst(vf_)));
+    if (acc >= 0) setBack(acc, vector_.at(in_[p_.red].operands[1]));
+    Value back = in_[s_.backBr];
+    back.lhs = lm;
+    back.rhs = iv;
+    emit(back);
+    emit(in_[s_.end]);
+
+    // 各 lane 的部分結果合併之後接著做剩下的迭代
+    LocalMap entry;
+    entry[s_.iv] = iv;
+    if (acc >= 0) {
+        int r = -1;
+        for (int l = 0; l < vf_; l++) {
+            Value lane;
+            lane.op = Op::ExtractLane;
+            lane.type = p_.redType;
+            lane.lhs = acc;
+            lane.constValue = l;
+            const int x = emit(lane);
+            if (r >= 0) {
+                r = emitOp(p_.redOp, r, x);
+                out_[r].type = p_.redType;
+            } else {
+                r = x;
+            }
+        }
+        entry[p_.red] = r;
+    }
+    copyVerbatim(s_.loop, s_.exitBr - 1, &entry);
+    if (acc >= 0) out_[map_[p_.red]].type = p_.redType;
+    exit = in_[s_.exitBr];
+    exit.lhs = emitOp(Op::Lt_S, map_[s_.iv], hi);
+    exit.rhs = map_[s_.loop];
+    map_[s_.exitBr] = emit(exit);
+    copyVerbatim(s_.bodyBegin(), s_.end, nullptr);
+
+    Value ret;
+    ret.op = Op::Return;
+    ret.lhs = p_.red >= 0 ? map_[p_.red] : -1;
+    emit(ret);
+}
+
+std::string cName(const std::string& name) {
+    if (!name.empty() && name[0] >= '0' && name[0] <= '9') return "func_" + name;
+    return name;
+}
+
+ValueType resultType(const ValueIR& values) {
+    for (const Value& v : values)
+        if (v.op == Op::Return && v.lhs >= 0) return resultTypeOf(values[v.lhs]);
+    return ValueType::Void;
+}
+
+// wasm 的 SIMD 函式：本體就是 `<f>_run`，有 export 時再包一個原本名字的
+void simdGlue(std::ostringstream& os, const ModuleFunction& f) {
+    const std::string name = cName(f.name);
+    const std::string body = kernelC(f, name + "_run", "");
+    os << "/* " << f.name << ": wasm SIMD */\n";
+    if (body.empty()) {
+        os << "#error \"wasm2sea: " << f.name << ": unsupported SIMD function\"\n\n";
+        return;
+    }
+    os << body;
+    if (!f.exported) {
+        os << "\n";
+        return;
+    }
+    const ValueType ret = resultType(f.values);
+    std::string args, sep;
+    os << kernelParamCType(ret) << " " << name << "(";
+    if (usesMemoryParam(f.values)) {
+        os << "uintptr_t mem";
+        args = "mem";
+        sep = ", ";
+    }
+    for (size_t k = 0; k < f.paramTypes.size(); k++) {
+        os << sep << kernelParamCType(f.paramTypes[k]) << " a" << k;
+        args += sep + "a" + std::to_string(k);
+        sep = ", ";
+    }
+    os << ") { " << (ret == ValueType::Void ? "" : "return ") << name << "_run(" << args << "); }\n\n";
+}
+
+} // namespace
+
+int vectorizeLoops(ModuleFunction& f, const AliasOptions& aopts, std::vector<ModuleFunction>& kernels) {
+    if (f.vector.isKernel) return 0;
+    for (const Value& v : f.values)
+        if (v.op == Op::Phi && v.use_vload_entry) return 0;
+    std::vector<LoopShape> loops = findLoops(f.values);
+    if (loops.empty()) return 0;
+
+    std::vector<Plan> plans;
+    {
+        AliasAnalysis aa(f.values, aopts);
+        DependenceAnalysis deps(f.values, loops, aa);
+        for (int k = 0; k < (int)loops.size(); k++) {
+            Plan p;
+            if (planLoop(f, loops, deps, k, aopts, p)) plans.push_back(std::move(p));
+        }
+    }
+
+    std::vector<OutlinedLoop> outlined;
+    std::vector<std::string> names;
+    std::vector<unsigned> effects;
+    std::vector<bool> memory;
+    for (const Plan& p : plans) {
+        const LoopShape& s = loops[p.loop];
+        ValueIR src = f.values;
+        std::vector<int> leafParam;
+        const ModuleFunction sig = outlineSignature(f, p, src, leafParam);
+        const std::string name = f.name + "__vec" + std::to_string(outlined.size());
+
+        std::vector<ModuleFunction> variants;
+        bool ok = true;
+        for (int bits : {128, kMaxBits}) {
+            ModuleFunction t = sig;
+            t.name = bits == 128 ? name : name + "_avx2";
+            t.origin = f.origin;
+            t.vector.isKernel = true;
+            t.vector.bits = bits;
+            t.values = finishOutlinedBody(
+                KernelBuilder(src, s, p, leafParam, t.paramTypes, bits / p.elemBits).run());
+            ok &= !kernelC(t, t.name, "").empty();
+            variants.push_back(std::move(t));
+        }
+        if (!ok) continue;
+
+        outlined.push_back(p);
+        names.push_back(name);
+        effects.push_back(effectsOf(variants[0].values));
+        memory.push_back(usesMemoryParam(variants[0].values));
+        for (auto& t : variants) kernels.push_back(std::move(t));
+    }
+    if (outlined.empty()) return 0;
+
+    f.values = replaceOutlinedLoops(f.values, loops, outlined, names, effects, memory);
+    return (int)outlined.size();
+}
+
+int routeSimdFunctions(std::vector<ModuleFunction>& funcs) {
+    int n = 0;
+    for (ModuleFunction& f : funcs) {
+        bool simd = false;
+        for (const Value& v : f.values) simd |= v.lanes > 1;
+        if (!simd || f.vector.isKernel) continue;
+        f.vector.isKernel = true;
+        f.vector.simd = true;
+        n++;
+
+        const bool mem = usesMemoryParam(f.values);
+        const ValueType ret = resultType(f.values);
+        for (ModuleFunction& g : funcs)
+            for (Value& v : g.values) {
+                if (v.op != Op::Call || v.callee_name != f.name) continue;
+                v.callee_name = f.name + "_run";
+                v.pass_memory = mem;
+                v.type = ret;
+            }
+        if (kernelC(f, cName(f.name) + "_run", "").empty())
+            std::cerr << "Warning: " << f.name << ": SIMD function uses nodes the C emitter does not support\n";
+        else
+            std::cout << "[PASS] simd: " << f.name << " -> C vector extensions\n";
+    }
+    return n;
+}
+
+// ============================================================
+// C glue
+// ============================================================
+
+std::string vectorGlueC(const std::vector<ModuleFunction>& funcs) {
+    std::ostringstream os;
+    for (const ModuleFunction& t : funcs) {
+        if (t.vector.simd) {
+            simdGlue(os, t);
+            continue;
+        }
+        if (!t.vector.isKernel || t.vector.bits != 128) continue;
+        const ModuleFunction* wide = nullptr;
+        for (const ModuleFunction& w : funcs)
+            if (w.vector.isKernel && w.name == t.name + "_avx2") wide = &w;
+
+        const std::string name = cName(t.name);
+        const bool mem = usesMemoryParam(t.values);
+        const ValueType ret = resultType(t.values);
+        if (t.vector.straightLine) os << "/* " << t.name << ": packed straight-line code */\n";
+        else os << "/* " << t.name << ": vectorized loop, iterations [p0, p1) */\n";
+        os << kernelC(t, name, "");
+        // --fp-contract 合併出來的 F64Fma：AVX2 版本連 FMA 一起開（Haswell 之後都有）
+        bool fma = false;
+        if (wide)
+            for (const Value& v : wide->values) fma |= v.op == Op::F64Fma;
+        if (wide) {
+            os << "#if defined(__x86_64__) || defined(__i386__)\n";
+            os << kernelC(*wide, cName(wide->name),
+                          fma ? "__attribute__((target(\"avx2,fma\")))" : "__attribute__((target(\"avx2\")))");
+            os << "#endif\n";
+        }
+
+        std::string args, sep;
+        os << "static " << kernelParamCType(ret) << " " << name << "_run(";
+        if (mem) {
+            os << "uintptr_t mem";
+            args = "mem";
+            sep = ", ";
+        }
+        for (size_t k = 0; k < t.paramTypes.size(); k++) {
+            os << sep << kernelParamCType(t.paramTypes[k]) << " a" << k;
+            args += sep + "a" + std::to_string(k);
+            sep = ", ";
+        }
+        os << ") {\n";
+        const std::string call = ret == ValueType::Void ? "{ " : "return ";
+        const std::string done = ret == ValueType::Void ? "; return; }" : ";";
+        if (wide) {
+            os << "#if defined(__x86_64__) || defined(__i386__)\n";
+            os << "    if (__builtin_cpu_supports(\"avx2\")"
+               << (fma ? " && __builtin_cpu_supports(\"fma\")" : "") << ") " << call << cName(wide->name) << "(" << args << ")"
+               << done << "\n";
+            os << "#endif\n";
+        }
+        os << "    " << call << name << "(" << args << ")" << done << "\n";
+        os << "}\n\n";
+    }
+    if (os.str().empty()) return "";
+    return kernelPreludeC() + os.str();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+#include <string>
+#include <vector>
+
+// ============================================================
+// Loop vectorization：最內層 loop 一次做 VF 個 lane
+// ============================================================
+//
+// bridge 出來的 C 每個 local 都是 static、每個存取都經過同一個 __mem，
+// C compiler 證明不了迭代之間沒有相依，不會向量化。這裡在 ValueIR 上做：
+//
+//   for (i = b; i < n; i++)           for (i = b; i < b + ((n-b) & -VF); i += VF)
+//     C[i] = A[i] * x + B[i];    →      C[i:VF] = A[i:VF] * splat(x) + B[i:VF]
+//                                     for (; i < n; i++)             // remainder
+//                                       C[i] = A[i] * x + B[i];
+//
+// 對象：value_ir_loops.hpp 的 counted loop，step 1 的 `i < n`、最內層、
+// body 沒有 If / call / global。
+//   - 每個 i32 / f64 的 load / store，位址對 i 是連續的（係數 = 存取寬度）；
+//     load 也可以跟 i 無關（每一輪讀一次，放進每個 lane）
+//   - 資料運算是 lane-wise 的：i32 的 + - * & | ^ 移位、f64 的 + - * / neg
+//     abs sqrt（--fast-math 時還有 min max）、i32 → f64。i 本身只能拿來算位址
+//   - loop-carried 值除了 i 只能是 i32 的 reduction（`s = s ⊕ x`，+ * & | ^）：
+//     每個 lane 各自累積，loop 之後合併。f64 的加總換了順序結果會變，只有
+//     --fast-math 時（F64Add / F64Mul 標了 fast_math）才做
+//   - DependenceAnalysis：這個 loop 帶的相依距離要是常數 d，而且 d >= VF，
+//     或先執行的存取在 body 裡也在前面（同一個 vector 迭代裡照 statement 的
+//     順序把每個 lane 做完，結果一樣）
+//
+// 向量節點是 lanes > 1 的 Value，type 是每個 lane 的型別，Splat /
+// ExtractLane 在純量跟向量之間轉換。dstogov/ir 沒有向量型別，所以整個
+// loop 跟 value_ir_parallel 一樣拆成新函式（value_ir_outline.hpp）：
+// `<f>__vec<k>` 是 128-bit（SSE2 / NEON），`<f>__vec<k>_avx2` 是 256-bit，
+// VF = 向量寬度 / 最寬的 lane。vectorGlueC 把它們寫成 C 的 vector
+// extension（value_ir_cemit.hpp），`_run` 在執行時用
+// __builtin_cpu_supports("avx2") 挑一個版本。
+
+// 回傳向量化的 loop 數。kernel 放進 kernels（vector.isKernel），f 有改寫時
+// 重建並跑過 cleanupValueIR。
+int vectorizeLoops(ModuleFunction& f, const AliasOptions& aopts, std::vector<ModuleFunction>& kernels);
+
+// wasm 本身就用 v128 的函式（wasm_lower 出來就有 lanes > 1 的節點）
+// bridge 寫不出來：整個函式標成 kernel（vector.simd），module 裡呼叫它的
+// Call 改叫 `<f>_run`。回傳標起來的函式數。要在 runModulePasses 之前：
+// inliner / specialization 看到的是已經改名的 call，不會碰它們。
+int routeSimdFunctions(std::vector<ModuleFunction>& funcs);
+
+// out.c 用的 C：vector typedef、每個 kernel 的 static 定義與 `_run`。
+// 要放在所有函式之前，沒有 kernel 時是空字串。
+std::string vectorGlueC(const std::vector<ModuleFunction>& funcs);
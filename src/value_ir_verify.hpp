@@ -70,6 +70,9 @@ inline VerifyResult verifyValueIR(const ValueIR& ir) {
             case Op::I64ExtendI32S: case Op::I64ExtendI32U:
             case Op::F64ConvertI64S: case Op::F64ConvertI64U:
             case Op::I64TruncF64S: case Op::I64TruncF64U:
+            case Op::F32DemoteF64: case Op::F64PromoteF32:
+            case Op::Splat: case Op::ExtractLane:
+            case Op::Bitcast: case Op::AnyTrue: case Op::AllTrue:
                 checkRef(ir, idx, v.lhs, "lhs", false, result);
                 break;
 
@@ -93,6 +96,18 @@ inline VerifyResult verifyValueIR(const ValueIR& ir) {
                 for (int op : v.operands)
                     checkRef(ir, idx, op, "select operand", false, result);
                 break;
+            case Op::Pack:
+                for (int op : v.operands)
+                    checkRef(ir, idx, op, "pack lane", false, result);
+                break;
+            case Op::F64Fma:
+                for (int op : v.operands)
+                    checkRef(ir, idx, op, "fma operand", false, result);
+                break;
+            case Op::ReplaceLane: case Op::Shuffle:
+                checkRef(ir, idx, v.lhs, "lhs", false, result);
+                checkRef(ir, idx, v.rhs, "rhs", false, result);
+                break;
 
             // ---- Call：lhs是callee_idx（opaque），operands是真正args ----
             case Op::Call:
@@ -144,6 +159,7 @@ inline VerifyResult verifyValueIR(const ValueIR& ir) {
             case Op::I32Const:
             case Op::I64Const:
             case Op::F64Const:
+            case Op::V128Const:
             case Op::LocalGet:
             case Op::LocalTee:
             case Op::GlobalGet:
@@ -161,7 +177,7 @@ inline VerifyResult verifyValueIR(const ValueIR& ir) {
             #ifdef WASM2SEA_ENABLE_DUMP
                 // 已知不需要驗證的 op，此處僅列出防止誤報
                 if (v.op != Op::Param && v.op != Op::I32Const && v.op != Op::I64Const &&
-                    v.op != Op::F64Const && v.op != Op::LocalGet && v.op != Op::LocalTee &&
+                    v.op != Op::F64Const && v.op != Op::V128Const && v.op != Op::LocalGet && v.op != Op::LocalTee &&
                     v.op != Op::GlobalGet && v.op != Op::Else && v.op != Op::End &&
                     v.op != Op::Loop && v.op != Op::Unreachable) {
                     fprintf(stderr, "[VERIFY WARNING] v%d: Op %s not explicitly classified in verifyValueIR\n",
@@ -0,0 +1,252 @@
+#include "value_ir_wavefront.hpp"
+#include "value_ir_deps.hpp"
+#include "value_ir_loops.hpp"
+#include "value_ir_rebuild.hpp"
+#include "value_ir_util.hpp"
+#include "wasm_lower.hpp"
+#include <algorithm>
+
+namespace {
+
+// ============================================================
+// 合法性與斜切係數
+// ============================================================
+
+struct Plan {
+    int outer = -1, inner = -1;   // findLoops 的 index
+    int skew = 0;                 // a
+    int tileSize = 0;             // B
+};
+
+int entryOf(const ValueIR& values, const LoopShape& s) {
+    return values[s.iv].operands[0];
+}
+
+// 沒被 pair 外面的 loop 帶走的相依，每個都要能斜切成非負的。
+// 順便看兩層各自是不是 DOALL：有一層是的話交給 value_ir_parallel。
+bool chooseSkew(const std::vector<Dependence>& deps, int outer, int inner, int& skew) {
+    bool outerCarries = false, innerCarries = false;
+    int a = 0;
+    for (const Dependence& d : deps) {
+        auto it1 = std::find(d.loops.begin(), d.loops.end(), outer);
+        auto it2 = std::find(d.loops.begin(), d.loops.end(), inner);
+        if (it1 == d.loops.end() || it2 == d.loops.end()) return false;
+        const size_t p1 = it1 - d.loops.begin(), p2 = it2 - d.loops.begin();
+        for (const auto& dir : directionVectors(d)) {
+            bool carried = false;
+            for (size_t m = 0; m < p1; m++) carried |= dir[m] != 0;
+            if (carried) continue;
+            if (dir[p1] == 0) {
+                // 同一列：tile 裡 j 照順序、J 大的 tile 在後面的波面
+                innerCarries |= dir[p2] != 0;
+                continue;
+            }
+            outerCarries = true;
+            int64_t d1 = d.distance[p1], d2 = d.distance[p2];
+            if (d1 == kUnknownDistance || d2 == kUnknownDistance || d1 == 0) return false;
+            if (d1 < 0) {
+                d1 = -d1;
+                d2 = -d2;
+            }
+            // a·d1 + d2 >= 0
+            if (d2 < 0) a = std::max<int64_t>(a, (-d2 + d1 - 1) / d1);
+            if (a > 4) return false;
+        }
+    }
+    skew = a;
+    return outerCarries && innerCarries;
+}
+
+// 最內層一個點（j 的一輪）的節點數，裡面的 loop 不知道 trip count 時當 64
+int64_t pointWork(const std::vector<LoopShape>& loops, int inner) {
+    const LoopShape& s = loops[inner];
+    int64_t body = s.backBr - s.bodyBegin();
+    for (int c = inner + 1; c < (int)loops.size() && loops[c].loop < s.end; c++)
+        if (loops[c].parent == inner)
+            body += (loops[c].end - loops[c].loop) * (loops[c].tripCount > 0 ? loops[c].tripCount : 64);
+    return std::max<int64_t>(1, body);
+}
+
+bool planPair(const ValueIR& values, const std::vector<LoopShape>& loops,
+              const DependenceAnalysis& deps, int outer, int inner,
+              const WavefrontOptions& opts, Plan& plan) {
+    const LoopShape& s1 = loops[outer];
+    const LoopShape& s2 = loops[inner];
+    if (s1.cmp != LoopCmp::LtS || s2.cmp != LoopCmp::LtS) return false;
+    if (values[s1.iv].type == ValueType::I64 || values[s2.iv].type == ValueType::I64) return false;
+    if (!loopNestSelfContained(values, s1)) return false;
+
+    const int64_t n1 = s1.tripCount, n2 = s2.tripCount;
+    if (n1 >= 0 && n2 >= 0 && n1 * n2 * pointWork(loops, inner) < opts.minWork) return false;
+    if (!chooseSkew(deps.dependences(s1.loop, s1.end), outer, inner, plan.skew)) return false;
+
+    int B = opts.tileSize > 0 ? opts.tileSize : 64;
+    if (opts.tileSize <= 0 && n1 > 0)
+        while (B > 8 && (n1 + B - 1) / B < 2 * opts.threads) B /= 2;
+    plan.outer = outer;
+    plan.inner = inner;
+    plan.tileSize = B;
+    return true;
+}
+
+// ============================================================
+// 重建
+// ============================================================
+
+class Wavefront : public ValueIRRebuilder {
+public:
+    Wavefront(const ValueIR& in, const std::vector<LoopShape>& loops, const std::vector<Plan>& plans)
+        : ValueIRRebuilder(in), loops_(loops), plans_(plans) {}
+
+    ValueIR run() {
+        std::vector<std::pair<int, int>> regions;
+        for (const Plan& p : plans_) regions.push_back({loops_[p.outer].loop, loops_[p.outer].end});
+        return ValueIRRebuilder::run(regions);
+    }
+
+private:
+    void emitRegion(size_t k) override;
+    int konst(int c) { return emitOp(Op::I32Const, -1, -1, c); }
+    int select(int cond, int a, int b) {
+        Value v;
+        v.op = Op::Select;
+        v.type = ValueType::I32;
+        v.operands = {cond, a, b};
+        return emit(v);
+    }
+    int minS(int a, int b) { return select(emitOp(Op::Lt_S, a, b), a, b); }
+    int maxS(int a, int b) { return select(emitOp(Op::Gt_S, a, b), a, b); }
+    // 新的 loop：Loop、iv = Phi(init)、Br_if(iv < bound)；回傳 {Loop, iv}
+    std::pair<int, int> openLoop(const LoopShape& like, int init, int bound, bool doall);
+    void closeLoop(const LoopShape& like, std::pair<int, int> l);
+    // 原本的 loop s 換成從 init 走到 bound，header 照複製
+    int openCopy(const LoopShape& s, int init, int bound);
+    void closeCopy(const LoopShape& s);
+
+    const std::vector<LoopShape>& loops_;
+    const std::vector<Plan>& plans_;
+};
+
+std::pair<int, int> Wavefront::openLoop(const LoopShape& like, int init, int bound, bool doall) {
+    Value loop = in_[like.loop];
+    loop.doall = doall;
+    int lm = emit(loop);
+    Value phi = in_[like.iv];
+    phi.operands = {init};
+    int iv = emit(phi);
+    Value exit = in_[like.exitBr];
+    exit.lhs = emitOp(Op::Lt_S, iv, bound);
+    exit.rhs = lm;
+    emit(exit);
+    return {lm, iv};
+}
+
+void Wavefront::closeLoop(const LoopShape& like, std::pair<int, int> l) {
+    setBack(l.second, emitOp(Op::Add, l.second, konst(1)));
+    Value back = in_[like.backBr];
+    back.lhs = l.first;
+    back.rhs = l.second;
+    emit(back);
+    emit(in_[like.end]);
+}
+
+int Wavefront::openCopy(const LoopShape& s, int init, int bound) {
+    map_[s.loop] = emit(in_[s.loop]);
+    Value phi = in_[s.iv];
+    phi.operands = {init};
+    int iv = emit(phi);
+    map_[s.iv] = iv;
+    for (int i = s.header(); i < s.exitBr; i++)
+        if (i != s.iv && map_[i] < 0) copyVerbatim(i, i, nullptr);
+    Value exit = in_[s.exitBr];
+    exit.lhs = emitOp(Op::Lt_S, iv, bound);
+    exit.rhs = map_[s.loop];
+    map_[s.exitBr] = emit(exit);
+    return iv;
+}
+
+void Wavefront::closeCopy(const LoopShape& s) {
+    setBack(map_[s.iv], map_[in_[s.iv].operands[1]]);
+    Value back = in_[s.backBr];
+    back.lhs = map_[s.loop];
+    back.rhs = map_[s.iv];
+    map_[s.backBr] = emit(back);
+    map_[s.end] = emit(in_[s.end]);
+}
+
+void Wavefront::emitRegion(size_t k) {
+    const Plan& p = plans_[k];
+    const LoopShape& s1 = loops_[p.outer];
+    const LoopShape& s2 = loops_[p.inner];
+
+    for (int i = s1.header(); i < s1.exitBr; i++)
+        if (in_[i].op == Op::Param || isConstOp(in_[i].op)) copyVerbatim(i, i, nullptr);
+    for (const LoopShape* s : {&s1, &s2})
+        for (int ref : {entryOf(in_, *s), s->bound})
+            if (ref > s1.loop && ref < s1.end && map_[ref] < 0) copyVerbatim(ref, ref, nullptr);
+    const int i0 = mapOutside(entryOf(in_, s1)), n = mapOutside(s1.bound);
+    const int j0 = mapOutside(entryOf(in_, s2)), m = mapOutside(s2.bound);
+
+    // tile 數：N = n - i0 列、斜切後 M + a·(N-1) 行，各自除以 B 無條件進位
+    // （N <= 0 時 NI <= 0，每條波面都是空的）
+    const int B = konst(p.tileSize), Bm1 = konst(p.tileSize - 1), one = konst(1), zero = konst(0);
+    const int a = konst(p.skew);
+    const int N = emitOp(Op::Sub, n, i0), M = emitOp(Op::Sub, m, j0);
+    const int span = emitOp(Op::Add, M, emitOp(Op::Mul, emitOp(Op::Sub, N, one), a));
+    const int NI = emitOp(Op::Div_S, emitOp(Op::Add, N, Bm1), B);
+    const int NJ = emitOp(Op::Div_S, emitOp(Op::Add, span, Bm1), B);
+    const int waves = emitOp(Op::Sub, emitOp(Op::Add, NI, NJ), one);
+
+    auto w = openLoop(s1, zero, waves, false);
+    const int w1 = emitOp(Op::Add, w.second, one);
+    const int Ilo = maxS(emitOp(Op::Sub, w1, NJ), zero);
+    const int Ihi = minS(w1, NI);
+
+    auto I = openLoop(s1, Ilo, Ihi, true);
+    const int J = emitOp(Op::Sub, w.second, I.second);
+    const int iBegin = emitOp(Op::Add, i0, emitOp(Op::Mul, I.second, B));
+    const int iEnd = minS(emitOp(Op::Add, iBegin, B), n);
+    const int jBegin = emitOp(Op::Add, j0, emitOp(Op::Mul, J, B));
+    const int jEnd = emitOp(Op::Add, jBegin, B);
+
+    const int i = openCopy(s1, iBegin, iEnd);
+    copyUnmapped(s1.bodyBegin(), s2.loop - 1, true);
+    const int shift = emitOp(Op::Mul, emitOp(Op::Sub, i, i0), a);
+    const int jLo = maxS(emitOp(Op::Sub, jBegin, shift), j0);
+    const int jHi = minS(emitOp(Op::Sub, jEnd, shift), m);
+    openCopy(s2, jLo, jHi);
+    copyUnmapped(s2.bodyBegin(), s2.backBr - 1, false);
+    closeCopy(s2);
+    copyUnmapped(s2.end + 1, s1.backBr - 1, true);
+    closeCopy(s1);
+
+    closeLoop(s1, I);
+    closeLoop(s1, w);
+}
+
+} // namespace
+
+int wavefrontLoops(ValueIR& values, const AliasAnalysis& aa, const WavefrontOptions& opts) {
+    for (const Value& v : values)
+        if (v.op == Op::Phi && v.use_vload_entry) return 0;
+    std::vector<LoopShape> loops = findLoops(values);
+    if (loops.empty()) return 0;
+    DependenceAnalysis deps(values, loops, aa);
+
+    std::vector<Plan> plans;
+    int skipUntil = -1;
+    for (int k = 0; k < (int)loops.size(); k++) {
+        if (loops[k].loop < skipUntil) continue;
+        std::vector<int> band = rectangularBand(values, loops, k);
+        if (band.size() < 2) continue;
+        Plan plan;
+        if (!planPair(values, loops, deps, band[0], band[1], opts, plan)) continue;
+        plans.push_back(plan);
+        skipUntil = loops[k].end;
+    }
+    if (plans.empty()) return 0;
+
+    ValueIR out = Wavefront(values, loops, plans).run();
+    values = cleanupValueIR(out);
+    return (int)plans.size();
+}
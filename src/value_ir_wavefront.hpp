@@ -0,0 +1,41 @@
+#pragma once
+
+#include "value_ir.hpp"
+#include "value_ir_alias.hpp"
+#include <cstdint>
+
+// ============================================================
+// Wavefront：兩個方向都帶相依的 loop nest 斜切成可以平行的波面
+// ============================================================
+//
+// seidel-2d 的 `A[i][j] = (A[i-1][j-1] + ... + A[i+1][j+1]) / 9` 在 i、j
+// 兩層都有相依（距離 (1,-1)、(1,0)、(1,1)、(0,1)），哪一層單獨拿出來
+// 都不是 DOALL。把 j 斜切成 j' = j + a·i（a 取讓每個相依都變成
+// (d1, d2 + a·d1) >= 0 的最小值）之後整個 nest fully permutable，切成
+// B × B 的 tile；tile (I, J) 只依賴 (I-1, ·) 與 (I, J-1) 這些座標和比較小
+// 的 tile，同一條 w = I + J 上的 tile 彼此獨立：
+//
+//   for (w = 0; w < NI + NJ - 1; w++)                  照順序，每條之間 join
+//     for (I = max(0, w-NJ+1); I < min(NI, w+1); I++)  標成 doall
+//       for (i = i0 + I·B; i < min(n, i0 + I·B + B); i++)
+//         for (j = max(j0, j0 + (w-I)·B - a·(i-i0));
+//              j < min(m, j0 + (w-I)·B + B - a·(i-i0)); j++)
+//           S(i, j);
+//
+// tile 裡面還是原本的 i、j 順序。I 那一層交給 value_ir_parallel 拆成
+// task：斜切之後的位址 dependence analysis 看不出來，所以 Loop 節點標上
+// doall，平行化時不再檢查相依。
+//
+// 對象：value_ir_loops.hpp 的 rectangularBand 開頭兩層（step 1 的
+// `i < n` signed），外層還有 loop（seidel 的時間步）時那一層照舊依序跑。
+// 只在兩層都不是 DOALL、每個沒被外層 loop 帶走的相依距離都是常數時
+// 套用（floyd-warshall 的 `path[i][k]` 這種距離不定的不套）。
+
+struct WavefrontOptions {
+    int tileSize = 0;              // 0 = 64，已知 trip count 時縮到每條波面至少 2·threads 個 tile
+    int threads = 1;
+    int64_t minWork = 1 << 15;     // 估計的節點數 × 迭代次數，跟 ParallelOptions 一樣
+};
+
+// 回傳改寫的 nest 數；有改寫時 values 重建並跑過 cleanupValueIR。
+int wavefrontLoops(ValueIR& values, const AliasAnalysis& aa, const WavefrontOptions& opts = {});
@@ -130,6 +130,107 @@ static const char* const kWasmOpNames[] = {
     "I64TruncF64U",   // I64TruncF64U
     "I64Load",        // I64Load
     "I64Store",       // I64Store
+    "F32Const",       // F32Const
+    "F32Add",         // F32Add
+    "F32Sub",         // F32Sub
+    "F32Mul",         // F32Mul
+    "F32Div",         // F32Div
+    "F32Abs",         // F32Abs
+    "F32Neg",         // F32Neg
+    "F32Sqrt",        // F32Sqrt
+    "F32Min",         // F32Min
+    "F32Max",         // F32Max
+    "F32Eq",          // F32Eq
+    "F32Ne",          // F32Ne
+    "F32Lt",          // F32Lt
+    "F32Gt",          // F32Gt
+    "F32Le",          // F32Le
+    "F32Ge",          // F32Ge
+    "F32ConvertI32S", // F32ConvertI32S
+    "F32ConvertI32U", // F32ConvertI32U
+    "F32ConvertI64S", // F32ConvertI64S
+    "F32ConvertI64U", // F32ConvertI64U
+    "I32TruncF32S",   // I32TruncF32S
+    "I32TruncF32U",   // I32TruncF32U
+    "I64TruncF32S",   // I64TruncF32S
+    "I64TruncF32U",   // I64TruncF32U
+    "F32DemoteF64",   // F32DemoteF64
+    "F64PromoteF32",  // F64PromoteF32
+    "F32Load",        // F32Load
+    "F32Store",       // F32Store
+    "V128Const",      // V128Const
+    "V128Load",       // V128Load
+    "V128Store",      // V128Store
+    "V128Load32Splat", // V128Load32Splat
+    "V128Load64Splat", // V128Load64Splat
+    "V128Load32Zero", // V128Load32Zero
+    "V128Load64Zero", // V128Load64Zero
+    "I32x4Splat",     // I32x4Splat
+    "I64x2Splat",     // I64x2Splat
+    "F64x2Splat",     // F64x2Splat
+    "I32x4ExtractLane", // I32x4ExtractLane
+    "I64x2ExtractLane", // I64x2ExtractLane
+    "F64x2ExtractLane", // F64x2ExtractLane
+    "I32x4ReplaceLane", // I32x4ReplaceLane
+    "I64x2ReplaceLane", // I64x2ReplaceLane
+    "F64x2ReplaceLane", // F64x2ReplaceLane
+    "I8x16Shuffle",   // I8x16Shuffle
+    "V128Not",        // V128Not
+    "V128And",        // V128And
+    "V128Or",         // V128Or
+    "V128Xor",        // V128Xor
+    "V128AndNot",     // V128AndNot
+    "V128Bitselect",  // V128Bitselect
+    "V128AnyTrue",    // V128AnyTrue
+    "I32x4Add",       // I32x4Add
+    "I32x4Sub",       // I32x4Sub
+    "I32x4Mul",       // I32x4Mul
+    "I32x4Neg",       // I32x4Neg
+    "I32x4Abs",       // I32x4Abs
+    "I32x4Shl",       // I32x4Shl
+    "I32x4ShrS",      // I32x4ShrS
+    "I32x4ShrU",      // I32x4ShrU
+    "I32x4Eq",        // I32x4Eq
+    "I32x4Ne",        // I32x4Ne
+    "I32x4LtS",       // I32x4LtS
+    "I32x4LtU",       // I32x4LtU
+    "I32x4GtS",       // I32x4GtS
+    "I32x4GtU",       // I32x4GtU
+    "I32x4LeS",       // I32x4LeS
+    "I32x4LeU",       // I32x4LeU
+    "I32x4GeS",       // I32x4GeS
+    "I32x4GeU",       // I32x4GeU
+    "I32x4MinS",      // I32x4MinS
+    "I32x4MinU",      // I32x4MinU
+    "I32x4MaxS",      // I32x4MaxS
+    "I32x4MaxU",      // I32x4MaxU
+    "I32x4AllTrue",   // I32x4AllTrue
+    "I64x2Add",       // I64x2Add
+    "I64x2Sub",       // I64x2Sub
+    "I64x2Mul",       // I64x2Mul
+    "I64x2Neg",       // I64x2Neg
+    "I64x2Shl",       // I64x2Shl
+    "I64x2ShrS",      // I64x2ShrS
+    "I64x2ShrU",      // I64x2ShrU
+    "I64x2Eq",        // I64x2Eq
+    "I64x2Ne",        // I64x2Ne
+    "F64x2Add",       // F64x2Add
+    "F64x2Sub",       // F64x2Sub
+    "F64x2Mul",       // F64x2Mul
+    "F64x2Div",       // F64x2Div
+    "F64x2Neg",       // F64x2Neg
+    "F64x2Abs",       // F64x2Abs
+    "F64x2Sqrt",      // F64x2Sqrt
+    "F64x2Min",       // F64x2Min
+    "F64x2Max",       // F64x2Max
+    "F64x2Eq",        // F64x2Eq
+    "F64x2Ne",        // F64x2Ne
+    "F64x2Lt",        // F64x2Lt
+    "F64x2Gt",        // F64x2Gt
+    "F64x2Le",        // F64x2Le
+    "F64x2Ge",        // F64x2Ge
+    "F64x2ConvertLowI32x4S", // F64x2ConvertLowI32x4S
+    "F64x2ConvertLowI32x4U", // F64x2ConvertLowI32x4U
     "Call",           // Call
     "Unreachable",    // Unreachable
     "Unsupported",    // Unsupported
@@ -181,6 +282,8 @@ void dumpInstr(const Instr& instr, int indent) {
         printf("I64Const(%lld)\n", (long long)instr.i64operand); break;
     case WasmOp::F64Const:
         printf("F64Const(%g)\n", instr.foperand); break;
+    case WasmOp::F32Const:
+        printf("F32Const(%g)\n", instr.foperand); break;
     case WasmOp::Br:
         printf("Br(depth=%d)\n", instr.operand); break;
     case WasmOp::Br_if:
@@ -207,6 +310,22 @@ void dumpInstr(const Instr& instr, int indent) {
         printf("F64Load(offset=%d)\n", instr.operand); break;
     case WasmOp::F64Store:
         printf("F64Store(offset=%d)\n", instr.operand); break;
+    case WasmOp::F32Load:
+        printf("F32Load(offset=%d)\n", instr.operand); break;
+    case WasmOp::F32Store:
+        printf("F32Store(offset=%d)\n", instr.operand); break;
+    case WasmOp::V128Load: case WasmOp::V128Store:
+    case WasmOp::V128Load32Splat: case WasmOp::V128Load64Splat:
+    case WasmOp::V128Load32Zero: case WasmOp::V128Load64Zero:
+        printf("%s(offset=%d)\n", opToString(instr.op), instr.operand); break;
+    case WasmOp::I32x4ExtractLane: case WasmOp::I64x2ExtractLane: case WasmOp::F64x2ExtractLane:
+    case WasmOp::I32x4ReplaceLane: case WasmOp::I64x2ReplaceLane: case WasmOp::F64x2ReplaceLane:
+        printf("%s(lane=%d)\n", opToString(instr.op), instr.operand); break;
+    case WasmOp::V128Const: case WasmOp::I8x16Shuffle:
+        printf("%s(", opToString(instr.op));
+        for (int k = 0; k < 16; k++) printf(k ? " %d" : "%d", instr.v128[k]);
+        printf(")\n");
+        break;
     case WasmOp::End:
         if (instr.operand == 0)      printf("End(loop)\n");
         else if (instr.operand == 1) printf("End(block)\n");
@@ -101,17 +101,63 @@ enum class WasmOp {
     // i64 memory
     I64Load, I64Store,
 
+    // F32（單精度，不轉成 f64）
+    F32Const,
+    F32Add, F32Sub, F32Mul, F32Div,
+    F32Abs, F32Neg, F32Sqrt,
+    F32Min, F32Max,
+    F32Eq, F32Ne, F32Lt, F32Gt, F32Le, F32Ge,
+    F32ConvertI32S, F32ConvertI32U,
+    F32ConvertI64S, F32ConvertI64U,
+    I32TruncF32S, I32TruncF32U,
+    I64TruncF32S, I64TruncF32U,
+    F32DemoteF64, F64PromoteF32,
+    F32Load, F32Store,
+
+    // SIMD（v128）：lane 的 operand = lane 編號
+    V128Const,          // v128 = 16 個 byte
+    V128Load, V128Store,
+    V128Load32Splat, V128Load64Splat,
+    V128Load32Zero, V128Load64Zero,
+    I32x4Splat, I64x2Splat, F64x2Splat,
+    I32x4ExtractLane, I64x2ExtractLane, F64x2ExtractLane,
+    I32x4ReplaceLane, I64x2ReplaceLane, F64x2ReplaceLane,
+    I8x16Shuffle,       // v128 = 16 個 byte 的來源（0..31）
+    V128Not, V128And, V128Or, V128Xor, V128AndNot, V128Bitselect,
+    V128AnyTrue,
+    I32x4Add, I32x4Sub, I32x4Mul, I32x4Neg, I32x4Abs,
+    I32x4Shl, I32x4ShrS, I32x4ShrU,
+    I32x4Eq, I32x4Ne,
+    I32x4LtS, I32x4LtU, I32x4GtS, I32x4GtU,
+    I32x4LeS, I32x4LeU, I32x4GeS, I32x4GeU,
+    I32x4MinS, I32x4MinU, I32x4MaxS, I32x4MaxU,
+    I32x4AllTrue,
+    I64x2Add, I64x2Sub, I64x2Mul, I64x2Neg,
+    I64x2Shl, I64x2ShrS, I64x2ShrU,
+    I64x2Eq, I64x2Ne,
+    F64x2Add, F64x2Sub, F64x2Mul, F64x2Div,
+    F64x2Neg, F64x2Abs, F64x2Sqrt,
+    F64x2Min, F64x2Max,
+    F64x2Eq, F64x2Ne, F64x2Lt, F64x2Gt, F64x2Le, F64x2Ge,
+    F64x2ConvertLowI32x4S, F64x2ConvertLowI32x4U,
+
     Call,       // operand = callee func index, foperand = num_args
     Unreachable,
     Unsupported,
     _Count
 };
 
+// wasm-ld 把 shadow stack pointer（__stack_pointer）放在 global 0；其他
+// global 就算拿來當指標也不是 frame
+constexpr int kStackPointerGlobal = 0;
+
 struct Instr {
     WasmOp op = WasmOp::Unsupported;
     int operand = 0;
     double foperand = 0.0;
     int64_t i64operand = 0;
+    int mem_bytes = 0;     // Load/Store：實際存取的位元組數（0 = 未知）
+    uint8_t v128[16] = {}; // V128Const 的值 / I8x16Shuffle 的 lane 來源
 };
 
 struct InstrSeq {
@@ -1,4 +1,6 @@
 #include "wasm_lower.hpp"
+#include "value_ir_util.hpp"
+#include <cstring>
 #include <unordered_map>
 #include <unordered_set>
 #include <functional>
@@ -77,6 +79,13 @@ struct LowerContext {
         return id;
     }
 
+    // v128 的 phi / select 跟著 operand 當向量（lanes、lane 型別）
+    void inheritLanes(int dst, int src) {
+        if (values[src].lanes <= 1) return;
+        values[dst].type = values[src].type;
+        values[dst].lanes = values[src].lanes;
+    }
+
     // 更新 loop phi 的 back-edge（Br / Br_if 共用）
     void updateLoopPhiBackedges(ControlFrame& target) {
         for (auto& [idx, phi_id] : target.loop_phis) {
@@ -144,6 +153,21 @@ MAKE_BINARY(F64Lt,   F64Lt,  I32)
 MAKE_BINARY(F64Gt,   F64Gt,  I32)
 MAKE_BINARY(F64Le,   F64Le,  I32)
 MAKE_BINARY(F64Ge,   F64Ge,  I32)
+MAKE_BINARY(F64Min,  F64Min, F64)
+MAKE_BINARY(F64Max,  F64Max, F64)
+// f32 共用 F64* 的 op，type 記成 F32
+MAKE_BINARY(F32Add,  F64Add, F32)
+MAKE_BINARY(F32Sub,  F64Sub, F32)
+MAKE_BINARY(F32Mul,  F64Mul, F32)
+MAKE_BINARY(F32Div,  F64Div, F32)
+MAKE_BINARY(F32Min,  F64Min, F32)
+MAKE_BINARY(F32Max,  F64Max, F32)
+MAKE_BINARY(F32Eq,   F64Eq,  I32)
+MAKE_BINARY(F32Ne,   F64Ne,  I32)
+MAKE_BINARY(F32Lt,   F64Lt,  I32)
+MAKE_BINARY(F32Gt,   F64Gt,  I32)
+MAKE_BINARY(F32Le,   F64Le,  I32)
+MAKE_BINARY(F32Ge,   F64Ge,  I32)
 
 #define MAKE_UNARY(wasmOp, irOp, vtype) \
     static void handle_##wasmOp(LowerContext& ctx, const Instr&, size_t) { \
@@ -171,6 +195,19 @@ MAKE_UNARY(F64Sin, F64Sin, F64)
 MAKE_UNARY(F64Cos, F64Cos, F64)
 MAKE_UNARY(F64Abs, F64Abs, F64)
 MAKE_UNARY(F64Pow, F64Pow, F64)
+MAKE_UNARY(F32Neg, F64Neg, F32)
+MAKE_UNARY(F32Abs, F64Abs, F32)
+MAKE_UNARY(F32Sqrt, F64Sqrt, F32)
+MAKE_UNARY(F32ConvertI32S,F64ConvertI32S,F32)
+MAKE_UNARY(F32ConvertI32U,F64ConvertI32U,F32)
+MAKE_UNARY(F32ConvertI64S,F64ConvertI64S,F32)
+MAKE_UNARY(F32ConvertI64U,F64ConvertI64U,F32)
+MAKE_UNARY(I32TruncF32S, I32TruncF64S, I32)
+MAKE_UNARY(I32TruncF32U, I32TruncF64U, I32)
+MAKE_UNARY(I64TruncF32S, I64TruncF64S, I64)
+MAKE_UNARY(I64TruncF32U, I64TruncF64U, I64)
+MAKE_UNARY(F32DemoteF64, F32DemoteF64, F32)
+MAKE_UNARY(F64PromoteF32, F64PromoteF32, F64)
 
 // ============================================================
 // 常數
@@ -196,6 +233,13 @@ static void handle_F64Const(LowerContext& ctx, const Instr& ins, size_t) {
     ctx.stack.push_back(id);
 }
 
+static void handle_F32Const(LowerContext& ctx, const Instr& ins, size_t) {
+    int id = ctx.newValue(Op::F64Const);
+    ctx.values[id].type = ValueType::F32;
+    ctx.values[id].fconst = (float)ins.foperand;
+    ctx.stack.push_back(id);
+}
+
 // ============================================================
 // Local Get / Set / Tee
 // ============================================================
@@ -305,6 +349,7 @@ static void handle_End(LowerContext& ctx, const Instr&, size_t) {
         int phi_id = ctx.newValue(Op::Phi);
         ctx.values[phi_id].local_index = -1;
         ctx.values[phi_id].operands = {frame.then_values[0], frame.else_values[0]};
+        ctx.inheritLanes(phi_id, frame.then_values[0]);
         ctx.stack.push_back(phi_id);
     }
 
@@ -320,6 +365,7 @@ static void handle_End(LowerContext& ctx, const Instr&, size_t) {
                 int phi_id = ctx.newValue(Op::Phi);
                 ctx.values[phi_id].local_index = -1;
                 ctx.values[phi_id].operands = {then_val, else_val};
+                ctx.inheritLanes(phi_id, then_val);
                 ctx.localVars[idx] = phi_id;
             }
         }
@@ -330,6 +376,7 @@ static void handle_End(LowerContext& ctx, const Instr&, size_t) {
                 int phi_id = ctx.newValue(Op::Phi);
                 ctx.values[phi_id].local_index = -1;
                 ctx.values[phi_id].operands = {then_val, entry_it->second};
+                ctx.inheritLanes(phi_id, then_val);
                 ctx.localVars[idx] = phi_id;
             }
         }
@@ -419,6 +466,7 @@ static void handle_Loop(LowerContext& ctx, const Instr&, size_t idx) {
         int phi_id = ctx.newValue(Op::Phi);
         ctx.values[phi_id].operands.push_back(entry_val);
         ctx.values[phi_id].local_index = i;
+        ctx.inheritLanes(phi_id, entry_val);
 
         // 檢查外層 loop 是否需要 VLOAD
         for (int k = (int)ctx.control_stack.size() - 1; k >= 0; k--) {
@@ -542,6 +590,7 @@ static void handle_BrTable(LowerContext& ctx, const Instr&, size_t) {
 // 其他
 // ============================================================
 
+// visitSelect 依序 push ifFalse、ifTrue、condition：條件下面是成立時的值
 static void handle_Select(LowerContext& ctx, const Instr&, size_t) {
     if (ctx.stack.size() < 3) return;
     int cond      = ctx.stack.back(); ctx.stack.pop_back();
@@ -549,6 +598,11 @@ static void handle_Select(LowerContext& ctx, const Instr&, size_t) {
     int false_val = ctx.stack.back(); ctx.stack.pop_back();
     int id = ctx.newValue(Op::Select);
     ctx.values[id].operands = {cond, true_val, false_val};
+    // 型別跟著運算出來的那一邊（Param / phi 沒記型別）
+    const Value& src = (ctx.values[true_val].op == Op::Param || ctx.values[true_val].op == Op::Phi)
+        ? ctx.values[false_val] : ctx.values[true_val];
+    ctx.values[id].type = resultTypeOf(src);
+    ctx.inheritLanes(id, true_val);
     ctx.stack.push_back(id);
 }
 
@@ -611,15 +665,18 @@ static void handle_Load(LowerContext& ctx, const Instr& ins, size_t) {
     ctx.values[id].lhs = ptr;
     ctx.values[id].type = t;
     ctx.values[id].mem_offset = ins.operand;
+    ctx.values[id].mem_bytes = ins.mem_bytes;
     ctx.stack.push_back(id);
 }
 
+// f32.load / f32.store 也走 F64Load / F64Store，type 是 F32、mem_bytes 是 4
 static void handle_F64Load(LowerContext& ctx, const Instr& ins, size_t) {
     int ptr = ctx.safePop();
     int id = ctx.newValue(Op::F64Load);
     ctx.values[id].lhs = ptr;
-    ctx.values[id].type = ValueType::F64;
+    ctx.values[id].type = (ins.op == WasmOp::F32Load) ? ValueType::F32 : ValueType::F64;
     ctx.values[id].mem_offset = ins.operand;
+    ctx.values[id].mem_bytes = ins.mem_bytes;
     ctx.stack.push_back(id);
 }
 
@@ -631,6 +688,7 @@ static void handle_Store(LowerContext& ctx, const Instr& ins, size_t) {
     ctx.values[id].rhs = val;
     ctx.values[id].type = t;
     ctx.values[id].mem_offset = ins.operand;
+    ctx.values[id].mem_bytes = ins.mem_bytes;
 }
 
 static void handle_F64Store(LowerContext& ctx, const Instr& ins, size_t) {
@@ -638,7 +696,9 @@ static void handle_F64Store(LowerContext& ctx, const Instr& ins, size_t) {
     int id = ctx.newValue(Op::F64Store);
     ctx.values[id].lhs = ptr;
     ctx.values[id].rhs = val;
+    if (ins.op == WasmOp::F32Store) ctx.values[id].type = ValueType::F32;
     ctx.values[id].mem_offset = ins.operand;
+    ctx.values[id].mem_bytes = ins.mem_bytes;
 }
 
 static void handle_Unsupported(LowerContext& ctx, const Instr&, size_t) {
@@ -647,6 +707,317 @@ static void handle_Unsupported(LowerContext& ctx, const Instr&, size_t) {
     ctx.stack.push_back(id);
 }
 
+// ============================================================
+// SIMD（v128）
+// ============================================================
+//
+// v128 是 lanes > 1 的向量節點，type 是每個 lane 的型別：i32x4 = {I32, 4}、
+// i64x2 = {I64, 2}、f64x2 = {F64, 2}。wasm 的 v128 沒有 lane 的型別，同一個
+// 值可以先當 f64x2 加、再當 i32x4 做 and，每個 op 用 simdAs 把 operand 轉成
+// 自己要的看法（不一樣時插 Bitcast）。位元運算一律當 i32x4 做；比較的結果是
+// 每個 lane 全 1 / 全 0 的 mask（f64x2 的 mask 是 i64 lane）。
+// 沒有直接對應的 op 用其他節點組：not = xor 全 1、neg = 0 - a、
+// abs / min / max = mask 挑選（lanes > 1 的 Select）。
+
+struct SimdShape {
+    ValueType type;
+    int lanes;
+};
+
+static const SimdShape kI32x4{ValueType::I32, 4};
+static const SimdShape kI64x2{ValueType::I64, 2};
+static const SimdShape kF64x2{ValueType::F64, 2};
+
+static int simdNew(LowerContext& ctx, Op op, SimdShape s) {
+    int id = ctx.newValue(op);
+    ctx.values[id].type = s.type;
+    ctx.values[id].lanes = s.lanes;
+    return id;
+}
+
+// id 換成 s 的看法。純量（safePop 補的 0）放進每個 lane
+static int simdAs(LowerContext& ctx, int id, SimdShape s) {
+    const int lanes = ctx.values[id].lanes;
+    if (lanes == s.lanes && resultTypeOf(ctx.values[id]) == s.type) return id;
+    int cast = simdNew(ctx, lanes > 1 ? Op::Bitcast : Op::Splat, s);
+    ctx.values[cast].lhs = id;
+    return cast;
+}
+
+static int simdBinaryNode(LowerContext& ctx, Op op, int lhs, int rhs, SimdShape out) {
+    int id = simdNew(ctx, op, out);
+    ctx.values[id].lhs = lhs;
+    ctx.values[id].rhs = rhs;
+    return id;
+}
+
+static int simdSplatConst(LowerContext& ctx, SimdShape s, int64_t c) {
+    int k = ctx.newValue(s.type == ValueType::I64 ? Op::I64Const : Op::I32Const);
+    ctx.values[k].type = s.type;
+    ctx.values[k].constValue = s.type == ValueType::I64 ? c : (int32_t)c;
+    int id = simdNew(ctx, Op::Splat, s);
+    ctx.values[id].lhs = k;
+    return id;
+}
+
+// mask 挑選：operands = {mask, 1 的 lane 取這邊, 0 的 lane 取這邊}
+static int simdSelect(LowerContext& ctx, int mask, int t, int f, SimdShape s) {
+    int id = simdNew(ctx, Op::Select, s);
+    ctx.values[id].operands = {mask, t, f};
+    return id;
+}
+
+static void simdBinary(LowerContext& ctx, Op op, SimdShape in, SimdShape out) {
+    int rhs = ctx.safePop(), lhs = ctx.safePop();
+    lhs = simdAs(ctx, lhs, in);
+    rhs = simdAs(ctx, rhs, in);
+    ctx.stack.push_back(simdBinaryNode(ctx, op, lhs, rhs, out));
+}
+
+static void simdUnary(LowerContext& ctx, Op op, SimdShape s) {
+    int a = simdAs(ctx, ctx.safePop(), s);
+    int id = simdNew(ctx, op, s);
+    ctx.values[id].lhs = a;
+    ctx.stack.push_back(id);
+}
+
+#define MAKE_SIMD_BINARY(wasmOp, irOp, in, out) \
+    static void handle_##wasmOp(LowerContext& ctx, const Instr&, size_t) { \
+        simdBinary(ctx, Op::irOp, in, out); \
+    }
+
+MAKE_SIMD_BINARY(V128And,  And,    kI32x4, kI32x4)
+MAKE_SIMD_BINARY(V128Or,   Or,     kI32x4, kI32x4)
+MAKE_SIMD_BINARY(V128Xor,  Xor,    kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4Add, Add,    kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4Sub, Sub,    kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4Mul, Mul,    kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4Eq,  Eq,     kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4Ne,  Ne,     kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4LtS, Lt_S,   kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4LtU, Lt_U,   kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4GtS, Gt_S,   kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4GtU, Gt_U,   kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4LeS, Le_S,   kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4LeU, Le_U,   kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4GeS, Ge_S,   kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I32x4GeU, Ge_U,   kI32x4, kI32x4)
+MAKE_SIMD_BINARY(I64x2Add, Add,    kI64x2, kI64x2)
+MAKE_SIMD_BINARY(I64x2Sub, Sub,    kI64x2, kI64x2)
+MAKE_SIMD_BINARY(I64x2Mul, Mul,    kI64x2, kI64x2)
+MAKE_SIMD_BINARY(I64x2Eq,  Eq,     kI64x2, kI64x2)
+MAKE_SIMD_BINARY(I64x2Ne,  Ne,     kI64x2, kI64x2)
+MAKE_SIMD_BINARY(F64x2Add, F64Add, kF64x2, kF64x2)
+MAKE_SIMD_BINARY(F64x2Sub, F64Sub, kF64x2, kF64x2)
+MAKE_SIMD_BINARY(F64x2Mul, F64Mul, kF64x2, kF64x2)
+MAKE_SIMD_BINARY(F64x2Div, F64Div, kF64x2, kF64x2)
+MAKE_SIMD_BINARY(F64x2Min, F64Min, kF64x2, kF64x2)
+MAKE_SIMD_BINARY(F64x2Max, F64Max, kF64x2, kF64x2)
+MAKE_SIMD_BINARY(F64x2Eq,  F64Eq,  kF64x2, kI64x2)
+MAKE_SIMD_BINARY(F64x2Ne,  F64Ne,  kF64x2, kI64x2)
+MAKE_SIMD_BINARY(F64x2Lt,  F64Lt,  kF64x2, kI64x2)
+MAKE_SIMD_BINARY(F64x2Gt,  F64Gt,  kF64x2, kI64x2)
+MAKE_SIMD_BINARY(F64x2Le,  F64Le,  kF64x2, kI64x2)
+MAKE_SIMD_BINARY(F64x2Ge,  F64Ge,  kF64x2, kI64x2)
+
+#define MAKE_SIMD_UNARY(wasmOp, irOp, shape) \
+    static void handle_##wasmOp(LowerContext& ctx, const Instr&, size_t) { \
+        simdUnary(ctx, Op::irOp, shape); \
+    }
+
+MAKE_SIMD_UNARY(F64x2Neg,  F64Neg,  kF64x2)
+MAKE_SIMD_UNARY(F64x2Abs,  F64Abs,  kF64x2)
+MAKE_SIMD_UNARY(F64x2Sqrt, F64Sqrt, kF64x2)
+
+static void handle_V128Const(LowerContext& ctx, const Instr& ins, size_t) {
+    int id = simdNew(ctx, Op::V128Const, kI32x4);
+    std::memcpy(ctx.values[id].v128, ins.v128, 16);
+    ctx.stack.push_back(id);
+}
+
+// v128.load / store：4 個 i32 lane，mem_bytes 跟向量化的 load 一樣是每個 lane 的寬度
+static void handle_V128Load(LowerContext& ctx, const Instr& ins, size_t) {
+    int ptr = ctx.safePop();
+    int id = simdNew(ctx, Op::Load, kI32x4);
+    ctx.values[id].lhs = ptr;
+    ctx.values[id].mem_offset = ins.operand;
+    ctx.values[id].mem_bytes = 4;
+    ctx.stack.push_back(id);
+}
+
+static void handle_V128Store(LowerContext& ctx, const Instr& ins, size_t) {
+    int val = ctx.safePop(), ptr = ctx.safePop();
+    val = simdAs(ctx, val, kI32x4);
+    int id = simdNew(ctx, Op::Store, kI32x4);
+    ctx.values[id].lhs = ptr;
+    ctx.values[id].rhs = val;
+    ctx.values[id].mem_offset = ins.operand;
+    ctx.values[id].mem_bytes = 4;
+}
+
+// load32/64_splat、load32/64_zero：純量 load 之後放進 lane
+static void handle_V128LoadLane(LowerContext& ctx, const Instr& ins, size_t) {
+    const bool wide = ins.op == WasmOp::V128Load64Splat || ins.op == WasmOp::V128Load64Zero;
+    const SimdShape s = wide ? kI64x2 : kI32x4;
+    int ptr = ctx.safePop();
+    int x = ctx.newValue(Op::Load);
+    ctx.values[x].lhs = ptr;
+    ctx.values[x].type = s.type;
+    ctx.values[x].mem_offset = ins.operand;
+    ctx.values[x].mem_bytes = wide ? 8 : 4;
+    int id;
+    if (ins.op == WasmOp::V128Load32Splat || ins.op == WasmOp::V128Load64Splat) {
+        id = simdNew(ctx, Op::Splat, s);
+        ctx.values[id].lhs = x;
+    } else {
+        int zero = ctx.newValue(wide ? Op::I64Const : Op::I32Const);
+        ctx.values[zero].type = s.type;
+        id = simdNew(ctx, Op::Pack, s);
+        ctx.values[id].operands.assign(s.lanes, zero);
+        ctx.values[id].operands[0] = x;
+    }
+    ctx.stack.push_back(id);
+}
+
+static SimdShape laneShape(WasmOp op) {
+    switch (op) {
+    case WasmOp::I64x2Splat: case WasmOp::I64x2ExtractLane: case WasmOp::I64x2ReplaceLane:
+        return kI64x2;
+    case WasmOp::F64x2Splat: case WasmOp::F64x2ExtractLane: case WasmOp::F64x2ReplaceLane:
+        return kF64x2;
+    default:
+        return kI32x4;
+    }
+}
+
+static void handle_Splat(LowerContext& ctx, const Instr& ins, size_t) {
+    int x = ctx.safePop();
+    int id = simdNew(ctx, Op::Splat, laneShape(ins.op));
+    ctx.values[id].lhs = x;
+    ctx.stack.push_back(id);
+}
+
+static void handle_ExtractLane(LowerContext& ctx, const Instr& ins, size_t) {
+    const SimdShape s = laneShape(ins.op);
+    int vec = simdAs(ctx, ctx.safePop(), s);
+    int id = ctx.newValue(Op::ExtractLane);
+    ctx.values[id].lhs = vec;
+    ctx.values[id].type = s.type;
+    ctx.values[id].constValue = ins.operand;
+    ctx.stack.push_back(id);
+}
+
+static void handle_ReplaceLane(LowerContext& ctx, const Instr& ins, size_t) {
+    const SimdShape s = laneShape(ins.op);
+    int x = ctx.safePop();
+    int vec = simdAs(ctx, ctx.safePop(), s);
+    int id = simdBinaryNode(ctx, Op::ReplaceLane, vec, x, s);
+    ctx.values[id].constValue = ins.operand;
+    ctx.stack.push_back(id);
+}
+
+static void handle_I8x16Shuffle(LowerContext& ctx, const Instr& ins, size_t) {
+    int b = ctx.safePop(), a = ctx.safePop();
+    a = simdAs(ctx, a, kI32x4);
+    b = simdAs(ctx, b, kI32x4);
+    int id = simdBinaryNode(ctx, Op::Shuffle, a, b, kI32x4);
+    std::memcpy(ctx.values[id].v128, ins.v128, 16);
+    ctx.stack.push_back(id);
+}
+
+static int simdNot(LowerContext& ctx, int a) {
+    int ones = simdNew(ctx, Op::V128Const, kI32x4);
+    std::memset(ctx.values[ones].v128, 0xff, 16);
+    return simdBinaryNode(ctx, Op::Xor, a, ones, kI32x4);
+}
+
+static void handle_V128Not(LowerContext& ctx, const Instr&, size_t) {
+    int a = simdAs(ctx, ctx.safePop(), kI32x4);
+    ctx.stack.push_back(simdNot(ctx, a));
+}
+
+static void handle_V128AndNot(LowerContext& ctx, const Instr&, size_t) {
+    int b = ctx.safePop(), a = ctx.safePop();
+    a = simdAs(ctx, a, kI32x4);
+    b = simdAs(ctx, b, kI32x4);
+    ctx.stack.push_back(simdBinaryNode(ctx, Op::And, a, simdNot(ctx, b), kI32x4));
+}
+
+// v128.bitselect(v1, v2, c) = (v1 & c) | (v2 & ~c)
+static void handle_V128Bitselect(LowerContext& ctx, const Instr&, size_t) {
+    int c = ctx.safePop(), v2 = ctx.safePop(), v1 = ctx.safePop();
+    v1 = simdAs(ctx, v1, kI32x4);
+    v2 = simdAs(ctx, v2, kI32x4);
+    c = simdAs(ctx, c, kI32x4);
+    ctx.stack.push_back(simdSelect(ctx, c, v1, v2, kI32x4));
+}
+
+static void handle_SimdTest(LowerContext& ctx, const Instr& ins, size_t) {
+    int a = simdAs(ctx, ctx.safePop(), kI32x4);
+    int id = ctx.newValue(ins.op == WasmOp::V128AnyTrue ? Op::AnyTrue : Op::AllTrue);
+    ctx.values[id].lhs = a;
+    ctx.stack.push_back(id);
+}
+
+// 移位量是純量：每個 lane 一份，emitter 照 lane 寬度 mask
+static void handle_SimdShift(LowerContext& ctx, const Instr& ins, size_t) {
+    const bool wide = ins.op == WasmOp::I64x2Shl || ins.op == WasmOp::I64x2ShrS || ins.op == WasmOp::I64x2ShrU;
+    const SimdShape s = wide ? kI64x2 : kI32x4;
+    const Op op = (ins.op == WasmOp::I32x4Shl || ins.op == WasmOp::I64x2Shl) ? Op::Shl
+                : (ins.op == WasmOp::I32x4ShrS || ins.op == WasmOp::I64x2ShrS) ? Op::Shr_S : Op::Shr_U;
+    int count = ctx.safePop();
+    int vec = simdAs(ctx, ctx.safePop(), s);
+    int n = simdNew(ctx, Op::Splat, s);
+    ctx.values[n].lhs = count;
+    ctx.stack.push_back(simdBinaryNode(ctx, op, vec, n, s));
+}
+
+static void handle_SimdNeg(LowerContext& ctx, const Instr& ins, size_t) {
+    const SimdShape s = ins.op == WasmOp::I64x2Neg ? kI64x2 : kI32x4;
+    int a = simdAs(ctx, ctx.safePop(), s);
+    ctx.stack.push_back(simdBinaryNode(ctx, Op::Sub, simdSplatConst(ctx, s, 0), a, s));
+}
+
+static void handle_I32x4Abs(LowerContext& ctx, const Instr&, size_t) {
+    int a = simdAs(ctx, ctx.safePop(), kI32x4);
+    int zero = simdSplatConst(ctx, kI32x4, 0);
+    int neg = simdBinaryNode(ctx, Op::Sub, zero, a, kI32x4);
+    int lt = simdBinaryNode(ctx, Op::Lt_S, a, zero, kI32x4);
+    ctx.stack.push_back(simdSelect(ctx, lt, neg, a, kI32x4));
+}
+
+static void handle_I32x4MinMax(LowerContext& ctx, const Instr& ins, size_t) {
+    int b = ctx.safePop(), a = ctx.safePop();
+    a = simdAs(ctx, a, kI32x4);
+    b = simdAs(ctx, b, kI32x4);
+    Op cmp;
+    switch (ins.op) {
+    case WasmOp::I32x4MinS: cmp = Op::Lt_S; break;
+    case WasmOp::I32x4MinU: cmp = Op::Lt_U; break;
+    case WasmOp::I32x4MaxS: cmp = Op::Gt_S; break;
+    default:                cmp = Op::Gt_U; break;
+    }
+    int m = simdBinaryNode(ctx, cmp, a, b, kI32x4);
+    ctx.stack.push_back(simdSelect(ctx, m, a, b, kI32x4));
+}
+
+// f64x2.convert_low_i32x4_s/u：lane 0、1 拿出來，兩個 lane 一起轉
+static void handle_F64x2ConvertLow(LowerContext& ctx, const Instr& ins, size_t) {
+    int a = simdAs(ctx, ctx.safePop(), kI32x4);
+    int lanes[2];
+    for (int l = 0; l < 2; l++) {
+        lanes[l] = ctx.newValue(Op::ExtractLane);
+        ctx.values[lanes[l]].lhs = a;
+        ctx.values[lanes[l]].constValue = l;
+    }
+    int low = simdNew(ctx, Op::Pack, {ValueType::I32, 2});
+    ctx.values[low].operands.assign(lanes, lanes + 2);
+    const Op op = ins.op == WasmOp::F64x2ConvertLowI32x4S ? Op::F64ConvertI32S : Op::F64ConvertI32U;
+    int id = simdNew(ctx, op, kF64x2);
+    ctx.values[id].lhs = low;
+    ctx.stack.push_back(id);
+}
+
 // ============================================================
 // Dispatch Table
 // ============================================================
@@ -710,9 +1081,37 @@ static const std::unordered_map<WasmOp, HandlerFn> kDispatch = {
     { WasmOp::I32TruncF64U,  handle_I32TruncF64U },
     { WasmOp::I64TruncF64S,  handle_I64TruncF64S },
     { WasmOp::I64TruncF64U,  handle_I64TruncF64U },
+    { WasmOp::F64Min,        handle_F64Min },
+    { WasmOp::F64Max,        handle_F64Max },
+    { WasmOp::F32Add,        handle_F32Add },
+    { WasmOp::F32Sub,        handle_F32Sub },
+    { WasmOp::F32Mul,        handle_F32Mul },
+    { WasmOp::F32Div,        handle_F32Div },
+    { WasmOp::F32Min,        handle_F32Min },
+    { WasmOp::F32Max,        handle_F32Max },
+    { WasmOp::F32Abs,        handle_F32Abs },
+    { WasmOp::F32Neg,        handle_F32Neg },
+    { WasmOp::F32Sqrt,       handle_F32Sqrt },
+    { WasmOp::F32Eq,         handle_F32Eq },
+    { WasmOp::F32Ne,         handle_F32Ne },
+    { WasmOp::F32Lt,         handle_F32Lt },
+    { WasmOp::F32Gt,         handle_F32Gt },
+    { WasmOp::F32Le,         handle_F32Le },
+    { WasmOp::F32Ge,         handle_F32Ge },
+    { WasmOp::F32ConvertI32S,handle_F32ConvertI32S },
+    { WasmOp::F32ConvertI32U,handle_F32ConvertI32U },
+    { WasmOp::F32ConvertI64S,handle_F32ConvertI64S },
+    { WasmOp::F32ConvertI64U,handle_F32ConvertI64U },
+    { WasmOp::I32TruncF32S,  handle_I32TruncF32S },
+    { WasmOp::I32TruncF32U,  handle_I32TruncF32U },
+    { WasmOp::I64TruncF32S,  handle_I64TruncF32S },
+    { WasmOp::I64TruncF32U,  handle_I64TruncF32U },
+    { WasmOp::F32DemoteF64,  handle_F32DemoteF64 },
+    { WasmOp::F64PromoteF32, handle_F64PromoteF32 },
     { WasmOp::I32Const,      handle_I32Const },
     { WasmOp::I64Const,      handle_I64Const },
     { WasmOp::F64Const,      handle_F64Const },
+    { WasmOp::F32Const,      handle_F32Const },
     { WasmOp::GlobalGet,     handle_GlobalGet },
     { WasmOp::GlobalSet,     handle_GlobalSet },
     { WasmOp::LocalGet,      handle_LocalGet },
@@ -737,9 +1136,84 @@ static const std::unordered_map<WasmOp, HandlerFn> kDispatch = {
     { WasmOp::I32Load,       handle_Load },
     { WasmOp::I64Load,       handle_Load },
     { WasmOp::F64Load,       handle_F64Load },
+    { WasmOp::F32Load,       handle_F64Load },
     { WasmOp::I32Store,      handle_Store },
     { WasmOp::I64Store,      handle_Store },
     { WasmOp::F64Store,      handle_F64Store },
+    { WasmOp::F32Store,      handle_F64Store },
+    { WasmOp::V128Const,      handle_V128Const },
+    { WasmOp::V128Load,       handle_V128Load },
+    { WasmOp::V128Store,      handle_V128Store },
+    { WasmOp::V128Load32Splat, handle_V128LoadLane },
+    { WasmOp::V128Load64Splat, handle_V128LoadLane },
+    { WasmOp::V128Load32Zero, handle_V128LoadLane },
+    { WasmOp::V128Load64Zero, handle_V128LoadLane },
+    { WasmOp::I32x4Splat,     handle_Splat },
+    { WasmOp::I64x2Splat,     handle_Splat },
+    { WasmOp::F64x2Splat,     handle_Splat },
+    { WasmOp::I32x4ExtractLane, handle_ExtractLane },
+    { WasmOp::I64x2ExtractLane, handle_ExtractLane },
+    { WasmOp::F64x2ExtractLane, handle_ExtractLane },
+    { WasmOp::I32x4ReplaceLane, handle_ReplaceLane },
+    { WasmOp::I64x2ReplaceLane, handle_ReplaceLane },
+    { WasmOp::F64x2ReplaceLane, handle_ReplaceLane },
+    { WasmOp::I8x16Shuffle,   handle_I8x16Shuffle },
+    { WasmOp::V128Not,        handle_V128Not },
+    { WasmOp::V128And,        handle_V128And },
+    { WasmOp::V128Or,         handle_V128Or },
+    { WasmOp::V128Xor,        handle_V128Xor },
+    { WasmOp::V128AndNot,     handle_V128AndNot },
+    { WasmOp::V128Bitselect,  handle_V128Bitselect },
+    { WasmOp::V128AnyTrue,    handle_SimdTest },
+    { WasmOp::I32x4AllTrue,   handle_SimdTest },
+    { WasmOp::I32x4Add,       handle_I32x4Add },
+    { WasmOp::I32x4Sub,       handle_I32x4Sub },
+    { WasmOp::I32x4Mul,       handle_I32x4Mul },
+    { WasmOp::I32x4Neg,       handle_SimdNeg },
+    { WasmOp::I32x4Abs,       handle_I32x4Abs },
+    { WasmOp::I32x4Shl,       handle_SimdShift },
+    { WasmOp::I32x4ShrS,      handle_SimdShift },
+    { WasmOp::I32x4ShrU,      handle_SimdShift },
+    { WasmOp::I32x4Eq,        handle_I32x4Eq },
+    { WasmOp::I32x4Ne,        handle_I32x4Ne },
+    { WasmOp::I32x4LtS,       handle_I32x4LtS },
+    { WasmOp::I32x4LtU,       handle_I32x4LtU },
+    { WasmOp::I32x4GtS,       handle_I32x4GtS },
+    { WasmOp::I32x4GtU,       handle_I32x4GtU },
+    { WasmOp::I32x4LeS,       handle_I32x4LeS },
+    { WasmOp::I32x4LeU,       handle_I32x4LeU },
+    { WasmOp::I32x4GeS,       handle_I32x4GeS },
+    { WasmOp::I32x4GeU,       handle_I32x4GeU },
+    { WasmOp::I32x4MinS,      handle_I32x4MinMax },
+    { WasmOp::I32x4MinU,      handle_I32x4MinMax },
+    { WasmOp::I32x4MaxS,      handle_I32x4MinMax },
+    { WasmOp::I32x4MaxU,      handle_I32x4MinMax },
+    { WasmOp::I64x2Add,       handle_I64x2Add },
+    { WasmOp::I64x2Sub,       handle_I64x2Sub },
+    { WasmOp::I64x2Mul,       handle_I64x2Mul },
+    { WasmOp::I64x2Neg,       handle_SimdNeg },
+    { WasmOp::I64x2Shl,       handle_SimdShift },
+    { WasmOp::I64x2ShrS,      handle_SimdShift },
+    { WasmOp::I64x2ShrU,      handle_SimdShift },
+    { WasmOp::I64x2Eq,        handle_I64x2Eq },
+    { WasmOp::I64x2Ne,        handle_I64x2Ne },
+    { WasmOp::F64x2Add,       handle_F64x2Add },
+    { WasmOp::F64x2Sub,       handle_F64x2Sub },
+    { WasmOp::F64x2Mul,       handle_F64x2Mul },
+    { WasmOp::F64x2Div,       handle_F64x2Div },
+    { WasmOp::F64x2Neg,       handle_F64x2Neg },
+    { WasmOp::F64x2Abs,       handle_F64x2Abs },
+    { WasmOp::F64x2Sqrt,      handle_F64x2Sqrt },
+    { WasmOp::F64x2Min,       handle_F64x2Min },
+    { WasmOp::F64x2Max,       handle_F64x2Max },
+    { WasmOp::F64x2Eq,        handle_F64x2Eq },
+    { WasmOp::F64x2Ne,        handle_F64x2Ne },
+    { WasmOp::F64x2Lt,        handle_F64x2Lt },
+    { WasmOp::F64x2Gt,        handle_F64x2Gt },
+    { WasmOp::F64x2Le,        handle_F64x2Le },
+    { WasmOp::F64x2Ge,        handle_F64x2Ge },
+    { WasmOp::F64x2ConvertLowI32x4S, handle_F64x2ConvertLow },
+    { WasmOp::F64x2ConvertLowI32x4U, handle_F64x2ConvertLow },
     { WasmOp::Unsupported,   handle_Unsupported },
 };
 
@@ -747,7 +1221,7 @@ static const std::unordered_map<WasmOp, HandlerFn> kDispatch = {
 // Cleanup Phase: DCE + degenerate PHI removal
 // ============================================================
 
-static ValueIR cleanupValueIR(ValueIR& values) {
+ValueIR cleanupValueIR(ValueIR& values) {
         // fprintf(stderr, "\n=== Cleanup Phase ===\n");
 
     // Step 1: 找退化 PHI
@@ -777,10 +1251,15 @@ static ValueIR cleanupValueIR(ValueIR& values) {
     for (size_t i = 0; i < values.size(); i++) {
         switch (values[i].op) {
             case Op::Return: case Op::Store: case Op::F64Store:
+            case Op::MemoryFill: case Op::MemoryCopy:
             case Op::Loop: case Op::If: case Op::Else: case Op::End:
             case Op::Br_if: case Op::Br: case Op::LocalSet: case Op::LocalGet:
             case Op::GlobalGet: case Op::GlobalSet:
                 used[i] = true; break;
+            // 結果沒用到的 call 也要留著（void 函式、只為了副作用的呼叫），
+            // 除非 summary 說它什麼都不寫
+            case Op::Call:
+                used[i] = !isRemovableCall(values[i]); break;
             default: break;
         }
     }
@@ -6,3 +6,7 @@
 // 將簡化版 WASM 指令序列 Lower 成你的 SSA IR
 ValueIR lowerWasmToSsa(const InstrSeq& code,
                         const std::vector<std::string>& funcNames = {});
+
+// 退化 PHI 消除 + DCE + 重新編號；lowering 最後會呼叫一次，
+// 之後改寫 ValueIR 的 pass 也用它來收掉被取代的節點。
+ValueIR cleanupValueIR(ValueIR& values);
@@ -142,13 +142,26 @@ std::vector<FunctionResult> readWasmFile(const std::string& filename) {
         // 构建返回结果
         InstrSeq instrSeq;
         instrSeq.push_back({WasmOp::FuncInfo, (int)numParams});  // 第一条指令存储参数数量
-        instrSeq.insert(instrSeq.end(), 
+        // v128 的 local 沒寫過就讀是 0：lowering 預設的 I32Const 0 不是
+        // 向量，開頭先明確地設成 v128.const 0
+        for (wasm::Index j = func->getNumParams(); j < func->getNumLocals(); j++) {
+            if (func->getLocalType(j) != wasm::Type::v128) continue;
+            instrSeq.push_back({WasmOp::V128Const, 0});
+            instrSeq.push_back({WasmOp::LocalSet, (int)j});
+        }
+        for (size_t j = 0; j < numParams; j++)
+            if (func->getLocalType(j) == wasm::Type::v128)
+                fprintf(stderr, "  Warning: v128 parameter %zu is not supported\n", j);
+        if (func->getResults() == wasm::Type::v128)
+            fprintf(stderr, "  Warning: v128 result is not supported\n");
+        instrSeq.insert(instrSeq.end(),
                     converter.instructions.begin(), 
                     converter.instructions.end());
 
         // ✅ 关键：创建 FunctionResult 并添加到 results
         FunctionResult funcResult;
         funcResult.name = funcName;           // ← 保存函数名
+        funcResult.exported = functionExports.count(i) > 0;
         funcResult.numParams = numParams;     // ← 保存参数数量
         funcResult.instructions = instrSeq;   // ← 保存指令序列
         // fprintf(stderr, "DEBUG: filling paramTypes, numParams=%zu\n", func->getNumParams());
@@ -156,8 +169,10 @@ std::vector<FunctionResult> readWasmFile(const std::string& filename) {
             wasm::Type t = func->getLocalType(j);
         // fprintf(stderr, "DEBUG: param[%zu] type=%s\n", j, t.toString().c_str());
             if (t == wasm::Type::i64)      funcResult.paramTypes.push_back(ParamType::I64);
+            else if (t == wasm::Type::f32) funcResult.paramTypes.push_back(ParamType::F32);
             else if (t == wasm::Type::f64) funcResult.paramTypes.push_back(ParamType::F64);
             else                            funcResult.paramTypes.push_back(ParamType::I32);
+            funcResult.paramNames.push_back(func->hasLocalName(j) ? std::string(func->getLocalName(j).str) : "");
         }
         // fprintf(stderr, "DEBUG: paramTypes.size()=%zu\n", funcResult.paramTypes.size());
 
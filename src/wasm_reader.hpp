@@ -4,14 +4,16 @@
 #include <string>
 #include <unordered_map>
 
-enum class ParamType { I32, I64, F64, Other };  // ← 確保在最上面
+enum class ParamType { I32, I64, F32, F64, Other };  // ← 確保在最上面
 
 // 在文件开头添加这个结构体定义
 struct FunctionResult {
     std::string name;        // 函数名
+    bool exported = false;   // name 是 export 名稱（module 外面會呼叫）
     size_t numParams;        // 参数数量
     InstrSeq instructions;   // 指令序列
     std::vector<ParamType> paramTypes;  // 参数类型列表（可选）
+    std::vector<std::string> paramNames;  // name section 的參數名稱（沒有就是空字串）
     std::unordered_map<int, int32_t> globalInitValues;  // ← 新增
 };
 
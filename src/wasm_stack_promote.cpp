@@ -0,0 +1,467 @@
+#include "wasm_stack_promote.hpp"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+
+// ============================================================
+// Shadow-stack slot promotion（InstrSeq 層級 pre-pass）
+// ============================================================
+//
+// clang -O0 產生的 kernel 長這樣：
+//
+//   global.get $__stack_pointer      ; prologue：F = SP - 32
+//   local.set 4
+//   i32.const 32
+//   local.set 5
+//   local.get 4
+//   local.get 5
+//   i32.sub
+//   local.set 6                      ; F
+//   local.get 6
+//   local.get 0
+//   i32.store offset=28              ; 指標參數 A 存進 frame
+//   ...
+//   local.get 6
+//   i32.load offset=12               ; 每次讀 i 都重新 load
+//
+// 所有 IV、指標參數都在記憶體裡，loop phi 幾乎不存在，後面的 alias
+// analysis / LICM 類優化也全部被記憶體存取擋住。這裡把符合條件的
+// slot 直接改寫成新的 wasm local：
+//
+//   local.get F; i32.load K          →  local.get S_K
+//   local.get F; <expr>; i32.store K  →  <expr>; local.set S_K
+//
+// 條件（任何一項不成立就保守地不提升）：
+//   1. frame base F 是 prologue 裡由 `global.get sp - 常數` 算出、整個
+//      函式只被賦值一次的 local。
+//   2. F 沒有逃逸：每一個 `local.get F` 都是上面兩種直接存取形狀，或是
+//      寫回 SP 的 `global.set`（非 leaf 函式的 SP 更新 / 還原）。只要
+//      F 被拿去做位址運算（stack 上的陣列）、傳給 call、存進記憶體，
+//      就整個 frame 都不提升。
+//   3. 這個 slot 的每一次存取都是 offset 完全相同的 4-byte i32
+//      load/store（mem_bytes == 4），沒有其他寬度的存取跟它重疊。
+//   4. 提升後 wasm_lower 的 SSA 構造處理得正確（見下方 hazard 檢查）。
+
+namespace {
+
+struct SymVal {
+    enum Kind { Unknown, Const, SpRel } kind = Unknown;
+    int global = -1;
+    int64_t value = 0;
+};
+
+struct SlotAccess {
+    size_t addrPos;   // 提供位址的 `local.get F` 位置
+    size_t pos;       // load / store 指令的位置
+    int64_t offset;   // 相對 SP 的 byte offset
+    int bytes;        // 0 = 寬度未知
+    bool isStore;
+    bool isI32;
+};
+
+// 直線段指令的 stack 效果；控制流、call（回傳值個數未知）回傳 false
+bool stackEffect(const Instr& ins, int& pops, int& pushes) {
+    switch (ins.op) {
+    case WasmOp::LocalGet: case WasmOp::GlobalGet: case WasmOp::MemorySize:
+    case WasmOp::I32Const: case WasmOp::I64Const: case WasmOp::F64Const: case WasmOp::F32Const:
+        pops = 0; pushes = 1; return true;
+    case WasmOp::LocalSet: case WasmOp::GlobalSet: case WasmOp::Drop:
+        pops = 1; pushes = 0; return true;
+    case WasmOp::LocalTee:
+    case WasmOp::I32Eqz: case WasmOp::I32Clz: case WasmOp::I32Ctz: case WasmOp::I32Popcnt:
+    case WasmOp::I64Eqz: case WasmOp::I64Clz: case WasmOp::I64Ctz: case WasmOp::I64Popcnt:
+    case WasmOp::F64Abs: case WasmOp::F64Neg: case WasmOp::F64Sqrt:
+    case WasmOp::F64Exp: case WasmOp::F64Log: case WasmOp::F64Sin: case WasmOp::F64Cos:
+    case WasmOp::F64ConvertI32S: case WasmOp::F64ConvertI32U:
+    case WasmOp::I32TruncF64S: case WasmOp::I32TruncF64U:
+    case WasmOp::I32WrapI64: case WasmOp::I64ExtendI32S: case WasmOp::I64ExtendI32U:
+    case WasmOp::F64ConvertI64S: case WasmOp::F64ConvertI64U:
+    case WasmOp::I64TruncF64S: case WasmOp::I64TruncF64U:
+    case WasmOp::F32Abs: case WasmOp::F32Neg: case WasmOp::F32Sqrt:
+    case WasmOp::F32ConvertI32S: case WasmOp::F32ConvertI32U:
+    case WasmOp::F32ConvertI64S: case WasmOp::F32ConvertI64U:
+    case WasmOp::I32TruncF32S: case WasmOp::I32TruncF32U:
+    case WasmOp::I64TruncF32S: case WasmOp::I64TruncF32U:
+    case WasmOp::F32DemoteF64: case WasmOp::F64PromoteF32:
+    case WasmOp::I32Load: case WasmOp::F64Load: case WasmOp::I64Load: case WasmOp::F32Load:
+        pops = 1; pushes = 1; return true;
+    case WasmOp::I32Store: case WasmOp::F64Store: case WasmOp::I64Store: case WasmOp::F32Store:
+        pops = 2; pushes = 0; return true;
+    case WasmOp::Select:
+        pops = 3; pushes = 1; return true;
+    case WasmOp::MemoryCopy: case WasmOp::MemoryFill:
+        pops = 3; pushes = 0; return true;
+    default:
+        break;
+    }
+    if ((ins.op >= WasmOp::I32Add && ins.op <= WasmOp::I32GeU) ||
+        (ins.op >= WasmOp::I32And && ins.op <= WasmOp::I32Rotr) ||
+        (ins.op >= WasmOp::F64Add && ins.op <= WasmOp::F64Div) ||
+        ins.op == WasmOp::F64Pow || ins.op == WasmOp::F64Min || ins.op == WasmOp::F64Max ||
+        (ins.op >= WasmOp::F64Eq && ins.op <= WasmOp::F64Ge) ||
+        (ins.op >= WasmOp::F32Add && ins.op <= WasmOp::F32Div) ||
+        (ins.op >= WasmOp::F32Min && ins.op <= WasmOp::F32Ge) ||
+        (ins.op >= WasmOp::I64Add && ins.op <= WasmOp::I64RemU) ||
+        (ins.op >= WasmOp::I64And && ins.op <= WasmOp::I64ShrU) ||
+        (ins.op >= WasmOp::I64Eq && ins.op <= WasmOp::I64GeU)) {
+        pops = 2; pushes = 1;
+        return true;
+    }
+    return false;
+}
+
+// code[k] 是 `local.get F`：往後模擬 stack，找出把它當位址吃掉的 store。
+// 中間必須是直線段的完整 value 運算式（binaryen 會把 -O0 的
+// `local.get F; <expr>; i32.store` 讀成這種樹狀順序），遇到控制流、
+// call、或 F 被 store 以外的指令吃掉都回傳 false。
+bool findStoreConsumer(const std::vector<Instr>& code, size_t k, size_t& storePos) {
+    int above = 0;   // F 上面還有幾個值
+    for (size_t j = k + 1; j < code.size(); j++) {
+        int pops, pushes;
+        if (!stackEffect(code[j], pops, pushes)) return false;
+        if (pops > above) {
+            bool isStore = code[j].op == WasmOp::I32Store || code[j].op == WasmOp::F64Store ||
+                           code[j].op == WasmOp::F32Store;
+            if (!isStore || above != 1) return false;
+            storePos = j;
+            return true;
+        }
+        above += pushes - pops;
+    }
+    return false;
+}
+
+// 跑過 prologue 的直線段，找出「值 = SP - 常數」的 local。
+// 遇到第一個不在白名單內的指令就停（prologue 只需要這幾種）。
+std::unordered_map<int, int64_t> findFrameLocals(const std::vector<Instr>& code,
+                                                  size_t numParams) {
+    std::unordered_map<int, SymVal> sym;
+    std::vector<SymVal> st;
+    auto pop = [&]() {
+        if (st.empty()) return SymVal{};
+        SymVal v = st.back();
+        st.pop_back();
+        return v;
+    };
+
+    bool stop = false;
+    for (size_t k = 1; k < code.size() && !stop; k++) {
+        const Instr& ins = code[k];
+        switch (ins.op) {
+        case WasmOp::LocalGet: {
+            auto it = sym.find(ins.operand);
+            st.push_back(it != sym.end() ? it->second : SymVal{});
+            break;
+        }
+        case WasmOp::LocalSet: sym[ins.operand] = pop(); break;
+        case WasmOp::LocalTee: sym[ins.operand] = st.empty() ? SymVal{} : st.back(); break;
+        case WasmOp::I32Const: {
+            SymVal v; v.kind = SymVal::Const; v.value = ins.operand;
+            st.push_back(v);
+            break;
+        }
+        case WasmOp::GlobalGet: {
+            SymVal v;
+            if (ins.operand == kStackPointerGlobal) {
+                v.kind = SymVal::SpRel;
+                v.global = ins.operand;
+            }
+            st.push_back(v);
+            break;
+        }
+        case WasmOp::I32Add:
+        case WasmOp::I32Sub: {
+            SymVal b = pop(), a = pop(), r;
+            bool sub = ins.op == WasmOp::I32Sub;
+            if (a.kind == SymVal::SpRel && b.kind == SymVal::Const) {
+                r = a;
+                r.value = sub ? a.value - b.value : a.value + b.value;
+            } else if (!sub && a.kind == SymVal::Const && b.kind == SymVal::SpRel) {
+                r = b;
+                r.value = a.value + b.value;
+            }
+            st.push_back(r);
+            break;
+        }
+        case WasmOp::GlobalSet: pop(); break;
+        case WasmOp::I32Store:
+        case WasmOp::F64Store:
+        case WasmOp::F32Store: pop(); pop(); break;
+        default: stop = true; break;
+        }
+    }
+
+    // 只被賦值一次（就是 prologue 那一次）的才算 frame base
+    std::unordered_map<int, int> assignCount;
+    for (const auto& ins : code)
+        if (ins.op == WasmOp::LocalSet || ins.op == WasmOp::LocalTee)
+            assignCount[ins.operand]++;
+
+    std::unordered_map<int, int64_t> frame;
+    int global = -1;
+    for (auto& [idx, v] : sym) {
+        if (v.kind != SymVal::SpRel || v.value >= 0) continue;
+        if (idx < (int)numParams || assignCount[idx] != 1) continue;
+        if (global >= 0 && v.global != global) return {};
+        global = v.global;
+        frame[idx] = v.value;
+    }
+    return frame;
+}
+
+// 結構化控制流的配對資訊 + 每個指令的後繼（給 liveness 用）
+struct Structure {
+    std::vector<int> match;      // Block/Loop/If -> End，End -> 開頭，Else -> If
+    std::vector<int> elsePos;    // If -> Else（沒有則 -1）
+    std::vector<std::vector<int>> succ;
+};
+
+Structure buildStructure(const std::vector<Instr>& code) {
+    size_t n = code.size();
+    Structure s;
+    s.match.assign(n, -1);
+    s.elsePos.assign(n, -1);
+    s.succ.resize(n);
+
+    std::vector<int> open;
+    for (size_t k = 0; k < n; k++) {
+        WasmOp op = code[k].op;
+        if (op == WasmOp::Block || op == WasmOp::Loop || op == WasmOp::If) {
+            open.push_back((int)k);
+        } else if (op == WasmOp::Else && !open.empty()) {
+            s.elsePos[open.back()] = (int)k;
+            s.match[k] = open.back();
+        } else if (op == WasmOp::End && !open.empty()) {
+            s.match[open.back()] = (int)k;
+            s.match[k] = open.back();
+            open.pop_back();
+        }
+    }
+
+    open.clear();
+    auto target = [&](int depth) -> int {
+        if (depth < 0 || depth >= (int)open.size()) return -1;   // 函式層級 = 離開函式
+        int c = open[open.size() - 1 - depth];
+        return code[c].op == WasmOp::Loop ? c : s.match[c];
+    };
+    auto add = [&](size_t k, int t) {
+        if (t >= 0 && t < (int)n) s.succ[k].push_back(t);
+    };
+
+    for (size_t k = 0; k < n; k++) {
+        const Instr& ins = code[k];
+        switch (ins.op) {
+        case WasmOp::Block:
+        case WasmOp::Loop:
+            add(k, (int)k + 1);
+            open.push_back((int)k);
+            break;
+        case WasmOp::If:
+            add(k, (int)k + 1);
+            add(k, s.elsePos[k] >= 0 ? s.elsePos[k] + 1 : s.match[k]);
+            open.push_back((int)k);
+            break;
+        case WasmOp::Else:
+            add(k, s.match[k] >= 0 ? s.match[s.match[k]] : -1);
+            break;
+        case WasmOp::End:
+            add(k, (int)k + 1);
+            if (!open.empty()) open.pop_back();
+            break;
+        case WasmOp::Br:
+            add(k, target(ins.operand));
+            break;
+        case WasmOp::Br_if:
+            add(k, (int)k + 1);
+            add(k, target(ins.operand));
+            break;
+        case WasmOp::BrTable:
+            // converter 只記下 default label，保守地視為可以跳到任何外層 label
+            for (int d = 0; d < (int)open.size(); d++) add(k, target(d));
+            break;
+        case WasmOp::Return:
+        case WasmOp::Unreachable:
+            break;
+        default:
+            add(k, (int)k + 1);
+            break;
+        }
+    }
+    return s;
+}
+
+}  // namespace
+
+InstrSeq promoteShadowStackSlots(const InstrSeq& in, int* promotedCount) {
+    if (promotedCount) *promotedCount = 0;
+    const std::vector<Instr>& code = in.instructions;
+    size_t n = code.size();
+    if (n < 2 || code[0].op != WasmOp::FuncInfo) return in;
+
+    auto frame = findFrameLocals(code, in.numParams);
+    if (frame.empty()) return in;
+
+    // ---- Step 1: 收集所有 frame 存取，同時做逃逸分析 ----
+    std::vector<SlotAccess> accesses;
+    for (size_t k = 1; k < n; k++) {
+        if (code[k].op != WasmOp::LocalGet) continue;
+        auto fit = frame.find(code[k].operand);
+        if (fit == frame.end()) continue;
+        int64_t base = fit->second;
+
+        const Instr* next = k + 1 < n ? &code[k + 1] : nullptr;
+        const Instr* next2 = k + 2 < n ? &code[k + 2] : nullptr;
+        if (next && (next->op == WasmOp::I32Load || next->op == WasmOp::F64Load ||
+                     next->op == WasmOp::F32Load)) {
+            accesses.push_back({k, k + 1, base + next->operand, next->mem_bytes,
+                                false, next->op == WasmOp::I32Load});
+            continue;
+        }
+        size_t storePos;
+        if (findStoreConsumer(code, k, storePos)) {
+            const Instr& store = code[storePos];
+            accesses.push_back({k, storePos, base + store.operand, store.mem_bytes,
+                                true, store.op == WasmOp::I32Store});
+            continue;
+        }
+        // SP 更新 / 還原：local.get F; global.set g  或  local.get F; i32.const c; i32.add; global.set g
+        if (next && next->op == WasmOp::GlobalSet) continue;
+        if (k + 3 < n && next->op == WasmOp::I32Const && next2->op == WasmOp::I32Add &&
+            code[k + 3].op == WasmOp::GlobalSet) continue;
+        return in;   // frame 逃逸
+    }
+
+    // ---- Step 2: 找出只被 4-byte i32 存取、沒有重疊的 slot ----
+    std::map<int64_t, int> slotIndex;     // SP 相對 offset -> slot 編號
+    for (const auto& a : accesses) {
+        if (!a.isI32 || a.bytes != 4 || slotIndex.count(a.offset)) continue;
+        bool ok = true;
+        for (const auto& b : accesses) {
+            int bytes = b.bytes > 0 ? b.bytes : 8;
+            bool overlap = b.offset < a.offset + 4 && a.offset < b.offset + bytes;
+            if (overlap && (!b.isI32 || b.bytes != 4 || b.offset != a.offset)) { ok = false; break; }
+        }
+        if (ok) slotIndex[a.offset] = (int)slotIndex.size();
+    }
+    if (slotIndex.empty()) return in;
+
+    size_t nslots = slotIndex.size();
+    std::vector<int> accSlot(n, -1);      // 指令位置 -> slot
+    std::vector<bool> accIsStore(n, false);
+    std::vector<size_t> accAddrPos(n, 0);
+    for (const auto& a : accesses) {
+        auto it = slotIndex.find(a.offset);
+        if (it == slotIndex.end()) continue;
+        accSlot[a.pos] = it->second;
+        accIsStore[a.pos] = a.isStore;
+        accAddrPos[a.pos] = a.addrPos;
+    }
+
+    // ---- Step 3: liveness（以 slot 為單位的 backward dataflow）----
+    Structure st = buildStructure(code);
+    size_t W = (nslots + 63) / 64;
+    std::vector<uint64_t> liveIn(n * W, 0);
+    auto bit = [](int s) { return (uint64_t)1 << (s % 64); };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t k = n; k-- > 0;) {
+            for (size_t w = 0; w < W; w++) {
+                uint64_t out = 0;
+                for (int s : st.succ[k]) out |= liveIn[s * W + w];
+                uint64_t in = out;
+                if (accSlot[k] >= 0 && (size_t)accSlot[k] / 64 == w) {
+                    if (accIsStore[k]) in &= ~bit(accSlot[k]);
+                    else in |= bit(accSlot[k]);
+                }
+                if (in != liveIn[k * W + w]) { liveIn[k * W + w] = in; changed = true; }
+            }
+        }
+    }
+    auto liveAt = [&](int pos, int s) {
+        return (liveIn[pos * W + s / 64] & bit(s)) != 0;
+    };
+
+    // ---- Step 4: hazard 檢查 ----
+    // wasm_lower 對 loop 的 SSA 構造有兩個前提，提升後的 slot 必須滿足：
+    //
+    //  (a) loop 結束之後，local 的值取的是 body 裡最後一次賦值的 SSA
+    //      value，而不是 exit 那一刻的 phi。top-test 迴圈跑 0 次、或從
+    //      body 中間 break 時這個值是錯的，所以在 loop 內被寫、又在
+    //      loop 的任何出口目標處 live 的 slot 不能提升。
+    //  (b) scanLoopBody 只在「depth 1 上先讀後寫」時才建 loop phi；只在
+    //      巢狀 If 內被改寫、又跨 iteration 存活的 local 會遺失 carry，
+    //      這種 slot 也不能提升（留在記憶體裡語意一定正確）。
+    std::vector<bool> unsafe(nslots, false);
+    for (size_t l = 0; l < n; l++) {
+        if (code[l].op != WasmOp::Loop || st.match[l] < 0) continue;
+        size_t e = (size_t)st.match[l];
+
+        std::vector<bool> written(nslots, false), readFirst(nslots, false), writtenD1(nslots, false);
+        int depth = 1;
+        for (size_t k = l + 1; k < e; k++) {
+            WasmOp op = code[k].op;
+            if (op == WasmOp::Block || op == WasmOp::Loop || op == WasmOp::If) depth++;
+            else if (op == WasmOp::End) depth--;
+            int s = accSlot[k];
+            if (s < 0) continue;
+            if (accIsStore[k]) {
+                written[s] = true;
+                if (depth == 1) writtenD1[s] = true;
+            } else if (depth == 1 && !writtenD1[s]) {
+                readFirst[s] = true;
+            }
+        }
+
+        for (size_t k = l + 1; k < e; k++) {
+            for (int t : st.succ[k]) {
+                if (t <= (int)e) continue;   // 還在 loop 裡
+                for (size_t s = 0; s < nslots; s++)
+                    if (written[s] && liveAt(t, (int)s)) unsafe[s] = true;
+            }
+        }
+        for (size_t s = 0; s < nslots; s++)
+            if (written[s] && liveAt((int)l, (int)s) && !readFirst[s]) unsafe[s] = true;
+    }
+
+    // ---- Step 5: 分配新的 local 編號並改寫 ----
+    int maxLocal = (int)in.numParams - 1;
+    for (const auto& ins : code)
+        if (ins.op == WasmOp::LocalGet || ins.op == WasmOp::LocalSet || ins.op == WasmOp::LocalTee)
+            maxLocal = std::max(maxLocal, ins.operand);
+
+    std::vector<int> newLocal(nslots, -1);
+    int next = maxLocal + 1;
+    int count = 0;
+    for (size_t s = 0; s < nslots; s++) {
+        // idx >= 2000 在 ir_bridge 裡被當成 wasm_global_N，不能撞上
+        if (unsafe[s] || next >= 2000) continue;
+        newLocal[s] = next++;
+        count++;
+    }
+    if (count == 0) return in;
+
+    // load：`local.get F; load K` → `local.get S`
+    // store：`local.get F; <expr>; store K` → `<expr>; local.set S`
+    std::vector<bool> drop(n, false);
+    for (size_t k = 0; k < n; k++)
+        if (accSlot[k] >= 0 && newLocal[accSlot[k]] >= 0) drop[accAddrPos[k]] = true;
+
+    InstrSeq out;
+    out.numParams = in.numParams;
+    for (size_t k = 0; k < n; k++) {
+        if (drop[k]) continue;
+        if (accSlot[k] >= 0 && newLocal[accSlot[k]] >= 0) {
+            Instr ins;
+            ins.op = accIsStore[k] ? WasmOp::LocalSet : WasmOp::LocalGet;
+            ins.operand = newLocal[accSlot[k]];
+            out.push_back(ins);
+            continue;
+        }
+        out.push_back(code[k]);
+    }
+    if (promotedCount) *promotedCount = count;
+    return out;
+}
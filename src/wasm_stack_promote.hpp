@@ -0,0 +1,12 @@
+#pragma once
+
+#include "wasm_instr.hpp"
+
+// clang -O0 把每個 C 區域變數（含指標參數、迴圈 IV）都放在 shadow stack
+// frame 上，每次存取都是 `local.get F; i32.load/store offset=K`。這個
+// pre-pass 在 lowering 之前，把「frame 沒有逃逸、只被 4-byte i32 存取、
+// 提升後 SSA lowering 處理得了」的 slot 改寫成新的 wasm local，讓後面的
+// lowering 直接走既有的 local SSA 前向替換 / loop phi 路徑。
+//
+// 回傳改寫後的指令序列；promotedCount（可為 nullptr）回傳被提升的 slot 數。
+InstrSeq promoteShadowStackSlots(const InstrSeq& code, int* promotedCount = nullptr);
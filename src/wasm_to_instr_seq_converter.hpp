@@ -50,8 +50,14 @@ public:
     void visitLoad(Load* n) {
         visitExpression(n->ptr);
         Instr instr;
-        instr.op = (n->type == Type::f64) ? WasmOp::F64Load : WasmOp::I32Load;
+        instr.op = (n->type == Type::f64) ? WasmOp::F64Load
+                 : (n->type == Type::f32) ? WasmOp::F32Load
+                 : (n->type == Type::v128) ? WasmOp::V128Load : WasmOp::I32Load;
         instr.operand = (int)n->offset;
+        // i64 / sub-word load 目前也被收成 I32Load，記下真正的寬度，
+        // 讓需要精確知道存取範圍的 pass（shadow-stack slot promotion）
+        // 可以分辨。
+        instr.mem_bytes = (int)n->bytes;
         instructions.push_back(instr);
     }
 
@@ -66,6 +72,13 @@ public:
         } else if (n->type == Type::f64) {
             instr.op = WasmOp::F64Const;
             instr.foperand = n->value.getf64();
+        } else if (n->type == Type::f32) {
+            instr.op = WasmOp::F32Const;
+            instr.foperand = n->value.getf32();
+        } else if (n->type == Type::v128) {
+            instr.op = WasmOp::V128Const;
+            auto bytes = n->value.getv128();
+            for (int k = 0; k < 16; k++) instr.v128[k] = bytes[k];
         } else {
             fprintf(stderr, "Warning: Unsupported const type\n");
             return;
@@ -86,15 +99,21 @@ public:
         visitExpression(n->ptr);
         visitExpression(n->value);
         Instr instr;
-        instr.op = (n->valueType == Type::f64) ? WasmOp::F64Store : WasmOp::I32Store;
+        instr.op = (n->valueType == Type::f64) ? WasmOp::F64Store
+                 : (n->valueType == Type::f32) ? WasmOp::F32Store
+                 : (n->valueType == Type::v128) ? WasmOp::V128Store : WasmOp::I32Store;
         instr.operand = (int)n->offset;
+        instr.mem_bytes = (int)n->bytes;
         instructions.push_back(instr);
     }
 
     void visitBinary(Binary* n) {
         visitExpression(n->left);
         visitExpression(n->right);
-        instructions.push_back({binaryOpToWasmOp(n->op), 0});
+        WasmOp op = binaryOpToWasmOp(n->op);
+        if (op == WasmOp::Unsupported && n->type == Type::v128)
+            fprintf(stderr, "Warning: Unsupported SIMD binary op: %d\n", n->op);
+        instructions.push_back({op, 0});
     }
 
     void visitUnary(Unary* n) {
@@ -105,6 +124,84 @@ public:
         instructions.push_back({op, 0});
     }
 
+    // ---- SIMD（v128）：只接 i32x4 / i64x2 / f64x2 ----
+    void visitSIMDExtract(SIMDExtract* n) {
+        visitExpression(n->vec);
+        WasmOp op = n->op == ExtractLaneVecI32x4 ? WasmOp::I32x4ExtractLane
+                  : n->op == ExtractLaneVecI64x2 ? WasmOp::I64x2ExtractLane
+                  : n->op == ExtractLaneVecF64x2 ? WasmOp::F64x2ExtractLane : WasmOp::Unsupported;
+        if (op == WasmOp::Unsupported)
+            fprintf(stderr, "Warning: Unsupported SIMD extract op: %d\n", n->op);
+        instructions.push_back({op, (int)n->index});
+    }
+
+    void visitSIMDReplace(SIMDReplace* n) {
+        visitExpression(n->vec);
+        visitExpression(n->value);
+        WasmOp op = n->op == ReplaceLaneVecI32x4 ? WasmOp::I32x4ReplaceLane
+                  : n->op == ReplaceLaneVecI64x2 ? WasmOp::I64x2ReplaceLane
+                  : n->op == ReplaceLaneVecF64x2 ? WasmOp::F64x2ReplaceLane : WasmOp::Unsupported;
+        if (op == WasmOp::Unsupported)
+            fprintf(stderr, "Warning: Unsupported SIMD replace op: %d\n", n->op);
+        instructions.push_back({op, (int)n->index});
+    }
+
+    void visitSIMDShuffle(SIMDShuffle* n) {
+        visitExpression(n->left);
+        visitExpression(n->right);
+        Instr instr;
+        instr.op = WasmOp::I8x16Shuffle;
+        for (int k = 0; k < 16; k++) instr.v128[k] = n->mask[k];
+        instructions.push_back(instr);
+    }
+
+    void visitSIMDTernary(SIMDTernary* n) {
+        visitExpression(n->a);
+        visitExpression(n->b);
+        visitExpression(n->c);
+        WasmOp op = n->op == Bitselect ? WasmOp::V128Bitselect : WasmOp::Unsupported;
+        if (op == WasmOp::Unsupported)
+            fprintf(stderr, "Warning: Unsupported SIMD ternary op: %d\n", n->op);
+        instructions.push_back({op, 0});
+    }
+
+    void visitSIMDShift(SIMDShift* n) {
+        visitExpression(n->vec);
+        visitExpression(n->shift);
+        WasmOp op;
+        switch (n->op) {
+            case ShlVecI32x4:  op = WasmOp::I32x4Shl; break;
+            case ShrSVecI32x4: op = WasmOp::I32x4ShrS; break;
+            case ShrUVecI32x4: op = WasmOp::I32x4ShrU; break;
+            case ShlVecI64x2:  op = WasmOp::I64x2Shl; break;
+            case ShrSVecI64x2: op = WasmOp::I64x2ShrS; break;
+            case ShrUVecI64x2: op = WasmOp::I64x2ShrU; break;
+            default:
+                fprintf(stderr, "Warning: Unsupported SIMD shift op: %d\n", n->op);
+                op = WasmOp::Unsupported;
+                break;
+        }
+        instructions.push_back({op, 0});
+    }
+
+    void visitSIMDLoad(SIMDLoad* n) {
+        visitExpression(n->ptr);
+        Instr instr;
+        switch (n->op) {
+            case Load32SplatVec128: instr.op = WasmOp::V128Load32Splat; break;
+            case Load64SplatVec128: instr.op = WasmOp::V128Load64Splat; break;
+            case Load32ZeroVec128:  instr.op = WasmOp::V128Load32Zero; break;
+            case Load64ZeroVec128:  instr.op = WasmOp::V128Load64Zero; break;
+            default:
+                fprintf(stderr, "Warning: Unsupported SIMD load op: %d\n", n->op);
+                instr.op = WasmOp::Unsupported;
+                break;
+        }
+        instr.operand = (int)n->offset;
+        instr.mem_bytes = (int)n->getMemBytes();
+        instructions.push_back(instr);
+    }
+
     void visitSelect(Select* n) {
         visitExpression(n->ifFalse);
         visitExpression(n->ifTrue);
@@ -300,6 +397,66 @@ public:
             case MinFloat64: return WasmOp::F64Min;
             case MaxFloat64: return WasmOp::F64Max;
 
+            // f32
+            case AddFloat32: return WasmOp::F32Add;
+            case SubFloat32: return WasmOp::F32Sub;
+            case MulFloat32: return WasmOp::F32Mul;
+            case DivFloat32: return WasmOp::F32Div;
+            case MinFloat32: return WasmOp::F32Min;
+            case MaxFloat32: return WasmOp::F32Max;
+            case EqFloat32:  return WasmOp::F32Eq;
+            case NeFloat32:  return WasmOp::F32Ne;
+            case LtFloat32:  return WasmOp::F32Lt;
+            case GtFloat32:  return WasmOp::F32Gt;
+            case LeFloat32:  return WasmOp::F32Le;
+            case GeFloat32:  return WasmOp::F32Ge;
+
+            // v128 位元
+            case AndVec128:     return WasmOp::V128And;
+            case OrVec128:      return WasmOp::V128Or;
+            case XorVec128:     return WasmOp::V128Xor;
+            case AndNotVec128:  return WasmOp::V128AndNot;
+
+            // i32x4
+            case AddVecI32x4:   return WasmOp::I32x4Add;
+            case SubVecI32x4:   return WasmOp::I32x4Sub;
+            case MulVecI32x4:   return WasmOp::I32x4Mul;
+            case EqVecI32x4:    return WasmOp::I32x4Eq;
+            case NeVecI32x4:    return WasmOp::I32x4Ne;
+            case LtSVecI32x4:   return WasmOp::I32x4LtS;
+            case LtUVecI32x4:   return WasmOp::I32x4LtU;
+            case GtSVecI32x4:   return WasmOp::I32x4GtS;
+            case GtUVecI32x4:   return WasmOp::I32x4GtU;
+            case LeSVecI32x4:   return WasmOp::I32x4LeS;
+            case LeUVecI32x4:   return WasmOp::I32x4LeU;
+            case GeSVecI32x4:   return WasmOp::I32x4GeS;
+            case GeUVecI32x4:   return WasmOp::I32x4GeU;
+            case MinSVecI32x4:  return WasmOp::I32x4MinS;
+            case MinUVecI32x4:  return WasmOp::I32x4MinU;
+            case MaxSVecI32x4:  return WasmOp::I32x4MaxS;
+            case MaxUVecI32x4:  return WasmOp::I32x4MaxU;
+
+            // i64x2
+            case AddVecI64x2:   return WasmOp::I64x2Add;
+            case SubVecI64x2:   return WasmOp::I64x2Sub;
+            case MulVecI64x2:   return WasmOp::I64x2Mul;
+            case EqVecI64x2:    return WasmOp::I64x2Eq;
+            case NeVecI64x2:    return WasmOp::I64x2Ne;
+
+            // f64x2
+            case AddVecF64x2:   return WasmOp::F64x2Add;
+            case SubVecF64x2:   return WasmOp::F64x2Sub;
+            case MulVecF64x2:   return WasmOp::F64x2Mul;
+            case DivVecF64x2:   return WasmOp::F64x2Div;
+            case MinVecF64x2:   return WasmOp::F64x2Min;
+            case MaxVecF64x2:   return WasmOp::F64x2Max;
+            case EqVecF64x2:    return WasmOp::F64x2Eq;
+            case NeVecF64x2:    return WasmOp::F64x2Ne;
+            case LtVecF64x2:    return WasmOp::F64x2Lt;
+            case GtVecF64x2:    return WasmOp::F64x2Gt;
+            case LeVecF64x2:    return WasmOp::F64x2Le;
+            case GeVecF64x2:    return WasmOp::F64x2Ge;
+
             default: return WasmOp::Unsupported;
         }
     }
@@ -340,6 +497,37 @@ public:
             case TruncSFloat64ToInt32:   return WasmOp::I32TruncF64S;
             case TruncUFloat64ToInt32:   return WasmOp::I32TruncF64U;
 
+            // f32
+            case AbsFloat32:  return WasmOp::F32Abs;
+            case NegFloat32:  return WasmOp::F32Neg;
+            case SqrtFloat32: return WasmOp::F32Sqrt;
+            case ConvertSInt32ToFloat32: return WasmOp::F32ConvertI32S;
+            case ConvertUInt32ToFloat32: return WasmOp::F32ConvertI32U;
+            case ConvertSInt64ToFloat32: return WasmOp::F32ConvertI64S;
+            case ConvertUInt64ToFloat32: return WasmOp::F32ConvertI64U;
+            case TruncSFloat32ToInt32:   return WasmOp::I32TruncF32S;
+            case TruncUFloat32ToInt32:   return WasmOp::I32TruncF32U;
+            case TruncSFloat32ToInt64:   return WasmOp::I64TruncF32S;
+            case TruncUFloat32ToInt64:   return WasmOp::I64TruncF32U;
+            case DemoteFloat64:          return WasmOp::F32DemoteF64;
+            case PromoteFloat32:         return WasmOp::F64PromoteF32;
+
+            // SIMD
+            case SplatVecI32x4:   return WasmOp::I32x4Splat;
+            case SplatVecI64x2:   return WasmOp::I64x2Splat;
+            case SplatVecF64x2:   return WasmOp::F64x2Splat;
+            case NotVec128:       return WasmOp::V128Not;
+            case AnyTrueVec128:   return WasmOp::V128AnyTrue;
+            case NegVecI32x4:     return WasmOp::I32x4Neg;
+            case AbsVecI32x4:     return WasmOp::I32x4Abs;
+            case AllTrueVecI32x4: return WasmOp::I32x4AllTrue;
+            case NegVecI64x2:     return WasmOp::I64x2Neg;
+            case NegVecF64x2:     return WasmOp::F64x2Neg;
+            case AbsVecF64x2:     return WasmOp::F64x2Abs;
+            case SqrtVecF64x2:    return WasmOp::F64x2Sqrt;
+            case ConvertLowSVecI32x4ToVecF64x2: return WasmOp::F64x2ConvertLowI32x4S;
+            case ConvertLowUVecI32x4ToVecF64x2: return WasmOp::F64x2ConvertLowI32x4U;
+
             default: return WasmOp::Unsupported;
         }
     }
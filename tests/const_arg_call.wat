@@ -0,0 +1,31 @@
+(module
+  (memory 1)
+  (func $scale (param $x i32) (param $n i32) (result i32)
+    local.get $x
+    local.get $n
+    i32.mul
+    local.get $n
+    i32.add
+  )
+  (func $mark (param $p i32) (result i32)
+    local.get $p
+    i32.const 42
+    i32.store
+    i32.const 1
+  )
+  (func $test (export "test") (param $a i32) (result i32)
+    i32.const 16
+    call $mark
+    local.get $a
+    i32.const 8
+    call $scale
+    i32.add
+    i32.const 3
+    i32.const 8
+    call $scale
+    i32.add
+    i32.const 16
+    i32.load
+    i32.add
+  )
+)
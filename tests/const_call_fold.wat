@@ -0,0 +1,34 @@
+(module
+  (func $fact (param $n i32) (result i32)
+    (local $result i32)
+    i32.const 1
+    local.set $result
+    (loop $loop
+      local.get $result
+      local.get $n
+      i32.mul
+      local.set $result
+      local.get $n
+      i32.const 1
+      i32.sub
+      local.set $n
+      local.get $n
+      i32.const 1
+      i32.gt_s
+      br_if $loop
+    )
+    local.get $result
+  )
+  (func $test (export "test") (param $x i32) (result i32)
+    i32.const 10
+    call $fact
+    local.get $x
+    i32.add
+    i32.const 5
+    call $fact
+    i32.const 3
+    call $fact
+    i32.div_s
+    i32.add
+  )
+)
@@ -0,0 +1,74 @@
+(module
+  (memory 1)
+  ;; A[i][j] = A[i-1][j] + A[i][j-1]（1 <= i, j < n）：flow 相依的距離是 (1, 0)
+  ;; 跟 (0, 1)。j - 1 >= 0、j < n 看得出來，delinearization 才會拆維度
+  (func $test (export "test") (param $a i32) (param $n i32)
+    (local $i i32) (local $j i32)
+    i32.const 1
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 1
+        local.set $j
+        block
+          loop
+            local.get $j
+            local.get $n
+            i32.lt_s
+            i32.eqz
+            br_if 1
+            local.get $a
+            local.get $i
+            local.get $n
+            i32.mul
+            local.get $j
+            i32.add
+            i32.const 2
+            i32.shl
+            i32.add
+            local.get $a
+            local.get $i
+            i32.const 1
+            i32.sub
+            local.get $n
+            i32.mul
+            local.get $j
+            i32.add
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            local.get $a
+            local.get $i
+            local.get $n
+            i32.mul
+            local.get $j
+            i32.const 1
+            i32.sub
+            i32.add
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            i32.add
+            i32.store
+            local.get $j
+            i32.const 1
+            i32.add
+            local.set $j
+            br 0
+          end
+        end
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+)
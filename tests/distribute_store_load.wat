@@ -0,0 +1,160 @@
+(module
+  (memory 1)
+  ;; A[i] = A[i-1] + B[i]（recurrence）跟 C[i] *= B[i]（每輪獨立）在同一個 loop：
+  ;; --distribute 把 recurrence 拆成自己的 loop（A、B、C 是不同的參數指標，要
+  ;; --assume-noalias-params）
+  (func $kernel (param $a i32) (param $b i32) (param $c i32) (param $n i32)
+    (local $i i32)
+    i32.const 1
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $a
+        local.get $i
+        i32.const 1
+        i32.sub
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $b
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.add
+        i32.store
+        local.get $c
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $b
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $c
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.mul
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $k i32) (local $n i32) (local $s i32)
+    ;; A 在 0、B 在 256、C 在 512；n = (x & 31) + 2
+    local.get $x
+    i32.const 31
+    i32.and
+    i32.const 2
+    i32.add
+    local.set $n
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 64
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.store
+        i32.const 256
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 7
+        i32.and
+        local.get $x
+        i32.add
+        i32.store
+        i32.const 512
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.const 3
+        local.get $k
+        i32.sub
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 256
+    i32.const 512
+    local.get $n
+    call $kernel
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 64
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $k
+        i32.const 1
+        i32.add
+        i32.mul
+        i32.add
+        local.set $s
+        local.get $s
+        i32.const 512
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.xor
+        local.set $s
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    local.get $s)
+)
@@ -0,0 +1,54 @@
+(module
+  ;; 不開任何 pass（-O0）也會碰到的形狀：do-while（loop 最後是跳回去的
+  ;; br_if 0，中間還有跳出 block 的 br_if）、if 裡面的 block
+  (func $sum_to (param $n i32) (result i32)
+    (local $i i32)
+    (local $s i32)
+    block
+      loop
+        local.get $s
+        local.get $i
+        i32.add
+        local.set $s
+        local.get $s
+        i32.const 50
+        i32.gt_s
+        br_if 1
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        local.get $i
+        local.get $n
+        i32.lt_s
+        br_if 0
+      end
+    end
+    local.get $s)
+  (func $bump (param $x i32) (result i32)
+    (local $r i32)
+    local.get $x
+    i32.const 0
+    i32.ge_s
+    if
+      block
+        local.get $x
+        i32.const 100
+        i32.add
+        local.set $r
+      end
+      local.get $r
+      i32.const 1
+      i32.add
+      local.set $r
+    end
+    local.get $r)
+  (func (export "test") (param i32) (result i32)
+    local.get 0
+    call $sum_to
+    local.get 0
+    call $bump
+    i32.const 1000
+    i32.mul
+    i32.add)
+)
@@ -0,0 +1,15 @@
+(module
+  (memory 1)
+  (func (export "test") (param i32) (result i32)
+    i32.const 0
+    local.get 0
+    f32.convert_i32_s
+    f32.const 0.5
+    f32.mul
+    f32.store
+    i32.const 0
+    f32.load
+    f32.const 2.0
+    f32.mul
+    i32.trunc_f32_s)
+)
@@ -0,0 +1,32 @@
+(module
+  (memory 1)
+  (func $mad (param i32) (result f64)
+    ;; A[0] * A[1] + A[2]：a*b 不是整數倍的 double，合併成 FMA 結果就不一樣。
+    ;; --fast-math --fp-contract=off 不能合併
+    i32.const 0
+    f64.load
+    i32.const 8
+    f64.load
+    f64.mul
+    i32.const 16
+    f64.load
+    f64.add)
+  (func (export "test") (param i32) (result i32)
+    ;; (1 + 2^-30)(1 - 2^-30) - 1：分開捨入是 0，FMA 是 -2^-60
+    i32.const 0
+    f64.const 1.000000000931322574615478515625
+    f64.store
+    i32.const 8
+    f64.const 0.999999999068677425384521484375
+    f64.store
+    i32.const 16
+    f64.const -1
+    f64.store
+    i32.const 0
+    call $mad
+    f64.const 1152921504606846976
+    f64.mul
+    i32.trunc_f64_s
+    local.get 0
+    i32.add)
+)
@@ -0,0 +1,27 @@
+(module
+  (memory 1)
+  (func $axpy (param i32) (result f64)
+    ;; A[0] * A[1] + A[2]：--fp-contract=fast 時成為一個 F64Fma
+    i32.const 0
+    f64.load
+    i32.const 8
+    f64.load
+    f64.mul
+    i32.const 16
+    f64.load
+    f64.add)
+  (func (export "test") (param i32) (result i32)
+    i32.const 0
+    local.get 0
+    f64.convert_i32_s
+    f64.store
+    i32.const 8
+    f64.const 3
+    f64.store
+    i32.const 16
+    f64.const 4
+    f64.store
+    local.get 0
+    call $axpy
+    i32.trunc_f64_s)
+)
@@ -0,0 +1,27 @@
+(module
+  ;; 回傳值是 Param / if 合流的 phi：摘要要從 signature 看出是 f64，
+  ;; 不然 call 會被當成回傳 i32
+  (func $pick (param $a f64) (param $b f64) (param $c i32) (result f64)
+    local.get $c
+    if (result f64)
+      local.get $a
+    else
+      local.get $b
+    end
+  )
+  (func $first (param $a f64) (result f64)
+    local.get $a
+  )
+  (func $test (export "test") (param $x i32) (result i32)
+    f64.const 1.5
+    f64.const 2.5
+    local.get $x
+    call $pick
+    f64.const 2.25
+    call $first
+    f64.add
+    f64.const 4
+    f64.mul
+    i32.trunc_f64_s
+  )
+)
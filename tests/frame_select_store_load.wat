@@ -0,0 +1,29 @@
+(module
+  (memory 1)
+  (global $sp (mut i32) (i32.const 4096))
+  ;; 位址是 select(fp-8, fp-4)：decompose 認不出是 frame，但它可能就是
+  ;; fp-4，load elimination 不能把最後的 load 轉送成 1
+  (func (export "test") (param $c i32) (result i32)
+    (local $fp i32)
+    global.get $sp
+    local.set $fp
+    local.get $fp
+    i32.const 4
+    i32.sub
+    i32.const 1
+    i32.store
+    local.get $fp
+    i32.const 8
+    i32.sub
+    local.get $fp
+    i32.const 4
+    i32.sub
+    local.get $c
+    select
+    i32.const 2
+    i32.store
+    local.get $fp
+    i32.const 4
+    i32.sub
+    i32.load)
+)
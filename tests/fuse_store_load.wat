@@ -0,0 +1,301 @@
+(module
+  (memory 1)
+  ;; --fuse：fuse_fwd 併成一個 loop，fuse_back 的相依距離是負的，要留著兩個 loop
+  ;; C[i] 讀 A[i-1]、A[i]：S1(i) → S2(i + d) 的 d 是 1 跟 0，可以併
+  (func $fuse_fwd (param $a i32) (param $b i32) (param $c i32) (param $n i32)
+    (local $i i32)
+    i32.const 1
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $b
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.const 3
+        i32.mul
+        local.get $i
+        i32.add
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    i32.const 1
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $c
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $a
+        local.get $i
+        i32.const -1
+        i32.add
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.xor
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  ;; C[i] 讀 A[i+1]：d = -1，併起來之後 S2(i) 會讀到還沒寫的 A[i+1]，
+  ;; 一定要拒絕
+  (func $fuse_back (param $a i32) (param $b i32) (param $c i32) (param $n i32)
+    (local $i i32)
+    i32.const 1
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $b
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.const 3
+        i32.mul
+        local.get $i
+        i32.add
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    i32.const 1
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $c
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $a
+        local.get $i
+        i32.const 1
+        i32.add
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.xor
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $k i32) (local $n i32) (local $s i32)
+    ;; A 在 0、B 在 8192、C 在 16384；n = 100 + (x & 255)。A 先填好，沒被
+    ;; 第一個 loop 蓋掉的 A[n] 也會被 fuse_back 讀到
+    local.get $x
+    i32.const 255
+    i32.and
+    i32.const 100
+    i32.add
+    local.set $n
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 2048
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 11
+        i32.mul
+        i32.const 63
+        i32.and
+        local.get $x
+        i32.sub
+        i32.store
+        i32.const 8192
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 5
+        i32.mul
+        i32.const 127
+        i32.and
+        local.get $x
+        i32.add
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 8192
+    i32.const 16384
+    local.get $n
+    call $fuse_fwd
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 31
+        i32.mul
+        i32.const 16384
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.add
+        local.set $s
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 2048
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 8192
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.const 16384
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.xor
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 8192
+    i32.const 16384
+    local.get $n
+    call $fuse_back
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 31
+        i32.mul
+        i32.const 16384
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.add
+        local.set $s
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    local.get $s)
+)
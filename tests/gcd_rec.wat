@@ -0,0 +1,15 @@
+(module
+  (func (export "test") (param i32 i32) (result i32)
+    local.get 1
+    i32.eqz
+    if (result i32)
+      local.get 0
+    else
+      local.get 1
+      local.get 0
+      local.get 1
+      i32.rem_u
+      call 0
+    end
+  )
+)
@@ -0,0 +1,25 @@
+(module
+  (memory 1)
+  (global $sp (mut i32) (i32.const 4096))
+  (global $buf (mut i32) (i32.const 0))
+  ;; global 1 不是 stack pointer，只是一個指標：buf - 4 跟 q 可能是同一格，
+  ;; load elimination 不能把最後的 load 轉送成 10
+  (func $poke (param $q i32) (result i32)
+    (local $p i32)
+    global.get $buf
+    i32.const 4
+    i32.sub
+    local.tee $p
+    i32.const 10
+    i32.store
+    local.get $q
+    i32.const 20
+    i32.store
+    local.get $p
+    i32.load)
+  (func (export "test") (param i32) (result i32)
+    i32.const 64
+    global.set $buf
+    local.get 0
+    call $poke)
+)
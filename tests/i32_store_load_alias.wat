@@ -0,0 +1,17 @@
+(module
+  (memory 1)
+  ;; 兩個指標參數：p == q 時第二個 store 會蓋掉第一個，
+  ;; load elimination 不能把 load p 轉送成 10
+  (func (export "test") (param i32 i32) (result i32)
+    local.get 0
+    i32.const 10
+    i32.store
+    local.get 1
+    i32.const 20
+    i32.store offset=4
+    local.get 0
+    i32.load
+    local.get 0
+    i32.load
+    i32.add)
+)
@@ -0,0 +1,18 @@
+(module
+  ;; 引數、結果都超過 32 位元：--partial-eval 折疊出來的 i64 常數要是完整的
+  (func $twice (param $v i64) (result i64)
+    local.get $v
+    local.get $v
+    i64.add
+  )
+  (func $test (export "test") (param $x i32) (result i32)
+    ;; 0x180000000 * 2 / 0x100000000 = 3
+    i64.const 0x180000000
+    call $twice
+    i64.const 0x100000000
+    i64.div_s
+    i32.wrap_i64
+    local.get $x
+    i32.add
+  )
+)
@@ -0,0 +1,21 @@
+(module
+  ;; 兩邊都是 Param 的 merge phi：--if-convert 換成的 Select 型別要從
+  ;; 簽章拿到 i64，不能當成 i32 把高 32 位元截掉
+  (func $test (export "test") (param $c i64) (param $a i64) (param $b i64) (result i64)
+    (local $r i64)
+    ;; c ? a : b
+    block
+      block
+        local.get $c
+        i32.wrap_i64
+        i32.eqz
+        br_if 0
+        local.get $a
+        local.set $r
+        br 1
+      end
+      local.get $b
+      local.set $r
+    end
+    local.get $r)
+)
@@ -0,0 +1,74 @@
+(module
+  (memory 1)
+  ;; --assume-inbounds-addressing：i 是 IV，A[i] 算成 base + sext(i)*4，loop 裡
+  ;; 用 64-bit 的影子 phi；loop 結束後再拿 i 算位址要照一般值延伸
+  (func $scale (param $a i32) (param $n i32) (result i32)
+    (local $i i32)
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.ge_s
+        br_if 1
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.const 3
+        i32.mul
+        local.get $i
+        i32.add
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    ;; A[n - 1]
+    local.get $a
+    local.get $i
+    i32.const 2
+    i32.shl
+    i32.add
+    i32.const 4
+    i32.sub
+    i32.load)
+  (func (export "test") (param i32) (result i32)
+    (local $k i32)
+    ;; A[k] = x + k，scale 之後 A[k] = 3x + 4k：回傳 A[7] + A[1]
+    block
+      loop
+        local.get $k
+        i32.const 8
+        i32.ge_s
+        br_if 1
+        local.get $k
+        i32.const 2
+        i32.shl
+        local.get 0
+        local.get $k
+        i32.add
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 8
+    call $scale
+    i32.const 4
+    i32.load
+    i32.add)
+)
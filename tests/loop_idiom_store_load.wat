@@ -0,0 +1,107 @@
+(module
+  (memory 1)
+  ;; A[i] = 0（lo <= i < n）：--loop-idiom 換成 memory.fill，n <= lo 時不寫
+  (func $clear (param $a i32) (param $lo i32) (param $n i32)
+    (local $i i32)
+    local.get $lo
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.const 0
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  ;; B[i] = A[i]（0 <= i < n）：--loop-idiom 換成 memory.copy
+  (func $copy (param $b i32) (param $a i32) (param $n i32)
+    (local $i i32)
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $b
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  (func (export "test") (param i32) (result i32)
+    (local $k i32)
+    ;; A[k] = k + x + 1，A 在 0、B 在 64；清掉 A[2 .. x & 7) 再整個複製到 B
+    block
+      loop
+        local.get $k
+        i32.const 10
+        i32.ge_s
+        br_if 1
+        local.get $k
+        i32.const 2
+        i32.shl
+        local.get 0
+        local.get $k
+        i32.add
+        i32.const 1
+        i32.add
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 2
+    local.get 0
+    i32.const 7
+    i32.and
+    call $clear
+    i32.const 64
+    i32.const 0
+    i32.const 10
+    call $copy
+    i32.const 72
+    i32.load
+    i32.const 76
+    i32.load
+    i32.const 100
+    i32.mul
+    i32.add
+    i32.const 100
+    i32.load
+    i32.const 10000
+    i32.mul
+    i32.add)
+)
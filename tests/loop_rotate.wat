@@ -0,0 +1,59 @@
+(module
+  ;; top-tested loop（clang -O0 的 block + br_if 1 + br 0）；--rotate-loops
+  ;; 轉成有 guard 的 do-while。n <= 0 時走 guard 的另一邊，loop 之後的
+  ;; i / sum 是入口值；內層 loop 在 i = 0 時一輪都不跑
+  (func $test (export "test") (param $n i32) (result i32)
+    (local $sum i32)
+    (local $i i32)
+    (local $j i32)
+    i32.const 0
+    local.set $sum
+    i32.const 0
+    local.set $i
+    (block $done
+      (loop $loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if $done
+        i32.const 0
+        local.set $j
+        (block $inner_done
+          (loop $inner
+            local.get $j
+            local.get $i
+            i32.lt_s
+            i32.eqz
+            br_if $inner_done
+            local.get $sum
+            local.get $j
+            i32.const 3
+            i32.mul
+            i32.add
+            local.set $sum
+            local.get $j
+            i32.const 1
+            i32.add
+            local.set $j
+            br $inner
+          )
+        )
+        local.get $sum
+        local.get $j
+        i32.add
+        local.set $sum
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br $loop
+      )
+    )
+    local.get $i
+    i32.const 1000
+    i32.mul
+    local.get $sum
+    i32.add
+  )
+)
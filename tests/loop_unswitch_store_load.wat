@@ -0,0 +1,91 @@
+(module
+  (memory 1)
+  ;; if 的條件 mode & 1 跟 i 無關，arm 裡有 store、if-convert 換不掉；
+  ;; --unswitch 複製成 A[i] *= 3 跟 A[i] += mode 兩個沒有分支的 loop
+  (func $scale (param $a i32) (param $n i32) (param $mode i32)
+    (local $i i32)
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $mode
+        i32.const 1
+        i32.and
+        if
+          local.get $a
+          local.get $i
+          i32.const 2
+          i32.shl
+          i32.add
+          local.get $a
+          local.get $i
+          i32.const 2
+          i32.shl
+          i32.add
+          i32.load
+          i32.const 3
+          i32.mul
+          i32.store
+        else
+          local.get $a
+          local.get $i
+          i32.const 2
+          i32.shl
+          i32.add
+          local.get $a
+          local.get $i
+          i32.const 2
+          i32.shl
+          i32.add
+          i32.load
+          local.get $mode
+          i32.add
+          i32.store
+        end
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  (func (export "test") (param i32) (result i32)
+    (local $k i32)
+    ;; A[k] = k + x，A 在 0；x 是奇數時乘 3，偶數時加 x
+    block
+      loop
+        local.get $k
+        i32.const 10
+        i32.ge_s
+        br_if 1
+        local.get $k
+        i32.const 2
+        i32.shl
+        local.get 0
+        local.get $k
+        i32.add
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 10
+    local.get 0
+    call $scale
+    i32.const 36
+    i32.load
+    i32.const 8
+    i32.load
+    i32.const 100
+    i32.mul
+    i32.add)
+)
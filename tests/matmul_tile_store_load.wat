@@ -0,0 +1,193 @@
+(module
+  (memory 1)
+  ;; C[i][j] += A[i][k] * B[k][j]（n x n，i-j-k 順序）：--interchange 把 k 換到 j
+  ;; 外面讓最內層的 B / C 連續，--tile 再分塊；n 不是 tile 大小的倍數時
+  ;; 最後一塊不滿
+  (func $matmul (param $a i32) (param $b i32) (param $c i32) (param $n i32)
+    (local $i i32) (local $j i32) (local $k i32)
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.set $j
+        block
+          loop
+            local.get $j
+            local.get $n
+            i32.lt_s
+            i32.eqz
+            br_if 1
+            i32.const 0
+            local.set $k
+            block
+              loop
+                local.get $k
+                local.get $n
+                i32.lt_s
+                i32.eqz
+                br_if 1
+                local.get $c
+                local.get $i
+                local.get $n
+                i32.mul
+                local.get $j
+                i32.add
+                i32.const 2
+                i32.shl
+                i32.add
+                local.get $c
+                local.get $i
+                local.get $n
+                i32.mul
+                local.get $j
+                i32.add
+                i32.const 2
+                i32.shl
+                i32.add
+                i32.load
+                local.get $a
+                local.get $i
+                local.get $n
+                i32.mul
+                local.get $k
+                i32.add
+                i32.const 2
+                i32.shl
+                i32.add
+                i32.load
+                local.get $b
+                local.get $k
+                local.get $n
+                i32.mul
+                local.get $j
+                i32.add
+                i32.const 2
+                i32.shl
+                i32.add
+                i32.load
+                i32.mul
+                i32.add
+                i32.store
+                local.get $k
+                i32.const 1
+                i32.add
+                local.set $k
+                br 0
+              end
+            end
+            local.get $j
+            i32.const 1
+            i32.add
+            local.set $j
+            br 0
+          end
+        end
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $k i32) (local $n i32) (local $s i32)
+    ;; A 在 0、B 在 1024、C 在 2048（最多 16 x 16）；n = (x & 7) + 5
+    local.get $x
+    i32.const 7
+    i32.and
+    i32.const 5
+    i32.add
+    local.set $n
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 256
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 7
+        i32.mul
+        i32.const 15
+        i32.and
+        local.get $x
+        i32.add
+        i32.store
+        i32.const 1024
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 5
+        i32.mul
+        i32.const 7
+        i32.and
+        i32.const 3
+        i32.sub
+        i32.store
+        i32.const 2048
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 1024
+    i32.const 2048
+    local.get $n
+    call $matmul
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 256
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 2048
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $k
+        i32.const 15
+        i32.and
+        i32.const 1
+        i32.add
+        i32.mul
+        i32.add
+        local.set $s
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    local.get $s)
+)
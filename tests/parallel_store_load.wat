@@ -0,0 +1,137 @@
+(module
+  (memory 1)
+  ;; --threads=N 把兩個 loop 都拆成 task 交給 w2s_runtime（A、B、C 是不同的
+  ;; 參數指標，要 --assume-noalias-params）
+  (func $kernel (param $a i32) (param $b i32) (param $c i32) (param $n i32) (result i32)
+    (local $i i32) (local $s i32)
+    ;; C[i] = A[i] * B[i] + i：每輪獨立（DOALL）
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $c
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $b
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.mul
+        local.get $i
+        i32.add
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    ;; s += C[i]：i32 加法的 reduction，各 thread 的部分和最後加起來
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        local.get $c
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.add
+        local.set $s
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    local.get $s)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $k i32) (local $n i32) (local $s i32)
+    ;; A 在 0、B 在 16384、C 在 32768；n = 3000 + (x & 1023)，夠大才真的開 thread
+    local.get $x
+    i32.const 1023
+    i32.and
+    i32.const 3000
+    i32.add
+    local.set $n
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 63
+        i32.and
+        local.get $x
+        i32.add
+        i32.store
+        i32.const 16384
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 7
+        i32.mul
+        i32.const 31
+        i32.and
+        i32.const 9
+        i32.sub
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 16384
+    i32.const 32768
+    local.get $n
+    call $kernel
+    local.set $s
+    local.get $s
+    i32.const 3
+    i32.mul
+    i32.const 32768
+    i32.const 17
+    i32.const 2
+    i32.shl
+    i32.add
+    i32.load
+    i32.add)
+)
@@ -6,66 +6,62 @@ shift
 cd ~/wasm2sea/tests
 wat2wasm ${TEST}.wat -o ${TEST}.wasm 2>/dev/null
 
+# 上一個測試的 out.c / a.out 先刪掉：wasm2sea 或 cc 失敗時不能拿舊的來跑
+IR_DIR=~/wasm2sea/third_party/dstogov-ir
+rm -f $IR_DIR/out.c $IR_DIR/a.out
+
 cd ~/wasm2sea/build
-./wasm2sea ../tests/${TEST}.wasm 2>/dev/null
+# WASM2SEA_FLAGS：例如 WASM2SEA_FLAGS=-O1 ./run_differential.sh 用優化 pipeline 跑整組
+# out.c 直接用 wasm2sea 寫的：向量化 kernel、平行化 task 的 C glue 只在這裡面，
+# 從 .ir 用 ./ir --emit-c 重生會把它們弄丟（多函式的 module 更是拿到舊檔）
+./wasm2sea ../tests/${TEST}.wasm --out-c $IR_DIR/out.c $WASM2SEA_FLAGS 2>/dev/null || exit 1
 
-cd ~/wasm2sea/third_party/dstogov-ir
-if [[ "$TEST" == *nested_loop* ]]; then
-    ./ir ../../build/${TEST}.ir -O0 --emit-c out.c 2>/dev/null
-    sed -i '1s/^/int32_t local_0, local_1, local_2;\n/' out.c
-elif [[ -f "../../build/${TEST}.ir" ]]; then
-    num_funcs=$(grep -c '^{' ../../build/${TEST}.ir 2>/dev/null || echo 0)
-    if [[ "$num_funcs" -le 1 ]]; then
-        ./ir ../../build/${TEST}.ir --emit-c out.c 2>/dev/null
-    fi
-    # else: use out.c generated by wasm2sea via ir_emit_c
-fi
+cd $IR_DIR
+# --threads=N 的 out.c 會 include w2s_runtime.h、呼叫 w2s_parallel_for；一律連進來
+RUNTIME="-I../../runtime ../../runtime/w2s_runtime.c"
 
 if [[ "$TEST" == *store* ]] || [[ "$TEST" == *load* ]]; then
     if [[ "$TEST" == i64_* ]]; then
-        cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_mem_i64.c -o a.out \
-           $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+        cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_mem_i64.c -o a.out $RUNTIME \
+           $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
     else
-        cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_mem.c -o a.out \
-           $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+        cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_mem.c -o a.out $RUNTIME \
+           $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
     fi
 elif [[ "$TEST" == i64_* ]]; then
-    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_i64.c -o a.out \
-       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_i64.c -o a.out $RUNTIME \
+       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
 elif [[ "$TEST" == i32_wrap_* ]]; then
-    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_i64_ret_i32.c -o a.out \
-       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_i64_ret_i32.c -o a.out $RUNTIME \
+       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
 elif [[ "$TEST" == i32_trunc_* ]]; then
-    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_f64_ret_i32.c -o a.out \
-       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_f64_ret_i32.c -o a.out $RUNTIME \
+       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
 elif [[ "$TEST" == i64_trunc_* ]]; then
-    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_f64_ret_i64.c -o a.out \
-       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_f64_ret_i64.c -o a.out $RUNTIME \
+       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
 elif [[ "$TEST" == f64_convert_i32_* ]]; then
-    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_f64.c -o a.out \
-       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_f64.c -o a.out $RUNTIME \
+       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
 elif [[ "$TEST" == f64_convert_i64_* ]]; then
-    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_i64_ret_f64.c -o a.out \
-       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_i64_ret_f64.c -o a.out $RUNTIME \
+       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
 elif [[ "$TEST" == matmul* ]]; then
-    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_matmul.c -o a.out \
-       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_matmul.c -o a.out $RUNTIME \
+       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
 elif [[ "$TEST" == jacobi1d_kernel ]]; then
-    ./ir ../../build/${TEST}.ir --emit-c out.c 2>/dev/null
-
-    sed -i '1s/^/int32_t local_12, local_22, local_32, local_38, local_39, local_47, local_48, local_49, local_50, local_66, local_76, local_82, local_83, local_91, local_92, local_93, local_94;\n/' out.c
-    
     cp ../../tests/jacobi_harness.c /tmp/jacobi_harness_test.c
     sed -i 's/\bkernel_jacobi_1d\b/test/g' /tmp/jacobi_harness_test.c
     
     cc -O2 -include stdint.h -include stdbool.h -include math.h \
-       out.c /tmp/jacobi_harness_test.c -o a.out -lm
+       out.c /tmp/jacobi_harness_test.c -o a.out $RUNTIME -lm -lpthread
 elif [[ "$TEST" == bubble_sort* ]] || [[ "$TEST" == *sort* ]]; then
-    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_sort.c -o a.out \
-       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+    cc -O2 -include stdint.h -include stdbool.h out.c ../../tests/run_varargs_ffi_sort.c -o a.out $RUNTIME \
+       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
 else
-    cc -O2 -include stdint.h -include stdbool.h out.c run_varargs_ffi.c -o a.out \
-       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread 2>/dev/null
+    cc -O2 -include stdint.h -include stdbool.h out.c run_varargs_ffi.c -o a.out $RUNTIME \
+       $(pkg-config --cflags --libs libffi) -lm -ldl -lpthread
 fi
 
+[ -x a.out ] || { echo "$TEST: cc failed" >&2; exit 1; }
 ./a.out "$@"
\ No newline at end of file
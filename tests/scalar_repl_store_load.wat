@@ -0,0 +1,72 @@
+(module
+  (memory 1)
+  ;; C[j] += A[k] 對 k：C[j] 的位址跟 k 無關，--scalar-repl 換成 loop phi。
+  ;; loop 前的 C[j] *= 2（gemm 的 beta）先存取過同一個位置，n 不知道時也能換
+  (func $acc (param $c i32) (param $a i32) (param $n i32)
+    (local $k i32)
+    local.get $c
+    local.get $c
+    i32.load
+    i32.const 2
+    i32.mul
+    i32.store
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $c
+        local.get $c
+        i32.load
+        local.get $a
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.add
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end)
+  (func (export "test") (param i32) (result i32)
+    (local $k i32)
+    ;; A[k] = k + x（A 從 64 開始），C 在 0
+    block
+      loop
+        local.get $k
+        i32.const 10
+        i32.ge_s
+        br_if 1
+        local.get $k
+        i32.const 2
+        i32.shl
+        local.get 0
+        local.get $k
+        i32.add
+        i32.store offset=64
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 1
+    i32.store
+    i32.const 0
+    i32.const 64
+    i32.const 10
+    call $acc
+    i32.const 0
+    i32.load)
+)
@@ -0,0 +1,34 @@
+(module
+  ;; select 跟 clang -O0 的三元運算式（block + br_if）；-O1 的 --if-convert
+  ;; 把後者也換成 Select，bridge 兩個都是 ir_COND
+  (func $test (export "test") (param $a i32) (param $b i32) (result i32)
+    (local $lo i32) (local $hi i32)
+    ;; a < b ? a : b
+    local.get $a
+    local.get $b
+    local.get $a
+    local.get $b
+    i32.lt_s
+    select
+    local.set $lo
+    ;; a > b ? a : b
+    block
+      block
+        local.get $a
+        local.get $b
+        i32.gt_s
+        i32.eqz
+        br_if 0
+        local.get $a
+        local.set $hi
+        br 1
+      end
+      local.get $b
+      local.set $hi
+    end
+    local.get $hi
+    i32.const 100
+    i32.mul
+    local.get $lo
+    i32.add)
+)
@@ -0,0 +1,232 @@
+(module
+  (memory 1)
+  ;; --slp-vectorize：slp_madd 的 store 跟 reduction 合成向量，slp_shift 的指標可能重疊要拒絕
+  (func $slp_madd (param $p i32) (param $k i32) (result i32)
+    (local $s i32)
+    ;; A = p、B = p + 64、C = p + 128：四個位址連續的 store 是種子，load 也連續
+    local.get $p
+    i32.const 128
+    i32.add
+    i32.const 0
+    i32.add
+    local.get $p
+    i32.const 0
+    i32.add
+    i32.load
+    local.get $p
+    i32.const 64
+    i32.add
+    i32.const 0
+    i32.add
+    i32.load
+    i32.mul
+    local.get $k
+    i32.add
+    i32.store
+    local.get $p
+    i32.const 128
+    i32.add
+    i32.const 4
+    i32.add
+    local.get $p
+    i32.const 4
+    i32.add
+    i32.load
+    local.get $p
+    i32.const 64
+    i32.add
+    i32.const 4
+    i32.add
+    i32.load
+    i32.mul
+    local.get $k
+    i32.add
+    i32.store
+    local.get $p
+    i32.const 128
+    i32.add
+    i32.const 8
+    i32.add
+    local.get $p
+    i32.const 8
+    i32.add
+    i32.load
+    local.get $p
+    i32.const 64
+    i32.add
+    i32.const 8
+    i32.add
+    i32.load
+    i32.mul
+    local.get $k
+    i32.add
+    i32.store
+    local.get $p
+    i32.const 128
+    i32.add
+    i32.const 12
+    i32.add
+    local.get $p
+    i32.const 12
+    i32.add
+    i32.load
+    local.get $p
+    i32.const 64
+    i32.add
+    i32.const 12
+    i32.add
+    i32.load
+    i32.mul
+    local.get $k
+    i32.add
+    i32.store
+    ;; C[0] + C[1] + C[2] + C[3]：reduction 種子
+    local.get $p
+    i32.const 128
+    i32.add
+    i32.const 0
+    i32.add
+    i32.load
+    local.get $p
+    i32.const 128
+    i32.add
+    i32.const 4
+    i32.add
+    i32.load
+    i32.add
+    local.get $p
+    i32.const 128
+    i32.add
+    i32.const 8
+    i32.add
+    i32.load
+    i32.add
+    local.get $p
+    i32.const 128
+    i32.add
+    i32.const 12
+    i32.add
+    i32.load
+    i32.add
+    local.set $s
+    local.get $s)
+  ;; a、c 是不同的參數，沒有 --assume-noalias-params 時可能重疊（test 傳 c = a + 4，
+  ;; C[0] 就是接著要讀的 A[1]），load 不能搬到 store 前面，要留成純量
+  (func $slp_shift (param $a i32) (param $c i32)
+    local.get $c
+    i32.const 0
+    i32.add
+    local.get $a
+    i32.const 0
+    i32.add
+    i32.load
+    i32.const 3
+    i32.mul
+    i32.const 7
+    i32.add
+    i32.store
+    local.get $c
+    i32.const 4
+    i32.add
+    local.get $a
+    i32.const 4
+    i32.add
+    i32.load
+    i32.const 3
+    i32.mul
+    i32.const 7
+    i32.add
+    i32.store
+    local.get $c
+    i32.const 8
+    i32.add
+    local.get $a
+    i32.const 8
+    i32.add
+    i32.load
+    i32.const 3
+    i32.mul
+    i32.const 7
+    i32.add
+    i32.store
+    local.get $c
+    i32.const 12
+    i32.add
+    local.get $a
+    i32.const 12
+    i32.add
+    i32.load
+    i32.const 3
+    i32.mul
+    i32.const 7
+    i32.add
+    i32.store)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $k i32) (local $s i32)
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 48
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 11
+        i32.mul
+        i32.const 63
+        i32.and
+        local.get $x
+        i32.sub
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    local.get $x
+    i32.const 3
+    i32.add
+    call $slp_madd
+    local.set $s
+    i32.const 0
+    i32.const 4
+    call $slp_shift
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 48
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 31
+        i32.mul
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.add
+        local.set $s
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    local.get $s)
+)
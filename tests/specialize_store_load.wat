@@ -0,0 +1,124 @@
+(module
+  (memory 1)
+  ;; B[i] += A[i] * k（0 <= i < n）
+  (func $axpy (param $a i32) (param $b i32) (param $n i32) (param $k i32)
+    (local $i i32)
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $b
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $b
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $k
+        i32.mul
+        i32.add
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $i i32) (local $s i32)
+    ;; A（0）[i] = i + x、B（128）[i] = 2i
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        i32.const 16
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $i
+        local.get $x
+        i32.add
+        i32.store
+        i32.const 128
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $i
+        i32.const 1
+        i32.shl
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    ;; 常數引數的 call site：--specialize-calls 改呼叫 n = 16、k = 3 的 clone
+    i32.const 0
+    i32.const 128
+    i32.const 16
+    i32.const 3
+    call $axpy
+    ;; n、k 不是常數：clone 只固定 A、B 的位址
+    i32.const 0
+    i32.const 128
+    local.get $x
+    i32.const 15
+    i32.and
+    local.get $x
+    call $axpy
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        i32.const 16
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 128
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $i
+        i32.const 1
+        i32.add
+        i32.mul
+        i32.add
+        local.set $s
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    local.get $s)
+)
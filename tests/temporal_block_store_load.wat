@@ -0,0 +1,191 @@
+(module
+  (memory 1)
+  ;; --temporal-blocking 把 t 跟兩個 sweep 切成平行四邊形的 tile；--tile-size=16 讓
+  ;; n 分成十幾個 tile，tile 邊界上的斜切跟 min / max 都會跑到
+  (func $kernel (param $a i32) (param $b i32) (param $n i32) (param $tsteps i32)
+    (local $t i32) (local $i i32) (local $n1 i32)
+    local.get $n
+    i32.const 1
+    i32.sub
+    local.set $n1
+    ;; jacobi-1d：B[i] = A[i-1] + 2·A[i] + A[i+1]，A[i] = B[i] ^ t；兩個 sweep 的
+    ;; i 距離 ±1，要斜切（σ > 0）才能把幾個時間步塞進同一個 tile
+    i32.const 0
+    local.set $t
+    block
+      loop
+        local.get $t
+        local.get $tsteps
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 1
+        local.set $i
+        block
+          loop
+            local.get $i
+            local.get $n1
+            i32.lt_s
+            i32.eqz
+            br_if 1
+            local.get $b
+            local.get $i
+            i32.const 2
+            i32.shl
+            i32.add
+            local.get $a
+            local.get $i
+            i32.const 1
+            i32.sub
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            local.get $a
+            local.get $i
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            i32.const 1
+            i32.shl
+            i32.add
+            local.get $a
+            local.get $i
+            i32.const 1
+            i32.add
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            i32.add
+            i32.store
+            local.get $i
+            i32.const 1
+            i32.add
+            local.set $i
+            br 0
+          end
+        end
+        i32.const 1
+        local.set $i
+        block
+          loop
+            local.get $i
+            local.get $n1
+            i32.lt_s
+            i32.eqz
+            br_if 1
+            local.get $a
+            local.get $i
+            i32.const 2
+            i32.shl
+            i32.add
+            local.get $b
+            local.get $i
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            local.get $t
+            i32.xor
+            i32.store
+            local.get $i
+            i32.const 1
+            i32.add
+            local.set $i
+            br 0
+          end
+        end
+        local.get $t
+        i32.const 1
+        i32.add
+        local.set $t
+        br 0
+      end
+    end)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $k i32) (local $n i32) (local $tsteps i32) (local $s i32)
+    ;; A 在 0、B 在 8192；n = 200 + (x & 63)，T = 5 + (x & 7)
+    local.get $x
+    i32.const 63
+    i32.and
+    i32.const 200
+    i32.add
+    local.set $n
+    local.get $x
+    i32.const 7
+    i32.and
+    i32.const 5
+    i32.add
+    local.set $tsteps
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 29
+        i32.mul
+        i32.const 255
+        i32.and
+        local.get $x
+        i32.add
+        i32.store
+        i32.const 8192
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.const 0
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    i32.const 8192
+    local.get $n
+    local.get $tsteps
+    call $kernel
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 31
+        i32.mul
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.add
+        local.set $s
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    local.get $s)
+)
@@ -0,0 +1,239 @@
+(module
+  (memory 1)
+  ;; S[i] += A[i][j]：store 只跟外層 i 有關，可以 unroll-and-jam；n 是奇數時
+  ;; 外層剩下的迭代走 remainder。S、A 是不同的參數指標，要 --assume-noalias-params
+  (func $rowsum (param $a i32) (param $s i32) (param $n i32) (param $m i32)
+    (local $i i32) (local $j i32)
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.set $j
+        block
+          loop
+            local.get $j
+            local.get $m
+            i32.lt_s
+            i32.eqz
+            br_if 1
+            local.get $s
+            local.get $i
+            i32.const 2
+            i32.shl
+            i32.add
+            local.get $s
+            local.get $i
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            local.get $a
+            local.get $i
+            i32.const 8
+            i32.mul
+            local.get $j
+            i32.add
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            i32.add
+            i32.store
+            local.get $j
+            i32.const 1
+            i32.add
+            local.set $j
+            br 0
+          end
+        end
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  ;; T[j] += A[i][j]：store 跟內層 j 有關，外層迭代之間有相依，不能 jam
+  (func $colsum (param $a i32) (param $t i32) (param $n i32) (param $m i32)
+    (local $i i32) (local $j i32)
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.set $j
+        block
+          loop
+            local.get $j
+            local.get $m
+            i32.lt_s
+            i32.eqz
+            br_if 1
+            local.get $t
+            local.get $j
+            i32.const 2
+            i32.shl
+            i32.add
+            local.get $t
+            local.get $j
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            local.get $a
+            local.get $i
+            i32.const 8
+            i32.mul
+            local.get $j
+            i32.add
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            i32.add
+            i32.store
+            local.get $j
+            i32.const 1
+            i32.add
+            local.set $j
+            br 0
+          end
+        end
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $k i32) (local $n i32) (local $s i32)
+    ;; A（0）是 16 x 8、S 在 1024、T 在 2048；外層 n = (x & 7) + 3
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 128
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 3
+        i32.mul
+        local.get $x
+        i32.add
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 16
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 1024
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.store
+        i32.const 2048
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.const 0
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    local.get $x
+    i32.const 7
+    i32.and
+    i32.const 3
+    i32.add
+    local.set $n
+    i32.const 0
+    i32.const 1024
+    local.get $n
+    i32.const 8
+    call $rowsum
+    i32.const 0
+    i32.const 2048
+    local.get $n
+    i32.const 8
+    call $colsum
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        i32.const 16
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 1024
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $k
+        i32.const 1
+        i32.add
+        i32.mul
+        i32.add
+        local.set $s
+        local.get $s
+        i32.const 2048
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $k
+        i32.const 7
+        i32.add
+        i32.mul
+        i32.add
+        local.set $s
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    local.get $s)
+)
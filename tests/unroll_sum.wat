@@ -0,0 +1,31 @@
+(module
+  (func $test (export "test") (param $n i32) (result i32)
+    (local $sum i32)
+    (local $i i32)
+    i32.const 0
+    local.set $sum
+    i32.const 0
+    local.set $i
+    (block $done
+      (loop $loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if $done
+        local.get $sum
+        local.get $i
+        local.get $i
+        i32.mul
+        i32.add
+        local.set $sum
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br $loop
+      )
+    )
+    local.get $sum
+  )
+)
@@ -0,0 +1,20 @@
+(module
+  (memory 1)
+  (func $fill (param i32)
+    i32.const 0
+    local.get 0
+    i32x4.splat
+    v128.const i32x4 1 2 3 4
+    i32x4.add
+    v128.store)
+  (func $get (param i32) (result i32)
+    local.get 0
+    i32.const 4
+    i32.mul
+    i32.load)
+  (func (export "test") (param i32) (result i32)
+    local.get 0
+    call $fill
+    i32.const 2
+    call $get)
+)
@@ -0,0 +1,217 @@
+(module
+  (memory 1)
+  ;; --vectorize：vec_fma 向量化（含 remainder），vec_shift 的指標可能重疊要拒絕
+  ;; n 不是 VF 的倍數，remainder loop 每次都會跑到
+  (func $vec_fma (param $p i32) (param $n i32) (param $k i32) (result i32)
+    (local $i i32) (local $s i32)
+    ;; A = p、B = p + 4096、C = p + 8192：同一個 base 差常數，相依距離 1024 / 2048 >= VF
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $p
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.const 8192
+        i32.add
+        local.get $p
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        local.get $k
+        i32.mul
+        local.get $p
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.const 4096
+        i32.add
+        i32.load
+        i32.add
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    ;; s += C[i] ^ B[i]：i32 的 reduction，每個 lane 各自累積
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        local.get $p
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.const 8192
+        i32.add
+        i32.load
+        local.get $p
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.const 4096
+        i32.add
+        i32.load
+        i32.xor
+        i32.add
+        local.set $s
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    local.get $s)
+  ;; a、c 是不同的參數，沒有 --assume-noalias-params 時可能重疊（test 傳 c = a + 4，
+  ;; C[i] 就是下一輪的 A[i+1]），一定要留成純量
+  (func $vec_shift (param $a i32) (param $c i32) (param $n i32)
+    (local $i i32)
+    i32.const 0
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $c
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $a
+        local.get $i
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.const 3
+        i32.mul
+        i32.const 7
+        i32.add
+        i32.store
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $k i32) (local $n i32) (local $s i32)
+    ;; n = 37 + (x & 31)，A、B 從 0、4096 開始填
+    local.get $x
+    i32.const 31
+    i32.and
+    i32.const 37
+    i32.add
+    local.set $n
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 11
+        i32.mul
+        i32.const 63
+        i32.and
+        local.get $x
+        i32.sub
+        i32.store
+        i32.const 4096
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 5
+        i32.mul
+        i32.const 127
+        i32.and
+        local.get $x
+        i32.add
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    local.get $n
+    local.get $x
+    i32.const 7
+    i32.and
+    i32.const 2
+    i32.add
+    call $vec_fma
+    local.set $s
+    i32.const 8192
+    i32.const 8196
+    local.get $n
+    call $vec_shift
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $n
+        i32.const 1
+        i32.add
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 31
+        i32.mul
+        i32.const 8192
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.add
+        local.set $s
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    local.get $s)
+)
@@ -0,0 +1,164 @@
+(module
+  (memory 1)
+  ;; --threads=N 把 i、j 斜切成 tile 的波面（value_ir_wavefront），同一條波面上的
+  ;; tile 交給 w2s_runtime；--tile-size=8 讓每條波面有好幾個 tile
+  (func $kernel (param $a i32) (param $n i32) (param $m i32)
+    (local $i i32) (local $j i32) (local $m1 i32)
+    local.get $m
+    i32.const 1
+    i32.sub
+    local.set $m1
+    ;; A[i][j] = (A[i-1][j+1] + A[i][j-1]) ^ i：距離 (1,-1) 與 (0,1)，i、j 兩層都
+    ;; 不是 DOALL；j 斜切成 j + i 之後才 fully permutable，tile 沿 I + J 的波面平行
+    i32.const 1
+    local.set $i
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 1
+        local.set $j
+        block
+          loop
+            local.get $j
+            local.get $m1
+            i32.lt_s
+            i32.eqz
+            br_if 1
+            local.get $a
+            local.get $i
+            local.get $m
+            i32.mul
+            local.get $j
+            i32.add
+            i32.const 2
+            i32.shl
+            i32.add
+            local.get $a
+            local.get $i
+            i32.const 1
+            i32.sub
+            local.get $m
+            i32.mul
+            local.get $j
+            i32.const 1
+            i32.add
+            i32.add
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            local.get $a
+            local.get $i
+            local.get $m
+            i32.mul
+            local.get $j
+            i32.const 1
+            i32.sub
+            i32.add
+            i32.const 2
+            i32.shl
+            i32.add
+            i32.load
+            i32.add
+            local.get $i
+            i32.xor
+            i32.store
+            local.get $j
+            i32.const 1
+            i32.add
+            local.set $j
+            br 0
+          end
+        end
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end)
+  (func $test (export "test") (param $x i32) (result i32)
+    (local $k i32) (local $n i32) (local $m i32) (local $nm i32) (local $s i32)
+    ;; n × m 最大 91 × 95，A 從 0 開始放得進一頁
+    local.get $x
+    i32.const 31
+    i32.and
+    i32.const 60
+    i32.add
+    local.set $n
+    local.get $x
+    i32.const 15
+    i32.and
+    i32.const 80
+    i32.add
+    local.set $m
+    local.get $n
+    local.get $m
+    i32.mul
+    local.set $nm
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $nm
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $k
+        i32.const 13
+        i32.mul
+        i32.const 127
+        i32.and
+        local.get $x
+        i32.add
+        i32.store
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    i32.const 0
+    local.get $n
+    local.get $m
+    call $kernel
+    i32.const 0
+    local.set $k
+    block
+      loop
+        local.get $k
+        local.get $nm
+        i32.lt_s
+        i32.eqz
+        br_if 1
+        local.get $s
+        i32.const 31
+        i32.mul
+        i32.const 0
+        local.get $k
+        i32.const 2
+        i32.shl
+        i32.add
+        i32.load
+        i32.add
+        local.set $s
+        local.get $k
+        i32.const 1
+        i32.add
+        local.set $k
+        br 0
+      end
+    end
+    local.get $s)
+)